@@ -61,9 +61,311 @@ typedef enum {
     BFI_E_LOAD_IDX_LEN,
     BFI_E_LOAD_ZERO_LEN,
     BFI_E_LOAD_INDEX,
+    BFI_E_MEM,
+    BFI_E_STO_SECTION,
+    BFI_E_LOAD_VERSION,
+    BFI_E_LOAD_SECTION,
+    BFI_E_LOAD_NO_SECTION,
+    BFI_E_ENGINE,
+    BFI_E_RANGE_FIELD,
+    BFI_E_FAMILY,
+    BFI_E_SUMMARY,
+    BFI_E_CATALOG,
+    BFI_E_DELTA,
+    BFI_E_CHECKSUM,
+    BFI_E_LOCK,
+    BFI_E_TIME_SLOT,
+    BFI_E_POSTINGS,
+    BFI_E_RESIZE,
 }bfi_ecode_t;
 
+/**
+ * \brief Engine (i.e. type of filter) of an index
+ */
+typedef enum {
+    BFI_ENGINE_STANDARD = 0,    ///< Bloom filter
+    BFI_ENGINE_STABLE = 1,      ///< Stable Bloom filter (decaying cells)
+    BFI_ENGINE_TEMPORAL = 2,    ///< Temporal Bloom filter (time slot masks)
+    BFI_ENGINE_QUOTIENT = 3,    ///< Quotient filter (mergeable, resizable)
+    BFI_ENGINE_REGISTER = 4,    ///< Bloom filter with bits of a key in a word
+}bfi_engine_t;
+
+/**
+ * \brief Hash function of an index
+ */
+typedef enum {
+    BFI_HASH_AP = 0,            ///< Arash Partow's hash (BloomFilter.hpp)
+}bfi_hash_t;
+
+/**
+ * \brief Parameters of a new index (see bfi_init_index_params())
+ *
+ * Always initialize parameters by bfi_params_init() first, so newly added
+ * parameters keep their default values.
+ */
+typedef struct {
+    bfi_engine_t engine;        ///< Engine of the index
+    uint64_t est_item_cnt;      ///< Estimated count of items in the index
+    double fp_prob;             ///< Required false positive probability
+
+    /** Stable Bloom filter (BFI_ENGINE_STABLE) parameters. Table size and
+     * count of hash functions are computed for est_item_cnt and fp_prob as for
+     * a Bloom filter, est_item_cnt is the count of recent items which should be
+     * remembered and fp_prob is the stable false positive probability.
+     */
+    unsigned int stable_cell_max;       ///< Maximal value of a cell (1-255)
+    /** Count of cells decremented per insertion (decay rate), 0 means optimal
+     * count for fp_prob. Item fades out after about
+     * stable_cell_max * table size / stable_decrement_cnt insertions.
+     */
+    uint64_t stable_decrement_cnt;
+
+    /** Temporal Bloom filter (BFI_ENGINE_TEMPORAL) parameters. Every cell is
+     * a mask of time slots (sub-intervals of the interval of the index, e.g.
+     * minutes of an hour), 8-bit up to 8 slots and 16-bit otherwise. Table
+     * size and count of hash functions are computed for est_item_cnt (items
+     * of all slots) and fp_prob as for a Bloom filter.
+     */
+    unsigned int temporal_slot_cnt;     ///< Count of time slots (1-16)
+
+    /** Quotient filter (BFI_ENGINE_QUOTIENT) parameters. Table has a slot
+     * per 0.75 of est_item_cnt rounded up to a power of 2, every slot stores
+     * remainder of a fingerprint long enough for fp_prob plus
+     * quotient_growth_bits bits. Every doubling of the table (see
+     * bfi_resize_index()) takes one remainder bit, so the index keeps fp_prob
+     * after quotient_growth_bits doublings. Only indexes of the same
+     * est_item_cnt, fp_prob and quotient_growth_bits could be merged.
+     */
+    unsigned int quotient_growth_bits;  ///< Bits reserved for growth (0-8)
+
+    /* Register-blocked Bloom filter (BFI_ENGINE_REGISTER) has no own
+     * parameters. All bits of a key are in one 64-bit word, so a lookup is
+     * one load whatever the count of bits per key (hash_cnt) is, but keys
+     * sharing a word raise false positives. Table size and bits per key are
+     * planned for est_item_cnt and fp_prob by a model of this trade-off
+     * (about 1.1 to 1.3 times the size of a Bloom filter for fp_prob 0.1 to
+     * 0.01, about 1.8 times for 0.001). Keys are hashed by one 32-bit hash,
+     * so fp_prob lower than about est_item_cnt / 2^32 is not reachable. The
+     * engine is meant for small hot filters, the table has at most 2^22
+     * words (32 MiB).
+     */
+
+    /** Optional count-min sketch of item frequencies (see
+     * bfi_estimate_count()), updated by the same hash values as the filter.
+     * Estimate exceeds real count by at most e / cms_width * (count of all
+     * insertions) with probability 1 - e^(-cms_depth). Sketch is not created
+     * if cms_width or cms_depth is 0 (default). cms_depth is limited by
+     * the count of hash functions of the filter.
+     */
+    uint32_t cms_width;                 ///< Counters per row
+    uint32_t cms_depth;                 ///< Count of rows
+    bool cms_conservative;              ///< Use conservative update
+    /** Random seed of the filter (selects its hash functions), 0 means
+     * the default seed. Used by BFI_ENGINE_STANDARD only. Indexes to be
+     * merged have to share the seed (see bfi_family_t).
+     */
+    uint64_t seed;
+    /** Count of hash functions and table size (bits) of the filter instead
+     * of the optimal ones for est_item_cnt and fp_prob (e.g. recommended by
+     * bfi_autotune()), both have to be set. 0 and 0 means optimal. hash_cnt
+     * is the count of bits per key (1-16) of BFI_ENGINE_REGISTER.
+     */
+    uint32_t hash_cnt;
+    uint64_t table_size;
+} bfi_params_t;
+
+// Maximal count of configurations benchmarked by bfi_autotune()
+#define BFI_TUNE_CANDIDATE_MAX 8
+
+/**
+ * \brief Configuration benchmarked by bfi_autotune()
+ */
+typedef struct {
+    uint32_t hash_cnt;          ///< Count of hash functions
+    uint64_t table_size;        ///< Size of the filter table (bits)
+    double fp_rate;             ///< Measured false positive rate
+    double insert_rate;         ///< Measured insertions per second
+    double lookup_rate;         ///< Measured lookups per second
+    bool selected;              ///< Recommended configuration
+} bfi_tune_candidate_t;
+
+/**
+ * \brief Family of indexes (filters which could be merged)
+ *
+ * Filters of one family use the same hash functions and table size, so they
+ * could be merged (e.g. indexes of several collectors). Descriptor is created
+ * once by bfi_family_create() and shared, every node then creates its indexes
+ * by bfi_init_index_family(). Descriptor of a stored index could be read by
+ * bfi_read_family() without loading the whole index.
+ */
+typedef struct {
+    bfi_engine_t engine;        ///< Engine of indexes
+    bfi_hash_t hash;            ///< Hash function
+    uint64_t seed;              ///< Random seed of the filter
+    uint64_t table_size;        ///< Size of the filter table (bits, slots of
+                                ///< BFI_ENGINE_QUOTIENT)
+    uint32_t hash_cnt;          ///< Count of hash functions
+    uint64_t est_item_cnt;      ///< Estimated count of items (informational)
+    double fp_prob;             ///< False positive probability (informational)
+} bfi_family_t;
+
+/**
+ * \brief Encoding of a stored index (see bfi_store_index_opts())
+ */
+typedef enum {
+    BFI_STORE_RAW = 0,          ///< Filters stored as they are in memory
+    /** Archival encoding - filters are split to chunks and every chunk is
+     * encoded by the shortest of: Rice coded gaps between set bits (sparse
+     * filters), run-length encoded zero bytes or raw bytes (dense filters).
+     */
+    BFI_STORE_COMPRESSED = 1,
+}bfi_store_encoding_t;
+
+// Sizes (in 64 bit words) of presence masks of a zone map
+#define BFI_ZONE_IPV4_WORDS 4
+#define BFI_ZONE_IPV6_WORDS 16
+
+/**
+ * \brief Zone map of an index
+ *
+ * Exact summary of addresses inserted into an index: range of IPv4 addresses
+ * (4 byte keys, network byte order), presence of their first octets and
+ * presence of /16 prefixes of IPv6 addresses (16 byte keys, hashed to 1024
+ * bits). Zone map rejects an address before the filter is queried. Indexes
+ * loaded from files without a zone map have an invalid zone map (every
+ * address passes).
+ */
+typedef struct {
+    bool valid;                 ///< Zone map describes all inserted addresses
+    uint32_t ipv4_min;          ///< Lowest IPv4 address (host byte order)
+    uint32_t ipv4_max;          ///< Highest IPv4 address (host byte order)
+    uint64_t ipv4_octets[BFI_ZONE_IPV4_WORDS];      ///< First octets (bits)
+    uint64_t ipv6_prefixes[BFI_ZONE_IPV6_WORDS];    ///< Sketch of /16 prefixes
+} bfi_zone_t;
+
+/**
+ * \brief I/O policies of index files (flags, see bfi_set_io_policy())
+ */
+typedef enum {
+    BFI_IO_DEFAULT = 0x00,      ///< Buffered I/O with default kernel behaviour
+    /** Filters are written by O_DIRECT bypassing the page cache (indexes
+     * are stored in version 2 format then, buffered writes are used if the
+     * file system does not support it).
+     */
+    BFI_IO_DIRECT = 0x01,
+    /** Stored and loaded files are dropped from the page cache (stored files
+     * are synced to disk first).
+     */
+    BFI_IO_DONTNEED = 0x02,
+    BFI_IO_RANDOM = 0x04,       ///< No readahead of cold indexes and catalogs
+    BFI_IO_WILLNEED = 0x08,     ///< Read ahead loaded files and catalogs
+} bfi_io_policy_t;
+
+/**
+ * \brief Options of storing an index
+ *
+ * Always initialize options by bfi_store_opts_init() first.
+ */
+typedef struct {
+    bfi_store_encoding_t encoding;      ///< Encoding of the index file
+    uint32_t chunk_size;        ///< Size of an encoded chunk, 0 means default
+    /** Maximal fold factor (power of 2, e.g. 64) of a folded summary stored
+     * with the index (see bfi_load_summary()), 0 means no summary. The largest
+     * factor which keeps the summary useful is used, the summary is omitted
+     * if the index is too full to be folded.
+     */
+    uint32_t summary_fold;
+    /** Time range of data of the index (e.g. flow start times), stored in
+     * the index file and in its catalog entry. 0 and 0 means unknown range.
+     */
+    uint64_t time_first;
+    uint64_t time_last;
+    /** Path of a catalog to add the stored index to (see bfi_catalog_add()),
+     * NULL means no catalog.
+     */
+    char *catalog;
+    bool zone_map;              ///< Store zone map of the index (default)
+    /** Store CRC-32C checksums of parts of the filter, they are verified
+     * by bfi_load_index() (BFI_E_CHECKSUM on mismatch).
+     */
+    bool checksum;
+    uint32_t io_policy;         ///< Flags of bfi_io_policy_t (global policy)
+} bfi_store_opts_t;
+
+/**
+ * \brief Statistics of a stored index (see bfi_stat_index())
+ */
+typedef struct {
+    bfi_family_t family;        ///< Family (parameters) of the index
+    uint64_t item_cnt;          ///< Count of stored items
+    /** Ratio of set bits (BFI_ENGINE_STANDARD) or of used slots
+     * (BFI_ENGINE_QUOTIENT) */
+    double fill_ratio;
+    uint64_t time_first;        ///< Time range of data (0 and 0 if unknown)
+    uint64_t time_last;
+    uint64_t file_size;         ///< Size of the index file
+    uint32_t checksum;          ///< CRC-32C of the index file
+    bfi_zone_t zone;            ///< Zone map of the index
+    uint32_t summary_fold;      ///< Fold factor of the summary (0 if none)
+} bfi_stat_t;
+
+/**
+ * \brief Catalog entry (see bfi_catalog_get())
+ */
+typedef struct {
+    /** Index file path relative to the directory of the catalog, or the
+     * absolute path of a file out of the directory tree of the catalog (use
+     * bfi_catalog_entry_path() to open it). Points to the catalog, valid
+     * until the catalog is closed.
+     */
+    const char *filename;
+    bfi_stat_t stat;            ///< Statistics of the index
+    bool has_summary;           ///< Folded summary is stored in the catalog
+} bfi_catalog_entry_t;
+
 typedef void *bfi_index_ptr_t;
+typedef void *bfi_block_index_ptr_t;
+typedef void *bfi_cold_index_ptr_t;
+typedef void *bfi_summary_ptr_t;
+typedef void *bfi_catalog_ptr_t;
+typedef void *bfi_postings_builder_ptr_t;
+typedef void *bfi_postings_ptr_t;
+
+// End of the last block of a block index (i.e. the end of data file)
+#define BFI_BLOCK_EOF UINT64_MAX
+
+/**
+ * \brief Range of data file (i.e. one or more consecutive blocks)
+ */
+typedef struct {
+    uint64_t begin;     ///< Offset of the first byte of the range
+    uint64_t end;       ///< Offset behind the last byte or BFI_BLOCK_EOF
+} bfi_block_range_t;
+
+/**
+ * \brief Fragment of a composite key (see bfi_add_addr_iov())
+ *
+ * Key made of fragments is the same key as its fragments concatenated, e.g.
+ * key of fragments (exporter id, interface, address) could be looked up also
+ * by a buffer holding these fields one after another.
+ */
+typedef struct bfi_iovec {
+    const void *base;   ///< Bytes of the fragment
+    size_t len;         ///< Length of the fragment
+} bfi_iovec_t;
+
+/**
+ * \brief Column of a batch of composite keys (see bfi_add_addr_columns())
+ *
+ * Fragment of key i is len bytes at base + i * stride, i.e. a column of
+ * a struct-of-arrays batch (stride == len) or a field of an array of records
+ * (stride == size of a record).
+ */
+typedef struct {
+    const void *base;   ///< Fragment of the first key
+    size_t len;         ///< Length of the fragment
+    size_t stride;      ///< Distance between fragments of consecutive keys
+} bfi_column_t;
 
 #if defined (__cplusplus)
 extern "C" {
@@ -89,6 +391,197 @@ const char *bfi_get_error_msg(bfi_ecode_t ecode);
 bfi_ecode_t bfi_init_index(bfi_index_ptr_t *index_ptr, uint64_t est_item_cnt,
 							double fp_prob);
 
+/**
+ * \brief Set default parameters of a new index
+ *
+ * Default is a Bloom filter (BFI_ENGINE_STANDARD) for 10000 items with false
+ * positive probability 0.0001.
+ * \param[out] params Parameters to initialize
+ */
+void bfi_params_init(bfi_params_t *params);
+
+/**
+ * \brief Initialize index with given parameters (i.e. of given engine)
+ *
+ * Indexes may be initialized by several threads at once, the construction
+ * does not use any global state of the application (e.g. rand()). Indexes
+ * with the same parameters and seed use the same hash functions.
+ *
+ * \param[in] index_ptr Pointer to index
+ * \param[in] params Parameters of the index
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_init_index_params(bfi_index_ptr_t *index_ptr,
+                    const bfi_params_t *params);
+
+/**
+ * \brief Recommend parameters of an index by benchmarks on a sample of keys
+ *
+ * Configurations of BFI_ENGINE_STANDARD (or BFI_ENGINE_REGISTER, by the
+ * engine of params) around the optimal count of hash functions (bits per key)
+ * for est_item_cnt and fp_prob of params are benchmarked on this machine:
+ * throughput of insertions and lookups is measured on a filter of the full
+ * size (cache effects) and false positive rate on a filter scaled
+ * to the sample (the same load of bits). Half of the sample is inserted,
+ * the other half is looked up as missing keys (keys should be distinct).
+ * The fastest configuration meeting fp_prob (within statistical error) and
+ * the memory cap is recommended, or the most accurate one if none meets it.
+ *
+ * \param[in/out] params Parameters of the index, hash_cnt and table_size
+ *    are set to the recommended configuration
+ * \param[in] keys Sample of keys stored one after another
+ * \param[in] key_len Length of every key
+ * \param[in] key_cnt Count of keys (at least 2)
+ * \param[in] memory_cap Maximal size of the filter (bytes), 0 means no cap
+ * \param[out] candidates Array of BFI_TUNE_CANDIDATE_MAX results (or NULL)
+ * \param[out] candidate_cnt Count of benchmarked configurations (or NULL)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_autotune(bfi_params_t *params, const unsigned char *keys,
+                    size_t key_len, uint64_t key_cnt, uint64_t memory_cap,
+                    bfi_tune_candidate_t *candidates,
+                    uint32_t *candidate_cnt);
+
+/**
+ * \brief Create family descriptor for given parameters
+ *
+ * Table size and count of hash functions are computed as by
+ * bfi_init_index_params(). Only BFI_ENGINE_STANDARD families are supported.
+ *
+ * \param[out] family Family descriptor
+ * \param[in] params Parameters of indexes of the family
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_family_create(bfi_family_t *family, const bfi_params_t *params);
+
+/**
+ * \brief Initialize empty index of a family
+ *
+ * \param[in] index_ptr Pointer to index
+ * \param[in] family Family descriptor
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_init_index_family(bfi_index_ptr_t *index_ptr,
+                    const bfi_family_t *family);
+
+/**
+ * \brief Get family descriptor of an index
+ *
+ * \param[in] index_ptr Index
+ * \param[out] family Family descriptor
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_index_family(bfi_index_ptr_t index_ptr, bfi_family_t *family);
+
+/**
+ * \brief Read family descriptor of a stored index
+ *
+ * Only the header of the filter is read, so merges could be planned without
+ * loading whole indexes.
+ *
+ * \param[in] filename Index file path
+ * \param[out] family Family descriptor
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_read_family(char *filename, bfi_family_t *family);
+
+/**
+ * \brief Check if indexes of two families could be merged
+ *
+ * \return True if the families are the same (engine, hash function, seed,
+ *    table size and count of hash functions), False otherwise.
+ */
+bool bfi_family_compatible(const bfi_family_t *a, const bfi_family_t *b);
+
+/**
+ * \brief Merge an index into another index of the same family
+ *
+ * Destination index contains union of both indexes, count of stored items is
+ * estimated from the merged filter. Count-min sketches of the same width and
+ * depth are merged by adding their counters, range filters of the same field
+ * and parameters by union. Sketch and range filters of the destination index
+ * which could not be merged are dropped (bfi_estimate_count() returns 0 and
+ * bfi_range_may_contain() true then), range filters and a sketch only of
+ * the merged index are not added.
+ *
+ * Quotient filters (BFI_ENGINE_QUOTIENT) of the same fingerprint length (i.e.
+ * of the same parameters) are merged even if their tables were resized
+ * differently: fingerprints of both tables are merged in sorted order by one
+ * sequential pass and the destination table grows to fit all of them. Count
+ * of stored items is exact (count of distinct fingerprints) then.
+ *
+ * \param[in/out] dst_ptr Destination index
+ * \param[in] src_ptr Merged index
+ * \return Returns BFI_OK on success, BFI_E_FAMILY if indexes are not of
+ *    the same family, other error code otherwise.
+ */
+bfi_ecode_t bfi_merge_index(bfi_index_ptr_t dst_ptr, bfi_index_ptr_t src_ptr);
+
+/**
+ * \brief Estimate similarity of two indexes of the same family
+ *
+ * Jaccard index |A & B| / |A | B| of sets of items of both indexes is
+ * estimated from counts of set bits of both filters and of their union.
+ *
+ * \param[in] a_ptr Index
+ * \param[in] b_ptr Other index
+ * \param[out] jaccard Estimated Jaccard index (0.0 - 1.0)
+ * \return Returns BFI_OK on success, BFI_E_FAMILY if indexes are not of
+ *    the same family, other error code otherwise.
+ */
+bfi_ecode_t bfi_index_similarity(bfi_index_ptr_t a_ptr, bfi_index_ptr_t b_ptr,
+                    double *jaccard);
+
+/**
+ * \brief Create delta between two versions of an index
+ *
+ * Delta is encoded XOR of filters of both versions (sparse for a growing
+ * index), it is used to replicate an index: apply the delta to a replica of
+ * the base version and to the base itself (see bfi_delta_apply()). Indexes
+ * have to be of the same family (e.g. both created from one bfi_family_t).
+ * Only BFI_ENGINE_STANDARD indexes without count-min sketches and range
+ * filters are supported (they are not replicated). Delta carries checksum of
+ * the table of the base version.
+ *
+ * \param[in] base_ptr Base (older) version of the index
+ * \param[in] index_ptr Current version of the index
+ * \param[out] delta Newly allocated delta (free() it)
+ * \param[out] delta_len Length of the delta
+ * \return Returns BFI_OK on success, BFI_E_FAMILY if indexes are not of
+ *    the same family, BFI_E_ENGINE if they are not supported, other error
+ *    code otherwise.
+ */
+bfi_ecode_t bfi_delta_create(bfi_index_ptr_t base_ptr,
+                    bfi_index_ptr_t index_ptr, char **delta,
+                    uint64_t *delta_len);
+
+/**
+ * \brief Apply delta to an index (in place)
+ *
+ * Index becomes the current version of bfi_delta_create(). Delta is applied
+ * only to the base version (checksum of the table has to match), so a delta
+ * missed, applied twice or out of order is rejected instead of clearing bits
+ * of the replica. Checksum of the delta is verified and all its chunks are
+ * decoded before the index is changed, so the index is left intact on error.
+ *
+ * \param[in/out] index_ptr Index (base version)
+ * \param[in] delta Delta created by bfi_delta_create()
+ * \param[in] delta_len Length of the delta
+ * \return Returns BFI_OK on success, BFI_E_FAMILY if the delta belongs to
+ *    another family, BFI_E_DELTA if it is corrupted or the index is not
+ *    its base version, other error code otherwise.
+ */
+bfi_ecode_t bfi_delta_apply(bfi_index_ptr_t index_ptr, const char *delta,
+                    uint64_t delta_len);
+
+/**
+ * \brief Get engine of an index
+ *
+ * \param[in] index_ptr Index
+ * \return Returns engine of the index.
+ */
+bfi_engine_t bfi_index_engine(bfi_index_ptr_t index_ptr);
+
 /**
  * \brief Destroy Bloom filter index
  *
@@ -114,6 +607,56 @@ void bfi_destroy_index(bfi_index_ptr_t *index_ptr);
 bfi_ecode_t bfi_add_addr_index(bfi_index_ptr_t index_ptr,
                     const unsigned char *buffer, const size_t len);
 
+/**
+ * \brief Add a batch of items of the same length to Bloom filter
+ *
+ * Result is the same as of bfi_add_addr_index() called for every item (also
+ * the count of unique items). Large batches of BFI_ENGINE_STANDARD indexes
+ * are inserted by several threads (see bfi_set_io_threads()), every thread
+ * sets bits of its own part of the filter. Other indexes are updated item
+ * by item.
+ *
+ * \param[in/out] index_ptr Bloom filter index
+ * \param[in] keys Items stored one after another
+ * \param[in] key_len Length of every item
+ * \param[in] key_cnt Count of items
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_add_addr_batch(bfi_index_ptr_t index_ptr,
+                    const unsigned char *keys, size_t key_len,
+                    uint64_t key_cnt);
+
+/**
+ * \brief Add item made of fragments to Bloom filter
+ *
+ * Same as bfi_add_addr_index() of the concatenated fragments, fragments are
+ * hashed one after another without copying them to a buffer.
+ *
+ * \param[in/out] index_ptr Bloom filter index
+ * \param[in] iov Fragments of the item
+ * \param[in] iov_cnt Count of fragments
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_add_addr_iov(bfi_index_ptr_t index_ptr,
+                    const bfi_iovec_t *iov, size_t iov_cnt);
+
+/**
+ * \brief Add a batch of items made of columns to Bloom filter
+ *
+ * Same as bfi_add_addr_batch() of items concatenated from columns, e.g.
+ * (source address, destination port) of a batch of flow records, without
+ * copying the columns.
+ *
+ * \param[in/out] index_ptr Bloom filter index
+ * \param[in] columns Columns (fragments of items)
+ * \param[in] column_cnt Count of columns
+ * \param[in] key_cnt Count of items
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_add_addr_columns(bfi_index_ptr_t index_ptr,
+                    const bfi_column_t *columns, size_t column_cnt,
+                    uint64_t key_cnt);
+
 /**
  * \brief Clear Bloom filter index.
  * \param[in] index_ptr Pointer to index structure to clear
@@ -133,6 +676,160 @@ bfi_ecode_t bfi_clear_index(bfi_index_ptr_t index_ptr);
 bool bfi_addr_is_stored(bfi_index_ptr_t index_ptr, const unsigned char *buffer,
                     const size_t len);
 
+/**
+ * \brief Check if items of a batch are contained in Bloom filter
+ *
+ * Result is the same as of bfi_addr_is_stored() called for every item.
+ * Probes of several items are prefetched before they are checked, so
+ * lookups of items in a large filter wait for memory in parallel.
+ *
+ * \param[in] index_ptr Bloom filter index
+ * \param[in] keys Items stored one after another
+ * \param[in] key_len Length of every item
+ * \param[in] key_cnt Count of items
+ * \param[out] stored Array of key_cnt results
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_addr_is_stored_batch(bfi_index_ptr_t index_ptr,
+                    const unsigned char *keys, size_t key_len,
+                    uint64_t key_cnt, bool *stored);
+
+/**
+ * \brief Check if item made of fragments is contained in Bloom filter
+ *
+ * Same as bfi_addr_is_stored() of the concatenated fragments.
+ *
+ * \param[in] index_ptr Bloom filter index
+ * \param[in] iov Fragments of the item
+ * \param[in] iov_cnt Count of fragments
+ * \return True if the item is present in the Bloom filter, False otherwise.
+ */
+bool bfi_addr_is_stored_iov(bfi_index_ptr_t index_ptr, const bfi_iovec_t *iov,
+                    size_t iov_cnt);
+
+/**
+ * \brief Check if items of a batch made of columns are contained in Bloom
+ *    filter
+ *
+ * Same as bfi_addr_is_stored_batch() of items concatenated from columns.
+ *
+ * \param[in] index_ptr Bloom filter index
+ * \param[in] columns Columns (fragments of items)
+ * \param[in] column_cnt Count of columns
+ * \param[in] key_cnt Count of items
+ * \param[out] stored Array of key_cnt results
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_addr_is_stored_columns(bfi_index_ptr_t index_ptr,
+                    const bfi_column_t *columns, size_t column_cnt,
+                    uint64_t key_cnt, bool *stored);
+
+/**
+ * \brief Estimate count of insertions of an address
+ *
+ * Every call of bfi_add_addr_index() is counted (i.e. also insertions of
+ * already present items), so the estimate could be used e.g. to order
+ * candidate indexes by the count of flows of an address.
+ *
+ * \param[in] index_ptr Index with count-min sketch (see bfi_params_t)
+ * \param[in] buffer Buffer containing value to check
+ * \param[in] len Length of value in buffer
+ * \return Returns estimated count (never lower than the real count) or 0 if
+ *    the index has no count-min sketch.
+ */
+uint64_t bfi_estimate_count(bfi_index_ptr_t index_ptr,
+                    const unsigned char *buffer, const size_t len);
+
+/**
+ * \brief Double the table of a quotient filter index
+ *
+ * Index which turns out to be under-provisioned (e.g. an interval with more
+ * flows than expected) grows without its original items: one remainder bit
+ * of every fingerprint becomes a quotient bit, so the false positive
+ * probability doubles (see quotient_growth_bits of bfi_params_t). Table grows
+ * also automatically when it is 90 % full.
+ *
+ * \param[in] index_ptr Index of BFI_ENGINE_QUOTIENT engine
+ * \return Returns BFI_OK on success, BFI_E_ENGINE if the index is not
+ *    a quotient filter, BFI_E_RESIZE if no remainder bit is left.
+ */
+bfi_ecode_t bfi_resize_index(bfi_index_ptr_t index_ptr);
+
+/**
+ * \brief Select time slot of following insertions to a temporal index
+ *
+ * Slot of a new or loaded index is the first one (or the slot selected
+ * before the index was stored).
+ *
+ * \param[in] index_ptr Index of BFI_ENGINE_TEMPORAL engine
+ * \param[in] slot Time slot (from 0 to temporal_slot_cnt - 1)
+ * \return Returns BFI_OK on success, BFI_E_ENGINE if the index is not
+ *    temporal, BFI_E_TIME_SLOT if the slot is out of range.
+ */
+bfi_ecode_t bfi_set_time_slot(bfi_index_ptr_t index_ptr, unsigned int slot);
+
+/**
+ * \brief Get time slots which may contain an address by one lookup
+ *
+ * E.g. minutes of an hour (files of the hour) which have to be searched
+ * for the address.
+ *
+ * \param[in] index_ptr Index
+ * \param[in] buffer Buffer containing value to check
+ * \param[in] len Length of value in buffer
+ * \return Returns mask of time slots (bit i is slot i), 0 if the address is
+ *    not present. Indexes of other engines have one slot (i.e. 1 means
+ *    present).
+ */
+uint32_t bfi_addr_slots(bfi_index_ptr_t index_ptr, const unsigned char *buffer,
+                    const size_t len);
+
+/**
+ * \brief Attach range filter of a field to an index
+ *
+ * Range filter answers whether any value of a range (e.g. destination port
+ * 1024-2048 or flow start within a time window) may be present. Range filters
+ * are stored in the same file as the index. Field identifiers are chosen by
+ * the caller.
+ *
+ * \param[in] index_ptr Index
+ * \param[in] field_id Identifier of the field
+ * \param[in] key_bits Count of bits of field values (1-64, e.g. 16 for ports)
+ * \param[in] est_item_cnt Estimated count of distinct values of the field
+ * \param[in] fp_prob Required false positive probability of a single probe
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_range_attach(bfi_index_ptr_t index_ptr, uint16_t field_id,
+                    unsigned int key_bits, uint64_t est_item_cnt,
+                    double fp_prob);
+
+/**
+ * \brief Add value of a field to its range filter
+ *
+ * \param[in/out] index_ptr Index
+ * \param[in] field_id Identifier of the field
+ * \param[in] value Value of the field
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_range_add(bfi_index_ptr_t index_ptr, uint16_t field_id,
+                    uint64_t value);
+
+/**
+ * \brief Check if any value of a range may be present in a range filter
+ *
+ * Count of filter probes is bounded (8 * key_bits), the range is reported as
+ * possibly present if the bound is reached.
+ *
+ * \param[in] index_ptr Index
+ * \param[in] field_id Identifier of the field
+ * \param[in] low Lowest value of the range
+ * \param[in] high Highest value of the range (inclusive)
+ * \return False if no value of the range is present, True otherwise (also if
+ *    there is no range filter of the field).
+ */
+bool bfi_range_may_contain(bfi_index_ptr_t index_ptr, uint16_t field_id,
+                    uint64_t low, uint64_t high);
+
 /**
  * \brief Gets count of items stored in Bloom filter index
  *
@@ -149,12 +846,113 @@ uint64_t bfi_stored_item_cnt(bfi_index_ptr_t index_ptr);
  *
  * \note Every file begins with special 16-bit integer for format and endianity
  *   check.
+ * \note Indexes of other engines than BFI_ENGINE_STANDARD and indexes with
+ *   a count-min sketch or range filters are stored in version 2 (sectioned)
+ *   file format.
+ * \note Zone map is not stored (plain indexes stay readable by older versions
+ *   of the library), use bfi_store_index_opts() to store it.
  * \param[in] index_ptr Bloom filter index (index to store)
  * \param[in] filename Destination file path
  * \return Returns BFI_OK on success, error code otherwise.
  */
 bfi_ecode_t bfi_store_index(bfi_index_ptr_t index_ptr, char *filename);
 
+/**
+ * \brief Set default options of storing an index (raw encoding, zone map)
+ *
+ * \param[out] opts Options to initialize
+ */
+void bfi_store_opts_init(bfi_store_opts_t *opts);
+
+/**
+ * \brief Store index to a file with given options
+ *
+ * Compressed indexes are stored in version 2 file format and they are decoded
+ * by bfi_load_index() transparently.
+ *
+ * \param[in] index_ptr Index to store
+ * \param[in] filename Destination file path
+ * \param[in] opts Options of storing
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_store_index_opts(bfi_index_ptr_t index_ptr, char *filename,
+                    const bfi_store_opts_t *opts);
+
+/**
+ * \brief Set count of threads used to store and load (large) indexes
+ *
+ * Filters are written and read by parts of 4 MiB and encoded chunks are
+ * (de)compressed in parallel. The setting is global for the process.
+ *
+ * \param[in] threads Count of threads (at most 16), 0 means count of online
+ *    processors (default), 1 disables threads
+ */
+void bfi_set_io_threads(uint32_t threads);
+
+/**
+ * \brief Set global I/O policy of index files
+ *
+ * Policy is used by loads, cold indexes and catalogs and it is the default
+ * policy of stores (see io_policy of bfi_store_opts_t). Collectors storing
+ * indexes which are not read locally again could use BFI_IO_DIRECT and
+ * BFI_IO_DONTNEED to keep hot data in the page cache, query nodes probing
+ * cold indexes could use BFI_IO_RANDOM to avoid useless readahead.
+ *
+ * \param[in] policy Flags of bfi_io_policy_t
+ */
+void bfi_set_io_policy(uint32_t policy);
+
+/**
+ * \brief Get global I/O policy of index files (flags of bfi_io_policy_t)
+ */
+uint32_t bfi_get_io_policy(void);
+
+/**
+ * \brief Warm up a loaded index for latency critical queries
+ *
+ * Every page of the filter is touched, so the first queries do not wait for
+ * page faults (e.g. of swapped out pages). Locked index stays in memory until
+ * it is destroyed.
+ *
+ * \param[in] index_ptr Index
+ * \param[in] lock Lock the filter in memory (mlock())
+ * \return Returns BFI_OK on success, BFI_E_LOCK if the filter could not be
+ *    locked (e.g. RLIMIT_MEMLOCK is too low), other error code otherwise.
+ */
+bfi_ecode_t bfi_prefetch_index(bfi_index_ptr_t index_ptr, bool lock);
+
+/**
+ * \brief Get count of NUMA nodes of the machine (1 if it is not known)
+ */
+uint32_t bfi_numa_node_cnt(void);
+
+/**
+ * \brief Replicate a read-only index to every NUMA node
+ *
+ * Every node gets its own copy of the filter, which is allocated and filled
+ * by a thread running on the node, so its pages are placed on the node.
+ * Lookups of a thread then probe the copy of its node and do not cross the
+ * interconnect of sockets. Nothing is replicated on machines with one node.
+ *
+ * Replicas are meant for loaded indexes of query servers, they are dropped
+ * when the index is modified (e.g. by bfi_add_addr_index()). The memory of
+ * replicas is counted by bfi_index_size().
+ *
+ * \note Only BFI_ENGINE_STANDARD indexes are supported.
+ * \param[in] index_ptr Index
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_replicate_index(bfi_index_ptr_t index_ptr);
+
+/**
+ * \brief Get memory used by filters of an index (the filter, its replicas
+ *    and range filters)
+ *
+ * \param[in] index_ptr Index
+ * \return Returns size in bytes.
+ */
+uint64_t bfi_index_size(bfi_index_ptr_t index_ptr);
+
 /**
  * \brief Load Bloom filter index from a file
  *
@@ -170,6 +968,529 @@ bfi_ecode_t bfi_store_index(bfi_index_ptr_t index_ptr, char *filename);
 bfi_ecode_t bfi_load_index(bfi_index_ptr_t *index_ptr, char *filename);
 
 
+/**
+ * \brief Open cold index (queried without loading the whole filter)
+ *
+ * Only parameters of the filter and its chunk table are loaded. A query
+ * decodes only chunks holding probes of the address (chunks of files stored
+ * with BFI_STORE_COMPRESSED encoding, fixed size chunks of raw files) and
+ * keeps a few recently decoded chunks in a cache.
+ *
+ * \note Only BFI_ENGINE_STANDARD and BFI_ENGINE_REGISTER indexes are
+ *   supported (a key of the latter is one word of the file). Cold index is
+ *   not thread-safe (queries update the cache).
+ * \param[out] cold_ptr Pointer to cold index
+ * \param[in] filename Index file path
+ * \param[in] resident Keep the (compressed) filter in memory, chunks are read
+ *    from the file on demand otherwise
+ * \param[in] cache_chunks Count of cached decoded chunks, 0 means default (4)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_open_cold_index(bfi_cold_index_ptr_t *cold_ptr,
+                    char *filename, bool resident, uint32_t cache_chunks);
+
+/**
+ * \brief Create cold index (compressed copy) of an index
+ *
+ * \param[out] cold_ptr Pointer to cold index
+ * \param[in] index_ptr Index (it is not modified)
+ * \param[in] chunk_size Size of a chunk, 0 means default (4 KiB)
+ * \param[in] cache_chunks Count of cached decoded chunks, 0 means default (4)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_cold_index_from(bfi_cold_index_ptr_t *cold_ptr,
+                    bfi_index_ptr_t index_ptr, uint32_t chunk_size,
+                    uint32_t cache_chunks);
+
+/**
+ * \brief Close cold index
+ *
+ * \note Sets pointer to cold index to NULL.
+ * \param[in] cold_ptr Pointer to pointer to cold index
+ */
+void bfi_close_cold_index(bfi_cold_index_ptr_t *cold_ptr);
+
+/**
+ * \brief Check if address is contained in cold index
+ *
+ * \param[in] cold_ptr Cold index
+ * \param[in] buffer Buffer containing value to check
+ * \param[in] len Length of value in buffer
+ * \return True if value may be present (also if a chunk could not be read),
+ *    False otherwise.
+ */
+bool bfi_cold_addr_is_stored(bfi_cold_index_ptr_t cold_ptr,
+                    const unsigned char *buffer, const size_t len);
+
+/**
+ * \brief Check if addresses of a batch are contained in cold index
+ *
+ * Same as bfi_cold_addr_is_stored() of every key, but probes of all keys
+ * are sorted by their offsets first. Probes of a raw file closer than 4 KiB
+ * are read by one pread() (only bytes between them, not whole chunks) and
+ * runs of adjacent chunks of an encoded file by one pread(), all reads of a
+ * batch are advised to the kernel before the first one. A key costs a few
+ * small reads of a huge file (one of BFI_ENGINE_REGISTER index), reads of
+ * probes of keys rejected by earlier reads are skipped.
+ *
+ * \param[in] cold_ptr Cold index
+ * \param[in] keys Keys stored one after another
+ * \param[in] key_len Length of every key
+ * \param[in] key_cnt Count of keys
+ * \param[out] stored Array of key_cnt results (keys of unread probes are
+ *    reported as present on error)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_cold_addr_is_stored_batch(bfi_cold_index_ptr_t cold_ptr,
+                    const unsigned char *keys, size_t key_len,
+                    uint64_t key_cnt, bool *stored);
+
+/**
+ * \brief Get memory used by cold index (resident data, chunk table, cache)
+ *
+ * \param[in] cold_ptr Cold index
+ * \return Returns size in bytes.
+ */
+uint64_t bfi_cold_index_size(bfi_cold_index_ptr_t cold_ptr);
+
+/**
+ * \brief Get zone map of an index
+ *
+ * \param[in] index_ptr Index
+ * \param[out] zone Zone map
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_index_zone(bfi_index_ptr_t index_ptr, bfi_zone_t *zone);
+
+/**
+ * \brief Read zone map of a stored index (without loading the index)
+ *
+ * \param[in] filename Index file path
+ * \param[out] zone Zone map (invalid if the file has no zone map)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_read_zone(char *filename, bfi_zone_t *zone);
+
+/**
+ * \brief Check whether an address may be stored in an index with a zone map
+ *
+ * \param[in] zone Zone map
+ * \param[in] buffer Buffer containing the address
+ * \param[in] len Length of the address in buffer
+ * \return Returns false if the address is surely not stored, true otherwise.
+ */
+bool bfi_zone_may_contain(const bfi_zone_t *zone, const unsigned char *buffer,
+                    const size_t len);
+
+/**
+ * \brief Load folded summary of a stored index
+ *
+ * Summary is a Bloom filter folded to a fraction of the size of the index
+ * (see bfi_store_opts_t), so summaries of many indexes could be kept in
+ * memory. Index is loaded only if its summary may contain the address.
+ *
+ * \param[out] summary_ptr Pointer to summary
+ * \param[in] filename Index file path
+ * \return Returns BFI_OK on success, BFI_E_LOAD_NO_SECTION if the index has no
+ *    summary, other error code otherwise.
+ */
+bfi_ecode_t bfi_load_summary(bfi_summary_ptr_t *summary_ptr, char *filename);
+
+/**
+ * \brief Create folded summary of an index
+ *
+ * \param[out] summary_ptr Pointer to summary
+ * \param[in] index_ptr Index (BFI_ENGINE_STANDARD only)
+ * \param[in] max_fold Maximal fold factor (power of 2)
+ * \return Returns BFI_OK on success, BFI_E_SUMMARY if the index is too full to
+ *    be folded, other error code otherwise.
+ */
+bfi_ecode_t bfi_summary_from_index(bfi_summary_ptr_t *summary_ptr,
+                    bfi_index_ptr_t index_ptr, uint32_t max_fold);
+
+/**
+ * \brief Check if address may be contained in the index of a summary
+ *
+ * \param[in] summary_ptr Summary
+ * \param[in] buffer Buffer containing value to check
+ * \param[in] len Length of value in buffer
+ * \return False if the address is not in the index, True otherwise.
+ */
+bool bfi_summary_may_contain(bfi_summary_ptr_t summary_ptr,
+                    const unsigned char *buffer, const size_t len);
+
+/**
+ * \brief Get size of the table of a summary (bytes)
+ */
+uint64_t bfi_summary_size(bfi_summary_ptr_t summary_ptr);
+
+/**
+ * \brief Destroy summary
+ *
+ * \note Sets pointer to summary to NULL.
+ * \param[in] summary_ptr Pointer to pointer to summary
+ */
+void bfi_destroy_summary(bfi_summary_ptr_t *summary_ptr);
+
+/**
+ * \brief Get statistics of a stored index
+ *
+ * \note The whole file is read once (the index is loaded, checksum of the
+ *    file is computed from the read data). Compressed filters are read twice.
+ * \param[in] filename Index file path
+ * \param[out] stat Statistics
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_stat_index(char *filename, bfi_stat_t *stat);
+
+/**
+ * \brief Load an index and get statistics of its file
+ *
+ * Same as bfi_load_index() followed by bfi_stat_index(), but the file is
+ * read once.
+ *
+ * \param[out] index_ptr Pointer to the loaded index (NULL on error)
+ * \param[in] filename Index file path
+ * \param[out] stat Statistics
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_load_index_stat(bfi_index_ptr_t *index_ptr, char *filename,
+                    bfi_stat_t *stat);
+
+/**
+ * \brief Add stored index to a catalog (or update its entry)
+ *
+ * Catalog is a file describing indexes of a directory (statistics, time
+ * ranges and folded summaries), so a query could select indexes by a single
+ * read of the catalog. Catalog is created if it does not exist, it is
+ * rewritten atomically and updates are serialized by a lock file
+ * (catalog path with ".lock" suffix).
+ *
+ * \param[in] catalog Catalog file path
+ * \param[in] filename Index file path (usually in the directory tree of
+ *    the catalog, other files are stored by their absolute path)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_catalog_add(char *catalog, char *filename);
+
+/**
+ * \brief Rebuild catalog from all indexes (*.bfi files) of its directory
+ *
+ * Files which are not valid indexes are skipped.
+ *
+ * \param[in] catalog Catalog file path
+ * \param[out] entry_cnt Count of entries of the new catalog (could be NULL)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_catalog_rebuild(char *catalog, uint64_t *entry_cnt);
+
+/**
+ * \brief Open catalog (the catalog file is mapped to memory)
+ *
+ * \param[out] catalog_ptr Pointer to catalog
+ * \param[in] catalog Catalog file path
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_catalog_open(bfi_catalog_ptr_t *catalog_ptr, char *catalog);
+
+/**
+ * \brief Close catalog
+ *
+ * \note Sets pointer to catalog to NULL.
+ */
+void bfi_catalog_close(bfi_catalog_ptr_t *catalog_ptr);
+
+/**
+ * \brief Get count of entries of a catalog
+ */
+uint64_t bfi_catalog_entry_cnt(bfi_catalog_ptr_t catalog_ptr);
+
+/**
+ * \brief Get entry of a catalog
+ *
+ * Entries are sorted by time_first (then by time_last and file name).
+ *
+ * \param[in] catalog_ptr Catalog
+ * \param[in] i Index of the entry
+ * \param[out] entry Entry
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_catalog_get(bfi_catalog_ptr_t catalog_ptr, uint64_t i,
+                    bfi_catalog_entry_t *entry);
+
+/**
+ * \brief Get path of the index file of a catalog entry
+ *
+ * Relative file names are joined to the directory of the catalog, absolute
+ * ones are used as they are.
+ *
+ * \param[in] catalog_ptr Catalog
+ * \param[in] entry Entry of the catalog (see bfi_catalog_get())
+ * \return Returns newly allocated path (free() it) or NULL on error.
+ */
+char *bfi_catalog_entry_path(bfi_catalog_ptr_t catalog_ptr,
+                    const bfi_catalog_entry_t *entry);
+
+/**
+ * \brief Get count of entries of unknown time range
+ *
+ * Entries of indexes stored without time range (e.g. version 1 files) are
+ * entries [0, count) of the catalog. They may contain data of any time, so
+ * queries bounded by time have to take them as candidates too.
+ */
+uint64_t bfi_catalog_unknown_time_cnt(bfi_catalog_ptr_t catalog_ptr);
+
+/**
+ * \brief Find entries which may overlap a time range
+ *
+ * Binary search by time, entries [first, end) have to be still checked for
+ * overlap (time_first <= time_end and time_last >= time_begin), entries out of
+ * [first, end) do not overlap the range. Entries of unknown time range are
+ * never in [first, end), they are entries [0, bfi_catalog_unknown_time_cnt())
+ * and they have to be queried as candidates of every range.
+ *
+ * \param[in] catalog_ptr Catalog
+ * \param[in] time_begin Beginning of the range
+ * \param[in] time_end End of the range (inclusive)
+ * \param[out] first Index of the first candidate entry
+ * \param[out] end Index behind the last candidate entry
+ */
+void bfi_catalog_find_time(bfi_catalog_ptr_t catalog_ptr, uint64_t time_begin,
+                    uint64_t time_end, uint64_t *first, uint64_t *end);
+
+/**
+ * \brief Load folded summary of a catalog entry
+ *
+ * \param[in] catalog_ptr Catalog
+ * \param[in] i Index of the entry
+ * \param[out] summary_ptr Pointer to summary (see bfi_summary_may_contain())
+ * \return Returns BFI_OK on success, BFI_E_LOAD_NO_SECTION if the entry has
+ *    no summary, other error code otherwise.
+ */
+bfi_ecode_t bfi_catalog_load_summary(bfi_catalog_ptr_t catalog_ptr,
+                    uint64_t i, bfi_summary_ptr_t *summary_ptr);
+
+/**
+ * \brief Get 64-bit fingerprint of an address (key of postings indexes)
+ *
+ * Collectors could log fingerprints of addresses of every interval instead
+ * of the addresses themselves and build postings indexes from the logs.
+ */
+uint64_t bfi_addr_fingerprint(const unsigned char *buffer, const size_t len);
+
+/**
+ * \brief Initialize builder of a postings index
+ *
+ * Postings index is an exact inverted index mapping fingerprints of addresses
+ * to lists of files (given by ids assigned by the caller, e.g. numbers of
+ * data files) containing them. It complements Bloom filter indexes for highly
+ * selective queries over long periods (e.g. all flows of one address over
+ * a year), one lookup returns all files instead of probing an index of every
+ * file. Only collisions of 64-bit fingerprints could add files which do not
+ * contain the address.
+ *
+ * Pairs are kept in memory until the index is built, they are sharded by
+ * a prefix of the fingerprint and shards are sorted and encoded in parallel
+ * (see bfi_set_io_threads()).
+ *
+ * \param[out] builder_ptr Pointer to builder
+ * \param[in] shard_bits Count of fingerprint bits selecting a shard (1-16),
+ *    0 means default (8)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_postings_builder_init(bfi_postings_builder_ptr_t *builder_ptr,
+                    unsigned int shard_bits);
+
+/**
+ * \brief Destroy builder of a postings index
+ *
+ * \note Sets pointer to builder to NULL.
+ */
+void bfi_postings_builder_destroy(bfi_postings_builder_ptr_t *builder_ptr);
+
+/**
+ * \brief Add address contained in a file to a postings index
+ *
+ * \param[in] builder_ptr Builder
+ * \param[in] buffer Buffer containing the address
+ * \param[in] len Length of the address in buffer
+ * \param[in] file_id Id of the file
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_postings_add_addr(bfi_postings_builder_ptr_t builder_ptr,
+                    const unsigned char *buffer, const size_t len,
+                    uint32_t file_id);
+
+/**
+ * \brief Add fingerprint of an address contained in a file (see
+ *    bfi_addr_fingerprint()) to a postings index
+ */
+bfi_ecode_t bfi_postings_add_fingerprint(
+                    bfi_postings_builder_ptr_t builder_ptr,
+                    uint64_t fingerprint, uint32_t file_id);
+
+/**
+ * \brief Build postings index and store it to a file
+ *
+ * Duplicate pairs are stored once. Builder could be used for further
+ * additions and builds.
+ *
+ * \param[in] builder_ptr Builder
+ * \param[in] filename Destination file path
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_postings_build(bfi_postings_builder_ptr_t builder_ptr,
+                    char *filename);
+
+/**
+ * \brief Open postings index (the file is mapped to memory)
+ *
+ * \param[out] postings_ptr Pointer to postings index
+ * \param[in] filename Postings index file path
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_postings_open(bfi_postings_ptr_t *postings_ptr,
+                    char *filename);
+
+/**
+ * \brief Close postings index
+ *
+ * \note Sets pointer to postings index to NULL.
+ */
+void bfi_postings_close(bfi_postings_ptr_t *postings_ptr);
+
+/**
+ * \brief Get count of distinct fingerprints of a postings index
+ */
+uint64_t bfi_postings_key_cnt(bfi_postings_ptr_t postings_ptr);
+
+/**
+ * \brief Get files containing an address
+ *
+ * \param[in] postings_ptr Postings index
+ * \param[in] buffer Buffer containing the address
+ * \param[in] len Length of the address in buffer
+ * \param[out] file_ids Newly allocated sorted array of file ids (free() it),
+ *    NULL if there is no file
+ * \param[out] file_cnt Count of file ids
+ * \return Returns BFI_OK on success (also if the address is not present),
+ *    BFI_E_POSTINGS if the index is corrupted, other error code otherwise.
+ */
+bfi_ecode_t bfi_postings_lookup(bfi_postings_ptr_t postings_ptr,
+                    const unsigned char *buffer, const size_t len,
+                    uint32_t **file_ids, uint64_t *file_cnt);
+
+/**
+ * \brief Get files containing an address given by its fingerprint (see
+ *    bfi_postings_lookup())
+ */
+bfi_ecode_t bfi_postings_lookup_fingerprint(bfi_postings_ptr_t postings_ptr,
+                    uint64_t fingerprint, uint32_t **file_ids,
+                    uint64_t *file_cnt);
+
+/**
+ * \brief Initialize block index
+ *
+ * Block index consists of a file-level Bloom filter (the same as a common
+ * index) and a small Bloom filter per every block of a data file. Blocks are
+ * delimited by the caller by bfi_block_index_new_block() (e.g. after every
+ * 64k records), which allows readers to skip blocks of a data file which
+ * cannot contain the queried address.
+ *
+ * \param[in] bindex_ptr Pointer to block index
+ * \param[in] est_item_cnt Estimated count of items in the whole data file
+ * \param[in] est_block_item_cnt Estimated count of items in one block
+ * \param[in] fp_prob Required false positive probability of Bloom filters
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_init_block_index(bfi_block_index_ptr_t *bindex_ptr,
+                    uint64_t est_item_cnt, uint64_t est_block_item_cnt,
+                    double fp_prob);
+
+/**
+ * \brief Destroy block index
+ *
+ * \note Sets pointer to index to NULL.
+ * \param[in] bindex_ptr Pointer to pointer to block index to free
+ */
+void bfi_destroy_block_index(bfi_block_index_ptr_t *bindex_ptr);
+
+/**
+ * \brief Start a new block of block index
+ *
+ * All items added after this call belong to the new block. The previous block
+ * ends at the data_offset. If an item is added before the first call of this
+ * function, the first block is started at offset 0.
+ *
+ * \param[in] bindex_ptr Block index
+ * \param[in] data_offset Offset of the block in the data file
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_block_index_new_block(bfi_block_index_ptr_t bindex_ptr,
+                    uint64_t data_offset);
+
+/**
+ * \brief Add item to block index (to the file-level and current block filter)
+ *
+ * \param[in/out] bindex_ptr Block index
+ * \param[in] buffer Buffer containing value to insert
+ * \param[in] len Length of value in buffer
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_block_index_add_addr(bfi_block_index_ptr_t bindex_ptr,
+                    const unsigned char *buffer, const size_t len);
+
+/**
+ * \brief Get ranges of data file which may contain an address
+ *
+ * Hash values of the address are computed only once and the file-level filter
+ * is checked first, so only files which may contain the address probe their
+ * block filters. Consecutive candidate blocks are merged into one range.
+ *
+ * \param[in] bindex_ptr Block index
+ * \param[in] buffer Buffer containing value to check
+ * \param[in] len Length of value in buffer
+ * \param[out] ranges Newly allocated array of candidate ranges (free() it),
+ *    NULL if there is no candidate range
+ * \param[out] range_cnt Count of candidate ranges
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_block_index_query(bfi_block_index_ptr_t bindex_ptr,
+                    const unsigned char *buffer, const size_t len,
+                    bfi_block_range_t **ranges, size_t *range_cnt);
+
+/**
+ * \brief Gets count of blocks in block index
+ *
+ * \param[in] bindex_ptr Block index
+ * \return Returns count of blocks.
+ */
+uint64_t bfi_block_index_block_cnt(bfi_block_index_ptr_t bindex_ptr);
+
+/**
+ * \brief Store block index to a file
+ *
+ * Block index is stored in version 2 (sectioned) file format. The file-level
+ * filter of the file could be loaded by bfi_load_index() as a common index.
+ *
+ * \param[in] bindex_ptr Block index (index to store)
+ * \param[in] filename Destination file path
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_store_block_index(bfi_block_index_ptr_t bindex_ptr,
+                    char *filename);
+
+/**
+ * \brief Load block index from a file
+ *
+ * \param[in] bindex_ptr Pointer to block index (where to load the index)
+ * \param[in] filename Destination file path (load index from here)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_load_block_index(bfi_block_index_ptr_t *bindex_ptr,
+                    char *filename);
+
+
 #if defined (__cplusplus)
 }
 #endif
@@ -29,6 +29,33 @@
  * - added print_filter() method
  * - added get_inserted_element_count() getter
  *
+ * Changes (2026):
+ *
+ * - added compute_hashes(), contains_hashes() and containsinsert_hashes()
+ *   methods (hash values computed once could be used for several filters)
+ * - insert(), containsinsert() and *_hashes() methods are virtual (derived
+ *   filters with different cells, see StableBloomFilter.hpp)
+ * - added constructor of a filter of a given random_seed_ (filter family)
+ * - added load_header_from_bytes() and header_size() methods (header of
+ *   a stored filter without the table), load_filter_from_bytes() uses them
+ * - added count_set_bits(), estimated_element_count() and
+ *   set_inserted_element_count() methods
+ * - added bit_position() and header_length() methods (probes of a stored
+ *   table could be located without loading it)
+ * - fixed copy constructor (deleted an uninitialized table)
+ * - added raw_table_size() and xor_table() methods (delta of two versions
+ *   of a table)
+ * - added get_header_as_bytes() and allocate_table() methods (table is
+ *   stored and loaded directly, get_filter_as_bytes() stores the header by
+ *   get_header_as_bytes())
+ * - added compute_hashes_fragments() (hash values of a key split to
+ *   fragments, the same as of the concatenated key)
+ * - generate_unique_salt() uses local salt_random generator instead of
+ *   srand()/rand() (construction is reentrant, salts are the same)
+ * - added valid_table_size(), load_header_from_bytes() rejects a header whose
+ *   raw_table_size_ does not match table_size_ (before the table is
+ *   allocated), the table is not left dangling if its allocation fails
+ *
  *********************************************************************
 */
 
@@ -89,6 +116,60 @@ static const unsigned char bit_mask[bits_per_char] = {
                                                        0x80   //10000000
                                                      };
 
+// Changes (2026) >>  ==================================================== >>
+/*
+  Generator of salts beyond the predefined ones. It is a local copy of the
+  additive feedback generator of glibc rand() (TYPE_3, degree 31), so salts of
+  filters created by earlier versions (seeded by srand()) are the same, but
+  construction of filters neither touches the global generator of the
+  application nor races with other threads.
+*/
+class salt_random
+{
+public:
+
+   explicit salt_random(unsigned int seed)
+   : front_(separation),
+     rear_(0)
+   {
+      if (0 == seed)
+         seed = 1;
+      int32_t word = static_cast<int32_t>(seed);
+      state_[0] = word;
+      for (int i = 1; i < degree; ++i)
+      {
+         // state_[i] = (16807 * state_[i - 1]) % 2147483647 without overflow
+         const long int hi = word / 127773;
+         const long int lo = word % 127773;
+         word = static_cast<int32_t>(16807 * lo - 2836 * hi);
+         if (word < 0)
+            word += 2147483647;
+         state_[i] = word;
+      }
+      for (int i = 0; i < 10 * degree; ++i)
+         next();
+   }
+
+   // Next value (0 to 2^31 - 1, as rand())
+   inline int next()
+   {
+      const uint32_t value = static_cast<uint32_t>(state_[front_]) + static_cast<uint32_t>(state_[rear_]);
+      state_[front_] = static_cast<int32_t>(value);
+      front_ = (front_ + 1) % degree;
+      rear_ = (rear_ + 1) % degree;
+      return static_cast<int>(value >> 1);
+   }
+
+private:
+
+   enum { degree = 31, separation = 3 };
+
+   int32_t state_[degree];
+   int front_;
+   int rear_;
+};
+// << Changes (2026) << ================================================== <<
+
 class bloom_parameters
 {
 public:
@@ -238,7 +319,33 @@ public:
       std::fill_n(bit_table_,raw_table_size_,0x00);
    }
 
+   // Changes (2026) >>  ==================================================== >>
+   /* Filter of an existing filter family, i.e. of the same random_seed_ as
+    * an existing filter (not derived from the seed of bloom_parameters).
+    * Filters of the same family (random_seed_, count of hash functions and
+    * table size) could be merged.
+   */
+   bloom_filter(const bloom_parameters& p, const unsigned long long int filter_random_seed)
+   : bit_table_(0),
+     projected_element_count_(p.projected_element_count),
+     inserted_element_count_(0),
+     random_seed_(filter_random_seed),
+     desired_false_positive_probability_(p.false_positive_probability)
+   {
+      salt_count_ = p.optimal_parameters.number_of_hashes;
+      table_size_ = p.optimal_parameters.table_size;
+      generate_unique_salt();
+      raw_table_size_ = table_size_ / bits_per_char;
+      bit_table_ = new cell_type[static_cast<std::size_t>(raw_table_size_)];
+      std::fill_n(bit_table_,raw_table_size_,0x00);
+   }
+   // << Changes (2026) << ================================================== <<
+
    bloom_filter(const bloom_filter& filter)
+   // Changes (2026) >>  ==================================================== >>
+   // operator=() deletes the (uninitialized) table first
+   : bit_table_(0)
+   // << Changes (2026) << ================================================== <<
    {
       this->operator=(filter);
    }
@@ -296,13 +403,13 @@ public:
       return (0 == table_size_);
    }
 
-   inline void clear()
+   inline virtual void clear()
    {
       std::fill_n(bit_table_,raw_table_size_,0x00);
       inserted_element_count_ = 0;
    }
 
-   inline void insert(const unsigned char* key_begin, const std::size_t& length)
+   inline virtual void insert(const unsigned char* key_begin, const std::size_t& length)
    {
       std::size_t bit_index = 0;
       std::size_t bit = 0;
@@ -366,7 +473,7 @@ public:
     * Method saves one for-loop of computing indices in comparison with calling
     * contains() + insert().
    */
-   inline bool containsinsert(const unsigned char* key_begin, const std::size_t& length)
+   inline virtual bool containsinsert(const unsigned char* key_begin, const std::size_t& length)
    {
       std::size_t bit_index = 0;
       std::size_t bit = 0;
@@ -393,6 +500,91 @@ public:
    }
    // << Changes (2016) << ================================================== <<
 
+   // Changes (2026) >>  ==================================================== >>
+
+   /* Hash values of a key do not depend on a table size, so the values
+    * computed once could be used with all filters of the same salt_count_
+    * and random_seed_ (i.e. with the same salt_).
+    * Array "hashes" has to be at least salt_.size() long.
+   */
+   inline void compute_hashes(const unsigned char* key_begin, const std::size_t& length, bloom_type* hashes) const
+   {
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         hashes[i] = hash_ap(key_begin,length,salt_[i]);
+      }
+   }
+
+   /* Hash values of a key split to fragments (e.g. fields of a composite
+    * key), equal to hash values of the concatenated fragments. Fragment is
+    * a structure with "base" (pointer to bytes) and "len" members.
+   */
+   template <typename Fragment>
+   inline void compute_hashes_fragments(const Fragment* fragments, const std::size_t count, bloom_type* hashes) const
+   {
+      std::size_t length = 0;
+      for (std::size_t i = 0; i < count; ++i)
+      {
+         length += fragments[i].len;
+      }
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         hashes[i] = hash_ap_fragments(fragments,length,salt_[i]);
+      }
+   }
+
+   inline virtual bool contains_hashes(const bloom_type* hashes) const
+   {
+      std::size_t bit_index = 0;
+      std::size_t bit = 0;
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         compute_indices(hashes[i],bit_index,bit);
+         if ((bit_table_[bit_index / bits_per_char] & bit_mask[bit]) != bit_mask[bit])
+         {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   // Position of the bit of the table probed for a hash value.
+   inline std::size_t bit_position(const bloom_type& hash) const
+   {
+      std::size_t bit_index = 0;
+      std::size_t bit = 0;
+      compute_indices(hash,bit_index,bit);
+      return bit_index;
+   }
+
+   // The same as containsinsert() but for precomputed hash values.
+   inline virtual bool containsinsert_hashes(const bloom_type* hashes)
+   {
+      std::size_t bit_index = 0;
+      std::size_t bit = 0;
+      bool present = true;
+
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         compute_indices(hashes[i],bit_index,bit);
+
+         if (present &&
+            ((bit_table_[bit_index / bits_per_char] & bit_mask[bit]) == 0x0)) {
+
+            present = false;
+         }
+
+         bit_table_[bit_index / bits_per_char] |= bit_mask[bit];
+      }
+
+      if (!present) {
+          ++inserted_element_count_;
+      }
+
+      return present;
+   }
+   // << Changes (2026) << ================================================== <<
+
    template<typename T>
    inline bool contains(const T& t) const
    {
@@ -570,78 +762,91 @@ public:
       // Get Bloom filter binary representation size
       uint32_t bf_len = BLOOMF_HEADER_SIZE + raw_table_size_*sizeof(cell_type);
       *buff = new char [bf_len];
-      char *fb_cursor = *buff;
-
-      // Store architecture check header
-      uint16_t type_size;
-      type_size = (uint16_t) sizeof(size_t);
-      memcpy(fb_cursor, &type_size, sizeof(type_size));
-      fb_cursor += sizeof(type_size);
-
-      type_size = (uint16_t) sizeof(bloom_type);
-      memcpy(fb_cursor, &type_size, sizeof(type_size));
-      fb_cursor += sizeof(type_size);
-
-      type_size = (uint16_t) sizeof(unsigned int);
-      memcpy(fb_cursor, &type_size, sizeof(type_size));
-      fb_cursor += sizeof(type_size);
+      // Changes (2026) >> header is stored by get_header_as_bytes() >>
+      char *fb_cursor = *buff + get_header_as_bytes(*buff);
+      // << Changes (2026) <<
 
-      type_size = (uint16_t) sizeof(unsigned long long int);
-      memcpy(fb_cursor, &type_size, sizeof(type_size));
-      fb_cursor += sizeof(type_size);
+      // Store Bloom filter itself
+      memcpy(fb_cursor, bit_table_, raw_table_size_ * sizeof(cell_type));
+//      fb_cursor += raw_table_size_ * sizeof(cell_type);
 
-      type_size = (uint16_t) sizeof(double);
-      memcpy(fb_cursor, &type_size, sizeof(type_size));
-      fb_cursor += sizeof(type_size);
+      return bf_len;
+   }
 
-      type_size = (uint16_t) sizeof(cell_type);
-      memcpy(fb_cursor, &type_size, sizeof(type_size));
-      fb_cursor += sizeof(type_size);
+   int load_filter_from_bytes(const char *buff, uint32_t len)
+   {
+      /* For Bloom filter binary format see get_filter_as_bytes() function
+       * above.
+      */
 
-      // Store Bloom filter header
-      size_t s = salt_.size();
-      memcpy(fb_cursor, &s, sizeof(s));
-      fb_cursor += sizeof(s);
-      for (size_t i = 0; i < s; ++i){
-         memcpy(fb_cursor, &salt_[i], sizeof(salt_[i]));
-         fb_cursor += sizeof(salt_[i]);
+      // Check for minimal possible size of valid index binary representation
+      if (len < MIN_BLOOMF_HEADER_SIZE){
+         return 1;
       }
-      memcpy(fb_cursor, &salt_count_, sizeof(salt_count_));
-      fb_cursor += sizeof(salt_count_);
 
-      memcpy(fb_cursor, &table_size_, sizeof(table_size_));
-      fb_cursor += sizeof(table_size_);
+      // Load Bloom filter header first
+      int ret = load_header_from_bytes(buff, len);
+      if (ret != 0){
+         return ret;
+      }
 
-      memcpy(fb_cursor, &raw_table_size_, sizeof(raw_table_size_));
-      fb_cursor += sizeof(raw_table_size_);
+      if (len != BLOOMF_HEADER_SIZE + raw_table_size_*sizeof(cell_type)){
+//         std::cerr << "Different sizes: " << len << " vs. " << BLOOMF_HEADER_SIZE + raw_table_size_*sizeof(cell_type) << std::endl;
+         return 1;
+      }
 
-      memcpy(fb_cursor, &projected_element_count_, sizeof(projected_element_count_));
-      fb_cursor += sizeof(projected_element_count_);
+      // Load Bloom filter itself
+      delete[] bit_table_;
+      bit_table_ = 0;
+      bit_table_ = new cell_type[static_cast<std::size_t>(raw_table_size_)];
+      memcpy(bit_table_, buff + BLOOMF_HEADER_SIZE, raw_table_size_ * sizeof(cell_type));
 
-      memcpy(fb_cursor, &inserted_element_count_, sizeof(inserted_element_count_));
-      fb_cursor += sizeof(inserted_element_count_);
+      return 0;
+   }
 
-      memcpy(fb_cursor, &random_seed_, sizeof(random_seed_));
-      fb_cursor += sizeof(random_seed_);
+   void clear_bytes(char **buff){
+      delete [] *buff;
+      *buff = NULL;
+   }
 
-      memcpy(fb_cursor, &desired_false_positive_probability_, sizeof(desired_false_positive_probability_));
-      fb_cursor += sizeof(desired_false_positive_probability_);
+   virtual unsigned long long int get_inserted_element_count(){
+      return inserted_element_count_;
+   }
+   // << Changes (2016) << ================================================== <<
 
-      // Store Bloom filter itself
-      memcpy(fb_cursor, bit_table_, raw_table_size_ * sizeof(cell_type));
-//      fb_cursor += raw_table_size_ * sizeof(cell_type);
+   // Changes (2026) >>  ==================================================== >>
 
-      return bf_len;
+   // Size of the beginning of a header needed by header_size()
+   static std::size_t header_prefix_size()
+   {
+      return sizeof(uint16_t)*6 + sizeof(size_t);
    }
 
-   int load_filter_from_bytes(const char *buff, uint32_t len)
+   // Size of the whole header of a stored filter (without the table)
+   static std::size_t header_size(const char *prefix)
    {
-      /* For Bloom filter binary format see get_filter_as_bytes() function
-       * above.
-      */
+      size_t s;
+      memcpy(&s, prefix + sizeof(uint16_t)*6, sizeof(s));
+      return header_prefix_size()
+             + sizeof(bloom_type) * s
+             + sizeof(salt_count_)
+             + sizeof(table_size_)
+             + sizeof(raw_table_size_)
+             + sizeof(projected_element_count_)
+             + sizeof(inserted_element_count_)
+             + sizeof(random_seed_)
+             + sizeof(desired_false_positive_probability_);
+   }
 
-      // Check for minimal possible size of valid index binary representation
-      if (len < MIN_BLOOMF_HEADER_SIZE){
+   /* Load everything but the table (i.e. parameters of the filter) from
+    * binary representation of the filter. Table is not allocated, so only
+    * parameters of the filter could be used (e.g. compute_hashes()).
+   */
+   int load_header_from_bytes(const char *buff, uint32_t len)
+   {
+      // Check for minimal possible size of valid header (salt count is
+      // checked below)
+      if (len < header_prefix_size()){
          return 1;
       }
 
@@ -685,6 +890,10 @@ public:
       size_t s;
       memcpy(&s, fb_cursor, sizeof(s));
       fb_cursor += sizeof(s);
+      if (s > (len - header_prefix_size()) / sizeof(bloom_type)){
+         return 1;
+      }
+      salt_.clear();
       for (size_t i = 0; i < s; ++i){
          bloom_type item;
          memcpy(&item, fb_cursor, sizeof(item));
@@ -710,28 +919,168 @@ public:
       memcpy(&desired_false_positive_probability_, fb_cursor, sizeof(desired_false_positive_probability_));
       fb_cursor += sizeof(desired_false_positive_probability_);
 
-      if (len != BLOOMF_HEADER_SIZE + raw_table_size_*sizeof(cell_type)){
-//         std::cerr << "Different sizes: " << len << " vs. " << BLOOMF_HEADER_SIZE + raw_table_size_*sizeof(cell_type) << std::endl;
+      // Stored sizes are not trusted, the table is allocated by them
+      if (!valid_table_size()){
          return 1;
       }
 
-      // Load Bloom filter itself
-      bit_table_ = new cell_type[static_cast<std::size_t>(raw_table_size_)];
-      memcpy(bit_table_, fb_cursor, raw_table_size_ * sizeof(cell_type));
-//      fb_cursor += sizeof(raw_table_size_ * sizeof(cell_type));
-
       return 0;
    }
 
-   void clear_bytes(char **buff){
-      delete [] *buff;
-      *buff = NULL;
+   // Size of the table in bytes matches the count of bits (derived filters
+   // have cells of other sizes)
+   virtual bool valid_table_size() const
+   {
+      return (0 != table_size_) && (0 == (table_size_ % bits_per_char)) &&
+             (raw_table_size_ == table_size_ / bits_per_char);
    }
 
-   unsigned int get_inserted_element_count(){
-      return inserted_element_count_;
+   // Length of the header of get_filter_as_bytes() representation (the table
+   // follows it)
+   std::size_t header_length() const
+   {
+      return BLOOMF_HEADER_SIZE;
    }
-   // << Changes (2016) << ================================================== <<
+
+   inline unsigned long long int count_set_bits() const
+   {
+      unsigned long long int count = 0;
+      std::size_t i = 0;
+      for (; i + sizeof(uint64_t) <= raw_table_size_; i += sizeof(uint64_t))
+      {
+         uint64_t word;
+         memcpy(&word, bit_table_ + i, sizeof(word));
+         count += __builtin_popcountll(word);
+      }
+      for (; i < raw_table_size_; ++i)
+      {
+         count += __builtin_popcount(bit_table_[i]);
+      }
+      return count;
+   }
+
+   /* Estimated count of (distinct) inserted elements computed from the count
+    * of set bits (S. J. Swamidass, P. Baldi: Mathematical correction for
+    * fingerprint similarity measures to improve chemical retrieval, 2007).
+    * Useful after merging filters (inserted_element_count_ is not merged).
+   */
+   inline double estimated_element_count() const
+   {
+      const double m = static_cast<double>(table_size_);
+      const double x = static_cast<double>(count_set_bits());
+      if (salt_.empty() || x >= m)
+         return static_cast<double>(projected_element_count_);
+      return -m / salt_.size() * std::log(1.0 - x / m);
+   }
+
+   void set_inserted_element_count(unsigned int count){
+      inserted_element_count_ = count;
+   }
+
+   void get_parameters(unsigned int& salt_count, unsigned long long int& table_size,
+                       unsigned long long int& random_seed,
+                       unsigned long long int& projected_element_count,
+                       double& false_positive_probability) const
+   {
+      salt_count = salt_count_;
+      table_size = table_size_;
+      random_seed = random_seed_;
+      projected_element_count = projected_element_count_;
+      false_positive_probability = desired_false_positive_probability_;
+   }
+
+   inline std::size_t raw_table_size() const
+   {
+      return raw_table_size_;
+   }
+
+   // Apply delta (XOR of two versions of the table) to a part of the table
+   inline void xor_table(std::size_t offset, const unsigned char* delta, std::size_t length)
+   {
+      if (offset >= raw_table_size_)
+         return;
+      if (length > raw_table_size_ - offset)
+         length = raw_table_size_ - offset;
+      for (std::size_t i = 0; i < length; ++i)
+      {
+         bit_table_[offset + i] ^= delta[i];
+      }
+   }
+   /* Store header of get_filter_as_bytes() representation (header_length()
+    * bytes) to a buffer, the table could be then stored separately.
+   */
+   std::size_t get_header_as_bytes(char *buff) const
+   {
+      char *fb_cursor = buff;
+
+      // Store architecture check header
+      uint16_t type_size;
+      type_size = (uint16_t) sizeof(size_t);
+      memcpy(fb_cursor, &type_size, sizeof(type_size));
+      fb_cursor += sizeof(type_size);
+
+      type_size = (uint16_t) sizeof(bloom_type);
+      memcpy(fb_cursor, &type_size, sizeof(type_size));
+      fb_cursor += sizeof(type_size);
+
+      type_size = (uint16_t) sizeof(unsigned int);
+      memcpy(fb_cursor, &type_size, sizeof(type_size));
+      fb_cursor += sizeof(type_size);
+
+      type_size = (uint16_t) sizeof(unsigned long long int);
+      memcpy(fb_cursor, &type_size, sizeof(type_size));
+      fb_cursor += sizeof(type_size);
+
+      type_size = (uint16_t) sizeof(double);
+      memcpy(fb_cursor, &type_size, sizeof(type_size));
+      fb_cursor += sizeof(type_size);
+
+      type_size = (uint16_t) sizeof(cell_type);
+      memcpy(fb_cursor, &type_size, sizeof(type_size));
+      fb_cursor += sizeof(type_size);
+
+      // Store Bloom filter header
+      size_t s = salt_.size();
+      memcpy(fb_cursor, &s, sizeof(s));
+      fb_cursor += sizeof(s);
+      for (size_t i = 0; i < s; ++i){
+         memcpy(fb_cursor, &salt_[i], sizeof(salt_[i]));
+         fb_cursor += sizeof(salt_[i]);
+      }
+      memcpy(fb_cursor, &salt_count_, sizeof(salt_count_));
+      fb_cursor += sizeof(salt_count_);
+
+      memcpy(fb_cursor, &table_size_, sizeof(table_size_));
+      fb_cursor += sizeof(table_size_);
+
+      memcpy(fb_cursor, &raw_table_size_, sizeof(raw_table_size_));
+      fb_cursor += sizeof(raw_table_size_);
+
+      memcpy(fb_cursor, &projected_element_count_, sizeof(projected_element_count_));
+      fb_cursor += sizeof(projected_element_count_);
+
+      memcpy(fb_cursor, &inserted_element_count_, sizeof(inserted_element_count_));
+      fb_cursor += sizeof(inserted_element_count_);
+
+      memcpy(fb_cursor, &random_seed_, sizeof(random_seed_));
+      fb_cursor += sizeof(random_seed_);
+
+      memcpy(fb_cursor, &desired_false_positive_probability_, sizeof(desired_false_positive_probability_));
+      fb_cursor += sizeof(desired_false_positive_probability_);
+
+      return fb_cursor - buff;
+   }
+
+   // Allocate (uninitialized) table for a filter loaded by
+   // load_header_from_bytes(), the table is filled by the caller
+   inline cell_type* allocate_table()
+   {
+      delete[] bit_table_;
+      bit_table_ = 0;
+      bit_table_ = new cell_type[static_cast<std::size_t>(raw_table_size_)];
+      return bit_table_;
+   }
+   // << Changes (2026) << ================================================== <<
 
 
 protected:
@@ -806,10 +1155,13 @@ protected:
       else
       {
          std::copy(predef_salt,predef_salt + predef_salt_count,std::back_inserter(salt_));
-         srand(static_cast<unsigned int>(random_seed_));
+         // Changes (2026) >> local generator instead of srand()/rand() >>
+         salt_random generator(static_cast<unsigned int>(random_seed_));
          while (salt_.size() < salt_count_)
          {
-            bloom_type current_salt = static_cast<bloom_type>(rand()) * static_cast<bloom_type>(rand());
+            bloom_type current_salt = static_cast<bloom_type>(generator.next());
+            current_salt *= static_cast<bloom_type>(generator.next());
+            // << Changes (2026) <<
             if (0 == current_salt) continue;
             if (salt_.end() == std::find(salt_.begin(), salt_.end(), current_salt))
             {
@@ -860,6 +1212,96 @@ protected:
       return hash;
    }
 
+   // Changes (2026) >>  ==================================================== >>
+
+   // Sequential reader of bytes of a key split to fragments
+   template <typename Fragment>
+   class fragment_reader
+   {
+   public:
+
+      fragment_reader(const Fragment* fragments)
+      : fragment_(fragments),
+        offset_(0)
+      {}
+
+      // Copy next count bytes (the key has them) to out
+      inline void read(unsigned char* out, std::size_t count)
+      {
+         while (count)
+         {
+            const std::size_t available = fragment_->len - offset_;
+            const std::size_t n = std::min(available,count);
+            memcpy(out, static_cast<const unsigned char*>(fragment_->base) + offset_, n);
+            out += n;
+            count -= n;
+            offset_ += n;
+            if (offset_ == fragment_->len)
+            {
+               ++fragment_;
+               offset_ = 0;
+            }
+         }
+      }
+
+   private:
+
+      const Fragment* fragment_;
+      std::size_t offset_;
+   };
+
+   // hash_ap() of concatenated fragments (bytes are read in the same order
+   // and words as from a contiguous key)
+   template <typename Fragment>
+   inline bloom_type hash_ap_fragments(const Fragment* fragments, std::size_t remaining_length, bloom_type hash) const
+   {
+      fragment_reader<Fragment> reader(fragments);
+      unsigned char word[8];
+      unsigned int loop = 0;
+      while (remaining_length >= 8)
+      {
+         unsigned int i1;
+         unsigned int i2;
+         reader.read(word,8);
+         memcpy(&i1, word, sizeof(i1));
+         memcpy(&i2, word + sizeof(i1), sizeof(i2));
+         hash ^= (hash <<  7) ^  i1 * (hash >> 3) ^
+              (~((hash << 11) + (i2 ^ (hash >> 5))));
+         remaining_length -= 8;
+      }
+      while (remaining_length >= 4)
+      {
+         unsigned int i;
+         reader.read(word,4);
+         memcpy(&i, word, sizeof(i));
+         if (loop & 0x01)
+            hash ^=    (hash <<  7) ^  i * (hash >> 3);
+         else
+            hash ^= (~((hash << 11) + (i ^ (hash >> 5))));
+         ++loop;
+         remaining_length -= 4;
+      }
+      while (remaining_length >= 2)
+      {
+         unsigned short i;
+         reader.read(word,2);
+         memcpy(&i, word, sizeof(i));
+         if (loop & 0x01)
+            hash ^=    (hash <<  7) ^  i * (hash >> 3);
+         else
+            hash ^= (~((hash << 11) + (i ^ (hash >> 5))));
+         ++loop;
+         remaining_length -= 2;
+      }
+      if (remaining_length)
+      {
+         reader.read(word,1);
+         hash += (word[0] ^ (hash * 0xA5A5A5A5)) + loop;
+      }
+      return hash;
+   }
+   // << Changes (2026) << ================================================== <<
+
    std::vector<bloom_type> salt_;
    unsigned char*          bit_table_;
    unsigned int            salt_count_;
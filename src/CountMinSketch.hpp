@@ -0,0 +1,249 @@
+/**
+ * \file CountMinSketch.hpp
+ * \brief Count-min sketch (item frequency estimation)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef INCLUDE_COUNT_MIN_SKETCH_HPP
+#define INCLUDE_COUNT_MIN_SKETCH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+
+/*
+  Count-min sketch, see G. Cormode, S. Muthukrishnan: An Improved Data Stream
+  Summary: The Count-Min Sketch and its Applications (2005).
+
+  Sketch does not hash keys itself, it is updated by hash values of a key
+  computed by a Bloom filter (see bloom_filter::compute_hashes()), i.e. row i
+  of the sketch uses i-th hash value of the key. Count of rows could not
+  exceed count of hash functions of the filter.
+
+  Estimated count is never lower than the real count of updates of the key.
+  With conservative update only the minimal counters of a key are incremented,
+  which lowers the overestimation (estimate is the same).
+*/
+class count_min_sketch
+{
+public:
+
+   typedef unsigned int bloom_type;
+   typedef uint32_t counter_type;
+
+   count_min_sketch()
+   : width_(0),
+     depth_(0),
+     conservative_(false),
+     table_(0)
+   {}
+
+   count_min_sketch(const uint32_t width, const uint32_t depth, const bool conservative)
+   : width_(width),
+     depth_(depth),
+     conservative_(conservative),
+     table_(0)
+   {
+      table_ = new counter_type[table_cells()];
+      std::fill_n(table_,table_cells(),0);
+   }
+
+   virtual ~count_min_sketch()
+   {
+      delete[] table_;
+   }
+
+   inline void clear()
+   {
+      std::fill_n(table_,table_cells(),0);
+   }
+
+   inline void update_hashes(const bloom_type* hashes)
+   {
+      if (!conservative_)
+      {
+         for (uint32_t i = 0; i < depth_; ++i)
+         {
+            counter_type& c = table_[cell(i,hashes[i])];
+            if (c != std::numeric_limits<counter_type>::max())
+               ++c;
+         }
+         return;
+      }
+
+      const counter_type min = estimate_hashes(hashes);
+      if (min == std::numeric_limits<counter_type>::max())
+         return;
+      for (uint32_t i = 0; i < depth_; ++i)
+      {
+         counter_type& c = table_[cell(i,hashes[i])];
+         if (c == min)
+            ++c;
+      }
+   }
+
+   inline counter_type estimate_hashes(const bloom_type* hashes) const
+   {
+      counter_type min = std::numeric_limits<counter_type>::max();
+      for (uint32_t i = 0; i < depth_; ++i)
+      {
+         min = std::min(min,table_[cell(i,hashes[i])]);
+      }
+      return (depth_ ? min : 0);
+   }
+
+   /* Sketch of both streams (sketches updated by the same hash values, e.g.
+    * of filters of one family). Counters are added, so the estimate is still
+    * never lower than the real count.
+   */
+   bool merge(const count_min_sketch& other)
+   {
+      if ((width_ != other.width_) || (depth_ != other.depth_))
+         return false;
+      for (uint64_t i = 0; i < table_cells(); ++i)
+      {
+         const counter_type room = std::numeric_limits<counter_type>::max() - table_[i];
+         table_[i] += std::min(room,other.table_[i]);
+      }
+      return true;
+   }
+
+   inline uint32_t width() const
+   {
+      return width_;
+   }
+
+   inline uint32_t depth() const
+   {
+      return depth_;
+   }
+
+   /* Count-min sketch binary format:
+    * +---------------------------------------------------------------------+
+    * | u32: width | u32: depth | u32: conservative (0/1)                   |
+    * | u32 []: counters (depth rows of width counters)                     |
+    * +---------------------------------------------------------------------+
+   */
+   uint64_t get_sketch_as_bytes(char **buff) const
+   {
+      const uint32_t conservative = conservative_ ? 1 : 0;
+      const uint64_t len = header_size() + table_cells() * sizeof(counter_type);
+      char *cursor;
+
+      *buff = new char[len];
+      cursor = *buff;
+      memcpy(cursor, &width_, sizeof(width_));
+      cursor += sizeof(width_);
+      memcpy(cursor, &depth_, sizeof(depth_));
+      cursor += sizeof(depth_);
+      memcpy(cursor, &conservative, sizeof(conservative));
+      cursor += sizeof(conservative);
+      memcpy(cursor, table_, table_cells() * sizeof(counter_type));
+
+      return len;
+   }
+
+   int load_sketch_from_bytes(const char *buff, const uint64_t len)
+   {
+      uint32_t conservative;
+
+      if (len < header_size())
+         return 1;
+
+      memcpy(&width_, buff, sizeof(width_));
+      buff += sizeof(width_);
+      memcpy(&depth_, buff, sizeof(depth_));
+      buff += sizeof(depth_);
+      memcpy(&conservative, buff, sizeof(conservative));
+      buff += sizeof(conservative);
+      conservative_ = (conservative != 0);
+
+      // Cells are indexed modulo width_ and every row is probed
+      if ((0 == width_) || (0 == depth_))
+         return 1;
+
+      if (len != header_size() + table_cells() * sizeof(counter_type))
+         return 1;
+
+      delete[] table_;
+      table_ = 0;
+      table_ = new counter_type[table_cells()];
+      memcpy(table_, buff, table_cells() * sizeof(counter_type));
+
+      return 0;
+   }
+
+   void clear_bytes(char **buff) const
+   {
+      delete [] *buff;
+      *buff = NULL;
+   }
+
+protected:
+
+   static inline uint64_t header_size()
+   {
+      return 3 * sizeof(uint32_t);
+   }
+
+   inline uint64_t table_cells() const
+   {
+      return static_cast<uint64_t>(width_) * depth_;
+   }
+
+   inline std::size_t cell(const uint32_t row, const bloom_type hash) const
+   {
+      /* Hash is scrambled (multiplicative hashing) and mapped to [0, width_)
+       * by multiply-shift, so columns are not correlated with bit indices of
+       * the Bloom filter (hash % table_size_).
+      */
+      const uint64_t h = static_cast<uint32_t>(hash * 0x9E3779B1U);
+      return static_cast<std::size_t>(row) * width_ + static_cast<std::size_t>((h * width_) >> 32);
+   }
+
+   uint32_t      width_;
+   uint32_t      depth_;
+   bool          conservative_;
+   counter_type* table_;
+
+private:
+
+   count_min_sketch(const count_min_sketch&);
+   count_min_sketch& operator = (const count_min_sketch&);
+};
+
+#endif
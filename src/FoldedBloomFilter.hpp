@@ -0,0 +1,116 @@
+/**
+ * \file FoldedBloomFilter.hpp
+ * \brief Folded Bloom filter (small summary of a Bloom filter)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef INCLUDE_FOLDED_BLOOM_FILTER_HPP
+#define INCLUDE_FOLDED_BLOOM_FILTER_HPP
+
+#include "BloomFilter.hpp"
+
+/*
+  Folded Bloom filter - a copy of a Bloom filter folded to a fraction of its
+  size by the folding logic of compressible_bloom_filter::compress(). Bit i of
+  the original table is OR-ed to bit (i % table_size_) of the folded table, so
+  a key probes bit ((hash % original_table_size_) % table_size_). There are no
+  false negatives against the original filter, the false positive
+  probability is higher (the folded table is denser).
+
+  Unlike compress(), table may be folded several times over at once (e.g. to
+  1/64 of its size), so a folded filter is small enough to be kept in memory
+  as a prefilter of a filter stored on a disk.
+*/
+class folded_bloom_filter : public bloom_filter
+{
+public:
+
+   folded_bloom_filter()
+   : bloom_filter(),
+     original_table_size_(0)
+   {}
+
+   folded_bloom_filter(const bloom_filter& filter, const unsigned int factor)
+   : bloom_filter(filter),
+     original_table_size_(table_size_)
+   {
+      unsigned long long int new_table_size = original_table_size_ / (factor ? factor : 1);
+      new_table_size -= new_table_size % bits_per_char;
+      if (new_table_size < bits_per_char)
+         new_table_size = bits_per_char;
+
+      // Whole bytes are folded (both sizes are multiples of bits_per_char)
+      const std::size_t new_raw_table_size = static_cast<std::size_t>(new_table_size / bits_per_char);
+      cell_type* tmp = new cell_type[new_raw_table_size];
+      std::copy(bit_table_, bit_table_ + new_raw_table_size, tmp);
+      for (std::size_t i = new_raw_table_size; i < raw_table_size_; i += new_raw_table_size)
+      {
+         const std::size_t cnt = std::min(new_raw_table_size, static_cast<std::size_t>(raw_table_size_ - i));
+         for (std::size_t j = 0; j < cnt; ++j)
+         {
+            tmp[j] |= bit_table_[i + j];
+         }
+      }
+
+      delete[] bit_table_;
+      bit_table_ = tmp;
+      table_size_ = new_table_size;
+      raw_table_size_ = new_raw_table_size;
+   }
+
+   inline unsigned long long int original_table_size() const
+   {
+      return original_table_size_;
+   }
+
+   inline void set_original_table_size(const unsigned long long int original_table_size)
+   {
+      original_table_size_ = original_table_size;
+   }
+
+protected:
+
+   inline virtual void compute_indices(const bloom_type& hash, std::size_t& bit_index, std::size_t& bit) const
+   {
+      bit_index = (hash % original_table_size_) % table_size_;
+      bit = bit_index % bits_per_char;
+   }
+
+private:
+
+   unsigned long long int original_table_size_;
+};
+
+#endif
@@ -0,0 +1,599 @@
+/**
+ * \file QuotientFilter.hpp
+ * \brief Quotient filter (mergeable and resizable filter of fingerprints)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef INCLUDE_QUOTIENT_FILTER_HPP
+#define INCLUDE_QUOTIENT_FILTER_HPP
+
+#include <stdint.h>
+#include "BloomFilter.hpp"
+
+/*
+  Quotient filter (M. A. Bender et al.: Don't Thrash: How to Cache Your Hash
+  on Flash, 2012) stores a p-bit fingerprint of every key in a compact hash
+  table of 2^q slots. Upper q bits of the fingerprint (quotient) select the
+  canonical slot, lower r = p - q bits (remainder) are stored in the slot.
+  Remainders of one quotient form a sorted run, runs shifted by collisions
+  form clusters, and three bits per slot (occupied, continuation, shifted)
+  recover quotients, so the filter could be:
+
+  - merged: fingerprints are visited in sorted order (see iterator below),
+    two filters of the same fingerprint length are merged by one sequential
+    pass over both tables, even if their table sizes differ,
+  - resized: one remainder bit is moved to the quotient, i.e. the table is
+    doubled without the original keys (false positive rate doubles).
+
+  Fingerprint is made of the first two hash values of a key (salt_ has two
+  salts) mixed together. Every slot is a little endian integer of
+  slot_bytes() bytes, i.e. raw_table_size_ == table_size_ * slot_bytes(),
+  table_size_ is the count of slots and fingerprint_count_ the count of
+  stored (distinct) fingerprints (inserted_element_count_ is its copy
+  saturated to an unsigned int, tables of up to 2^40 slots hold more). The
+  filter grows (see resize()) when max_load is reached, at least one slot is
+  always kept empty.
+*/
+class quotient_filter : public bloom_filter
+{
+public:
+
+   enum { fingerprint_hash_count = 2, max_fingerprint_bits = 64, min_quotient_bits = 3, max_quotient_bits = 40 };
+
+   // Load factor which triggers growth of the table
+   static double max_load() { return 0.9; }
+
+   quotient_filter()
+   : bloom_filter(),
+     quotient_bits_(0),
+     remainder_bits_(0),
+     fingerprint_count_(0)
+   {}
+
+   quotient_filter(const bloom_parameters& p, const unsigned int quotient_bits,
+                   const unsigned int remainder_bits)
+   : bloom_filter(p),
+     quotient_bits_(quotient_bits),
+     remainder_bits_(remainder_bits),
+     fingerprint_count_(0)
+   {
+      if (salt_count_ != fingerprint_hash_count)
+      {
+         salt_count_ = fingerprint_hash_count;
+         salt_.clear();
+         generate_unique_salt();
+      }
+      allocate_slots();
+   }
+
+   using bloom_filter::insert;
+   using bloom_filter::contains;
+
+   inline virtual void insert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      insert_fingerprint(fingerprint(key_begin,length));
+   }
+
+   inline virtual bool contains(const unsigned char* key_begin, const std::size_t length) const
+   {
+      return contains_fingerprint(fingerprint(key_begin,length));
+   }
+
+   inline virtual bool containsinsert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      return insert_fingerprint(fingerprint(key_begin,length));
+   }
+
+   inline virtual bool contains_hashes(const bloom_type* hashes) const
+   {
+      return contains_fingerprint(fingerprint(hashes));
+   }
+
+   inline virtual bool containsinsert_hashes(const bloom_type* hashes)
+   {
+      return insert_fingerprint(fingerprint(hashes));
+   }
+
+   inline virtual void clear()
+   {
+      bloom_filter::clear();
+      fingerprint_count_ = 0;
+   }
+
+   inline virtual unsigned long long int get_inserted_element_count()
+   {
+      return fingerprint_count_;
+   }
+
+   inline unsigned int quotient_bits() const
+   {
+      return quotient_bits_;
+   }
+
+   inline unsigned int remainder_bits() const
+   {
+      return remainder_bits_;
+   }
+
+   /*
+     Double the table (one remainder bit becomes a quotient bit). Fingerprints
+     are reinserted in sorted order, i.e. every insertion appends to the end
+     of its cluster. Returns false if no remainder bit is left.
+   */
+   inline bool resize()
+   {
+      if ((remainder_bits_ < 2) || (quotient_bits_ >= max_quotient_bits))
+         return false;
+
+      quotient_filter source;
+      source.take_table(*this);
+      quotient_bits_ = source.quotient_bits_ + 1;
+      remainder_bits_ = source.remainder_bits_ - 1;
+      allocate_slots();
+
+      for (iterator itr(source); !itr.done(); )
+      {
+         append_fingerprint(itr.next());
+      }
+      return true;
+   }
+
+   /*
+     Merge fingerprints of another filter of the same fingerprint length and
+     hash functions (sizes of the tables may differ). Both tables are read
+     sequentially in sorted order and the merged table is written in sorted
+     order, the table grows when max_load is reached (shared fingerprints are
+     not counted twice). Returns false if the filters could not be merged.
+   */
+   inline bool merge(const quotient_filter& f)
+   {
+      if (&f == this)
+         return true;
+      if ((fingerprint_bits() != f.fingerprint_bits()) ||
+          (random_seed_ != f.random_seed_) ||
+          (salt_ != f.salt_))
+         return false;
+
+      const unsigned int bits = fingerprint_bits();
+      quotient_filter source;
+      source.take_table(*this);
+      quotient_bits_ = std::max(source.quotient_bits_,f.quotient_bits_);
+      remainder_bits_ = bits - quotient_bits_;
+      allocate_slots();
+
+      iterator a(source);
+      iterator b(f);
+      bool a_valid = !a.done();
+      bool b_valid = !b.done();
+      uint64_t fa = a_valid ? a.next() : 0;
+      uint64_t fb = b_valid ? b.next() : 0;
+      while (a_valid || b_valid)
+      {
+         const bool take_a = a_valid && (!b_valid || (fa <= fb));
+         const bool take_b = b_valid && (!a_valid || (fb <= fa));
+         const uint64_t fp = take_a ? fa : fb;
+         if (take_a)
+         {
+            a_valid = !a.done();
+            if (a_valid) fa = a.next();
+         }
+         if (take_b)
+         {
+            b_valid = !b.done();
+            if (b_valid) fb = b.next();
+         }
+         if (make_room())
+            append_fingerprint(fp);
+      }
+      return true;
+   }
+
+   // Used when the filter is loaded (see load_filter_from_bytes()), the count
+   // of stored fingerprints is recounted from the table
+   inline bool set_quotient_parameters(const unsigned int quotient_bits,
+                                       const unsigned int remainder_bits)
+   {
+      if ((quotient_bits < min_quotient_bits) || (quotient_bits > max_quotient_bits) ||
+          (0 == remainder_bits) || (quotient_bits + remainder_bits > max_fingerprint_bits) ||
+          (salt_.size() < fingerprint_hash_count))
+         return false;
+      quotient_bits_ = quotient_bits;
+      remainder_bits_ = remainder_bits;
+      if ((table_size_ != (1ULL << quotient_bits_)) ||
+          (raw_table_size_ != table_size_ * slot_bytes()))
+         return false;
+
+      unsigned long long int count = 0;
+      for (uint64_t i = 0; i < table_size_; ++i)
+      {
+         if (!is_empty(get_slot(i)))
+            ++count;
+      }
+      // At least one slot is empty (see insert_fingerprint())
+      if (count >= table_size_)
+         return false;
+      fingerprint_count_ = count;
+      sync_element_count();
+      return true;
+   }
+
+   // Slots are known only after set_quotient_parameters(), a header is
+   // checked for a power of two slots of any width
+   virtual bool valid_table_size() const
+   {
+      return (0 != table_size_) && (table_size_ <= (1ULL << max_quotient_bits)) &&
+             (0 == (table_size_ & (table_size_ - 1))) &&
+             (0 == (raw_table_size_ % table_size_)) &&
+             (raw_table_size_ / table_size_ >= 1) &&
+             (raw_table_size_ / table_size_ <= (max_fingerprint_bits + metadata_bits + 7) / 8);
+   }
+
+protected:
+
+   /*
+     Visits fingerprints of a filter in ascending order, i.e. runs in order of
+     quotients. Cluster which wraps around the end of the table holds both the
+     highest and the lowest quotients, so the iteration starts at the start of
+     that cluster, skips its high quotients and visits them after the rest of
+     the table.
+   */
+   class iterator
+   {
+   public:
+
+      iterator(const quotient_filter& f)
+      : f_(f),
+        start_(0),
+        index_(0),
+        quotient_(0),
+        visited_(0),
+        skip_(false)
+      {
+         if (0 == f_.fingerprint_count_)
+            return;
+         if (!is_empty(f_.get_slot(0)) && !f_.is_cluster_start(f_.get_slot(0)))
+         {
+            // Wrapping cluster (an empty slot always precedes its start)
+            start_ = f_.table_size_ - 1;
+            while (!f_.is_cluster_start(f_.get_slot(start_)))
+               --start_;
+            skip_ = true;
+         }
+         else
+         {
+            while (!f_.is_cluster_start(f_.get_slot(start_)))
+               ++start_;
+         }
+         index_ = start_;
+      }
+
+      inline bool done() const
+      {
+         return visited_ >= f_.fingerprint_count_;
+      }
+
+      inline uint64_t next()
+      {
+         for ( ; ; )
+         {
+            const uint64_t slot = f_.get_slot(index_);
+            if (f_.is_cluster_start(slot))
+               quotient_ = index_;
+            else if (f_.is_run_start(slot))
+            {
+               // Run of the next occupied quotient
+               do
+               {
+                  quotient_ = f_.next_slot(quotient_);
+               }
+               while (!is_occupied(f_.get_slot(quotient_)));
+            }
+            if (skip_ && (quotient_ < start_))
+               skip_ = false;
+            index_ = f_.next_slot(index_);
+            if (index_ == start_)
+               skip_ = false;
+            if (!is_empty(slot) && !(skip_ && (quotient_ >= start_)))
+            {
+               ++visited_;
+               return (quotient_ << f_.remainder_bits_) | remainder(slot);
+            }
+         }
+      }
+
+   private:
+
+      const quotient_filter& f_;
+      uint64_t start_;
+      uint64_t index_;
+      uint64_t quotient_;
+      uint64_t visited_;
+      bool skip_;
+   };
+
+   // Slot metadata (the remainder is stored above it)
+   enum { occupied_bit = 1, continuation_bit = 2, shifted_bit = 4, metadata_bits = 3 };
+
+   static inline bool is_occupied(const uint64_t slot)     { return 0 != (slot & occupied_bit);     }
+   static inline bool is_continuation(const uint64_t slot) { return 0 != (slot & continuation_bit); }
+   static inline bool is_shifted(const uint64_t slot)      { return 0 != (slot & shifted_bit);      }
+   static inline bool is_empty(const uint64_t slot)        { return 0 == (slot & 7);                }
+   static inline uint64_t remainder(const uint64_t slot)   { return slot >> metadata_bits;          }
+
+   static inline bool is_cluster_start(const uint64_t slot)
+   {
+      return is_occupied(slot) && !is_continuation(slot) && !is_shifted(slot);
+   }
+
+   static inline bool is_run_start(const uint64_t slot)
+   {
+      return !is_continuation(slot) && (is_occupied(slot) || is_shifted(slot));
+   }
+
+   inline unsigned int fingerprint_bits() const
+   {
+      return quotient_bits_ + remainder_bits_;
+   }
+
+   inline std::size_t slot_bytes() const
+   {
+      return (remainder_bits_ + metadata_bits + 7) / 8;
+   }
+
+   inline uint64_t remainder_mask() const
+   {
+      return (1ULL << remainder_bits_) - 1;
+   }
+
+   inline uint64_t fingerprint(const bloom_type* hashes) const
+   {
+      /* Both hash values are mixed (finalizer of MurmurHash3), low bits of
+       * a single hash value of keys differing in their last bytes collide.
+      */
+      uint64_t fp = (static_cast<uint64_t>(hashes[0]) << 32) | hashes[1];
+      fp ^= fp >> 33;
+      fp *= 0xFF51AFD7ED558CCDULL;
+      fp ^= fp >> 33;
+      fp *= 0xC4CEB9FE1A85EC53ULL;
+      fp ^= fp >> 33;
+      if (fingerprint_bits() >= max_fingerprint_bits)
+         return fp;
+      return fp & ((1ULL << fingerprint_bits()) - 1);
+   }
+
+   inline uint64_t fingerprint(const unsigned char* key_begin, const std::size_t length) const
+   {
+      bloom_type hashes[fingerprint_hash_count];
+      hashes[0] = hash_ap(key_begin,length,salt_[0]);
+      hashes[1] = hash_ap(key_begin,length,salt_[1]);
+      return fingerprint(hashes);
+   }
+
+   inline uint64_t next_slot(const uint64_t index) const
+   {
+      return (index + 1) & (table_size_ - 1);
+   }
+
+   inline uint64_t prev_slot(const uint64_t index) const
+   {
+      return (index - 1) & (table_size_ - 1);
+   }
+
+   inline uint64_t get_slot(const uint64_t index) const
+   {
+      const cell_type* cell = bit_table_ + index * slot_bytes();
+      uint64_t slot = 0;
+      for (std::size_t i = 0; i < slot_bytes(); ++i)
+      {
+         slot |= static_cast<uint64_t>(cell[i]) << (8 * i);
+      }
+      return slot;
+   }
+
+   inline void set_slot(const uint64_t index, uint64_t slot)
+   {
+      cell_type* cell = bit_table_ + index * slot_bytes();
+      for (std::size_t i = 0; i < slot_bytes(); ++i, slot >>= 8)
+      {
+         cell[i] = static_cast<cell_type>(slot);
+      }
+   }
+
+   // Slot where the run of a (occupied) quotient starts
+   inline uint64_t run_start(const uint64_t quotient) const
+   {
+      // Start of the cluster
+      uint64_t b = quotient;
+      while (is_shifted(get_slot(b)))
+         b = prev_slot(b);
+
+      // Skip runs of preceding quotients of the cluster
+      uint64_t s = b;
+      while (b != quotient)
+      {
+         do
+         {
+            s = next_slot(s);
+         }
+         while (is_continuation(get_slot(s)));
+         do
+         {
+            b = next_slot(b);
+         }
+         while (!is_occupied(get_slot(b)));
+      }
+      return s;
+   }
+
+   inline bool contains_fingerprint(const uint64_t fp) const
+   {
+      const uint64_t fq = fp >> remainder_bits_;
+      const uint64_t fr = fp & remainder_mask();
+
+      if (!is_occupied(get_slot(fq)))
+         return false;
+
+      // Remainders of a run are sorted
+      uint64_t s = run_start(fq);
+      do
+      {
+         const uint64_t r = remainder(get_slot(s));
+         if (r == fr)
+            return true;
+         else if (r > fr)
+            return false;
+         s = next_slot(s);
+      }
+      while (is_continuation(get_slot(s)));
+      return false;
+   }
+
+   // Returns true if the fingerprint was already present
+   inline bool insert_fingerprint(const uint64_t fp)
+   {
+      if (contains_fingerprint(fp))
+         return true;
+      if (make_room())
+         append_fingerprint(fp);
+      return false;
+   }
+
+   // Grow the table at max_load, returns false if the table is full and could
+   // not grow (a fingerprint would be lost)
+   inline bool make_room()
+   {
+      return (fingerprint_count_ + 1.0 <= max_load() * table_size_) || resize() ||
+             (fingerprint_count_ + 1ULL < table_size_);
+   }
+
+   // Insert a fingerprint which is not present (the table has an empty slot)
+   inline void append_fingerprint(const uint64_t fp)
+   {
+      const uint64_t fq = fp >> remainder_bits_;
+      const uint64_t fr = fp & remainder_mask();
+      const uint64_t canonical = get_slot(fq);
+      uint64_t entry = fr << metadata_bits;
+
+      ++fingerprint_count_;
+      sync_element_count();
+      if (is_empty(canonical))
+      {
+         set_slot(fq,entry | occupied_bit);
+         return;
+      }
+      if (!is_occupied(canonical))
+         set_slot(fq,canonical | occupied_bit);
+
+      const uint64_t start = run_start(fq);
+      uint64_t s = start;
+      if (is_occupied(canonical))
+      {
+         // Position of the remainder in the sorted run
+         do
+         {
+            if (remainder(get_slot(s)) > fr)
+               break;
+            s = next_slot(s);
+         }
+         while (is_continuation(get_slot(s)));
+
+         if (s == start)
+            set_slot(start,get_slot(start) | continuation_bit); // Old run start follows
+         else
+            entry |= continuation_bit;
+      }
+      if (s != fq)
+         entry |= shifted_bit;
+
+      // Shift the rest of the cluster by one slot, occupied bits stay with
+      // canonical slots
+      uint64_t current = entry;
+      bool empty;
+      do
+      {
+         uint64_t previous = get_slot(s);
+         empty = is_empty(previous);
+         if (!empty)
+         {
+            previous |= shifted_bit;
+            if (is_occupied(previous))
+            {
+               current |= occupied_bit;
+               previous &= ~static_cast<uint64_t>(occupied_bit);
+            }
+         }
+         set_slot(s,current);
+         current = previous;
+         s = next_slot(s);
+      }
+      while (!empty);
+   }
+
+   inline void allocate_slots()
+   {
+      delete[] bit_table_;
+      table_size_ = 1ULL << quotient_bits_;
+      raw_table_size_ = table_size_ * slot_bytes();
+      bit_table_ = new cell_type[static_cast<std::size_t>(raw_table_size_)];
+      std::fill_n(bit_table_,raw_table_size_,0x00);
+      fingerprint_count_ = 0;
+      inserted_element_count_ = 0;
+   }
+
+   // Copy of the count stored by the base class (an unsigned int)
+   inline void sync_element_count()
+   {
+      inserted_element_count_ = static_cast<unsigned int>(
+         std::min<unsigned long long int>(fingerprint_count_,std::numeric_limits<unsigned int>::max()));
+   }
+
+   // Move the table of another filter to this (empty) filter
+   inline void take_table(quotient_filter& f)
+   {
+      std::swap(bit_table_,f.bit_table_);
+      std::swap(table_size_,f.table_size_);
+      std::swap(raw_table_size_,f.raw_table_size_);
+      std::swap(inserted_element_count_,f.inserted_element_count_);
+      std::swap(fingerprint_count_,f.fingerprint_count_);
+      std::swap(quotient_bits_,f.quotient_bits_);
+      std::swap(remainder_bits_,f.remainder_bits_);
+   }
+
+   unsigned int quotient_bits_;
+   unsigned int remainder_bits_;
+   unsigned long long int fingerprint_count_;
+};
+
+#endif
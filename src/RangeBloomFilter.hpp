@@ -0,0 +1,162 @@
+/**
+ * \file RangeBloomFilter.hpp
+ * \brief Range Bloom filter (dyadic intervals, range queries)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef INCLUDE_RANGE_BLOOM_FILTER_HPP
+#define INCLUDE_RANGE_BLOOM_FILTER_HPP
+
+#include "BloomFilter.hpp"
+
+/*
+  Range Bloom filter answers "may any key of [low, high] be present" for
+  integer keys of key_bits_ bits (e.g. ports, timestamps).
+
+  Every key is inserted at every level of a dyadic interval tree, i.e. as
+  a (key >> level, level) pair for level 0 .. key_bits_ - 1. Query splits
+  the range into maximal dyadic intervals and every interval present in the
+  filter is verified by descending to its sub-intervals down to the level 0
+  (the doubt resolving of Rosetta, see S. Luo et al.: Rosetta: A Robust Space-
+  Time Optimized Range Filter for Key-Value Stores, SIGMOD 2020). Count of
+  probes of one query is limited by max_probes_, the query answers "may be
+  present" when the limit is reached.
+*/
+class range_bloom_filter : public bloom_filter
+{
+public:
+
+   range_bloom_filter()
+   : bloom_filter(),
+     key_bits_(0),
+     max_probes_(0)
+   {}
+
+   range_bloom_filter(const bloom_parameters& p, const unsigned int key_bits)
+   : bloom_filter(p),
+     key_bits_(key_bits),
+     max_probes_(8 * key_bits)
+   {}
+
+   inline void insert_key(const uint64_t key)
+   {
+      for (unsigned int level = 0; level < key_bits_; ++level)
+      {
+         unsigned char node[node_size];
+         make_node(key >> level,level,node);
+         bloom_filter::containsinsert(node,node_size);
+      }
+   }
+
+   inline bool range_may_contain(uint64_t low, uint64_t high) const
+   {
+      const uint64_t key_max = (key_bits_ >= 64) ? ~0ULL : ((1ULL << key_bits_) - 1);
+      unsigned int budget = max_probes_;
+
+      if (low > high || low > key_max)
+         return false;
+      if (high > key_max)
+         high = key_max;
+
+      // Split [low, high] into maximal dyadic intervals (from left to right)
+      for (;;)
+      {
+         unsigned int level = 0;
+         while ((level + 1 < key_bits_) &&
+                ((low & ((1ULL << (level + 1)) - 1)) == 0) &&
+                (high - low >= (1ULL << (level + 1)) - 1))
+         {
+            ++level;
+         }
+
+         if (check_interval(low >> level,level,budget))
+            return true;
+
+         const uint64_t last = low + ((1ULL << level) - 1);
+         if (last >= high)
+            return false;
+         low = last + 1;
+      }
+   }
+
+   inline unsigned int key_bits() const
+   {
+      return key_bits_;
+   }
+
+   inline unsigned int max_probes() const
+   {
+      return max_probes_;
+   }
+
+   inline void set_range_parameters(const unsigned int key_bits, const unsigned int max_probes)
+   {
+      key_bits_ = key_bits;
+      max_probes_ = max_probes;
+   }
+
+protected:
+
+   static const std::size_t node_size = sizeof(uint64_t) + 1;
+
+   static inline void make_node(const uint64_t prefix, const unsigned int level, unsigned char* node)
+   {
+      memcpy(node,&prefix,sizeof(prefix));
+      node[sizeof(prefix)] = static_cast<unsigned char>(level);
+   }
+
+   inline bool check_interval(const uint64_t prefix, const unsigned int level, unsigned int& budget) const
+   {
+      unsigned char node[node_size];
+
+      if (0 == budget)
+         return true;
+      --budget;
+
+      make_node(prefix,level,node);
+      if (!bloom_filter::contains(node,node_size))
+         return false;
+      if (0 == level)
+         return true;
+
+      return check_interval(prefix << 1,level - 1,budget) ||
+             check_interval((prefix << 1) | 1,level - 1,budget);
+   }
+
+   unsigned int key_bits_;
+   unsigned int max_probes_;
+};
+
+#endif
@@ -0,0 +1,257 @@
+/**
+ * \file RegisterBloomFilter.hpp
+ * \brief Register-blocked Bloom filter (all bits of a key in one 64-bit word)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef INCLUDE_REGISTER_BLOOM_FILTER_HPP
+#define INCLUDE_REGISTER_BLOOM_FILTER_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "BloomFilter.hpp"
+
+/*
+  Register-blocked Bloom filter keeps all k bits of a key in one 64-bit word
+  of the table, so insertion is one load, OR and store and lookup one load
+  and AND, whatever k is. It is meant for small hot filters (e.g. watchlists
+  of a few thousand addresses) resident in L1/L2 caches.
+
+  One hash value of a key (salt_ has one salt) selects both the word (upper
+  bits, multiplied by the count of words) and the mask of k bits. The mask
+  is an OR of two precomputed masks: one of ceil(k/2) bits of the lower half
+  of the word and one of floor(k/2) bits of the upper half, each selected
+  from a table of pattern_count masks, so keys of a word rarely share the
+  whole mask while both tables stay in L1. Masks are generated by
+  salt_random seeded by random_seed_, so they need not be stored. Table size
+  is a multiple of 64 bits and word_count() is limited (max_word_count),
+  inserted_element_count_ is counted as by containsinsert().
+
+  Keys share words, so the false positive probability is higher than of a
+  standard filter of the same size (the planner sizes the filter by the
+  model of bfi_register_fp_prob()).
+*/
+class register_bloom_filter : public bloom_filter
+{
+public:
+
+   enum { word_bits = 64, max_bits_per_key = 16, pattern_bits = 10, pattern_count = 1 << pattern_bits };
+   enum { max_word_count = 1 << 22 };
+
+   register_bloom_filter()
+   : bloom_filter(),
+     bits_per_key_(0),
+     word_count_(0)
+   {}
+
+   register_bloom_filter(const bloom_parameters& p, const unsigned int bits_per_key)
+   : bloom_filter(p),
+     bits_per_key_(std::min<unsigned int>(std::max(bits_per_key, 1U), max_bits_per_key)),
+     word_count_(0)
+   {
+      if (1 != salt_count_)
+      {
+         salt_count_ = 1;
+         salt_.clear();
+         generate_unique_salt();
+      }
+      // Table of whole words
+      if (0 != (table_size_ % word_bits))
+      {
+         table_size_ += word_bits - (table_size_ % word_bits);
+         raw_table_size_ = table_size_ / bits_per_char;
+         delete[] bit_table_;
+         bit_table_ = new cell_type[static_cast<std::size_t>(raw_table_size_)];
+         std::fill_n(bit_table_,raw_table_size_,0x00);
+      }
+      word_count_ = table_size_ / word_bits;
+      generate_patterns();
+   }
+
+   using bloom_filter::insert;
+   using bloom_filter::contains;
+
+   inline virtual void insert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      const bloom_type hash = hash_ap(key_begin,length,salt_[0]);
+      const uint64_t index = word_index(hash);
+      store_word(index,load_word(index) | pattern(hash));
+      ++inserted_element_count_;
+   }
+
+   inline virtual bool contains(const unsigned char* key_begin, const std::size_t length) const
+   {
+      return contains_hash(hash_ap(key_begin,length,salt_[0]));
+   }
+
+   inline virtual bool containsinsert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      return containsinsert_hash(hash_ap(key_begin,length,salt_[0]));
+   }
+
+   inline virtual bool contains_hashes(const bloom_type* hashes) const
+   {
+      return contains_hash(hashes[0]);
+   }
+
+   inline virtual bool containsinsert_hashes(const bloom_type* hashes)
+   {
+      return containsinsert_hash(hashes[0]);
+   }
+
+   /*
+     Lookup of a batch of keys by their hash values. The loop has no branch
+     depending on the table, so loads of all keys are issued independently
+     and the compiler may vectorize it across keys (gathers of words and
+     masks).
+   */
+   inline void contains_hashes_batch(const bloom_type* hashes, const std::size_t count, bool* results) const
+   {
+      for (std::size_t i = 0; i < count; ++i)
+      {
+         const uint64_t mask = pattern(hashes[i]);
+         results[i] = (load_word(word_index(hashes[i])) & mask) == mask;
+      }
+   }
+
+   // Word and mask of a key by its hash value (probes of a stored filter)
+   inline uint64_t word_position(const bloom_type hash, uint64_t& mask) const
+   {
+      mask = pattern(hash);
+      return word_index(hash);
+   }
+
+   inline unsigned int bits_per_key() const
+   {
+      return bits_per_key_;
+   }
+
+   inline unsigned long long int word_count() const
+   {
+      return word_count_;
+   }
+
+   // Used when the filter is loaded (see load_filter_from_bytes()), masks are
+   // generated again from random_seed_
+   inline bool set_register_parameters(const unsigned int bits_per_key)
+   {
+      if ((0 == bits_per_key) || (bits_per_key > max_bits_per_key) ||
+          (1 != salt_.size()) || (0 == table_size_) ||
+          (0 != (table_size_ % word_bits)) ||
+          (table_size_ / word_bits > max_word_count) ||
+          (raw_table_size_ != table_size_ / bits_per_char))
+         return false;
+      bits_per_key_ = bits_per_key;
+      word_count_ = table_size_ / word_bits;
+      generate_patterns();
+      return true;
+   }
+
+protected:
+
+   // Upper bits of the hash value select the word (without division)
+   inline uint64_t word_index(const bloom_type hash) const
+   {
+      return (static_cast<uint64_t>(hash) * word_count_) >> 32;
+   }
+
+   // Hash values of keys of one word are close to each other, so masks of
+   // both halves are selected by upper bits of the hash value multiplied by
+   // a constant (Fibonacci hashing spreads close values)
+   inline uint64_t pattern(const bloom_type hash) const
+   {
+      const uint32_t mixed = static_cast<uint32_t>(hash) * 0x9E3779B1U;
+      return patterns_[mixed >> (32 - pattern_bits)] |
+             patterns_[pattern_count + ((mixed >> (32 - 2 * pattern_bits)) & (pattern_count - 1))];
+   }
+
+   inline uint64_t load_word(const uint64_t index) const
+   {
+      uint64_t word;
+      memcpy(&word,bit_table_ + index * sizeof(word),sizeof(word));
+      return word;
+   }
+
+   inline void store_word(const uint64_t index, const uint64_t word)
+   {
+      memcpy(bit_table_ + index * sizeof(word),&word,sizeof(word));
+   }
+
+   inline bool contains_hash(const bloom_type hash) const
+   {
+      const uint64_t mask = pattern(hash);
+      return (load_word(word_index(hash)) & mask) == mask;
+   }
+
+   inline bool containsinsert_hash(const bloom_type hash)
+   {
+      const uint64_t index = word_index(hash);
+      const uint64_t mask = pattern(hash);
+      const uint64_t word = load_word(index);
+      const bool present = (word & mask) == mask;
+      store_word(index,word | mask);
+      if (!present)
+         ++inserted_element_count_;
+      return present;
+   }
+
+   // Masks of ceil(k/2) distinct bits of the lower half of a word followed
+   // by masks of floor(k/2) distinct bits of the upper half
+   void generate_patterns()
+   {
+      const unsigned int half_bits = word_bits / 2;
+      salt_random generator(static_cast<unsigned int>(random_seed_ ^ (random_seed_ >> 32)));
+      patterns_.resize(2 * pattern_count);
+      for (std::size_t i = 0; i < 2 * pattern_count; ++i)
+      {
+         const bool upper = (i >= pattern_count);
+         const int bits = static_cast<int>(upper ? bits_per_key_ / 2 : (bits_per_key_ + 1) / 2);
+         uint64_t mask = 0;
+         while (__builtin_popcountll(mask) < bits)
+         {
+            // Upper bits of the generator are the better ones
+            mask |= 1ULL << ((generator.next() >> 8) % half_bits + (upper ? half_bits : 0));
+         }
+         patterns_[i] = mask;
+      }
+   }
+
+   unsigned int bits_per_key_;
+   unsigned long long int word_count_;
+   std::vector<uint64_t> patterns_;
+};
+
+#endif
@@ -0,0 +1,261 @@
+/**
+ * \file StableBloomFilter.hpp
+ * \brief Stable Bloom filter (Bloom filter with decaying cells)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef INCLUDE_STABLE_BLOOM_FILTER_HPP
+#define INCLUDE_STABLE_BLOOM_FILTER_HPP
+
+#include "BloomFilter.hpp"
+
+/*
+  Stable Bloom filter, see F. Deng, D. Rafiei: Approximately Detecting
+  Duplicates for Streaming Data using Stable Bloom Filters (SIGMOD 2006).
+
+  Every cell is a small counter (one cell_type per cell, i.e. table_size_
+  cells of raw_table_size_ == table_size_ bytes). Insertion decrements
+  decrement_count_ cells and sets all cells of the key to cell_max_, a key is
+  present if none of its cells is zero. Old keys fade away, so the false
+  positive probability converges to a stable value regardless of a count of
+  inserted keys.
+
+  Decremented cells are consecutive cells starting at a random position (the
+  variant suggested by the authors), so the decrement is a plain loop over
+  a contiguous array which is vectorized by a compiler. Random positions are
+  generated by a local xorshift generator seeded by random_seed_, i.e. the
+  filter is deterministic and does not touch a global state.
+*/
+class stable_bloom_filter : public bloom_filter
+{
+public:
+
+   stable_bloom_filter()
+   : bloom_filter(),
+     cell_max_(0),
+     decrement_count_(0),
+     rng_state_(0)
+   {}
+
+   stable_bloom_filter(const bloom_parameters& p,
+                       const unsigned int cell_max,
+                       const unsigned long long int decrement_count)
+   : bloom_filter(p),
+     cell_max_(cell_max),
+     decrement_count_(decrement_count),
+     rng_state_(random_seed_ ? random_seed_ : 1)
+   {
+      // One cell per bit of the parent filter
+      delete[] bit_table_;
+      raw_table_size_ = table_size_;
+      bit_table_ = new cell_type[static_cast<std::size_t>(raw_table_size_)];
+      std::fill_n(bit_table_,raw_table_size_,0x00);
+
+      if ((0 == cell_max_) || (cell_max_ > std::numeric_limits<cell_type>::max()))
+         cell_max_ = std::numeric_limits<cell_type>::max();
+
+      if (0 == decrement_count_)
+         decrement_count_ = optimal_decrement_count(salt_.size(), table_size_, cell_max_, desired_false_positive_probability_);
+      else if (decrement_count_ > table_size_)
+         decrement_count_ = table_size_;
+   }
+
+   /*
+     Stable false positive probability (FPS) of the filter is:
+       FPS = (1 - (1 / (1 + 1 / (P * (1/k - 1/m))))^Max)^k
+     Returns P (count of cells decremented per insertion) for a required FPS.
+   */
+   static unsigned long long int optimal_decrement_count(const std::size_t k,
+                                                         const unsigned long long int m,
+                                                         const unsigned int max,
+                                                         const double fps)
+   {
+      const double c = 1.0 / k - 1.0 / m;
+      const double a = 1.0 - std::pow(fps, 1.0 / k);
+      const double p = 1.0 / (c * (std::pow(a, -1.0 / max) - 1.0));
+
+      if (!(p >= 1.0))
+         return 1;
+      else if (p >= m)
+         return m;
+
+      return static_cast<unsigned long long int>(p + 0.5);
+   }
+
+   using bloom_filter::insert;
+   using bloom_filter::contains;
+
+   inline virtual void insert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      decrement();
+      std::size_t cell = 0;
+      std::size_t bit = 0;
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         compute_indices(hash_ap(key_begin,length,salt_[i]),cell,bit);
+         bit_table_[cell] = static_cast<cell_type>(cell_max_);
+      }
+      ++inserted_element_count_;
+   }
+
+   inline virtual bool contains(const unsigned char* key_begin, const std::size_t length) const
+   {
+      std::size_t cell = 0;
+      std::size_t bit = 0;
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         compute_indices(hash_ap(key_begin,length,salt_[i]),cell,bit);
+         if (0 == bit_table_[cell])
+         {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   inline virtual bool containsinsert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      const bool present = contains(key_begin,length);
+      insert(key_begin,length);
+      if (present)
+         --inserted_element_count_;
+      return present;
+   }
+
+   inline virtual bool contains_hashes(const bloom_type* hashes) const
+   {
+      std::size_t cell = 0;
+      std::size_t bit = 0;
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         compute_indices(hashes[i],cell,bit);
+         if (0 == bit_table_[cell])
+         {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   inline virtual bool containsinsert_hashes(const bloom_type* hashes)
+   {
+      const bool present = contains_hashes(hashes);
+      std::size_t cell = 0;
+      std::size_t bit = 0;
+
+      decrement();
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         compute_indices(hashes[i],cell,bit);
+         bit_table_[cell] = static_cast<cell_type>(cell_max_);
+      }
+      if (!present)
+         ++inserted_element_count_;
+      return present;
+   }
+
+   inline unsigned int cell_max() const
+   {
+      return cell_max_;
+   }
+
+   inline unsigned long long int decrement_count() const
+   {
+      return decrement_count_;
+   }
+
+   inline unsigned long long int rng_state() const
+   {
+      return rng_state_;
+   }
+
+   // Used when the filter is loaded (see load_filter_from_bytes())
+   inline bool set_stable_parameters(const unsigned int cell_max,
+                                     const unsigned long long int decrement_count,
+                                     const unsigned long long int rng_state)
+   {
+      if ((0 == cell_max) || (cell_max > std::numeric_limits<cell_type>::max()))
+         return false;
+      cell_max_ = cell_max;
+      decrement_count_ = std::min(decrement_count, table_size_);
+      rng_state_ = rng_state ? rng_state : 1;
+      return true;
+   }
+
+   // One byte cell per bit of the parent filter
+   virtual bool valid_table_size() const
+   {
+      return (0 != table_size_) && (raw_table_size_ == table_size_);
+   }
+
+protected:
+
+   inline unsigned long long int next_random()
+   {
+      // xorshift64*
+      rng_state_ ^= rng_state_ >> 12;
+      rng_state_ ^= rng_state_ << 25;
+      rng_state_ ^= rng_state_ >> 27;
+      return rng_state_ * 0x2545F4914F6CDD1DULL;
+   }
+
+   inline void decrement()
+   {
+      if (0 == table_size_)
+         return;
+
+      const unsigned long long int start = next_random() % table_size_;
+      const unsigned long long int first = std::min(decrement_count_, table_size_ - start);
+
+      // Consecutive cells wrap around the end of the table
+      decrement_cells(bit_table_ + start, first);
+      decrement_cells(bit_table_, decrement_count_ - first);
+   }
+
+   static inline void decrement_cells(cell_type* cells, const unsigned long long int count)
+   {
+      // Branch-free saturating decrement (vectorized by a compiler)
+      for (unsigned long long int i = 0; i < count; ++i)
+      {
+         cells[i] -= (0 != cells[i]);
+      }
+   }
+
+   unsigned int           cell_max_;
+   unsigned long long int decrement_count_;
+   unsigned long long int rng_state_;
+};
+
+#endif
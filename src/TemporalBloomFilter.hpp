@@ -0,0 +1,240 @@
+/**
+ * \file TemporalBloomFilter.hpp
+ * \brief Temporal Bloom filter (time slot masks in cells)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef INCLUDE_TEMPORAL_BLOOM_FILTER_HPP
+#define INCLUDE_TEMPORAL_BLOOM_FILTER_HPP
+
+#include "BloomFilter.hpp"
+
+/*
+  Temporal Bloom filter answers which sub-intervals (time slots) of the
+  interval of the filter may contain a key, e.g. minutes of an hour, by one
+  lookup instead of a lookup in a filter of every sub-interval.
+
+  Every cell is a mask with one bit per time slot (slot_count_ <= 16 slots),
+  cells are 8-bit masks up to 8 slots and 16-bit masks otherwise, i.e.
+  raw_table_size_ == table_size_ * cell_bytes(). Insertion sets the bit of
+  the current slot (see set_slot()) in every probed cell, lookup ANDs masks of
+  all probed cells. Bit of a slot is an ordinary Bloom filter of keys
+  inserted in that slot, so the false positive probability of every slot is
+  not higher than the probability of the whole filter.
+
+  The AND is a running AND with an early exit on an empty mask, the exit
+  ends most lookups of missing keys after a probe or two.
+*/
+class temporal_bloom_filter : public bloom_filter
+{
+public:
+
+   enum { max_slot_count = 16 };
+
+   temporal_bloom_filter()
+   : bloom_filter(),
+     slot_count_(0),
+     slot_(0)
+   {}
+
+   temporal_bloom_filter(const bloom_parameters& p, const unsigned int slot_count)
+   : bloom_filter(p),
+     slot_count_(std::min<unsigned int>(std::max(slot_count, 1U), max_slot_count)),
+     slot_(0)
+   {
+      // One mask per bit of the parent filter
+      delete[] bit_table_;
+      raw_table_size_ = table_size_ * cell_bytes();
+      bit_table_ = new cell_type[static_cast<std::size_t>(raw_table_size_)];
+      std::fill_n(bit_table_,raw_table_size_,0x00);
+   }
+
+   using bloom_filter::insert;
+   using bloom_filter::contains;
+
+   inline virtual void insert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      std::size_t cell = 0;
+      std::size_t bit = 0;
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         compute_indices(hash_ap(key_begin,length,salt_[i]),cell,bit);
+         set_cell(cell);
+      }
+      ++inserted_element_count_;
+   }
+
+   inline virtual bool contains(const unsigned char* key_begin, const std::size_t length) const
+   {
+      return 0 != slots(key_begin,length);
+   }
+
+   inline virtual bool containsinsert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      const bool present = contains(key_begin,length);
+      insert(key_begin,length);
+      if (present)
+         --inserted_element_count_;
+      return present;
+   }
+
+   inline virtual bool contains_hashes(const bloom_type* hashes) const
+   {
+      return 0 != slots_hashes(hashes);
+   }
+
+   inline virtual bool containsinsert_hashes(const bloom_type* hashes)
+   {
+      const bool present = contains_hashes(hashes);
+      std::size_t cell = 0;
+      std::size_t bit = 0;
+
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         compute_indices(hashes[i],cell,bit);
+         set_cell(cell);
+      }
+      if (!present)
+         ++inserted_element_count_;
+      return present;
+   }
+
+   // Mask of slots which may contain the key (bit i is slot i)
+   inline unsigned int slots(const unsigned char* key_begin, const std::size_t length) const
+   {
+      unsigned int mask = all_slots();
+      std::size_t cell = 0;
+      std::size_t bit = 0;
+      for (std::size_t i = 0; (i < salt_.size()) && mask; ++i)
+      {
+         compute_indices(hash_ap(key_begin,length,salt_[i]),cell,bit);
+         mask &= get_cell(cell);
+      }
+      return mask;
+   }
+
+   inline unsigned int slots_hashes(const bloom_type* hashes) const
+   {
+      unsigned int mask = all_slots();
+      std::size_t cell = 0;
+      std::size_t bit = 0;
+      for (std::size_t i = 0; (i < salt_.size()) && mask; ++i)
+      {
+         compute_indices(hashes[i],cell,bit);
+         mask &= get_cell(cell);
+      }
+      return mask;
+   }
+
+   // Select slot of following insertions
+   inline bool set_slot(const unsigned int slot)
+   {
+      if (slot >= slot_count_)
+         return false;
+      slot_ = slot;
+      return true;
+   }
+
+   inline unsigned int slot() const
+   {
+      return slot_;
+   }
+
+   inline unsigned int slot_count() const
+   {
+      return slot_count_;
+   }
+
+   // Used when the filter is loaded (see load_filter_from_bytes())
+   inline bool set_temporal_parameters(const unsigned int slot_count,
+                                       const unsigned int slot)
+   {
+      if ((0 == slot_count) || (slot_count > max_slot_count) || (slot >= slot_count))
+         return false;
+      slot_count_ = slot_count;
+      slot_ = slot;
+      return raw_table_size_ == table_size_ * cell_bytes();
+   }
+
+   // Width of cells is known only after set_temporal_parameters(), a header
+   // is checked for any of them
+   virtual bool valid_table_size() const
+   {
+      return (0 != table_size_) && (0 == (raw_table_size_ % table_size_)) &&
+             (raw_table_size_ / table_size_ >= 1) &&
+             (raw_table_size_ / table_size_ <= 2);
+   }
+
+protected:
+
+   inline std::size_t cell_bytes() const
+   {
+      return (slot_count_ <= 8) ? 1 : 2;
+   }
+
+   inline unsigned int all_slots() const
+   {
+      return (1U << slot_count_) - 1;
+   }
+
+   inline unsigned int get_cell(const std::size_t cell) const
+   {
+      if (slot_count_ <= 8)
+         return bit_table_[cell];
+
+      unsigned short mask;
+      memcpy(&mask, bit_table_ + 2 * cell, sizeof(mask));
+      return mask;
+   }
+
+   inline void set_cell(const std::size_t cell)
+   {
+      if (slot_count_ <= 8)
+      {
+         bit_table_[cell] |= static_cast<cell_type>(1U << slot_);
+         return;
+      }
+
+      unsigned short mask;
+      memcpy(&mask, bit_table_ + 2 * cell, sizeof(mask));
+      mask |= static_cast<unsigned short>(1U << slot_);
+      memcpy(bit_table_ + 2 * cell, &mask, sizeof(mask));
+   }
+
+   unsigned int slot_count_;
+   unsigned int slot_;
+};
+
+#endif
@@ -0,0 +1,501 @@
+/**
+ * \file bf_batch.c
+ * \brief Batched operations on indexes
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bf_index_internal.h"
+#include "bf_parallel.h"
+#include "bf_numa.h"
+#include "bloomf_wrapper.h"
+
+// Batches smaller than this are inserted by the calling thread only
+#define BFI_BATCH_MIN_KEYS 4096
+// Keys looked up at once (probes of all of them are prefetched first)
+#define BFI_BATCH_GROUP 16
+// Fragments of a key are kept on the stack up to this count of columns
+#define BFI_BATCH_STACK_COLUMNS 16
+
+/**
+ * \brief Keys of a batch (keys of the same length one after another or
+ *    columns of composite keys)
+ */
+typedef struct {
+    const unsigned char *keys;
+    size_t key_len;
+    const bfi_column_t *columns;    // NULL if keys are contiguous
+    size_t column_cnt;
+} bfi_batch_keys_t;
+
+/**
+ * \brief Probe of a key (bit of the filter set by the key)
+ */
+typedef struct {
+    uint64_t bit;
+    uint64_t key;
+} bfi_batch_probe_t;
+
+/* Keys are inserted in three parallel steps:
+ * 1. chunks of keys are hashed to bit positions, probes of every chunk are
+ *    counted by partitions of the table (contiguous ranges of bytes),
+ * 2. probes are scattered to partitions (keeping the order of keys),
+ * 3. bits of every partition are set by one thread.
+ * No byte of the table is written by two threads. Probes of a partition are
+ * processed in the order of keys, so a key is new iff one of its bits was
+ * not set before (as bf_containsinsert() of keys one by one).
+ */
+typedef struct {
+    bloom_filter_h *bf;
+    const bfi_batch_keys_t *src;
+    uint64_t key_cnt;
+    uint32_t hash_cnt;
+    uint32_t part_cnt;          // Count of chunks and of partitions
+    unsigned char *table;
+    uint64_t table_len;
+    uint64_t *positions;        // Bit positions of probes (key_cnt * hash_cnt)
+    bfi_batch_probe_t *probes;  // Probes ordered by partitions
+    // Count of probes of chunk c in partition p, then their offset in probes
+    uint64_t offsets[BFI_PARALLEL_MAX][BFI_PARALLEL_MAX];
+    uint64_t part_end[BFI_PARALLEL_MAX];
+    bfi_zone_t zones[BFI_PARALLEL_MAX];
+    unsigned char *new_keys;    // Keys which set a bit
+    bfi_ecode_t ret;
+} bfi_batch_ctx_t;
+
+
+/**
+ * \brief Get fragments of a key of a batch
+ *
+ * \param[out] iov Array of (at least) column_cnt fragments
+ * \return Returns count of fragments.
+ */
+static inline size_t bfi_batch_key(const bfi_batch_keys_t *src, uint64_t k,
+                    bfi_iovec_t *iov)
+{
+    if (!src->columns) {
+        iov[0].base = src->keys + k * src->key_len;
+        iov[0].len = src->key_len;
+        return 1;
+    }
+
+    for (size_t c = 0; c < src->column_cnt; ++c) {
+        iov[c].base = (const unsigned char *) src->columns[c].base
+                      + k * src->columns[c].stride;
+        iov[c].len = src->columns[c].len;
+    }
+
+    return src->column_cnt;
+}
+
+
+/**
+ * \brief Allocate fragments of a key of a batch (stack_iov is used if
+ *    possible)
+ *
+ * \return Returns array of fragments (free it by bfi_batch_free_iov()) or NULL
+ *    on allocation error.
+ */
+static bfi_iovec_t *bfi_batch_alloc_iov(const bfi_batch_keys_t *src,
+                    bfi_iovec_t *stack_iov)
+{
+    if (!src->columns || src->column_cnt <= BFI_BATCH_STACK_COLUMNS) {
+        return stack_iov;
+    }
+
+    return (bfi_iovec_t *) malloc(src->column_cnt * sizeof(bfi_iovec_t));
+}
+
+
+static void bfi_batch_free_iov(bfi_iovec_t *iov, bfi_iovec_t *stack_iov)
+{
+    if (iov != stack_iov) {
+        free(iov);
+    }
+}
+
+
+static inline uint64_t bfi_batch_chunk_first(const bfi_batch_ctx_t *ctx,
+                    uint64_t chunk)
+{
+    return ctx->key_cnt * chunk / ctx->part_cnt;
+}
+
+
+static inline uint32_t bfi_batch_partition(const bfi_batch_ctx_t *ctx,
+                    uint64_t bit)
+{
+    return (uint32_t) ((bit / 8) * ctx->part_cnt / ctx->table_len);
+}
+
+
+static void bfi_batch_hash_worker(void *arg, uint64_t first, uint64_t end)
+{
+    bfi_batch_ctx_t *ctx = (bfi_batch_ctx_t *) arg;
+    uint32_t stack_hashes[BFI_STACK_HASH_CNT];
+    bfi_iovec_t stack_iov[BFI_BATCH_STACK_COLUMNS];
+    bfi_iovec_t *iov;
+
+    iov = bfi_batch_alloc_iov(ctx->src, stack_iov);
+    if (!iov) {
+        bfi_parallel_error(&ctx->ret, BFI_E_MEM);
+        return;
+    }
+
+    for (uint64_t c = first; c < end; ++c) {
+        uint64_t *counts = ctx->offsets[c];
+
+        bfi_zone_reset(&ctx->zones[c], true);
+        for (uint64_t k = bfi_batch_chunk_first(ctx, c);
+                k < bfi_batch_chunk_first(ctx, c + 1); ++k) {
+            size_t iov_cnt = bfi_batch_key(ctx->src, k, iov);
+            uint64_t *positions = ctx->positions + k * ctx->hash_cnt;
+            uint32_t *hashes;
+
+            hashes = bfi_compute_hashes_iov(ctx->bf, iov, iov_cnt,
+                                            stack_hashes);
+            if (!hashes) {
+                bfi_parallel_error(&ctx->ret, BFI_E_MEM);
+                goto cleanup;
+            }
+            for (uint32_t i = 0; i < ctx->hash_cnt; ++i) {
+                positions[i] = bf_bit_position(ctx->bf, hashes[i]);
+                counts[bfi_batch_partition(ctx, positions[i])]++;
+            }
+            bfi_free_hashes(hashes, stack_hashes);
+            bfi_zone_update_iov(&ctx->zones[c], iov, iov_cnt);
+        }
+    }
+
+cleanup:
+    bfi_batch_free_iov(iov, stack_iov);
+}
+
+
+static void bfi_batch_scatter_worker(void *arg, uint64_t first, uint64_t end)
+{
+    bfi_batch_ctx_t *ctx = (bfi_batch_ctx_t *) arg;
+
+    for (uint64_t c = first; c < end; ++c) {
+        uint64_t *offsets = ctx->offsets[c];
+
+        for (uint64_t k = bfi_batch_chunk_first(ctx, c);
+                k < bfi_batch_chunk_first(ctx, c + 1); ++k) {
+            const uint64_t *positions = ctx->positions + k * ctx->hash_cnt;
+
+            for (uint32_t i = 0; i < ctx->hash_cnt; ++i) {
+                bfi_batch_probe_t *probe;
+
+                probe = &ctx->probes[offsets[bfi_batch_partition(ctx,
+                                                        positions[i])]++];
+                probe->bit = positions[i];
+                probe->key = k;
+            }
+        }
+    }
+}
+
+
+static void bfi_batch_set_worker(void *arg, uint64_t first, uint64_t end)
+{
+    bfi_batch_ctx_t *ctx = (bfi_batch_ctx_t *) arg;
+
+    for (uint64_t p = first; p < end; ++p) {
+        for (uint64_t i = p ? ctx->part_end[p - 1] : 0; i < ctx->part_end[p];
+                ++i) {
+            const bfi_batch_probe_t *probe = &ctx->probes[i];
+            unsigned char mask = (unsigned char) (1U << (probe->bit % 8));
+            unsigned char *byte = &ctx->table[probe->bit / 8];
+
+            if (!(*byte & mask)) {
+                *byte |= mask;
+                // Other partitions may mark the same key
+                __atomic_store_n(&ctx->new_keys[probe->key], 1,
+                                 __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+
+/**
+ * \brief Add keys of a batch (see bfi_add_addr_batch())
+ */
+static bfi_ecode_t bfi_batch_add(bfi_index_t *index,
+                    const bfi_batch_keys_t *src, uint64_t key_cnt)
+{
+    bfi_batch_ctx_t *ctx;
+    uint64_t offset = 0;
+    uint64_t new_cnt = 0;
+    bfi_ecode_t ret;
+
+    bfi_numa_drop_replicas(index);
+
+    // Cells of other engines and sketches are updated key by key
+    if (index->engine != BFI_ENGINE_STANDARD || index->cms
+            || key_cnt < BFI_BATCH_MIN_KEYS || bfi_parallel_threads() < 2) {
+        bfi_iovec_t stack_iov[BFI_BATCH_STACK_COLUMNS];
+        bfi_iovec_t *iov = bfi_batch_alloc_iov(src, stack_iov);
+
+        if (!iov) {
+            return BFI_E_MEM;
+        }
+        ret = BFI_E_OK;
+        for (uint64_t k = 0; k < key_cnt && ret == BFI_E_OK; ++k) {
+            size_t iov_cnt = bfi_batch_key(src, k, iov);
+
+            ret = bfi_add_addr_iov((bfi_index_ptr_t) index, iov, iov_cnt);
+        }
+        bfi_batch_free_iov(iov, stack_iov);
+        return ret;
+    }
+
+    ctx = (bfi_batch_ctx_t *) calloc(1, sizeof(*ctx));
+    if (!ctx) {
+        return BFI_E_MEM;
+    }
+    ctx->bf = index->bf;
+    ctx->src = src;
+    ctx->key_cnt = key_cnt;
+    ctx->hash_cnt = (uint32_t) bf_hash_count(index->bf);
+    ctx->part_cnt = bfi_parallel_threads();
+    // Table is owned by the index, bits are set directly
+    ctx->table = (unsigned char *) bf_table(index->bf, &ctx->table_len);
+    ctx->ret = BFI_E_OK;
+    ctx->positions = (uint64_t *) malloc(key_cnt * ctx->hash_cnt
+                                         * sizeof(uint64_t));
+    ctx->probes = (bfi_batch_probe_t *) malloc(key_cnt * ctx->hash_cnt
+                                               * sizeof(bfi_batch_probe_t));
+    ctx->new_keys = (unsigned char *) calloc(key_cnt, 1);
+    if (!ctx->positions || !ctx->probes || !ctx->new_keys) {
+        ret = BFI_E_MEM;
+        goto cleanup;
+    }
+
+    bfi_parallel_for(ctx->part_cnt, 1, bfi_batch_hash_worker, ctx);
+    if (ctx->ret != BFI_E_OK) {
+        ret = ctx->ret;
+        goto cleanup;
+    }
+
+    // Counts to offsets (partition by partition, chunks in order)
+    for (uint32_t p = 0; p < ctx->part_cnt; ++p) {
+        for (uint32_t c = 0; c < ctx->part_cnt; ++c) {
+            uint64_t cnt = ctx->offsets[c][p];
+
+            ctx->offsets[c][p] = offset;
+            offset += cnt;
+        }
+        ctx->part_end[p] = offset;
+    }
+    bfi_parallel_for(ctx->part_cnt, 1, bfi_batch_scatter_worker, ctx);
+    bfi_parallel_for(ctx->part_cnt, 1, bfi_batch_set_worker, ctx);
+
+    for (uint64_t k = 0; k < key_cnt; ++k) {
+        new_cnt += ctx->new_keys[k];
+    }
+    bf_set_inserted_element_cnt(index->bf,
+                    bf_get_inserted_element_cnt(index->bf) + new_cnt);
+    for (uint32_t c = 0; c < ctx->part_cnt; ++c) {
+        bfi_zone_merge(&index->zone, &ctx->zones[c]);
+    }
+    ret = BFI_E_OK;
+
+cleanup:
+    free(ctx->positions);
+    free(ctx->probes);
+    free(ctx->new_keys);
+    free(ctx);
+
+    return ret;
+}
+
+
+bfi_ecode_t bfi_add_addr_batch(bfi_index_ptr_t index_ptr,
+                    const unsigned char *keys, size_t key_len,
+                    uint64_t key_cnt)
+{
+    bfi_batch_keys_t src = { keys, key_len, NULL, 0 };
+
+    if (!index_ptr) {
+        return BFI_E_NO_INDEX;
+    }
+
+    return bfi_batch_add((bfi_index_t *) index_ptr, &src, key_cnt);
+}
+
+
+bfi_ecode_t bfi_add_addr_columns(bfi_index_ptr_t index_ptr,
+                    const bfi_column_t *columns, size_t column_cnt,
+                    uint64_t key_cnt)
+{
+    bfi_batch_keys_t src = { NULL, 0, columns, column_cnt };
+
+    if (!index_ptr) {
+        return BFI_E_NO_INDEX;
+    }
+
+    return bfi_batch_add((bfi_index_t *) index_ptr, &src, key_cnt);
+}
+
+
+/**
+ * \brief Look up keys of a batch (see bfi_addr_is_stored_batch())
+ */
+static bfi_ecode_t bfi_batch_lookup(bfi_index_t *index,
+                    const bfi_batch_keys_t *src, uint64_t key_cnt,
+                    bool *stored)
+{
+    uint64_t positions[BFI_BATCH_GROUP][BFI_STACK_HASH_CNT];
+    uint32_t hashes[BFI_STACK_HASH_CNT];
+    bfi_iovec_t stack_iov[BFI_BATCH_STACK_COLUMNS];
+    bfi_iovec_t *iov;
+    bloom_filter_h *bf = bfi_local_filter(index);
+    const unsigned char *table;
+    uint64_t table_len;
+    uint32_t hash_cnt;
+
+    iov = bfi_batch_alloc_iov(src, stack_iov);
+    if (!iov) {
+        return BFI_E_MEM;
+    }
+    hash_cnt = (uint32_t) bf_hash_count(bf);
+
+    // Words of a group are probed by one branch-free loop over the keys
+    // (register-blocked filters have one hash function, see
+    // set_register_parameters(), others are probed one by one below)
+    if (index->engine == BFI_ENGINE_REGISTER && hash_cnt == 1) {
+        uint32_t group_hashes[BFI_BATCH_GROUP];
+        bool passed[BFI_BATCH_GROUP];
+
+        for (uint64_t first = 0; first < key_cnt; first += BFI_BATCH_GROUP) {
+            uint64_t cnt = key_cnt - first < BFI_BATCH_GROUP
+                           ? key_cnt - first : BFI_BATCH_GROUP;
+
+            for (uint64_t i = 0; i < cnt; ++i) {
+                size_t iov_cnt = bfi_batch_key(src, first + i, iov);
+
+                passed[i] = bfi_zone_may_contain_iov(&index->zone, iov,
+                                                     iov_cnt);
+                bfi_compute_hashes_iov(bf, iov, iov_cnt, &group_hashes[i]);
+            }
+            rgbf_contains_hashes_batch(bf, group_hashes, cnt, stored + first);
+            for (uint64_t i = 0; i < cnt; ++i) {
+                stored[first + i] = stored[first + i] && passed[i];
+            }
+        }
+        bfi_batch_free_iov(iov, stack_iov);
+        return BFI_E_OK;
+    }
+
+    // Cells of other engines are probed by the engine
+    if (index->engine != BFI_ENGINE_STANDARD
+            || hash_cnt > BFI_STACK_HASH_CNT) {
+        for (uint64_t k = 0; k < key_cnt; ++k) {
+            size_t iov_cnt = bfi_batch_key(src, k, iov);
+
+            stored[k] = bfi_addr_is_stored_iov((bfi_index_ptr_t) index, iov,
+                                               iov_cnt);
+        }
+        bfi_batch_free_iov(iov, stack_iov);
+        return BFI_E_OK;
+    }
+
+    table = bf_table(bf, &table_len);
+    for (uint64_t first = 0; first < key_cnt; first += BFI_BATCH_GROUP) {
+        uint64_t end = first + BFI_BATCH_GROUP < key_cnt
+                       ? first + BFI_BATCH_GROUP : key_cnt;
+
+        // Probes of a group are fetched from memory in parallel
+        for (uint64_t k = first; k < end; ++k) {
+            size_t iov_cnt = bfi_batch_key(src, k, iov);
+            uint64_t *pos = positions[k - first];
+
+            stored[k] = bfi_zone_may_contain_iov(&index->zone, iov, iov_cnt);
+            if (!stored[k]) {
+                continue;
+            }
+            // Hash values fit the stack (hash_cnt is checked above)
+            bfi_compute_hashes_iov(bf, iov, iov_cnt, hashes);
+            for (uint32_t i = 0; i < hash_cnt; ++i) {
+                pos[i] = bf_bit_position(bf, hashes[i]);
+                __builtin_prefetch(table + pos[i] / 8);
+            }
+        }
+
+        for (uint64_t k = first; k < end; ++k) {
+            const uint64_t *pos = positions[k - first];
+
+            for (uint32_t i = 0; i < hash_cnt && stored[k]; ++i) {
+                stored[k] = (table[pos[i] / 8] >> (pos[i] % 8)) & 1;
+            }
+        }
+    }
+    bfi_batch_free_iov(iov, stack_iov);
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_addr_is_stored_batch(bfi_index_ptr_t index_ptr,
+                    const unsigned char *keys, size_t key_len,
+                    uint64_t key_cnt, bool *stored)
+{
+    bfi_batch_keys_t src = { keys, key_len, NULL, 0 };
+
+    if (!index_ptr) {
+        return BFI_E_NO_INDEX;
+    }
+
+    return bfi_batch_lookup((bfi_index_t *) index_ptr, &src, key_cnt, stored);
+}
+
+
+bfi_ecode_t bfi_addr_is_stored_columns(bfi_index_ptr_t index_ptr,
+                    const bfi_column_t *columns, size_t column_cnt,
+                    uint64_t key_cnt, bool *stored)
+{
+    bfi_batch_keys_t src = { NULL, 0, columns, column_cnt };
+
+    if (!index_ptr) {
+        return BFI_E_NO_INDEX;
+    }
+
+    return bfi_batch_lookup((bfi_index_t *) index_ptr, &src, key_cnt, stored);
+}
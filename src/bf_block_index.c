@@ -0,0 +1,548 @@
+/**
+ * \file bf_block_index.c
+ * \brief Block-granular Bloom filter indexes (file-level and per-block filters)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bf_index_internal.h"
+#include "bf_index_file.h"
+#include "bloomf_wrapper.h"
+
+// Initial size of block arrays (doubled when full)
+#define BFI_BLOCK_ALLOC_INIT 64
+
+typedef struct {
+    bloom_filter_h *file_filter;    // File-level filter
+    bloom_parameters_h *block_bp;   // Parameters of block filters
+    bloom_filter_h **blocks;        // Block filters
+    uint64_t *offsets;              // Offsets of blocks in a data file
+    uint64_t block_cnt;
+    uint64_t block_alloc;
+} bfi_block_index_t;
+
+/* BFI_SEC_BLOCKS section format:
+ * +---------------------------------------------------------------------+
+ * | u64: block count                                                    |
+ * > ---- Block table (block count items) --------------------------------<
+ * | u64: data offset | u64: filter length                               |
+ * > ---- Block filters (get_filter_as_bytes() format), contiguously -----<
+ * +---------------------------------------------------------------------+
+ */
+
+
+static bfi_ecode_t bfi_block_alloc(bfi_block_index_t *bindex, uint64_t cnt)
+{
+    bloom_filter_h **blocks;
+    uint64_t *offsets;
+
+    if (cnt <= bindex->block_alloc) {
+        return BFI_E_OK;
+    }
+
+    blocks = (bloom_filter_h **) realloc(bindex->blocks,
+                                         cnt * sizeof(bloom_filter_h *));
+    if (!blocks) {
+        return BFI_E_MEM;
+    }
+    bindex->blocks = blocks;
+
+    offsets = (uint64_t *) realloc(bindex->offsets, cnt * sizeof(uint64_t));
+    if (!offsets) {
+        return BFI_E_MEM;
+    }
+    bindex->offsets = offsets;
+    bindex->block_alloc = cnt;
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_init_block_index(bfi_block_index_ptr_t *bindex_ptr,
+                    uint64_t est_item_cnt, uint64_t est_block_item_cnt,
+                    double fp_prob)
+{
+    bfi_block_index_t *bindex;
+    bloom_parameters_h *bp;
+
+    bindex = (bfi_block_index_t *) calloc(1, sizeof(bfi_block_index_t));
+    if (!bindex) {
+        return BFI_E_MEM;
+    }
+
+    // File-level filter
+    bp = new_bloom_parameters();
+    bp_set_false_pos_prob(bp, fp_prob);
+    bp_set_proj_elem_cnt(bp, est_item_cnt);
+    if (!bfi_compute_parameters(bp)){
+        del_bloom_parameters(bp);
+        free(bindex);
+        return BFI_E_BP_COMP_PARAMS;
+    }
+    bindex->file_filter = new_bloom_filter_bp(bp);
+    del_bloom_parameters(bp);
+
+    // Block filters use the same false positive probability, i.e. the same
+    // count of hash functions (and salts), so hash values of a key could be
+    // computed only once for all filters.
+    bindex->block_bp = new_bloom_parameters();
+    bp_set_false_pos_prob(bindex->block_bp, fp_prob);
+    bp_set_proj_elem_cnt(bindex->block_bp, est_block_item_cnt);
+    if (!bfi_compute_parameters(bindex->block_bp)){
+        bfi_destroy_block_index((bfi_block_index_ptr_t *) &bindex);
+        return BFI_E_BP_COMP_PARAMS;
+    }
+
+    *bindex_ptr = (bfi_block_index_ptr_t) bindex;
+
+    return BFI_E_OK;
+}
+
+
+void bfi_destroy_block_index(bfi_block_index_ptr_t *bindex_ptr)
+{
+    bfi_block_index_t *bindex;
+
+    if (!bindex_ptr || !*bindex_ptr) {
+        return;
+    }
+    bindex = (bfi_block_index_t *) *bindex_ptr;
+
+    for (uint64_t i = 0; i < bindex->block_cnt; ++i) {
+        bf_delete_filter(bindex->blocks[i]);
+    }
+    free(bindex->blocks);
+    free(bindex->offsets);
+    if (bindex->block_bp) {
+        del_bloom_parameters(bindex->block_bp);
+    }
+    if (bindex->file_filter) {
+        bf_delete_filter(bindex->file_filter);
+    }
+    free(bindex);
+
+    *bindex_ptr = NULL;
+}
+
+
+bfi_ecode_t bfi_block_index_new_block(bfi_block_index_ptr_t bindex_ptr,
+                    uint64_t data_offset)
+{
+    bfi_block_index_t *bindex = (bfi_block_index_t *) bindex_ptr;
+    bfi_ecode_t ret;
+
+    if (!bindex || !bindex->block_bp) {
+        // no index or loaded (read only) index
+        return BFI_E_NO_INDEX;
+    }
+
+    if (bindex->block_cnt == bindex->block_alloc) {
+        ret = bfi_block_alloc(bindex, bindex->block_alloc
+                              ? 2 * bindex->block_alloc : BFI_BLOCK_ALLOC_INIT);
+        if (ret != BFI_E_OK) {
+            return ret;
+        }
+    }
+
+    bindex->blocks[bindex->block_cnt] = new_bloom_filter_bp(bindex->block_bp);
+    bindex->offsets[bindex->block_cnt] = data_offset;
+    bindex->block_cnt++;
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_block_index_add_addr(bfi_block_index_ptr_t bindex_ptr,
+                    const unsigned char *buffer, const size_t len)
+{
+    bfi_block_index_t *bindex = (bfi_block_index_t *) bindex_ptr;
+    uint32_t stack_hashes[BFI_STACK_HASH_CNT];
+    uint32_t *hashes;
+    bfi_ecode_t ret;
+
+    if (!bindex) {
+        return BFI_E_NO_INDEX;
+    }
+    if (bindex->block_cnt == 0) {
+        ret = bfi_block_index_new_block(bindex_ptr, 0);
+        if (ret != BFI_E_OK) {
+            return ret;
+        }
+    }
+
+    hashes = bfi_compute_hashes(bindex->file_filter, buffer, len, stack_hashes);
+    if (!hashes) {
+        return BFI_E_MEM;
+    }
+    bf_containsinsert_hashes(bindex->file_filter, hashes);
+    bf_containsinsert_hashes(bindex->blocks[bindex->block_cnt - 1], hashes);
+    bfi_free_hashes(hashes, stack_hashes);
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_block_index_query(bfi_block_index_ptr_t bindex_ptr,
+                    const unsigned char *buffer, const size_t len,
+                    bfi_block_range_t **ranges, size_t *range_cnt)
+{
+    bfi_block_index_t *bindex = (bfi_block_index_t *) bindex_ptr;
+    uint32_t stack_hashes[BFI_STACK_HASH_CNT];
+    uint32_t *hashes;
+    bfi_block_range_t *range_arr = NULL;
+    size_t cnt = 0;
+    bool in_range = false;
+
+    *ranges = NULL;
+    *range_cnt = 0;
+
+    if (!bindex) {
+        return BFI_E_NO_INDEX;
+    }
+
+    hashes = bfi_compute_hashes(bindex->file_filter, buffer, len, stack_hashes);
+    if (!hashes) {
+        return BFI_E_MEM;
+    }
+
+    if (!bf_contains_hashes(bindex->file_filter, hashes)) {
+        bfi_free_hashes(hashes, stack_hashes);
+        return BFI_E_OK;
+    }
+
+    for (uint64_t i = 0; i < bindex->block_cnt; ++i) {
+        if (!bf_contains_hashes(bindex->blocks[i], hashes)) {
+            in_range = false;
+            continue;
+        }
+
+        if (in_range) {
+            // Extend current range by this block
+            range_arr[cnt - 1].end = (i + 1 < bindex->block_cnt)
+                                     ? bindex->offsets[i + 1] : BFI_BLOCK_EOF;
+            continue;
+        }
+
+        if (!range_arr) {
+            // There is at most (block_cnt + 1) / 2 separate ranges
+            range_arr = (bfi_block_range_t *) malloc(
+                    (bindex->block_cnt + 1) / 2 * sizeof(bfi_block_range_t));
+            if (!range_arr) {
+                bfi_free_hashes(hashes, stack_hashes);
+                return BFI_E_MEM;
+            }
+        }
+        range_arr[cnt].begin = bindex->offsets[i];
+        range_arr[cnt].end = (i + 1 < bindex->block_cnt)
+                             ? bindex->offsets[i + 1] : BFI_BLOCK_EOF;
+        cnt++;
+        in_range = true;
+    }
+    bfi_free_hashes(hashes, stack_hashes);
+
+    *ranges = range_arr;
+    *range_cnt = cnt;
+
+    return BFI_E_OK;
+}
+
+
+uint64_t bfi_block_index_block_cnt(bfi_block_index_ptr_t bindex_ptr)
+{
+    if (!bindex_ptr) {
+        return 0;
+    }
+
+    return ((bfi_block_index_t *) bindex_ptr)->block_cnt;
+}
+
+
+bfi_ecode_t bfi_store_block_index(bfi_block_index_ptr_t bindex_ptr,
+                    char *filename)
+{
+    bfi_block_index_t *bindex = (bfi_block_index_t *) bindex_ptr;
+    bfi_section_t sections[2];
+    const char *payloads[2];
+    char *file_bytes = NULL;
+    char *blocks_bytes = NULL;
+    char *cursor;
+    char **block_bytes = NULL;
+    uint64_t *block_lens = NULL;
+    uint64_t blocks_len;
+    FILE *bf_file_ptr;
+    bfi_ecode_t ret = BFI_E_OK;
+
+    if (!bindex) {
+        // nothing to store
+        return BFI_E_NO_INDEX;
+    }
+
+    block_bytes = (char **) calloc(bindex->block_cnt + 1, sizeof(char *));
+    block_lens = (uint64_t *) calloc(bindex->block_cnt + 1, sizeof(uint64_t));
+    if (!block_bytes || !block_lens) {
+        ret = BFI_E_MEM;
+        goto cleanup;
+    }
+
+    // Get binary representations of all filters
+    sections[0].length = bf_get_filter_as_bytes(bindex->file_filter,
+                                                &file_bytes);
+    if (sections[0].length == 0) {
+        ret = BFI_E_STO_BYTES;
+        goto cleanup;
+    }
+    blocks_len = sizeof(uint64_t) + bindex->block_cnt * 2 * sizeof(uint64_t);
+    for (uint64_t i = 0; i < bindex->block_cnt; ++i) {
+        block_lens[i] = bf_get_filter_as_bytes(bindex->blocks[i],
+                                               &block_bytes[i]);
+        if (block_lens[i] == 0) {
+            ret = BFI_E_STO_BYTES;
+            goto cleanup;
+        }
+        blocks_len += block_lens[i];
+    }
+
+    // Build blocks section (table first, filters follow contiguously)
+    blocks_bytes = (char *) malloc(blocks_len);
+    if (!blocks_bytes) {
+        ret = BFI_E_MEM;
+        goto cleanup;
+    }
+    cursor = blocks_bytes;
+    memcpy(cursor, &bindex->block_cnt, sizeof(uint64_t));
+    cursor += sizeof(uint64_t);
+    for (uint64_t i = 0; i < bindex->block_cnt; ++i) {
+        memcpy(cursor, &bindex->offsets[i], sizeof(uint64_t));
+        cursor += sizeof(uint64_t);
+        memcpy(cursor, &block_lens[i], sizeof(uint64_t));
+        cursor += sizeof(uint64_t);
+    }
+    for (uint64_t i = 0; i < bindex->block_cnt; ++i) {
+        memcpy(cursor, block_bytes[i], block_lens[i]);
+        cursor += block_lens[i];
+    }
+
+    sections[0].type = BFI_SEC_BLOOM;
+    sections[0].encoding = BFI_ENC_RAW;
+    payloads[0] = file_bytes;
+    sections[1].type = BFI_SEC_BLOCKS;
+    sections[1].encoding = BFI_ENC_RAW;
+    sections[1].length = blocks_len;
+    payloads[1] = blocks_bytes;
+
+	// Open file, mode: write binary
+    bf_file_ptr = fopen(filename, "wb");
+    if (!bf_file_ptr){
+        ret = BFI_E_STO_FILE_ERR;
+        goto cleanup;
+    }
+    ret = bfi_file_write(bf_file_ptr, BFI_ENGINE_STANDARD, 0, sections,
+                         payloads, 2);
+    if (fclose(bf_file_ptr) != 0 && ret == BFI_E_OK) {
+        ret = BFI_E_STO_INDEX;
+    }
+
+cleanup:
+    if (file_bytes) {
+        bf_clear_bytes(bindex->file_filter, &file_bytes);
+    }
+    for (uint64_t i = 0; block_bytes && i < bindex->block_cnt; ++i) {
+        if (block_bytes[i]) {
+            bf_clear_bytes(bindex->blocks[i], &block_bytes[i]);
+        }
+    }
+    free(block_bytes);
+    free(block_lens);
+    free(blocks_bytes);
+
+    return ret;
+}
+
+
+/**
+ * \brief Re-create block filters from BFI_SEC_BLOCKS section payload
+ */
+static bfi_ecode_t bfi_load_blocks(bfi_block_index_t *bindex,
+                    const char *payload, uint64_t payload_len)
+{
+    const char *filter_cursor;
+    uint64_t block_cnt;
+    uint64_t table_len;
+    uint64_t filter_len;
+    unsigned int hash_cnt;
+    unsigned long long int table_size, seed, block_seed, est_item_cnt;
+    double fp_prob;
+    int load_ret;
+    bfi_ecode_t ret;
+
+    if (payload_len < sizeof(uint64_t)) {
+        return BFI_E_LOAD_SECTION;
+    }
+    memcpy(&block_cnt, payload, sizeof(uint64_t));
+    table_len = sizeof(uint64_t) + block_cnt * 2 * sizeof(uint64_t);
+    if (block_cnt > payload_len / (2 * sizeof(uint64_t))
+            || table_len > payload_len) {
+        return BFI_E_LOAD_SECTION;
+    }
+
+    ret = bfi_block_alloc(bindex, block_cnt);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+
+    bf_get_parameters(bindex->file_filter, &hash_cnt, &table_size, &seed,
+                      &est_item_cnt, &fp_prob);
+
+    filter_cursor = payload + table_len;
+    for (uint64_t i = 0; i < block_cnt; ++i) {
+        const char *entry = payload + sizeof(uint64_t)
+                            + i * 2 * sizeof(uint64_t);
+        memcpy(&bindex->offsets[i], entry, sizeof(uint64_t));
+        memcpy(&filter_len, entry + sizeof(uint64_t), sizeof(uint64_t));
+
+        if (filter_len > UINT32_MAX
+                || filter_len > (uint64_t) (payload + payload_len
+                                            - filter_cursor)) {
+            return BFI_E_LOAD_SECTION;
+        }
+
+        bindex->blocks[i] = new_bloom_filter();
+        bindex->block_cnt++;
+        load_ret = bf_load_filter_from_bytes(bindex->blocks[i], filter_cursor,
+                                             (uint32_t) filter_len);
+        if (load_ret != 0) {
+            return load_ret == BFI_E_LOAD_MEM ? BFI_E_LOAD_MEM
+                                              : BFI_E_LOAD_BYTES;
+        }
+        // Hash values of the file filter are probed in every block
+        bf_get_parameters(bindex->blocks[i], &hash_cnt, &table_size,
+                          &block_seed, &est_item_cnt, &fp_prob);
+        if (bf_hash_count(bindex->blocks[i])
+                    != bf_hash_count(bindex->file_filter)
+                || block_seed != seed) {
+            return BFI_E_LOAD_BYTES;
+        }
+        filter_cursor += filter_len;
+    }
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_load_block_index(bfi_block_index_ptr_t *bindex_ptr,
+                    char *filename)
+{
+    bfi_block_index_t *bindex;
+    bfi_file_header_t header;
+    bfi_section_t *sections = NULL;
+    const bfi_section_t *sec;
+    char *payload = NULL;
+    uint64_t payload_len;
+    FILE *bf_file_ptr;
+    int load_ret;
+    bfi_ecode_t ret;
+
+    *bindex_ptr = NULL;
+
+	// Open file, mode: read binary
+    bf_file_ptr = fopen(filename, "rb");
+    if (!bf_file_ptr){
+        return BFI_E_LOAD_FILE_ERR;
+    }
+
+    bindex = (bfi_block_index_t *) calloc(1, sizeof(bfi_block_index_t));
+    if (!bindex) {
+        fclose(bf_file_ptr);
+        return BFI_E_LOAD_MEM;
+    }
+
+    ret = bfi_file_read_toc(bf_file_ptr, &header, &sections);
+    if (ret != BFI_E_OK) {
+        goto cleanup;
+    }
+
+    // File-level filter
+    sec = bfi_file_find_section(sections, header.section_cnt, BFI_SEC_BLOOM);
+    if (!sec) {
+        ret = BFI_E_LOAD_NO_SECTION;
+        goto cleanup;
+    }
+    ret = bfi_file_read_section(bf_file_ptr, sec, &payload, &payload_len);
+    if (ret != BFI_E_OK) {
+        goto cleanup;
+    }
+    if (payload_len > UINT32_MAX) {
+        ret = BFI_E_LOAD_IDX_LEN;
+        goto cleanup;
+    }
+    bindex->file_filter = new_bloom_filter();
+    load_ret = bf_load_filter_from_bytes(bindex->file_filter, payload,
+                                         (uint32_t) payload_len);
+    if (load_ret != 0) {
+        ret = load_ret == BFI_E_LOAD_MEM ? BFI_E_LOAD_MEM : BFI_E_LOAD_BYTES;
+        goto cleanup;
+    }
+    free(payload);
+    payload = NULL;
+
+    // Block filters
+    sec = bfi_file_find_section(sections, header.section_cnt, BFI_SEC_BLOCKS);
+    if (!sec) {
+        ret = BFI_E_LOAD_NO_SECTION;
+        goto cleanup;
+    }
+    ret = bfi_file_read_section(bf_file_ptr, sec, &payload, &payload_len);
+    if (ret != BFI_E_OK) {
+        goto cleanup;
+    }
+    ret = bfi_load_blocks(bindex, payload, payload_len);
+
+cleanup:
+    free(payload);
+    free(sections);
+    fclose(bf_file_ptr);
+
+    if (ret != BFI_E_OK) {
+        bfi_destroy_block_index((bfi_block_index_ptr_t *) &bindex);
+        return ret;
+    }
+
+    *bindex_ptr = (bfi_block_index_ptr_t) bindex;
+
+    return BFI_E_OK;
+}
@@ -0,0 +1,1101 @@
+/**
+ * \file bf_catalog.c
+ * \brief Directory catalogs of indexes
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bf_index_internal.h"
+#include "bf_index_file.h"
+#include "bf_crc.h"
+#include "bf_io.h"
+#include "bloomf_wrapper.h"
+
+/* Catalog file format (host byte order, like index files):
+ * +---------------------------------------------------------------------+
+ * | header (bfi_catalog_header_t)                                       |
+ * | entries (entry_cnt * entry_size bytes, sorted by time)              |
+ * | heap (file names and summaries, summaries are aligned to 8 bytes)   |
+ * +---------------------------------------------------------------------+
+ * Entries have fixed size, so the catalog is searched directly in the
+ * mapped file. Readers accept larger entries (fields appended by future
+ * versions) and ignore the unknown part of them.
+ */
+#define BFI_CATALOG_MAGIC 0x43494642    // "BFIC"
+#define BFI_CATALOG_VERSION 1
+
+// Suffix of index files picked by bfi_catalog_rebuild()
+#define BFI_CATALOG_INDEX_SUFFIX ".bfi"
+
+// Size of a buffer used to compute checksums of index files
+#define BFI_CATALOG_IO_BUFF (1 << 20)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entry_size;
+    uint64_t entry_cnt;
+    uint64_t heap_offset;
+    uint64_t heap_len;
+    uint64_t max_duration;      // Longest time range of an entry
+    uint32_t reserved[2];
+} bfi_catalog_header_t;
+
+typedef struct {
+    uint64_t time_first;
+    uint64_t time_last;
+    uint64_t name_offset;       // Offset of the file name in the heap
+    uint64_t summary_offset;    // Offset of the summary in the heap
+    uint64_t summary_len;       // Length of the summary (0 if there is none)
+    uint64_t file_size;
+    uint64_t item_cnt;
+    uint64_t table_size;
+    uint64_t seed;
+    uint64_t est_item_cnt;
+    double fp_prob;
+    double fill_ratio;
+    uint32_t hash_cnt;
+    uint32_t checksum;
+    uint16_t engine;
+    uint16_t hash;
+    uint32_t name_len;
+    uint32_t flags;             // BFI_CATALOG_F_* flags
+    uint32_t ipv4_min;          // Zone map of the index
+    uint32_t ipv4_max;
+    uint32_t summary_fold;      // Fold factor of the summary (0 if unknown)
+    uint64_t ipv4_octets[BFI_ZONE_IPV4_WORDS];
+    uint64_t ipv6_prefixes[BFI_ZONE_IPV6_WORDS];
+} bfi_catalog_record_t;
+
+// Zone map of an entry is valid
+#define BFI_CATALOG_F_ZONE 0x1
+
+typedef struct {
+    char *map;
+    size_t map_len;
+    char *dir;                  // Directory of the catalog
+    const bfi_catalog_header_t *header;
+    const char *entries;
+    const char *heap;
+} bfi_catalog_t;
+
+// Entry of a catalog being written
+typedef struct {
+    bfi_catalog_record_t rec;
+    char *name;
+    char *summary;
+} bfi_catalog_item_t;
+
+
+/**
+ * \brief Compute size and CRC-32C checksum of a file
+ */
+static bfi_ecode_t bfi_catalog_checksum(char *filename, uint32_t *checksum,
+                    uint64_t *file_size)
+{
+    char *buff;
+    size_t len;
+    FILE *file_ptr;
+
+    *checksum = 0;
+    *file_size = 0;
+
+    buff = (char *) malloc(BFI_CATALOG_IO_BUFF);
+    if (!buff) {
+        return BFI_E_MEM;
+    }
+    file_ptr = fopen(filename, "rb");
+    if (!file_ptr) {
+        free(buff);
+        return BFI_E_LOAD_FILE_ERR;
+    }
+    while ((len = fread(buff, 1, BFI_CATALOG_IO_BUFF, file_ptr)) > 0) {
+        *checksum = bfi_crc32c(*checksum, buff, len);
+        *file_size += len;
+    }
+    if (ferror(file_ptr)) {
+        fclose(file_ptr);
+        free(buff);
+        return BFI_E_LOAD_FILE_ERR;
+    }
+    fclose(file_ptr);
+    free(buff);
+
+    return BFI_E_OK;
+}
+
+
+/**
+ * \brief Fill statistics of an index in memory (family, items, fill ratio)
+ */
+static void bfi_catalog_index_stat(bfi_index_t *index, bfi_stat_t *stat)
+{
+    bfi_index_family((bfi_index_ptr_t) index, &stat->family);
+    stat->item_cnt = bfi_stored_item_cnt((bfi_index_ptr_t) index);
+    if ((index->engine == BFI_ENGINE_STANDARD
+            || index->engine == BFI_ENGINE_REGISTER)
+            && stat->family.table_size) {
+        stat->fill_ratio = (double) bf_count_set_bits(index->bf)
+                           / stat->family.table_size;
+    } else if (index->engine == BFI_ENGINE_QUOTIENT
+            && stat->family.table_size) {
+        // Load factor (table size is the count of slots)
+        stat->fill_ratio = (double) stat->item_cnt / stat->family.table_size;
+    }
+}
+
+
+/**
+ * \brief Fill statistics of an index file just stored or loaded
+ */
+static void bfi_catalog_stored_stat(bfi_index_t *index,
+                    const bfi_stored_t *stored, bfi_stat_t *stat)
+{
+    memset(stat, 0, sizeof(*stat));
+    bfi_catalog_index_stat(index, stat);
+    stat->time_first = stored->time_first;
+    stat->time_last = stored->time_last;
+    stat->file_size = stored->file_size;
+    stat->checksum = stored->checksum;
+    if (stored->zone_map) {
+        stat->zone = index->zone;
+    } else {
+        bfi_zone_reset(&stat->zone, false);
+    }
+    if (stored->summary) {
+        stat->summary_fold = bfi_summary_fold_factor(stored->summary,
+                                                     stored->summary_len);
+    }
+}
+
+
+/**
+ * \brief Size of a file (or 0 if it could not be found)
+ */
+static uint64_t bfi_catalog_file_size(const char *filename)
+{
+    struct stat st;
+
+    return stat(filename, &st) == 0 ? (uint64_t) st.st_size : 0;
+}
+
+
+/**
+ * \brief Load an index and get statistics (and optionally the summary
+ *    payload) of its file
+ *
+ * File is read once, only a file with data behind the sections is read
+ * again to compute its checksum.
+ */
+static bfi_ecode_t bfi_catalog_load(bfi_index_ptr_t *index_ptr,
+                    char *filename, bfi_stat_t *stat, char **summary,
+                    uint64_t *summary_len)
+{
+    bfi_stored_t stored;
+    bfi_ecode_t ret;
+
+    ret = bfi_load_index_stored(index_ptr, filename, &stored);
+    if (ret != BFI_E_OK) {
+        free(stored.summary);
+        return ret;
+    }
+    bfi_catalog_stored_stat((bfi_index_t *) *index_ptr, &stored, stat);
+
+    if (bfi_catalog_file_size(filename) != stat->file_size) {
+        ret = bfi_catalog_checksum(filename, &stat->checksum,
+                                   &stat->file_size);
+    }
+    if (ret == BFI_E_OK && summary) {
+        *summary = stored.summary;
+        *summary_len = stored.summary_len;
+    } else {
+        free(stored.summary);
+    }
+
+    return ret;
+}
+
+
+/**
+ * \brief Get statistics (and optionally the summary payload) of an index file
+ */
+static bfi_ecode_t bfi_catalog_stat(char *filename, bfi_stat_t *stat,
+                    char **summary, uint64_t *summary_len)
+{
+    bfi_index_ptr_t index_ptr = NULL;
+    bfi_ecode_t ret;
+
+    if (summary) {
+        *summary = NULL;
+        *summary_len = 0;
+    }
+
+    ret = bfi_catalog_load(&index_ptr, filename, stat, summary, summary_len);
+    bfi_destroy_index(&index_ptr);
+
+    return ret;
+}
+
+
+bfi_ecode_t bfi_stat_index(char *filename, bfi_stat_t *stat)
+{
+    return bfi_catalog_stat(filename, stat, NULL, NULL);
+}
+
+
+bfi_ecode_t bfi_load_index_stat(bfi_index_ptr_t *index_ptr, char *filename,
+                    bfi_stat_t *stat)
+{
+    bfi_ecode_t ret;
+
+    *index_ptr = NULL;
+    ret = bfi_catalog_load(index_ptr, filename, stat, NULL, NULL);
+    if (ret != BFI_E_OK) {
+        bfi_destroy_index(index_ptr);
+    }
+
+    return ret;
+}
+
+
+/**
+ * \brief Directory of a catalog (newly allocated string)
+ */
+static char *bfi_catalog_dir(const char *catalog)
+{
+    const char *slash = strrchr(catalog, '/');
+
+    if (!slash) {
+        return strdup(".");
+    }
+    if (slash == catalog) {
+        return strdup("/");
+    }
+
+    return strndup(catalog, slash - catalog);
+}
+
+
+/**
+ * \brief Name of an index file stored in a catalog
+ *
+ * Files in the directory tree of the catalog are stored relative to the
+ * catalog directory, other files by their absolute path (see
+ * bfi_catalog_entry_path()).
+ */
+static char *bfi_catalog_entry_name(const char *catalog, const char *filename)
+{
+    char *dir = bfi_catalog_dir(catalog);
+    char *real_dir = NULL;
+    char *real_file = NULL;
+    char *name = NULL;
+    size_t dir_len;
+
+    if (!dir) {
+        return NULL;
+    }
+    real_dir = realpath(dir, NULL);
+    real_file = realpath(filename, NULL);
+    if (!real_dir || !real_file) {
+        goto cleanup;
+    }
+
+    dir_len = strlen(real_dir);
+    if (strncmp(real_file, real_dir, dir_len) == 0
+            && real_file[dir_len] == '/') {
+        name = strdup(real_file + dir_len + 1);
+    } else if (dir_len == 1 && real_dir[0] == '/') {
+        name = strdup(real_file + 1);
+    } else {
+        name = strdup(real_file);
+    }
+
+cleanup:
+    free(dir);
+    free(real_dir);
+    free(real_file);
+
+    return name;
+}
+
+
+/**
+ * \brief Fill catalog record by statistics of an index
+ */
+static void bfi_catalog_record_from_stat(bfi_catalog_record_t *rec,
+                    const bfi_stat_t *stat)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->time_first = stat->time_first;
+    rec->time_last = stat->time_last;
+    rec->file_size = stat->file_size;
+    rec->item_cnt = stat->item_cnt;
+    rec->table_size = stat->family.table_size;
+    rec->seed = stat->family.seed;
+    rec->est_item_cnt = stat->family.est_item_cnt;
+    rec->fp_prob = stat->family.fp_prob;
+    rec->fill_ratio = stat->fill_ratio;
+    rec->hash_cnt = stat->family.hash_cnt;
+    rec->checksum = stat->checksum;
+    rec->engine = (uint16_t) stat->family.engine;
+    rec->hash = (uint16_t) stat->family.hash;
+    rec->summary_fold = stat->summary_fold;
+    if (stat->zone.valid) {
+        rec->flags |= BFI_CATALOG_F_ZONE;
+    }
+    rec->ipv4_min = stat->zone.ipv4_min;
+    rec->ipv4_max = stat->zone.ipv4_max;
+    memcpy(rec->ipv4_octets, stat->zone.ipv4_octets,
+           sizeof(rec->ipv4_octets));
+    memcpy(rec->ipv6_prefixes, stat->zone.ipv6_prefixes,
+           sizeof(rec->ipv6_prefixes));
+}
+
+
+/**
+ * \brief Create catalog item of an index file
+ */
+static bfi_ecode_t bfi_catalog_item(bfi_catalog_item_t *item, char *filename,
+                    char *name)
+{
+    bfi_stat_t stat;
+    uint64_t summary_len;
+    bfi_ecode_t ret;
+
+    memset(item, 0, sizeof(*item));
+    ret = bfi_catalog_stat(filename, &stat, &item->summary, &summary_len);
+    if (ret != BFI_E_OK) {
+        free(item->summary);
+        item->summary = NULL;
+        return ret;
+    }
+    bfi_catalog_record_from_stat(&item->rec, &stat);
+    item->rec.summary_len = summary_len;
+    item->name = name;
+
+    return BFI_E_OK;
+}
+
+
+static void bfi_catalog_free_items(bfi_catalog_item_t *items, uint64_t cnt)
+{
+    for (uint64_t i = 0; i < cnt; ++i) {
+        free(items[i].name);
+        free(items[i].summary);
+    }
+    free(items);
+}
+
+
+static int bfi_catalog_item_cmp(const void *a, const void *b)
+{
+    const bfi_catalog_item_t *x = (const bfi_catalog_item_t *) a;
+    const bfi_catalog_item_t *y = (const bfi_catalog_item_t *) b;
+
+    if (x->rec.time_first != y->rec.time_first) {
+        return x->rec.time_first < y->rec.time_first ? -1 : 1;
+    }
+    if (x->rec.time_last != y->rec.time_last) {
+        return x->rec.time_last < y->rec.time_last ? -1 : 1;
+    }
+
+    return strcmp(x->name, y->name);
+}
+
+
+/**
+ * \brief Write catalog atomically (to a temporary file renamed over it)
+ *
+ * Items are sorted by this function.
+ */
+static bfi_ecode_t bfi_catalog_write(const char *catalog,
+                    bfi_catalog_item_t *items, uint64_t cnt)
+{
+    static const char padding[8] = { 0 };
+    bfi_catalog_header_t header;
+    char *tmp_name;
+    FILE *file_ptr;
+    bool ok = true;
+
+    qsort(items, cnt, sizeof(*items), bfi_catalog_item_cmp);
+
+    memset(&header, 0, sizeof(header));
+    header.magic = BFI_CATALOG_MAGIC;
+    header.version = BFI_CATALOG_VERSION;
+    header.entry_size = sizeof(bfi_catalog_record_t);
+    header.entry_cnt = cnt;
+    header.heap_offset = sizeof(header) + cnt * sizeof(bfi_catalog_record_t);
+    for (uint64_t i = 0; i < cnt; ++i) {
+        bfi_catalog_record_t *rec = &items[i].rec;
+
+        rec->name_len = (uint32_t) strlen(items[i].name);
+        rec->name_offset = header.heap_len;
+        header.heap_len += rec->name_len + 1;
+        if (rec->summary_len) {
+            header.heap_len = (header.heap_len + 7) & ~(uint64_t) 7;
+            rec->summary_offset = header.heap_len;
+            header.heap_len += rec->summary_len;
+        }
+        if (rec->time_last > rec->time_first
+                && rec->time_last - rec->time_first > header.max_duration) {
+            header.max_duration = rec->time_last - rec->time_first;
+        }
+    }
+
+    tmp_name = (char *) malloc(strlen(catalog) + sizeof(".tmp"));
+    if (!tmp_name) {
+        return BFI_E_MEM;
+    }
+    strcpy(tmp_name, catalog);
+    strcat(tmp_name, ".tmp");
+
+    file_ptr = fopen(tmp_name, "wb");
+    if (!file_ptr) {
+        free(tmp_name);
+        return BFI_E_CATALOG;
+    }
+    ok = fwrite(&header, sizeof(header), 1, file_ptr) == 1;
+    for (uint64_t i = 0; ok && i < cnt; ++i) {
+        ok = fwrite(&items[i].rec, sizeof(items[i].rec), 1, file_ptr) == 1;
+    }
+    for (uint64_t i = 0, pos = 0; ok && i < cnt; ++i) {
+        const bfi_catalog_record_t *rec = &items[i].rec;
+
+        ok = fwrite(items[i].name, rec->name_len + 1, 1, file_ptr) == 1;
+        pos += rec->name_len + 1;
+        if (ok && rec->summary_len) {
+            if (rec->summary_offset > pos) {
+                ok = fwrite(padding, rec->summary_offset - pos, 1, file_ptr)
+                     == 1;
+            }
+            ok = ok && fwrite(items[i].summary, rec->summary_len, 1, file_ptr)
+                       == 1;
+            pos = rec->summary_offset + rec->summary_len;
+        }
+    }
+    ok = ok && fflush(file_ptr) == 0 && fsync(fileno(file_ptr)) == 0;
+    ok = fclose(file_ptr) == 0 && ok;
+    ok = ok && rename(tmp_name, catalog) == 0;
+    if (!ok) {
+        unlink(tmp_name);
+    }
+    free(tmp_name);
+
+    return ok ? BFI_E_OK : BFI_E_CATALOG;
+}
+
+
+/**
+ * \brief Lock catalog for update (the lock is released by closing the
+ *    returned descriptor)
+ *
+ * \return Returns file descriptor of the lock file or -1 on error.
+ */
+static int bfi_catalog_lock(const char *catalog)
+{
+    char *lock_name;
+    int fd;
+
+    lock_name = (char *) malloc(strlen(catalog) + sizeof(".lock"));
+    if (!lock_name) {
+        return -1;
+    }
+    strcpy(lock_name, catalog);
+    strcat(lock_name, ".lock");
+
+    fd = open(lock_name, O_RDWR | O_CREAT, 0644);
+    free(lock_name);
+    if (fd < 0) {
+        return -1;
+    }
+    while (flock(fd, LOCK_EX) != 0) {
+        if (errno != EINTR) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    return fd;
+}
+
+
+/**
+ * \brief Get catalog record of an entry
+ */
+static inline const bfi_catalog_record_t *bfi_catalog_record(
+                    const bfi_catalog_t *cat, uint64_t i)
+{
+    return (const bfi_catalog_record_t *) (cat->entries
+                                           + i * cat->header->entry_size);
+}
+
+
+/**
+ * \brief Check that a heap part of an entry is in the catalog
+ */
+static bool bfi_catalog_entry_valid(const bfi_catalog_t *cat,
+                    const bfi_catalog_record_t *rec)
+{
+    uint64_t heap_len = cat->header->heap_len;
+
+    if (rec->name_offset >= heap_len
+            || rec->name_len >= heap_len - rec->name_offset
+            || cat->heap[rec->name_offset + rec->name_len] != '\0') {
+        return false;
+    }
+    if (rec->summary_len && (rec->summary_offset > heap_len
+            || rec->summary_len > heap_len - rec->summary_offset)) {
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * \brief Read all items of an existing catalog (for its update)
+ */
+static bfi_ecode_t bfi_catalog_read_items(char *catalog,
+                    bfi_catalog_item_t **items, uint64_t *cnt)
+{
+    bfi_catalog_ptr_t cat_ptr;
+    bfi_catalog_t *cat;
+    bfi_ecode_t ret;
+
+    *items = NULL;
+    *cnt = 0;
+
+    ret = bfi_catalog_open(&cat_ptr, catalog);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+    cat = (bfi_catalog_t *) cat_ptr;
+
+    // One spare item for an appended entry
+    *items = (bfi_catalog_item_t *) calloc(cat->header->entry_cnt + 1,
+                                           sizeof(bfi_catalog_item_t));
+    if (!*items) {
+        bfi_catalog_close(&cat_ptr);
+        return BFI_E_MEM;
+    }
+    for (uint64_t i = 0; i < cat->header->entry_cnt; ++i) {
+        const bfi_catalog_record_t *rec = bfi_catalog_record(cat, i);
+        bfi_catalog_item_t *item = &(*items)[i];
+
+        if (!bfi_catalog_entry_valid(cat, rec)) {
+            ret = BFI_E_CATALOG;
+            break;
+        }
+        memcpy(&item->rec, rec, sizeof(item->rec));
+        item->name = strdup(cat->heap + rec->name_offset);
+        if (rec->summary_len) {
+            item->summary = (char *) malloc(rec->summary_len);
+            if (item->summary) {
+                memcpy(item->summary, cat->heap + rec->summary_offset,
+                       rec->summary_len);
+            }
+        }
+        ++*cnt;
+        if (!item->name || (rec->summary_len && !item->summary)) {
+            ret = BFI_E_MEM;
+            break;
+        }
+    }
+    bfi_catalog_close(&cat_ptr);
+
+    if (ret != BFI_E_OK) {
+        bfi_catalog_free_items(*items, *cnt);
+        *items = NULL;
+        *cnt = 0;
+    }
+
+    return ret;
+}
+
+
+/**
+ * \brief Add item to a catalog (or replace the entry of the same file)
+ *
+ * Item is freed by this function.
+ */
+static bfi_ecode_t bfi_catalog_append(char *catalog, bfi_catalog_item_t *item)
+{
+    bfi_catalog_item_t *items = NULL;
+    uint64_t cnt = 0;
+    uint64_t i;
+    int lock_fd;
+    bfi_ecode_t ret;
+
+    lock_fd = bfi_catalog_lock(catalog);
+    if (lock_fd < 0) {
+        free(item->name);
+        free(item->summary);
+        return BFI_E_CATALOG;
+    }
+
+    if (access(catalog, F_OK) == 0) {
+        ret = bfi_catalog_read_items(catalog, &items, &cnt);
+    } else {
+        items = (bfi_catalog_item_t *) calloc(1, sizeof(*items));
+        ret = items ? BFI_E_OK : BFI_E_MEM;
+    }
+    if (ret != BFI_E_OK) {
+        free(item->name);
+        free(item->summary);
+        close(lock_fd);
+        return ret;
+    }
+
+    // Replace entry of the same file or append a new one
+    for (i = 0; i < cnt; ++i) {
+        if (strcmp(items[i].name, item->name) == 0) {
+            free(items[i].name);
+            free(items[i].summary);
+            break;
+        }
+    }
+    items[i] = *item;
+    if (i == cnt) {
+        ++cnt;
+    }
+
+    ret = bfi_catalog_write(catalog, items, cnt);
+    close(lock_fd);
+    bfi_catalog_free_items(items, cnt);
+
+    return ret;
+}
+
+
+bfi_ecode_t bfi_catalog_add(char *catalog, char *filename)
+{
+    bfi_catalog_item_t item;
+    char *name;
+    bfi_ecode_t ret;
+
+    name = bfi_catalog_entry_name(catalog, filename);
+    if (!name) {
+        return BFI_E_LOAD_FILE_ERR;
+    }
+    ret = bfi_catalog_item(&item, filename, name);
+    if (ret != BFI_E_OK) {
+        free(name);
+        return ret;
+    }
+
+    return bfi_catalog_append(catalog, &item);
+}
+
+
+bfi_ecode_t bfi_catalog_add_stored(char *catalog, char *filename,
+                    bfi_index_t *index, bfi_stored_t *stored)
+{
+    bfi_catalog_item_t item;
+    bfi_stat_t stat;
+
+    bfi_catalog_stored_stat(index, stored, &stat);
+
+    memset(&item, 0, sizeof(item));
+    item.summary = stored->summary;
+    stored->summary = NULL;
+    item.name = bfi_catalog_entry_name(catalog, filename);
+    if (!item.name) {
+        free(item.summary);
+        return BFI_E_LOAD_FILE_ERR;
+    }
+
+    bfi_catalog_record_from_stat(&item.rec, &stat);
+    item.rec.summary_len = item.summary ? stored->summary_len : 0;
+
+    return bfi_catalog_append(catalog, &item);
+}
+
+
+bfi_ecode_t bfi_catalog_rebuild(char *catalog, uint64_t *entry_cnt)
+{
+    bfi_catalog_item_t *items = NULL;
+    uint64_t cnt = 0;
+    uint64_t alloc_cnt = 0;
+    size_t suffix_len = strlen(BFI_CATALOG_INDEX_SUFFIX);
+    struct dirent *dirent;
+    char *dir;
+    DIR *dir_ptr;
+    int lock_fd;
+    bfi_ecode_t ret = BFI_E_OK;
+
+    if (entry_cnt) {
+        *entry_cnt = 0;
+    }
+
+    dir = bfi_catalog_dir(catalog);
+    if (!dir) {
+        return BFI_E_MEM;
+    }
+    lock_fd = bfi_catalog_lock(catalog);
+    if (lock_fd < 0) {
+        free(dir);
+        return BFI_E_CATALOG;
+    }
+    dir_ptr = opendir(dir);
+    if (!dir_ptr) {
+        close(lock_fd);
+        free(dir);
+        return BFI_E_CATALOG;
+    }
+
+    while ((dirent = readdir(dir_ptr)) != NULL) {
+        size_t name_len = strlen(dirent->d_name);
+        char *path;
+        char *name;
+
+        if (name_len <= suffix_len || strcmp(dirent->d_name + name_len
+                    - suffix_len, BFI_CATALOG_INDEX_SUFFIX) != 0) {
+            continue;
+        }
+        if (cnt == alloc_cnt) {
+            bfi_catalog_item_t *tmp;
+
+            alloc_cnt = alloc_cnt ? 2 * alloc_cnt : 64;
+            tmp = (bfi_catalog_item_t *) realloc(items,
+                                            alloc_cnt * sizeof(*items));
+            if (!tmp) {
+                ret = BFI_E_MEM;
+                break;
+            }
+            items = tmp;
+        }
+
+        path = (char *) malloc(strlen(dir) + name_len + 2);
+        name = strdup(dirent->d_name);
+        if (!path || !name) {
+            free(path);
+            free(name);
+            ret = BFI_E_MEM;
+            break;
+        }
+        sprintf(path, "%s/%s", dir, dirent->d_name);
+        // Files which are not indexes are skipped
+        if (bfi_catalog_item(&items[cnt], path, name) == BFI_E_OK) {
+            ++cnt;
+        } else {
+            free(name);
+        }
+        free(path);
+    }
+    closedir(dir_ptr);
+
+    if (ret == BFI_E_OK) {
+        ret = bfi_catalog_write(catalog, items, cnt);
+    }
+    if (ret == BFI_E_OK && entry_cnt) {
+        *entry_cnt = cnt;
+    }
+    close(lock_fd);
+    bfi_catalog_free_items(items, cnt);
+    free(dir);
+
+    return ret;
+}
+
+
+bfi_ecode_t bfi_catalog_open(bfi_catalog_ptr_t *catalog_ptr, char *catalog)
+{
+    const bfi_catalog_header_t *header;
+    bfi_catalog_t *cat;
+    struct stat st;
+    void *map;
+    int fd;
+
+    *catalog_ptr = NULL;
+
+    fd = open(catalog, O_RDONLY);
+    if (fd < 0) {
+        return BFI_E_LOAD_FILE_ERR;
+    }
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size
+            < sizeof(bfi_catalog_header_t)) {
+        close(fd);
+        return BFI_E_CATALOG;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return BFI_E_CATALOG;
+    }
+    bfi_io_advise_map(map, st.st_size, bfi_get_io_policy());
+
+    // Header and location of entries and heap
+    header = (const bfi_catalog_header_t *) map;
+    if (header->magic != BFI_CATALOG_MAGIC
+            || header->version != BFI_CATALOG_VERSION
+            || header->entry_size < sizeof(bfi_catalog_record_t)
+            || header->entry_size % 8 != 0
+            || header->entry_cnt > (st.st_size - sizeof(*header))
+                                   / header->entry_size
+            || header->heap_offset < sizeof(*header)
+                                     + header->entry_cnt * header->entry_size
+            || header->heap_offset > (uint64_t) st.st_size
+            || header->heap_len > st.st_size - header->heap_offset) {
+        munmap(map, st.st_size);
+        return BFI_E_CATALOG;
+    }
+
+    cat = (bfi_catalog_t *) malloc(sizeof(bfi_catalog_t));
+    if (cat) {
+        cat->dir = bfi_catalog_dir(catalog);
+    }
+    if (!cat || !cat->dir) {
+        free(cat);
+        munmap(map, st.st_size);
+        return BFI_E_MEM;
+    }
+    cat->map = (char *) map;
+    cat->map_len = st.st_size;
+    cat->header = header;
+    cat->entries = cat->map + sizeof(*header);
+    cat->heap = cat->map + header->heap_offset;
+    *catalog_ptr = (bfi_catalog_ptr_t) cat;
+
+    return BFI_E_OK;
+}
+
+
+void bfi_catalog_close(bfi_catalog_ptr_t *catalog_ptr)
+{
+    bfi_catalog_t *cat;
+
+    if (!catalog_ptr || !*catalog_ptr) {
+        return;
+    }
+
+    cat = (bfi_catalog_t *) *catalog_ptr;
+    munmap(cat->map, cat->map_len);
+    free(cat->dir);
+    free(cat);
+    *catalog_ptr = NULL;
+}
+
+
+uint64_t bfi_catalog_entry_cnt(bfi_catalog_ptr_t catalog_ptr)
+{
+    bfi_catalog_t *cat = (bfi_catalog_t *) catalog_ptr;
+
+    if (!cat) {
+        return 0;
+    }
+
+    return cat->header->entry_cnt;
+}
+
+
+bfi_ecode_t bfi_catalog_get(bfi_catalog_ptr_t catalog_ptr, uint64_t i,
+                    bfi_catalog_entry_t *entry)
+{
+    bfi_catalog_t *cat = (bfi_catalog_t *) catalog_ptr;
+    const bfi_catalog_record_t *rec;
+
+    if (!cat || i >= cat->header->entry_cnt) {
+        return BFI_E_CATALOG;
+    }
+    rec = bfi_catalog_record(cat, i);
+    if (!bfi_catalog_entry_valid(cat, rec)) {
+        return BFI_E_CATALOG;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    entry->filename = cat->heap + rec->name_offset;
+    entry->has_summary = rec->summary_len != 0;
+    entry->stat.family.engine = (bfi_engine_t) rec->engine;
+    entry->stat.family.hash = (bfi_hash_t) rec->hash;
+    entry->stat.family.seed = rec->seed;
+    entry->stat.family.table_size = rec->table_size;
+    entry->stat.family.hash_cnt = rec->hash_cnt;
+    entry->stat.family.est_item_cnt = rec->est_item_cnt;
+    entry->stat.family.fp_prob = rec->fp_prob;
+    entry->stat.item_cnt = rec->item_cnt;
+    entry->stat.fill_ratio = rec->fill_ratio;
+    entry->stat.time_first = rec->time_first;
+    entry->stat.time_last = rec->time_last;
+    entry->stat.file_size = rec->file_size;
+    entry->stat.checksum = rec->checksum;
+    entry->stat.summary_fold = rec->summary_fold;
+    entry->stat.zone.valid = (rec->flags & BFI_CATALOG_F_ZONE) != 0;
+    entry->stat.zone.ipv4_min = rec->ipv4_min;
+    entry->stat.zone.ipv4_max = rec->ipv4_max;
+    memcpy(entry->stat.zone.ipv4_octets, rec->ipv4_octets,
+           sizeof(rec->ipv4_octets));
+    memcpy(entry->stat.zone.ipv6_prefixes, rec->ipv6_prefixes,
+           sizeof(rec->ipv6_prefixes));
+
+    return BFI_E_OK;
+}
+
+
+char *bfi_catalog_entry_path(bfi_catalog_ptr_t catalog_ptr,
+                    const bfi_catalog_entry_t *entry)
+{
+    bfi_catalog_t *cat = (bfi_catalog_t *) catalog_ptr;
+    char *path;
+
+    if (!cat || !entry->filename) {
+        return NULL;
+    }
+    if (entry->filename[0] == '/') {
+        return strdup(entry->filename);
+    }
+    path = (char *) malloc(strlen(cat->dir) + strlen(entry->filename) + 2);
+    if (path) {
+        sprintf(path, "%s/%s", cat->dir, entry->filename);
+    }
+
+    return path;
+}
+
+
+uint64_t bfi_catalog_unknown_time_cnt(bfi_catalog_ptr_t catalog_ptr)
+{
+    bfi_catalog_t *cat = (bfi_catalog_t *) catalog_ptr;
+    uint64_t lo = 0;
+    uint64_t hi;
+
+    if (!cat) {
+        return 0;
+    }
+
+    // Entries of unknown time range (0 and 0) are sorted before all others
+    hi = cat->header->entry_cnt;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        const bfi_catalog_record_t *rec = bfi_catalog_record(cat, mid);
+
+        if (rec->time_first == 0 && rec->time_last == 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+
+/**
+ * \brief Index of the first entry which starts at or after a time
+ */
+static uint64_t bfi_catalog_lower_bound(const bfi_catalog_t *cat,
+                    uint64_t time)
+{
+    uint64_t lo = 0;
+    uint64_t hi = cat->header->entry_cnt;
+
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+
+        if (bfi_catalog_record(cat, mid)->time_first < time) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+
+void bfi_catalog_find_time(bfi_catalog_ptr_t catalog_ptr, uint64_t time_begin,
+                    uint64_t time_end, uint64_t *first, uint64_t *end)
+{
+    bfi_catalog_t *cat = (bfi_catalog_t *) catalog_ptr;
+    uint64_t max_duration;
+    uint64_t unknown_cnt;
+
+    *first = 0;
+    *end = 0;
+    if (!cat || time_begin > time_end) {
+        return;
+    }
+
+    // An entry overlapping the range could start up to max_duration before it
+    max_duration = cat->header->max_duration;
+    *first = bfi_catalog_lower_bound(cat, time_begin > max_duration
+                                          ? time_begin - max_duration : 0);
+    *end = time_end == UINT64_MAX ? cat->header->entry_cnt
+                                  : bfi_catalog_lower_bound(cat, time_end + 1);
+
+    // Entries of unknown time range are reported separately (see
+    // bfi_catalog_unknown_time_cnt())
+    unknown_cnt = bfi_catalog_unknown_time_cnt(catalog_ptr);
+    if (*first < unknown_cnt) {
+        *first = unknown_cnt;
+    }
+    if (*end < *first) {
+        *end = *first;
+    }
+}
+
+
+bfi_ecode_t bfi_catalog_load_summary(bfi_catalog_ptr_t catalog_ptr,
+                    uint64_t i, bfi_summary_ptr_t *summary_ptr)
+{
+    bfi_catalog_t *cat = (bfi_catalog_t *) catalog_ptr;
+    const bfi_catalog_record_t *rec;
+
+    *summary_ptr = NULL;
+    if (!cat || i >= cat->header->entry_cnt) {
+        return BFI_E_CATALOG;
+    }
+    rec = bfi_catalog_record(cat, i);
+    if (!bfi_catalog_entry_valid(cat, rec)) {
+        return BFI_E_CATALOG;
+    }
+    if (rec->summary_len == 0) {
+        return BFI_E_LOAD_NO_SECTION;
+    }
+
+    return bfi_summary_from_bytes(cat->heap + rec->summary_offset,
+                                  rec->summary_len,
+                                  (bloom_filter_h **) summary_ptr);
+}
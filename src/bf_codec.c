@@ -0,0 +1,810 @@
+/**
+ * \file bf_codec.c
+ * \brief Chunked archival encoding of index sections
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "bf_codec.h"
+#include "bf_parallel.h"
+
+// Zero runs shorter than this are kept in literals (ZRLE)
+#define BFI_ZRLE_MIN_RUN 3
+
+// Maximal Rice parameter
+#define BFI_RICE_MAX_K 30
+
+#define BFI_RICE_HDR_LEN (sizeof(uint32_t) + sizeof(uint8_t))
+
+// Minimal count of chunks encoded or decoded by one thread
+#define BFI_CODEC_PARALLEL_CHUNKS 16
+
+
+static inline uint64_t bfi_load_le64(const uint8_t *p)
+{
+    uint64_t w;
+
+    memcpy(&w, p, sizeof(w));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    return w;
+}
+
+
+/**
+ * \brief Bit writer (least significant bit first)
+ */
+typedef struct {
+    uint8_t *out;
+    uint32_t pos;
+    uint32_t max;
+    uint64_t acc;
+    unsigned int bits;
+} bfi_bitwriter_t;
+
+// Put up to 32 bits, returns false if the output is full
+static inline bool bfi_bw_put(bfi_bitwriter_t *bw, uint32_t value,
+                    unsigned int cnt)
+{
+    bw->acc |= (uint64_t) value << bw->bits;
+    bw->bits += cnt;
+    while (bw->bits >= 8) {
+        if (bw->pos == bw->max) {
+            return false;
+        }
+        bw->out[bw->pos++] = (uint8_t) bw->acc;
+        bw->acc >>= 8;
+        bw->bits -= 8;
+    }
+
+    return true;
+}
+
+static inline bool bfi_bw_flush(bfi_bitwriter_t *bw)
+{
+    if (bw->bits) {
+        if (bw->pos == bw->max) {
+            return false;
+        }
+        bw->out[bw->pos++] = (uint8_t) bw->acc;
+        bw->acc = 0;
+        bw->bits = 0;
+    }
+
+    return true;
+}
+
+
+/**
+ * \brief Bit reader (least significant bit first)
+ *
+ * Bits of buf above avail are always zero, so the unary code is read by
+ * a single count trailing zeros instruction.
+ */
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    uint64_t buf;
+    unsigned int avail;
+} bfi_bitreader_t;
+
+static inline void bfi_br_refill(bfi_bitreader_t *br)
+{
+    if (br->end - br->p >= 8) {
+        // Word at a time, whole bytes which fit into buf are consumed
+        unsigned int avail = br->avail | 56;
+
+        br->buf |= bfi_load_le64(br->p) << br->avail;
+        br->buf &= ((uint64_t) 1 << avail) - 1;
+        br->p += (avail - br->avail) >> 3;
+        br->avail = avail;
+    } else {
+        while (br->avail <= 56 && br->p < br->end) {
+            br->buf |= (uint64_t) *br->p++ << br->avail;
+            br->avail += 8;
+        }
+    }
+}
+
+static inline void bfi_br_consume(bfi_bitreader_t *br, unsigned int cnt)
+{
+    br->buf = cnt >= 64 ? 0 : br->buf >> cnt;
+    br->avail -= cnt;
+}
+
+// Read unary coded value, returns false at the end of data
+static inline bool bfi_br_unary(bfi_bitreader_t *br, uint64_t limit,
+                    uint64_t *value)
+{
+    uint64_t q = 0;
+
+    for (;;) {
+        if (br->avail <= 56) {
+            bfi_br_refill(br);
+        }
+        if (br->buf) {
+            unsigned int t = (unsigned int) __builtin_ctzll(br->buf);
+
+            bfi_br_consume(br, t + 1);
+            *value = q + t;
+            return true;
+        }
+        if (br->avail == 0) {
+            return false;
+        }
+        q += br->avail;
+        br->buf = 0;
+        br->avail = 0;
+        if (q > limit) {
+            return false;
+        }
+    }
+}
+
+static inline bool bfi_br_bits(bfi_bitreader_t *br, unsigned int cnt,
+                    uint32_t *value)
+{
+    if (br->avail < cnt) {
+        bfi_br_refill(br);
+        if (br->avail < cnt) {
+            return false;
+        }
+    }
+    *value = (uint32_t) (br->buf & (((uint64_t) 1 << cnt) - 1));
+    bfi_br_consume(br, cnt);
+
+    return true;
+}
+
+
+static inline uint32_t bfi_varint_put(uint8_t *out, uint32_t value)
+{
+    uint32_t len = 0;
+
+    while (value >= 0x80) {
+        out[len++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    out[len++] = (uint8_t) value;
+
+    return len;
+}
+
+static inline bool bfi_varint_get(const uint8_t **p, const uint8_t *end,
+                    uint32_t *value)
+{
+    uint32_t v = 0;
+
+    for (unsigned int shift = 0; shift < 35; shift += 7) {
+        if (*p == end) {
+            return false;
+        }
+        v |= (uint32_t) (**p & 0x7F) << shift;
+        if (!(*(*p)++ & 0x80)) {
+            *value = v;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * \brief Encode chunk by ZRLE codec
+ *
+ * \return Returns encoded length or UINT32_MAX if it exceeds max.
+ */
+static uint32_t bfi_zrle_encode(const uint8_t *in, uint32_t n, uint8_t *out,
+                    uint32_t max)
+{
+    uint32_t i = 0;
+    uint32_t o = 0;
+
+    while (i < n) {
+        uint32_t lit_begin = i;
+        uint32_t lit_end;
+
+        while (lit_begin < n && in[lit_begin] == 0) {
+            lit_begin++;
+        }
+
+        // Literal ends by a long enough zero run (or by the end of chunk)
+        lit_end = lit_begin;
+        while (lit_end < n) {
+            if (in[lit_end]) {
+                lit_end++;
+                continue;
+            }
+            uint32_t run_end = lit_end;
+            while (run_end < n && in[run_end] == 0) {
+                run_end++;
+            }
+            if (run_end - lit_end >= BFI_ZRLE_MIN_RUN || run_end == n) {
+                break;
+            }
+            lit_end = run_end;
+        }
+
+        // Two varints take at most 10 bytes
+        if ((uint64_t) o + 10 + (lit_end - lit_begin) > max) {
+            return UINT32_MAX;
+        }
+        o += bfi_varint_put(out + o, lit_begin - i);
+        o += bfi_varint_put(out + o, lit_end - lit_begin);
+        memcpy(out + o, in + lit_begin, lit_end - lit_begin);
+        o += lit_end - lit_begin;
+        i = lit_end;
+    }
+
+    return o;
+}
+
+
+static bfi_ecode_t bfi_zrle_decode(const uint8_t *p, const uint8_t *end,
+                    uint8_t *out, uint32_t n)
+{
+    uint32_t i = 0;
+
+    while (i < n) {
+        uint32_t run;
+        uint32_t lit;
+
+        if (!bfi_varint_get(&p, end, &run) || !bfi_varint_get(&p, end, &lit)
+                || (uint64_t) run + lit == 0
+                || (uint64_t) i + run + lit > n
+                || (uint64_t) (end - p) < lit) {
+            return BFI_E_LOAD_SECTION;
+        }
+        memset(out + i, 0, run);
+        i += run;
+        memcpy(out + i, p, lit);
+        i += lit;
+        p += lit;
+    }
+
+    return p == end ? BFI_E_OK : BFI_E_LOAD_SECTION;
+}
+
+
+/**
+ * \brief Encode chunk by Rice coding of gaps between set bits
+ *
+ * \return Returns encoded length or UINT32_MAX if it exceeds max.
+ */
+static uint32_t bfi_rice_encode(const uint8_t *in, uint32_t n, uint8_t *out,
+                    uint32_t max)
+{
+    bfi_bitwriter_t bw;
+    uint64_t bit_cnt = (uint64_t) n * 8;
+    uint64_t set_cnt = 0;
+    uint64_t prev = UINT64_MAX;         // Position of the previous set bit
+    uint32_t i;
+    unsigned int k = 0;
+    uint32_t u32;
+
+    if (max < BFI_RICE_HDR_LEN) {
+        return UINT32_MAX;
+    }
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        set_cnt += __builtin_popcountll(bfi_load_le64(in + i));
+    }
+    for (; i < n; ++i) {
+        set_cnt += __builtin_popcount(in[i]);
+    }
+    if (set_cnt == 0) {
+        return UINT32_MAX;
+    }
+
+    // Gaps are nearly geometrically distributed, optimal parameter is about
+    // log2(ln(2) * mean gap)
+    uint64_t target = (uint64_t) (0.6931 * bit_cnt / set_cnt);
+    while (k < BFI_RICE_MAX_K && ((uint64_t) 2 << k) <= target) {
+        k++;
+    }
+
+    u32 = (uint32_t) set_cnt;
+    memcpy(out, &u32, sizeof(u32));
+    out[sizeof(u32)] = (uint8_t) k;
+
+    bw.out = out;
+    bw.pos = BFI_RICE_HDR_LEN;
+    bw.max = max;
+    bw.acc = 0;
+    bw.bits = 0;
+
+    for (i = 0; i < n; i += 8) {
+        uint64_t word;
+
+        if (i + 8 <= n) {
+            word = bfi_load_le64(in + i);
+        } else {
+            word = 0;
+            for (uint32_t j = i; j < n; ++j) {
+                word |= (uint64_t) in[j] << ((j - i) * 8);
+            }
+        }
+
+        while (word) {
+            uint64_t pos = (uint64_t) i * 8 + __builtin_ctzll(word);
+            uint64_t gap = pos - prev - 1;
+            uint64_t q = gap >> k;
+
+            prev = pos;
+            word &= word - 1;
+
+            for (; q >= 32; q -= 32) {
+                if (!bfi_bw_put(&bw, 0, 32)) {
+                    return UINT32_MAX;
+                }
+            }
+            if (!bfi_bw_put(&bw, (uint32_t) 1 << q, (unsigned int) q + 1)
+                    || !bfi_bw_put(&bw, (uint32_t) (gap & ((1U << k) - 1)),
+                                   k)) {
+                return UINT32_MAX;
+            }
+        }
+    }
+    if (!bfi_bw_flush(&bw)) {
+        return UINT32_MAX;
+    }
+
+    return bw.pos;
+}
+
+
+static bfi_ecode_t bfi_rice_decode(const uint8_t *p, const uint8_t *end,
+                    uint8_t *out, uint32_t n)
+{
+    bfi_bitreader_t br;
+    uint64_t bit_cnt = (uint64_t) n * 8;
+    uint64_t pos = UINT64_MAX;
+    uint32_t set_cnt;
+    unsigned int k;
+
+    if (end - p < (ptrdiff_t) BFI_RICE_HDR_LEN) {
+        return BFI_E_LOAD_SECTION;
+    }
+    memcpy(&set_cnt, p, sizeof(set_cnt));
+    k = p[sizeof(set_cnt)];
+    if (k > BFI_RICE_MAX_K || set_cnt > bit_cnt) {
+        return BFI_E_LOAD_SECTION;
+    }
+
+    br.p = p + BFI_RICE_HDR_LEN;
+    br.end = end;
+    br.buf = 0;
+    br.avail = 0;
+
+    memset(out, 0, n);
+    for (uint32_t i = 0; i < set_cnt; ++i) {
+        uint64_t q;
+        uint32_t r;
+
+        /* Fast path - whole code of the gap is in the buffer. State is kept
+         * in local variables and the buffer is refilled unconditionally
+         * (cheaper than a mispredicted branch). Bits above avail are not
+         * cleared here, they are the following bits of the stream anyway.
+         */
+        if (br.end - br.p >= 8) {
+            uint64_t buf = br.buf | (bfi_load_le64(br.p) << br.avail);
+            unsigned int avail = br.avail | 56;
+            unsigned int t = (unsigned int) __builtin_ctzll(buf | ((uint64_t) 1 << 63));
+
+            if (t + 1 + k <= avail) {
+                br.p += (avail - br.avail) >> 3;
+                r = (uint32_t) (buf >> (t + 1)) & ((1U << k) - 1);
+                br.buf = buf >> (t + 1 + k);
+                br.avail = avail - (t + 1 + k);
+                pos += (((uint64_t) t << k) | r) + 1;
+                if (pos >= bit_cnt) {
+                    return BFI_E_LOAD_SECTION;
+                }
+                out[pos >> 3] |= (uint8_t) (1 << (pos & 7));
+                continue;
+            }
+            br.buf &= ((uint64_t) 1 << br.avail) - 1;
+        }
+
+        if (!bfi_br_unary(&br, bit_cnt >> k, &q) || !bfi_br_bits(&br, k, &r)) {
+            return BFI_E_LOAD_SECTION;
+        }
+        pos += ((q << k) | r) + 1;
+        if (pos >= bit_cnt) {
+            return BFI_E_LOAD_SECTION;
+        }
+        out[pos >> 3] |= (uint8_t) (1 << (pos & 7));
+    }
+
+    return BFI_E_OK;
+}
+
+
+/**
+ * \brief Encode single chunk by the codec giving the shortest output
+ *
+ * \param[out] out Buffer for the encoded chunk (n bytes)
+ * \param[in] scratch Buffer of 2 * n bytes
+ */
+static void bfi_codec_encode_chunk(const uint8_t *in, uint32_t n,
+                    bfi_chunk_t *chunk, char *out, uint8_t *scratch)
+{
+    uint32_t rice_len;
+    uint32_t zrle_len;
+
+    if (in[0] == 0 && memcmp(in, in + 1, n - 1) == 0) {
+        chunk->codec = BFI_CODEC_ZERO;
+        chunk->length = 0;
+        return;
+    }
+
+    // Codec giving the shortest output, raw if nothing saves at least
+    // 1/16 of the chunk (raw chunk is decoded much faster)
+    rice_len = bfi_rice_encode(in, n, scratch, n - n / 16 - 1);
+    zrle_len = bfi_zrle_encode(in, n, scratch + n, n - n / 16 - 1);
+    if (rice_len <= zrle_len && rice_len != UINT32_MAX) {
+        chunk->codec = BFI_CODEC_RICE;
+        chunk->length = rice_len;
+        memcpy(out, scratch, rice_len);
+    } else if (zrle_len != UINT32_MAX) {
+        chunk->codec = BFI_CODEC_ZRLE;
+        chunk->length = zrle_len;
+        memcpy(out, scratch + n, zrle_len);
+    } else {
+        chunk->codec = BFI_CODEC_RAW;
+        chunk->length = n;
+        memcpy(out, in, n);
+    }
+}
+
+
+typedef struct {
+    const char *head;           // Payload given by two parts
+    uint64_t head_len;
+    const char *body;
+    bfi_chunk_table_t *table;
+    char *encoded;              // Chunk c is encoded at its raw offset
+    uint64_t data_offset;       // behind data_offset
+    bfi_ecode_t ret;
+} bfi_codec_encode_ctx_t;
+
+
+static void bfi_codec_encode_worker(void *arg, uint64_t first, uint64_t end)
+{
+    bfi_codec_encode_ctx_t *ctx = (bfi_codec_encode_ctx_t *) arg;
+    uint32_t chunk_size = ctx->table->chunk_size;
+    uint8_t *scratch;
+
+    // Scratch for codecs and for a chunk spanning both parts of the payload
+    scratch = (uint8_t *) malloc(3 * (uint64_t) chunk_size);
+    if (!scratch) {
+        bfi_parallel_error(&ctx->ret, BFI_E_MEM);
+        return;
+    }
+
+    for (uint64_t c = first; c < end; ++c) {
+        uint64_t start = c * chunk_size;
+        uint32_t n = bfi_codec_chunk_raw_len(ctx->table, (uint32_t) c);
+        const uint8_t *in;
+
+        if (start >= ctx->head_len) {
+            in = (const uint8_t *) ctx->body + (start - ctx->head_len);
+        } else if (start + n <= ctx->head_len) {
+            in = (const uint8_t *) ctx->head + start;
+        } else {
+            uint64_t in_head = ctx->head_len - start;
+
+            memcpy(scratch + 2 * (uint64_t) chunk_size, ctx->head + start,
+                   in_head);
+            memcpy(scratch + 2 * (uint64_t) chunk_size + in_head, ctx->body,
+                   n - in_head);
+            in = scratch + 2 * (uint64_t) chunk_size;
+        }
+        bfi_codec_encode_chunk(in, n, &ctx->table->chunks[c],
+                               ctx->encoded + ctx->data_offset + start,
+                               scratch);
+    }
+
+    free(scratch);
+}
+
+
+uint64_t bfi_codec_encode_parts(const char *head, uint64_t head_len,
+                    const char *body, uint64_t body_len, uint32_t chunk_size,
+                    char **encoded)
+{
+    bfi_codec_encode_ctx_t ctx;
+    bfi_chunk_table_t table;
+    uint64_t raw_len = head_len + body_len;
+    uint64_t table_len;
+    uint64_t o;
+
+    *encoded = NULL;
+
+    if (chunk_size == 0) {
+        chunk_size = BFI_CODEC_CHUNK_SIZE;
+    } else if (chunk_size < BFI_CODEC_CHUNK_MIN) {
+        chunk_size = BFI_CODEC_CHUNK_MIN;
+    } else if (chunk_size > BFI_CODEC_CHUNK_MAX) {
+        chunk_size = BFI_CODEC_CHUNK_MAX;
+    }
+    if ((raw_len + chunk_size - 1) / chunk_size > UINT32_MAX) {
+        return 0;
+    }
+
+    table.raw_len = raw_len;
+    table.chunk_size = chunk_size;
+    table.chunk_cnt = (uint32_t) ((raw_len + chunk_size - 1) / chunk_size);
+    table_len = BFI_CODEC_HDR_LEN + table.chunk_cnt * sizeof(bfi_chunk_t);
+
+    // Encoded chunk is never longer than the raw one
+    *encoded = (char *) malloc(table_len + raw_len);
+    table.chunks = (bfi_chunk_t *) malloc(table.chunk_cnt
+                                          * sizeof(bfi_chunk_t) + 1);
+    if (!*encoded || !table.chunks) {
+        free(*encoded);
+        *encoded = NULL;
+        free(table.chunks);
+        return 0;
+    }
+
+    // Chunks are encoded in parallel (every one at its raw offset) ...
+    ctx.head = head;
+    ctx.head_len = head_len;
+    ctx.body = body;
+    ctx.table = &table;
+    ctx.encoded = *encoded;
+    ctx.data_offset = table_len;
+    ctx.ret = BFI_E_OK;
+    bfi_parallel_for(table.chunk_cnt, BFI_CODEC_PARALLEL_CHUNKS,
+                     bfi_codec_encode_worker, &ctx);
+    if (ctx.ret != BFI_E_OK) {
+        free(*encoded);
+        *encoded = NULL;
+        free(table.chunks);
+        return 0;
+    }
+
+    // ... and then moved behind each other
+    o = table_len;
+    for (uint32_t c = 0; c < table.chunk_cnt; ++c) {
+        bfi_chunk_t *chunk = &table.chunks[c];
+        uint64_t at = table_len + (uint64_t) c * chunk_size;
+
+        if (chunk->length && at != o) {
+            memmove(*encoded + o, *encoded + at, chunk->length);
+        }
+        chunk->offset = o;
+        o += chunk->length;
+    }
+
+    memcpy(*encoded, &table.raw_len, sizeof(uint64_t));
+    memcpy(*encoded + sizeof(uint64_t), &table.chunk_size, sizeof(uint32_t));
+    memcpy(*encoded + sizeof(uint64_t) + sizeof(uint32_t), &table.chunk_cnt,
+           sizeof(uint32_t));
+    memcpy(*encoded + BFI_CODEC_HDR_LEN, table.chunks,
+           table.chunk_cnt * sizeof(bfi_chunk_t));
+
+    free(table.chunks);
+
+    return o;
+}
+
+
+uint64_t bfi_codec_encode(const char *raw, uint64_t raw_len,
+                    uint32_t chunk_size, char **encoded)
+{
+    return bfi_codec_encode_parts(raw, raw_len, NULL, 0, chunk_size, encoded);
+}
+
+
+uint64_t bfi_codec_table_len(const char *buff)
+{
+    uint32_t chunk_cnt;
+
+    memcpy(&chunk_cnt, buff + sizeof(uint64_t) + sizeof(uint32_t),
+           sizeof(chunk_cnt));
+
+    return BFI_CODEC_HDR_LEN + (uint64_t) chunk_cnt * sizeof(bfi_chunk_t);
+}
+
+
+bfi_ecode_t bfi_codec_read_table(const char *buff, uint64_t len,
+                    bfi_chunk_table_t *table)
+{
+    uint64_t table_len;
+
+    table->chunks = NULL;
+    if (len < BFI_CODEC_HDR_LEN) {
+        return BFI_E_LOAD_SECTION;
+    }
+
+    memcpy(&table->raw_len, buff, sizeof(uint64_t));
+    memcpy(&table->chunk_size, buff + sizeof(uint64_t), sizeof(uint32_t));
+    memcpy(&table->chunk_cnt, buff + sizeof(uint64_t) + sizeof(uint32_t),
+           sizeof(uint32_t));
+    table_len = bfi_codec_table_len(buff);
+    // Chunks cover the raw payload, the last one partially (compared
+    // without overflow of a corrupted raw_len)
+    if (table->chunk_size < BFI_CODEC_CHUNK_MIN
+            || table->chunk_size > BFI_CODEC_CHUNK_MAX
+            || table->chunk_cnt == 0
+            || table->raw_len > (uint64_t) table->chunk_cnt
+                                * table->chunk_size
+            || table->raw_len <= (uint64_t) (table->chunk_cnt - 1)
+                                 * table->chunk_size
+            || table_len > len) {
+        return BFI_E_LOAD_SECTION;
+    }
+
+    table->chunks = (bfi_chunk_t *) malloc(table->chunk_cnt
+                                           * sizeof(bfi_chunk_t) + 1);
+    if (!table->chunks) {
+        return BFI_E_LOAD_MEM;
+    }
+    memcpy(table->chunks, buff + BFI_CODEC_HDR_LEN,
+           table->chunk_cnt * sizeof(bfi_chunk_t));
+
+    for (uint32_t c = 0; c < table->chunk_cnt; ++c) {
+        const bfi_chunk_t *chunk = &table->chunks[c];
+
+        if (chunk->codec > BFI_CODEC_RICE || chunk->offset < table_len
+                || chunk->offset > len || chunk->length > len - chunk->offset
+                || chunk->length > bfi_codec_chunk_raw_len(table, c)
+                || (chunk->codec == BFI_CODEC_RAW
+                    && chunk->length != bfi_codec_chunk_raw_len(table, c))) {
+            bfi_codec_free_table(table);
+            return BFI_E_LOAD_SECTION;
+        }
+    }
+
+    return BFI_E_OK;
+}
+
+
+void bfi_codec_free_table(bfi_chunk_table_t *table)
+{
+    free(table->chunks);
+    table->chunks = NULL;
+}
+
+
+uint32_t bfi_codec_chunk_raw_len(const bfi_chunk_table_t *table,
+                    uint32_t chunk)
+{
+    uint64_t begin = (uint64_t) chunk * table->chunk_size;
+
+    if (table->raw_len - begin < table->chunk_size) {
+        return (uint32_t) (table->raw_len - begin);
+    }
+
+    return table->chunk_size;
+}
+
+
+bfi_ecode_t bfi_codec_decode_chunk(const bfi_chunk_t *chunk, const char *data,
+                    char *raw, uint32_t raw_len)
+{
+    const uint8_t *p = (const uint8_t *) data;
+
+    switch (chunk->codec) {
+    case BFI_CODEC_RAW:
+        if (chunk->length != raw_len) {
+            return BFI_E_LOAD_SECTION;
+        }
+        memcpy(raw, data, raw_len);
+        return BFI_E_OK;
+    case BFI_CODEC_ZERO:
+        memset(raw, 0, raw_len);
+        return BFI_E_OK;
+    case BFI_CODEC_ZRLE:
+        return bfi_zrle_decode(p, p + chunk->length, (uint8_t *) raw, raw_len);
+    case BFI_CODEC_RICE:
+        return bfi_rice_decode(p, p + chunk->length, (uint8_t *) raw, raw_len);
+    default:
+        return BFI_E_LOAD_SECTION;
+    }
+}
+
+
+typedef struct {
+    const char *buff;
+    const bfi_chunk_table_t *table;
+    char *raw;
+    bfi_ecode_t ret;
+} bfi_codec_decode_ctx_t;
+
+
+static void bfi_codec_decode_worker(void *arg, uint64_t first, uint64_t end)
+{
+    bfi_codec_decode_ctx_t *ctx = (bfi_codec_decode_ctx_t *) arg;
+    const bfi_chunk_table_t *table = ctx->table;
+
+    for (uint64_t c = first; c < end && ctx->ret == BFI_E_OK; ++c) {
+        bfi_ecode_t ret;
+
+        ret = bfi_codec_decode_chunk(&table->chunks[c],
+                                     ctx->buff + table->chunks[c].offset,
+                                     ctx->raw + c * table->chunk_size,
+                                     bfi_codec_chunk_raw_len(table,
+                                                             (uint32_t) c));
+        if (ret != BFI_E_OK) {
+            bfi_parallel_error(&ctx->ret, ret);
+        }
+    }
+}
+
+
+bfi_ecode_t bfi_codec_decode(const char *buff, uint64_t len, char **raw,
+                    uint64_t *raw_len)
+{
+    bfi_codec_decode_ctx_t ctx;
+    bfi_chunk_table_t table;
+    bfi_ecode_t ret;
+
+    *raw = NULL;
+
+    ret = bfi_codec_read_table(buff, len, &table);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+
+    *raw = (char *) malloc(table.raw_len + 1);
+    if (!*raw) {
+        bfi_codec_free_table(&table);
+        return BFI_E_LOAD_MEM;
+    }
+    ctx.buff = buff;
+    ctx.table = &table;
+    ctx.raw = *raw;
+    ctx.ret = BFI_E_OK;
+    bfi_parallel_for(table.chunk_cnt, BFI_CODEC_PARALLEL_CHUNKS,
+                     bfi_codec_decode_worker, &ctx);
+    ret = ctx.ret;
+    if (ret != BFI_E_OK) {
+        free(*raw);
+        *raw = NULL;
+    }
+    *raw_len = table.raw_len;
+    bfi_codec_free_table(&table);
+
+    return ret;
+}
@@ -0,0 +1,176 @@
+/**
+ * \file bf_codec.h
+ * \brief Chunked archival encoding of index sections (header file)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _BLOOMF_CODEC_H
+#define _BLOOMF_CODEC_H
+
+#include <stdint.h>
+#include "bf_index_internal.h"
+
+/* Chunked encoding (BFI_ENC_CHUNKED) of a section payload:
+ * +---------------------------------------------------------------------+
+ * | u64: raw length | u32: chunk size | u32: chunk count                 |
+ * > ---- Chunk table (count items) --------------------------------------<
+ * | u32: codec | u32: encoded length | u64: offset                       |
+ * > ---- Encoded chunks --------------------------------------------------<
+ * +---------------------------------------------------------------------+
+ * > payload is split to chunks of chunk size bytes (the last one could be
+ *   shorter), every chunk is encoded by the codec giving the shortest output
+ * > offset of every chunk is relative to the beginning of the payload, so
+ *   a single chunk could be read and decoded (random access)
+ *
+ * Codecs:
+ * > BFI_CODEC_RAW - chunk stored as is (dense filters)
+ * > BFI_CODEC_ZERO - chunk of zero bytes, nothing is stored
+ * > BFI_CODEC_ZRLE - runs of zero bytes and literals:
+ *   (varint: zero run length, varint: literal length, literal bytes)...
+ * > BFI_CODEC_RICE - Rice coded gaps between set bits (sparse filters):
+ *   u32: count of set bits | u8: Rice parameter | bit stream
+ *   (every gap is stored as unary quotient (zeros ended by one) followed by
+ *   the parameter count of bits of remainder, least significant bit first)
+ */
+#define BFI_CODEC_HDR_LEN (sizeof(uint64_t) + 2 * sizeof(uint32_t))
+
+// Default, minimal and maximal size of a chunk (bytes)
+#define BFI_CODEC_CHUNK_SIZE (64 * 1024)
+#define BFI_CODEC_CHUNK_MIN 512
+#define BFI_CODEC_CHUNK_MAX (16 * 1024 * 1024)
+
+typedef enum {
+    BFI_CODEC_RAW = 0,
+    BFI_CODEC_ZERO = 1,
+    BFI_CODEC_ZRLE = 2,
+    BFI_CODEC_RICE = 3,
+} bfi_codec_t;
+
+typedef struct {
+    uint32_t codec;
+    uint32_t length;
+    uint64_t offset;
+} bfi_chunk_t;
+
+typedef struct {
+    uint64_t raw_len;
+    uint32_t chunk_size;
+    uint32_t chunk_cnt;
+    bfi_chunk_t *chunks;
+} bfi_chunk_table_t;
+
+/**
+ * \brief Encode payload by chunked encoding
+ *
+ * \param[in] raw Payload
+ * \param[in] raw_len Length of the payload
+ * \param[in] chunk_size Size of a chunk (0 means BFI_CODEC_CHUNK_SIZE)
+ * \param[out] encoded Newly allocated encoded payload (free() it)
+ * \return Returns length of the encoded payload or 0 on error.
+ */
+uint64_t bfi_codec_encode(const char *raw, uint64_t raw_len,
+                    uint32_t chunk_size, char **encoded);
+
+/**
+ * \brief Encode payload given by two parts (e.g. header and table of a filter)
+ *
+ * Chunks are encoded in parallel (see bfi_set_io_threads()).
+ *
+ * \param[in] head First part of the payload
+ * \param[in] head_len Length of the first part
+ * \param[in] body Second part of the payload (or NULL)
+ * \param[in] body_len Length of the second part
+ * \param[in] chunk_size Size of a chunk (0 means BFI_CODEC_CHUNK_SIZE)
+ * \param[out] encoded Newly allocated encoded payload (free() it)
+ * \return Returns length of the encoded payload or 0 on error.
+ */
+uint64_t bfi_codec_encode_parts(const char *head, uint64_t head_len,
+                    const char *body, uint64_t body_len, uint32_t chunk_size,
+                    char **encoded);
+
+/**
+ * \brief Length of the beginning of encoded payload holding the chunk table
+ *
+ * \param[in] buff At least BFI_CODEC_HDR_LEN bytes of encoded payload
+ */
+uint64_t bfi_codec_table_len(const char *buff);
+
+/**
+ * \brief Read and check chunk table of encoded payload
+ *
+ * \param[in] buff Beginning of encoded payload (bfi_codec_table_len() bytes)
+ * \param[in] len Length of the whole encoded payload
+ * \param[out] table Chunk table (free it by bfi_codec_free_table())
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_codec_read_table(const char *buff, uint64_t len,
+                    bfi_chunk_table_t *table);
+
+/**
+ * \brief Free chunk table read by bfi_codec_read_table()
+ */
+void bfi_codec_free_table(bfi_chunk_table_t *table);
+
+/**
+ * \brief Raw length of a chunk (the last chunk could be shorter)
+ */
+uint32_t bfi_codec_chunk_raw_len(const bfi_chunk_table_t *table,
+                    uint32_t chunk);
+
+/**
+ * \brief Decode single chunk
+ *
+ * \param[in] chunk Chunk to decode
+ * \param[in] data Encoded chunk (chunk->length bytes)
+ * \param[out] raw Buffer for decoded chunk
+ * \param[in] raw_len Raw length of the chunk
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_codec_decode_chunk(const bfi_chunk_t *chunk, const char *data,
+                    char *raw, uint32_t raw_len);
+
+/**
+ * \brief Decode whole encoded payload
+ *
+ * \param[in] buff Encoded payload
+ * \param[in] len Length of the encoded payload
+ * \param[out] raw Newly allocated payload (free() it)
+ * \param[out] raw_len Length of the payload
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_codec_decode(const char *buff, uint64_t len, char **raw,
+                    uint64_t *raw_len);
+
+#endif //_BLOOMF_CODEC_H
@@ -0,0 +1,879 @@
+/**
+ * \file bf_cold_index.c
+ * \brief Cold indexes queried over compressed chunks
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bf_index_internal.h"
+#include "bf_index_file.h"
+#include "bf_codec.h"
+#include "bf_io.h"
+#include "bloomf_wrapper.h"
+
+// Default count of decoded chunks kept in the cache
+#define BFI_COLD_CACHE_CNT 4
+
+// Default size of a chunk of a cold index created from an index (small chunks
+// are decoded faster, larger ones are compressed better)
+#define BFI_COLD_CHUNK_SIZE 4096
+
+// Count of keys of a batch whose probes are sorted and read together
+#define BFI_COLD_BATCH_KEYS 1024
+
+// Probes of a raw file closer than this are read by one pread() (a page is
+// read by the device anyway)
+#define BFI_COLD_READ_GAP 4096
+
+// Maximal length of one read of a batch
+#define BFI_COLD_READ_MAX (64 * 1024)
+
+typedef struct {
+    uint32_t chunk;             // Cached chunk or UINT32_MAX
+    uint64_t last_use;
+    char *raw;                  // Decoded chunk
+} bfi_cold_slot_t;
+
+// Byte of the filter payload probed by a key
+typedef struct {
+    uint64_t offset;            // Offset in the filter payload
+    uint32_t key;               // Key of a batch
+    uint8_t mask;               // Bits of the byte which have to be set
+} bfi_cold_probe_t;
+
+// Part of the filter payload read by one pread() (probes [first, end))
+typedef struct {
+    uint64_t offset;
+    uint64_t len;
+    uint32_t first;
+    uint32_t end;
+} bfi_cold_read_t;
+
+typedef struct {
+    uint16_t engine;
+    bloom_filter_h *bf;         // Filter with loaded header only (no table)
+    uint64_t table_offset;      // Offset of the table in the filter payload
+    bfi_chunk_table_t table;    // Chunks of the filter payload
+    FILE *file_ptr;             // Index file (if chunks are read from disk)
+    uint64_t section_offset;    // Offset of the filter section in the file
+    bool chunked;               // Section is encoded (not raw)
+    char *data;                 // Resident encoded payload (or NULL)
+    uint64_t data_len;
+    char *read_buff;            // Buffer for chunks and probes read from disk
+    uint64_t read_len;
+    bfi_cold_probe_t *probes;   // Probes of one key
+    uint32_t probe_max;         // Maximal count of probes of a key
+    bfi_cold_slot_t *cache;
+    uint32_t cache_cnt;
+    uint64_t clock;
+    bfi_zone_t zone;            // Zone map of the index
+} bfi_cold_index_t;
+
+
+/**
+ * \brief Allocate cold index with empty cache of decoded chunks (and probes
+ *    of one key)
+ */
+static bfi_ecode_t bfi_cold_alloc_cache(bfi_cold_index_t *cold,
+                    uint32_t cache_cnt)
+{
+    // Bytes of a word of a register-blocked filter or a byte per hash
+    cold->probe_max = cold->engine == BFI_ENGINE_REGISTER ? sizeof(uint64_t)
+                                        : (uint32_t) bf_hash_count(cold->bf);
+    cold->probes = (bfi_cold_probe_t *) malloc(cold->probe_max
+                                               * sizeof(bfi_cold_probe_t));
+    if (!cold->probes) {
+        return BFI_E_MEM;
+    }
+
+    if (cache_cnt == 0) {
+        cache_cnt = BFI_COLD_CACHE_CNT;
+    }
+    if (cache_cnt > cold->table.chunk_cnt && cold->table.chunk_cnt) {
+        cache_cnt = cold->table.chunk_cnt;
+    }
+
+    cold->cache = (bfi_cold_slot_t *) calloc(cache_cnt,
+                                             sizeof(bfi_cold_slot_t));
+    if (!cold->cache) {
+        return BFI_E_MEM;
+    }
+    cold->cache_cnt = cache_cnt;
+    for (uint32_t i = 0; i < cache_cnt; ++i) {
+        cold->cache[i].chunk = UINT32_MAX;
+        cold->cache[i].raw = (char *) malloc(cold->table.chunk_size);
+        if (!cold->cache[i].raw) {
+            return BFI_E_MEM;
+        }
+    }
+
+    return BFI_E_OK;
+}
+
+
+/**
+ * \brief Chunk table of a raw section (chunks are stored as they are)
+ */
+static bfi_ecode_t bfi_cold_raw_table(bfi_chunk_table_t *table,
+                    uint64_t raw_len)
+{
+    table->raw_len = raw_len;
+    table->chunk_size = BFI_COLD_CHUNK_SIZE;
+    table->chunk_cnt = (uint32_t) ((raw_len + table->chunk_size - 1)
+                                   / table->chunk_size);
+    table->chunks = (bfi_chunk_t *) malloc(table->chunk_cnt
+                                           * sizeof(bfi_chunk_t) + 1);
+    if (!table->chunks) {
+        return BFI_E_MEM;
+    }
+    for (uint32_t c = 0; c < table->chunk_cnt; ++c) {
+        table->chunks[c].codec = BFI_CODEC_RAW;
+        table->chunks[c].length = bfi_codec_chunk_raw_len(table, c);
+        table->chunks[c].offset = (uint64_t) c * table->chunk_size;
+    }
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_open_cold_index(bfi_cold_index_ptr_t *cold_ptr,
+                    char *filename, bool resident, uint32_t cache_chunks)
+{
+    bfi_cold_index_t *cold;
+    bfi_section_t sec;
+    uint64_t table_len;
+    uint16_t engine;
+    bfi_ecode_t ret;
+
+    *cold_ptr = NULL;
+
+    cold = (bfi_cold_index_t *) calloc(1, sizeof(bfi_cold_index_t));
+    if (!cold) {
+        return BFI_E_MEM;
+    }
+
+	// Open file, mode: read binary
+    cold->file_ptr = fopen(filename, "rb");
+    if (!cold->file_ptr){
+        free(cold);
+        return BFI_E_LOAD_FILE_ERR;
+    }
+    // Chunks are read by probes of queried addresses
+    bfi_io_advise_file(fileno(cold->file_ptr), bfi_get_io_policy(), true);
+
+    // Parameters of the filter and its chunks
+    ret = bfi_file_read_filter_header(cold->file_ptr, &engine, &cold->bf,
+                                      &sec);
+    if (ret != BFI_E_OK) {
+        goto error;
+    }
+    cold->engine = engine;
+    if (engine == BFI_ENGINE_REGISTER) {
+        ret = bfi_register_read_file(cold->file_ptr, cold->bf);
+    } else if (engine != BFI_ENGINE_STANDARD) {
+        ret = BFI_E_ENGINE;
+    }
+    if (ret != BFI_E_OK) {
+        goto error;
+    }
+    ret = bfi_zone_read_file(cold->file_ptr, &cold->zone);
+    if (ret != BFI_E_OK) {
+        goto error;
+    }
+    cold->table_offset = bf_header_length(cold->bf);
+    cold->section_offset = sec.offset;
+    cold->chunked = sec.encoding == BFI_ENC_CHUNKED;
+    if (cold->chunked) {
+        ret = bfi_file_read_chunk_table(cold->file_ptr, &sec, &cold->table);
+    } else {
+        ret = bfi_cold_raw_table(&cold->table, sec.length);
+    }
+    if (ret != BFI_E_OK) {
+        goto error;
+    }
+    // Probes of the whole table have to map to chunks of the payload
+    bf_table(cold->bf, &table_len);
+    if (table_len == 0 || cold->table.raw_len < cold->table_offset
+            || cold->table.raw_len - cold->table_offset != table_len) {
+        ret = BFI_E_LOAD_BYTES;
+        goto error;
+    }
+
+    // Encoded payload is kept in memory or chunks are read on demand
+    if (resident) {
+        cold->data_len = sec.length;
+        cold->data = (char *) malloc(sec.length);
+        if (!cold->data) {
+            ret = BFI_E_LOAD_MEM;
+            goto error;
+        }
+        ret = bfi_file_pread(cold->file_ptr, sec.offset, sec.length,
+                             cold->data);
+        if (ret != BFI_E_OK) {
+            goto error;
+        }
+        fclose(cold->file_ptr);
+        cold->file_ptr = NULL;
+    } else {
+        cold->read_len = cold->table.chunk_size > BFI_COLD_READ_MAX
+                         ? cold->table.chunk_size : BFI_COLD_READ_MAX;
+        cold->read_buff = (char *) malloc(cold->read_len);
+        if (!cold->read_buff) {
+            ret = BFI_E_LOAD_MEM;
+            goto error;
+        }
+    }
+
+    ret = bfi_cold_alloc_cache(cold, cache_chunks);
+    if (ret != BFI_E_OK) {
+        goto error;
+    }
+
+    *cold_ptr = (bfi_cold_index_ptr_t) cold;
+
+    return BFI_E_OK;
+
+error:
+    bfi_close_cold_index((bfi_cold_index_ptr_t *) &cold);
+
+    return ret;
+}
+
+
+bfi_ecode_t bfi_cold_index_from(bfi_cold_index_ptr_t *cold_ptr,
+                    bfi_index_ptr_t index_ptr, uint32_t chunk_size,
+                    uint32_t cache_chunks)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    bfi_cold_index_t *cold;
+    uint32_t bf_len;
+    char *bf_bytes;
+    bfi_ecode_t ret;
+
+    *cold_ptr = NULL;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+    if (index->engine != BFI_ENGINE_STANDARD
+            && index->engine != BFI_ENGINE_REGISTER) {
+        return BFI_E_ENGINE;
+    }
+
+    cold = (bfi_cold_index_t *) calloc(1, sizeof(bfi_cold_index_t));
+    if (!cold) {
+        return BFI_E_MEM;
+    }
+    cold->engine = index->engine;
+
+    bf_len = bf_get_filter_as_bytes(index->bf, &bf_bytes);
+    if (bf_len == 0) {
+        free(cold);
+        return BFI_E_STO_BYTES;
+    }
+    cold->bf = bfi_new_empty_filter(index->engine);
+    if (bf_load_header_from_bytes(cold->bf, bf_bytes, bf_len) != 0
+            || (index->engine == BFI_ENGINE_REGISTER
+                && rgbf_set_parameters(cold->bf,
+                                       rgbf_get_bits_per_key(index->bf)) != 0)) {
+        bf_clear_bytes(index->bf, &bf_bytes);
+        ret = BFI_E_LOAD_BYTES;
+        goto error;
+    }
+    cold->table_offset = bf_header_length(cold->bf);
+    cold->zone = index->zone;
+
+    // Compressed copy of the filter
+    cold->data_len = bfi_codec_encode(bf_bytes, bf_len,
+                        chunk_size ? chunk_size : BFI_COLD_CHUNK_SIZE,
+                        &cold->data);
+    bf_clear_bytes(index->bf, &bf_bytes);
+    if (cold->data_len == 0) {
+        ret = BFI_E_MEM;
+        goto error;
+    }
+    ret = bfi_codec_read_table(cold->data, cold->data_len, &cold->table);
+    if (ret != BFI_E_OK) {
+        goto error;
+    }
+
+    ret = bfi_cold_alloc_cache(cold, cache_chunks);
+    if (ret != BFI_E_OK) {
+        goto error;
+    }
+
+    *cold_ptr = (bfi_cold_index_ptr_t) cold;
+
+    return BFI_E_OK;
+
+error:
+    bfi_close_cold_index((bfi_cold_index_ptr_t *) &cold);
+
+    return ret;
+}
+
+
+void bfi_close_cold_index(bfi_cold_index_ptr_t *cold_ptr)
+{
+    bfi_cold_index_t *cold;
+
+    if (!cold_ptr || !*cold_ptr) {
+        return;
+    }
+    cold = (bfi_cold_index_t *) *cold_ptr;
+
+    if (cold->bf) {
+        bf_delete_filter(cold->bf);
+    }
+    if (cold->file_ptr) {
+        fclose(cold->file_ptr);
+    }
+    if (cold->cache) {
+        for (uint32_t i = 0; i < cold->cache_cnt; ++i) {
+            free(cold->cache[i].raw);
+        }
+        free(cold->cache);
+    }
+    bfi_codec_free_table(&cold->table);
+    free(cold->data);
+    free(cold->read_buff);
+    free(cold->probes);
+    free(cold);
+
+    *cold_ptr = NULL;
+}
+
+
+/**
+ * \brief Find decoded chunk in the cache
+ *
+ * \return Returns decoded chunk or NULL if it is not cached.
+ */
+static const char *bfi_cold_cached(bfi_cold_index_t *cold, uint32_t chunk)
+{
+    for (uint32_t i = 0; i < cold->cache_cnt; ++i) {
+        if (cold->cache[i].chunk == chunk) {
+            cold->cache[i].last_use = ++cold->clock;
+            return cold->cache[i].raw;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * \brief Decode encoded chunk to the least recently used slot of the cache
+ *
+ * \return Returns decoded chunk or NULL on error.
+ */
+static const char *bfi_cold_decode(bfi_cold_index_t *cold, uint32_t chunk,
+                    const char *data)
+{
+    bfi_cold_slot_t *slot = &cold->cache[0];
+
+    for (uint32_t i = 1; i < cold->cache_cnt; ++i) {
+        if (cold->cache[i].last_use < slot->last_use) {
+            slot = &cold->cache[i];
+        }
+    }
+
+    slot->chunk = UINT32_MAX;
+    if (bfi_codec_decode_chunk(&cold->table.chunks[chunk], data, slot->raw,
+                               bfi_codec_chunk_raw_len(&cold->table, chunk))
+            != BFI_E_OK) {
+        return NULL;
+    }
+    slot->chunk = chunk;
+    slot->last_use = ++cold->clock;
+
+    return slot->raw;
+}
+
+
+/**
+ * \brief Get decoded chunk (decode it to the least recently used slot)
+ *
+ * \return Returns decoded chunk or NULL on error.
+ */
+static const char *bfi_cold_chunk(bfi_cold_index_t *cold, uint32_t chunk)
+{
+    const bfi_chunk_t *c = &cold->table.chunks[chunk];
+    const char *data;
+
+    data = bfi_cold_cached(cold, chunk);
+    if (data) {
+        return data;
+    }
+
+    if (cold->data) {
+        data = cold->data + c->offset;
+    } else {
+        if (bfi_file_pread_fd(fileno(cold->file_ptr),
+                              cold->section_offset + c->offset, c->length,
+                              cold->read_buff) != BFI_E_OK) {
+            return NULL;
+        }
+        data = cold->read_buff;
+    }
+
+    return bfi_cold_decode(cold, chunk, data);
+}
+
+
+/**
+ * \brief Bytes of the filter payload probed by an address
+ *
+ * \return Returns count of probes (0 if hash values could not be computed,
+ *    the address may be present then).
+ */
+static uint32_t bfi_cold_probes(bfi_cold_index_t *cold,
+                    const unsigned char *buffer, size_t len, uint32_t key,
+                    bfi_cold_probe_t *probes)
+{
+    uint32_t stack_hashes[BFI_STACK_HASH_CNT];
+    uint32_t *hashes;
+    uint32_t cnt = 0;
+
+    hashes = bfi_compute_hashes(cold->bf, buffer, len, stack_hashes);
+    if (!hashes) {
+        return 0;
+    }
+
+    if (cold->engine == BFI_ENGINE_REGISTER) {
+        // Non-zero bytes of the mask of the word (in the byte order of the
+        // stored table)
+        uint64_t mask;
+        uint64_t word = rgbf_word_position(cold->bf, hashes[0], &mask);
+        unsigned char mask_bytes[sizeof(mask)];
+
+        memcpy(mask_bytes, &mask, sizeof(mask));
+        for (uint32_t b = 0; b < sizeof(mask); ++b) {
+            if (mask_bytes[b]) {
+                probes[cnt].offset = cold->table_offset + word * sizeof(mask)
+                                     + b;
+                probes[cnt].key = key;
+                probes[cnt++].mask = mask_bytes[b];
+            }
+        }
+    } else {
+        for (uint32_t i = 0; i < cold->probe_max; ++i) {
+            uint64_t bit = bf_bit_position(cold->bf, hashes[i]);
+
+            probes[cnt].offset = cold->table_offset + bit / 8;
+            probes[cnt].key = key;
+            probes[cnt++].mask = (uint8_t) (1 << (bit % 8));
+        }
+    }
+    bfi_free_hashes(hashes, stack_hashes);
+
+    return cnt;
+}
+
+
+static inline uint32_t bfi_cold_probe_chunk(const bfi_cold_index_t *cold,
+                    const bfi_cold_probe_t *probe)
+{
+    return (uint32_t) (probe->offset / cold->table.chunk_size);
+}
+
+
+/**
+ * \brief Check probe in its decoded chunk
+ */
+static inline bool bfi_cold_probe_set(const bfi_cold_index_t *cold,
+                    const char *raw, const bfi_cold_probe_t *probe)
+{
+    uint8_t byte = (uint8_t) raw[probe->offset % cold->table.chunk_size];
+
+    return (byte & probe->mask) == probe->mask;
+}
+
+
+bool bfi_cold_addr_is_stored(bfi_cold_index_ptr_t cold_ptr,
+                    const unsigned char *buffer, const size_t len)
+{
+    bfi_cold_index_t *cold = (bfi_cold_index_t *) cold_ptr;
+    bfi_cold_probe_t *probes;
+    uint32_t probe_cnt;
+    bool pending = false;
+    bool ret = true;
+
+    if (!cold) {
+        return false;
+    }
+    if (!bfi_zone_may_contain(&cold->zone, buffer, len)) {
+        return false;
+    }
+
+    probes = cold->probes;
+    probe_cnt = bfi_cold_probes(cold, buffer, len, 0, probes);
+
+    /* Probes of cached chunks are checked first, so a missing address is
+     * often rejected without decoding any chunk. Checked probes are marked
+     * by zero mask.
+     */
+    for (uint32_t i = 0; i < probe_cnt && ret; ++i) {
+        const char *raw = bfi_cold_cached(cold,
+                                          bfi_cold_probe_chunk(cold,
+                                                               &probes[i]));
+
+        if (!raw) {
+            pending = true;
+            continue;
+        }
+        ret = bfi_cold_probe_set(cold, raw, &probes[i]);
+        probes[i].mask = 0;
+    }
+
+    // Remaining probes
+    for (uint32_t i = 0; i < probe_cnt && ret && pending; ++i) {
+        const char *raw;
+
+        if (!probes[i].mask) {
+            continue;
+        }
+        raw = bfi_cold_chunk(cold, bfi_cold_probe_chunk(cold, &probes[i]));
+        if (!raw) {
+            // Unable to check, the address may be present
+            break;
+        }
+        ret = bfi_cold_probe_set(cold, raw, &probes[i]);
+    }
+
+    return ret;
+}
+
+
+static int bfi_cold_probe_cmp(const void *a, const void *b)
+{
+    uint64_t offset_a = ((const bfi_cold_probe_t *) a)->offset;
+    uint64_t offset_b = ((const bfi_cold_probe_t *) b)->offset;
+
+    return (offset_a > offset_b) - (offset_a < offset_b);
+}
+
+
+/**
+ * \brief Probes of keys of a batch which are not decided by cached chunks
+ *
+ * \return Returns count of probes.
+ */
+static uint32_t bfi_cold_batch_probes(bfi_cold_index_t *cold,
+                    const unsigned char *keys, size_t key_len,
+                    uint32_t key_cnt, bool *stored, bfi_cold_probe_t *probes)
+{
+    uint32_t probe_cnt = 0;
+
+    for (uint32_t k = 0; k < key_cnt; ++k) {
+        const unsigned char *key = keys + (uint64_t) k * key_len;
+        uint32_t first = probe_cnt;
+        uint32_t cnt;
+
+        stored[k] = bfi_zone_may_contain(&cold->zone, key, key_len);
+        if (!stored[k]) {
+            continue;
+        }
+        cnt = bfi_cold_probes(cold, key, key_len, k, probes + first);
+        for (uint32_t i = first; i < first + cnt && stored[k]; ++i) {
+            const char *raw = bfi_cold_cached(cold,
+                                              bfi_cold_probe_chunk(cold,
+                                                                   &probes[i]));
+
+            if (!raw) {
+                probes[probe_cnt++] = probes[i];
+            } else {
+                stored[k] = bfi_cold_probe_set(cold, raw, &probes[i]);
+            }
+        }
+        if (!stored[k]) {
+            // Other probes of a rejected key are not read
+            probe_cnt = first;
+        }
+    }
+
+    return probe_cnt;
+}
+
+
+/**
+ * \brief Check if any key of probes [first, end) is not rejected yet
+ */
+static bool bfi_cold_read_needed(const bfi_cold_probe_t *probes,
+                    uint32_t first, uint32_t end, const bool *stored)
+{
+    for (uint32_t p = first; p < end; ++p) {
+        if (stored[probes[p].key]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * \brief Check sorted probes of a raw filter read from disk
+ *
+ * Only bytes between probes are read, not whole chunks. Probes closer than
+ * BFI_COLD_READ_GAP bytes are read by one pread().
+ */
+static bfi_ecode_t bfi_cold_check_raw(bfi_cold_index_t *cold,
+                    const bfi_cold_probe_t *probes, uint32_t probe_cnt,
+                    bfi_cold_read_t *reads, bool *stored)
+{
+    int fd = fileno(cold->file_ptr);
+    uint32_t read_cnt = 0;
+    bfi_ecode_t ret;
+
+    for (uint32_t p = 0; p < probe_cnt; ++p) {
+        bfi_cold_read_t *read = &reads[read_cnt];
+
+        if (read_cnt > 0) {
+            uint64_t end = read[-1].offset + read[-1].len;
+
+            if (probes[p].offset < end + BFI_COLD_READ_GAP
+                    && probes[p].offset + 1 - read[-1].offset
+                       <= cold->read_len) {
+                if (probes[p].offset >= end) {
+                    read[-1].len = probes[p].offset + 1 - read[-1].offset;
+                }
+                read[-1].end = p + 1;
+                continue;
+            }
+        }
+        read->offset = probes[p].offset;
+        read->len = 1;
+        read->first = p;
+        read->end = p + 1;
+        read_cnt++;
+    }
+
+    // All reads are issued to the device before waiting for the first one
+    for (uint32_t r = 0; r < read_cnt && read_cnt > 1; ++r) {
+        bfi_io_advise_range(fd, cold->section_offset + reads[r].offset,
+                            reads[r].len);
+    }
+
+    for (uint32_t r = 0; r < read_cnt; ++r) {
+        const bfi_cold_read_t *read = &reads[r];
+
+        if (!bfi_cold_read_needed(probes, read->first, read->end, stored)) {
+            continue;
+        }
+        ret = bfi_file_pread_fd(fd, cold->section_offset + read->offset,
+                                read->len, cold->read_buff);
+        if (ret != BFI_E_OK) {
+            return ret;
+        }
+        for (uint32_t p = read->first; p < read->end; ++p) {
+            uint8_t byte = (uint8_t) cold->read_buff[probes[p].offset
+                                                     - read->offset];
+
+            if ((byte & probes[p].mask) != probes[p].mask) {
+                stored[probes[p].key] = false;
+            }
+        }
+    }
+
+    return BFI_E_OK;
+}
+
+
+/**
+ * \brief Check sorted probes of an encoded or resident filter
+ *
+ * Chunks of probes are decoded to the cache. Runs of chunks of a file which
+ * are at most BFI_COLD_READ_GAP bytes apart are read by one pread().
+ */
+static bfi_ecode_t bfi_cold_check_chunks(bfi_cold_index_t *cold,
+                    const bfi_cold_probe_t *probes, uint32_t probe_cnt,
+                    bfi_cold_read_t *reads, bool *stored)
+{
+    int fd = cold->file_ptr ? fileno(cold->file_ptr) : -1;
+    uint32_t read_cnt = 0;
+    bfi_ecode_t ret;
+
+    for (uint32_t p = 0, end; p < probe_cnt; p = end) {
+        uint32_t chunk = bfi_cold_probe_chunk(cold, &probes[p]);
+        const bfi_chunk_t *c = &cold->table.chunks[chunk];
+        bfi_cold_read_t *read = &reads[read_cnt];
+
+        for (end = p + 1; end < probe_cnt
+                && bfi_cold_probe_chunk(cold, &probes[end]) == chunk; ++end) {
+        }
+        if (c->length > cold->read_len && !cold->data) {
+            return BFI_E_LOAD_SECTION;
+        }
+        if (read_cnt > 0 && c->offset >= read[-1].offset + read[-1].len
+                && c->offset < read[-1].offset + read[-1].len
+                               + BFI_COLD_READ_GAP
+                && c->offset + c->length - read[-1].offset
+                   <= cold->read_len) {
+            read[-1].len = c->offset + c->length - read[-1].offset;
+            read[-1].end = end;
+            continue;
+        }
+        read->offset = c->offset;
+        read->len = c->length;
+        read->first = p;
+        read->end = end;
+        read_cnt++;
+    }
+
+    if (!cold->data) {
+        for (uint32_t r = 0; r < read_cnt && read_cnt > 1; ++r) {
+            bfi_io_advise_range(fd, cold->section_offset + reads[r].offset,
+                                reads[r].len);
+        }
+    }
+
+    for (uint32_t r = 0; r < read_cnt; ++r) {
+        const bfi_cold_read_t *read = &reads[r];
+        const char *data;
+
+        if (!bfi_cold_read_needed(probes, read->first, read->end, stored)) {
+            continue;
+        }
+        if (cold->data) {
+            data = cold->data + read->offset;
+        } else {
+            ret = bfi_file_pread_fd(fd, cold->section_offset + read->offset,
+                                    read->len, cold->read_buff);
+            if (ret != BFI_E_OK) {
+                return ret;
+            }
+            data = cold->read_buff;
+        }
+
+        // Chunks of the read
+        for (uint32_t p = read->first, end; p < read->end; p = end) {
+            uint32_t chunk = bfi_cold_probe_chunk(cold, &probes[p]);
+            const char *raw;
+
+            for (end = p + 1; end < read->end
+                    && bfi_cold_probe_chunk(cold, &probes[end]) == chunk;
+                    ++end) {
+            }
+            if (!bfi_cold_read_needed(probes, p, end, stored)) {
+                continue;
+            }
+            raw = bfi_cold_decode(cold, chunk, data
+                                  + (cold->table.chunks[chunk].offset
+                                     - read->offset));
+            if (!raw) {
+                return BFI_E_LOAD_SECTION;
+            }
+            for (uint32_t i = p; i < end; ++i) {
+                if (!bfi_cold_probe_set(cold, raw, &probes[i])) {
+                    stored[probes[i].key] = false;
+                }
+            }
+        }
+    }
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_cold_addr_is_stored_batch(bfi_cold_index_ptr_t cold_ptr,
+                    const unsigned char *keys, size_t key_len,
+                    uint64_t key_cnt, bool *stored)
+{
+    bfi_cold_index_t *cold = (bfi_cold_index_t *) cold_ptr;
+    bfi_cold_probe_t *probes;
+    bfi_cold_read_t *reads;
+    uint64_t max;
+    bfi_ecode_t ret = BFI_E_OK;
+
+    if (!cold) {
+        return BFI_E_NO_INDEX;
+    }
+
+    max = (uint64_t) BFI_COLD_BATCH_KEYS * cold->probe_max;
+    probes = (bfi_cold_probe_t *) malloc(max * sizeof(bfi_cold_probe_t));
+    reads = (bfi_cold_read_t *) malloc(max * sizeof(bfi_cold_read_t));
+    if (!probes || !reads) {
+        ret = BFI_E_MEM;
+        goto cleanup;
+    }
+
+    /* Probes of a group of keys are sorted by their offsets, so the filter
+     * is read by one sequential pass of a few reads per group.
+     */
+    for (uint64_t first = 0; first < key_cnt && ret == BFI_E_OK;
+            first += BFI_COLD_BATCH_KEYS) {
+        uint32_t cnt = (uint32_t) (key_cnt - first < BFI_COLD_BATCH_KEYS
+                                   ? key_cnt - first : BFI_COLD_BATCH_KEYS);
+        uint32_t probe_cnt;
+
+        probe_cnt = bfi_cold_batch_probes(cold, keys + first * key_len,
+                                          key_len, cnt, stored + first,
+                                          probes);
+        if (probe_cnt == 0) {
+            continue;
+        }
+        qsort(probes, probe_cnt, sizeof(bfi_cold_probe_t), bfi_cold_probe_cmp);
+        if (cold->data || cold->chunked) {
+            ret = bfi_cold_check_chunks(cold, probes, probe_cnt, reads,
+                                        stored + first);
+        } else {
+            ret = bfi_cold_check_raw(cold, probes, probe_cnt, reads,
+                                     stored + first);
+        }
+    }
+
+cleanup:
+    free(probes);
+    free(reads);
+
+    return ret;
+}
+
+
+uint64_t bfi_cold_index_size(bfi_cold_index_ptr_t cold_ptr)
+{
+    bfi_cold_index_t *cold = (bfi_cold_index_t *) cold_ptr;
+
+    if (!cold) {
+        return 0;
+    }
+
+    return cold->data_len + cold->table.chunk_cnt * sizeof(bfi_chunk_t)
+           + (uint64_t) cold->cache_cnt * cold->table.chunk_size;
+}
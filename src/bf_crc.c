@@ -0,0 +1,168 @@
+/**
+ * \file bf_crc.c
+ * \brief CRC-32C checksums of index files
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include "bf_crc.h"
+
+// Reflected CRC-32C polynomial
+#define BFI_CRC32C_POLY 0x82F63B78
+
+// Slicing-by-8 tables (8 bytes are processed per step)
+static uint32_t bfi_crc_table[8][256];
+
+
+/**
+ * \brief Generate tables when the library is loaded (no locking is needed)
+ */
+static void __attribute__((constructor)) bfi_crc_init(void)
+{
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+
+        for (int j = 0; j < 8; ++j) {
+            crc = (crc >> 1) ^ (BFI_CRC32C_POLY & (0 - (crc & 1)));
+        }
+        bfi_crc_table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int t = 1; t < 8; ++t) {
+            bfi_crc_table[t][i] = (bfi_crc_table[t - 1][i] >> 8)
+                                  ^ bfi_crc_table[0][bfi_crc_table[t - 1][i]
+                                                     & 0xFF];
+        }
+    }
+}
+
+
+uint32_t bfi_crc32c(uint32_t crc, const void *buff, size_t len)
+{
+    const uint8_t *p = (const uint8_t *) buff;
+
+    crc = ~crc;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (len >= 8) {
+        uint32_t lo;
+        uint32_t hi;
+
+        memcpy(&lo, p, sizeof(lo));
+        memcpy(&hi, p + 4, sizeof(hi));
+        lo ^= crc;
+        crc = bfi_crc_table[7][lo & 0xFF] ^ bfi_crc_table[6][(lo >> 8) & 0xFF]
+              ^ bfi_crc_table[5][(lo >> 16) & 0xFF] ^ bfi_crc_table[4][lo >> 24]
+              ^ bfi_crc_table[3][hi & 0xFF] ^ bfi_crc_table[2][(hi >> 8) & 0xFF]
+              ^ bfi_crc_table[1][(hi >> 16) & 0xFF] ^ bfi_crc_table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+#endif
+    while (len--) {
+        crc = (crc >> 8) ^ bfi_crc_table[0][(crc ^ *p++) & 0xFF];
+    }
+
+    return ~crc;
+}
+
+
+/**
+ * \brief Multiply a vector by a matrix over GF(2)
+ */
+static uint32_t bfi_crc_matrix_times(const uint32_t *mat, uint32_t vec)
+{
+    uint32_t sum = 0;
+
+    while (vec) {
+        if (vec & 1) {
+            sum ^= *mat;
+        }
+        vec >>= 1;
+        mat++;
+    }
+
+    return sum;
+}
+
+
+static void bfi_crc_matrix_square(uint32_t *square, const uint32_t *mat)
+{
+    for (int n = 0; n < 32; ++n) {
+        square[n] = bfi_crc_matrix_times(mat, mat[n]);
+    }
+}
+
+
+uint32_t bfi_crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t len2)
+{
+    uint32_t even[32];          // Operator of 2^k zero bits (k even)
+    uint32_t odd[32];           // Operator of 2^k zero bits (k odd)
+    uint32_t row = 1;
+
+    if (len2 == 0) {
+        return crc1;
+    }
+
+    // Operator of one zero bit
+    odd[0] = BFI_CRC32C_POLY;
+    for (int n = 1; n < 32; ++n) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    bfi_crc_matrix_square(even, odd);
+    bfi_crc_matrix_square(odd, even);
+
+    // Append len2 zero bytes to crc1 (operators of 1, 2, 4, ... bytes)
+    do {
+        bfi_crc_matrix_square(even, odd);
+        if (len2 & 1) {
+            crc1 = bfi_crc_matrix_times(even, crc1);
+        }
+        len2 >>= 1;
+        if (len2 == 0) {
+            break;
+        }
+        bfi_crc_matrix_square(odd, even);
+        if (len2 & 1) {
+            crc1 = bfi_crc_matrix_times(odd, crc1);
+        }
+        len2 >>= 1;
+    } while (len2);
+
+    return crc1 ^ crc2;
+}
@@ -0,0 +1,70 @@
+/**
+ * \file bf_crc.h
+ * \brief CRC-32C checksums of index files (header file)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _BLOOMF_CRC_H
+#define _BLOOMF_CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * \brief Update CRC-32C (Castagnoli) checksum by data
+ *
+ * Start with crc 0, the result of the last update is the checksum.
+ *
+ * \param[in] crc Checksum of previous data
+ * \param[in] buff Data
+ * \param[in] len Length of data
+ * \return Returns updated checksum.
+ */
+uint32_t bfi_crc32c(uint32_t crc, const void *buff, size_t len);
+
+/**
+ * \brief Combine CRC-32C checksums of two consecutive blocks of data
+ *
+ * Checksums of parts written (or read) in parallel give the checksum of the
+ * whole data without another pass over it.
+ *
+ * \param[in] crc1 Checksum of the first block
+ * \param[in] crc2 Checksum of the second block
+ * \param[in] len2 Length of the second block
+ * \return Returns checksum of the first block followed by the second one.
+ */
+uint32_t bfi_crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+
+#endif //_BLOOMF_CRC_H
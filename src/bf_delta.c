@@ -0,0 +1,294 @@
+/**
+ * \file bf_delta.c
+ * \brief Delta encoding of two versions of an index
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bf_index_internal.h"
+#include "bf_index_file.h"
+#include "bf_codec.h"
+#include "bf_crc.h"
+#include "bf_numa.h"
+#include "bloomf_wrapper.h"
+
+/* Delta format (host byte order, like index files):
+ * +---------------------------------------------------------------------+
+ * | header (bfi_delta_header_t)                                         |
+ * | zone map of the new version (BFI_SEC_ZONE format)                   |
+ * | XOR of old and new table (chunked encoding, see bf_codec.h)         |
+ * +---------------------------------------------------------------------+
+ * Filters only gain bits between two versions, so the XOR is sparse and
+ * chunks of it are encoded as zero chunks or Rice coded set bits. XOR clears
+ * bits of any other version than the base one (a missed, repeated or
+ * reordered delta), so the delta is applied only to a table of the checksum
+ * of the base table.
+ */
+#define BFI_DELTA_MAGIC 0x44494642      // "BFID"
+
+// Zone map of the new version is valid
+#define BFI_DELTA_F_ZONE 0x1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t flags;
+    uint64_t table_len;         // Length of the table (bytes)
+    uint64_t seed;              // Family of the filter
+    uint64_t hash_cnt;
+    uint64_t item_cnt;          // Count of items of the new version
+    uint32_t checksum;          // CRC-32C of the rest of the delta
+    uint32_t base_checksum;     // CRC-32C of the table of the base version
+} bfi_delta_header_t;
+
+#define BFI_DELTA_HDR_LEN (sizeof(bfi_delta_header_t) + BFI_ZONE_SEC_LEN)
+
+
+/**
+ * \brief Check if an index has a count-min sketch or range filters (they are
+ *    not carried by deltas and would get stale on the replica)
+ */
+static bool bfi_delta_sidecars(const bfi_index_t *index)
+{
+    return index->cms != NULL || index->range_cnt != 0;
+}
+
+
+/**
+ * \brief XOR two tables (word by word, vectorized by the compiler)
+ */
+static void bfi_delta_xor(const unsigned char *a, const unsigned char *b,
+                    unsigned char *dst, uint64_t len)
+{
+    uint64_t i = 0;
+
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t x;
+        uint64_t y;
+
+        memcpy(&x, a + i, sizeof(x));
+        memcpy(&y, b + i, sizeof(y));
+        x ^= y;
+        memcpy(dst + i, &x, sizeof(x));
+    }
+    for (; i < len; ++i) {
+        dst[i] = a[i] ^ b[i];
+    }
+}
+
+
+bfi_ecode_t bfi_delta_create(bfi_index_ptr_t base_ptr,
+                    bfi_index_ptr_t index_ptr, char **delta,
+                    uint64_t *delta_len)
+{
+    bfi_index_t *base = (bfi_index_t *) base_ptr;
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    bfi_family_t base_family;
+    bfi_family_t family;
+    bfi_delta_header_t header;
+    const unsigned char *base_table;
+    const unsigned char *table;
+    uint64_t base_len;
+    uint64_t table_len;
+    unsigned char *xor_table;
+    char *encoded;
+    uint64_t encoded_len;
+
+    *delta = NULL;
+    *delta_len = 0;
+
+    if (!base || !index) {
+        return BFI_E_NO_INDEX;
+    }
+    if (index->engine != BFI_ENGINE_STANDARD || bfi_delta_sidecars(base)
+            || bfi_delta_sidecars(index)) {
+        return BFI_E_ENGINE;
+    }
+    bfi_index_family(base_ptr, &base_family);
+    bfi_index_family(index_ptr, &family);
+    if (!bfi_family_compatible(&base_family, &family)) {
+        return BFI_E_FAMILY;
+    }
+
+    base_table = bf_table(base->bf, &base_len);
+    table = bf_table(index->bf, &table_len);
+    if (base_len != table_len || table_len == 0) {
+        return BFI_E_FAMILY;
+    }
+
+    xor_table = (unsigned char *) malloc(table_len);
+    if (!xor_table) {
+        return BFI_E_MEM;
+    }
+    bfi_delta_xor(base_table, table, xor_table, table_len);
+    encoded_len = bfi_codec_encode((const char *) xor_table, table_len, 0,
+                                   &encoded);
+    free(xor_table);
+    if (encoded_len == 0) {
+        return BFI_E_MEM;
+    }
+
+    *delta = (char *) malloc(BFI_DELTA_HDR_LEN + encoded_len);
+    if (!*delta) {
+        free(encoded);
+        return BFI_E_MEM;
+    }
+    bfi_zone_as_bytes(&index->zone, *delta + sizeof(header));
+    memcpy(*delta + BFI_DELTA_HDR_LEN, encoded, encoded_len);
+    free(encoded);
+    *delta_len = BFI_DELTA_HDR_LEN + encoded_len;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = BFI_DELTA_MAGIC;
+    header.flags = index->zone.valid ? BFI_DELTA_F_ZONE : 0;
+    header.table_len = table_len;
+    header.seed = family.seed;
+    header.hash_cnt = family.hash_cnt;
+    header.item_cnt = bf_get_inserted_element_cnt(index->bf);
+    header.base_checksum = bfi_crc32c(0, base_table, base_len);
+    header.checksum = bfi_crc32c(0, *delta + sizeof(header),
+                                 *delta_len - sizeof(header));
+    memcpy(*delta, &header, sizeof(header));
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_delta_apply(bfi_index_ptr_t index_ptr, const char *delta,
+                    uint64_t delta_len)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    bfi_delta_header_t header;
+    bfi_family_t family;
+    bfi_chunk_table_t table;
+    bfi_zone_t zone;
+    const unsigned char *index_table;
+    const char *payload;
+    uint64_t payload_len;
+    uint64_t table_len;
+    uint32_t nonzero_cnt = 0;
+    char *raw;
+    bfi_ecode_t ret = BFI_E_OK;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+    if (index->engine != BFI_ENGINE_STANDARD || bfi_delta_sidecars(index)) {
+        return BFI_E_ENGINE;
+    }
+
+    // Header and family of the delta
+    if (!delta || delta_len < BFI_DELTA_HDR_LEN + BFI_CODEC_HDR_LEN) {
+        return BFI_E_DELTA;
+    }
+    memcpy(&header, delta, sizeof(header));
+    if (header.magic != BFI_DELTA_MAGIC
+            || header.checksum != bfi_crc32c(0, delta + sizeof(header),
+                                             delta_len - sizeof(header))) {
+        return BFI_E_DELTA;
+    }
+    bfi_index_family(index_ptr, &family);
+    index_table = bf_table(index->bf, &table_len);
+    if (header.table_len != table_len || header.seed != family.seed
+            || header.hash_cnt != family.hash_cnt) {
+        return BFI_E_FAMILY;
+    }
+    if (header.base_checksum != bfi_crc32c(0, index_table, table_len)) {
+        return BFI_E_DELTA;
+    }
+    ret = bfi_zone_from_bytes(delta + sizeof(header), BFI_ZONE_SEC_LEN,
+                              &zone);
+    if (ret != BFI_E_OK) {
+        return BFI_E_DELTA;
+    }
+    zone.valid = (header.flags & BFI_DELTA_F_ZONE) != 0;
+
+    // Chunks of the XOR (zero chunks are skipped)
+    payload = delta + BFI_DELTA_HDR_LEN;
+    payload_len = delta_len - BFI_DELTA_HDR_LEN;
+    if (bfi_codec_read_table(payload, payload_len, &table) != BFI_E_OK) {
+        return BFI_E_DELTA;
+    }
+    if (table.raw_len != table_len) {
+        bfi_codec_free_table(&table);
+        return BFI_E_DELTA;
+    }
+
+    // Non-zero chunks are decoded and validated before the filter is
+    // changed, so a corrupted delta leaves the index intact
+    for (uint32_t i = 0; i < table.chunk_cnt; ++i) {
+        nonzero_cnt += table.chunks[i].codec != BFI_CODEC_ZERO;
+    }
+    raw = (char *) malloc((uint64_t) nonzero_cnt * table.chunk_size + 1);
+    if (!raw) {
+        bfi_codec_free_table(&table);
+        return BFI_E_MEM;
+    }
+    for (uint32_t i = 0, n = 0; i < table.chunk_cnt; ++i) {
+        const bfi_chunk_t *chunk = &table.chunks[i];
+
+        if (chunk->codec == BFI_CODEC_ZERO) {
+            continue;
+        }
+        ret = bfi_codec_decode_chunk(chunk, payload + chunk->offset,
+                                     raw + (uint64_t) n++ * table.chunk_size,
+                                     bfi_codec_chunk_raw_len(&table, i));
+        if (ret != BFI_E_OK) {
+            free(raw);
+            bfi_codec_free_table(&table);
+            return BFI_E_DELTA;
+        }
+    }
+
+    bfi_numa_drop_replicas(index);
+    for (uint32_t i = 0, n = 0; i < table.chunk_cnt; ++i) {
+        if (table.chunks[i].codec == BFI_CODEC_ZERO) {
+            continue;
+        }
+        bf_xor_table(index->bf, (uint64_t) i * table.chunk_size,
+                     (const unsigned char *) raw
+                     + (uint64_t) n++ * table.chunk_size,
+                     bfi_codec_chunk_raw_len(&table, i));
+    }
+    free(raw);
+    bfi_codec_free_table(&table);
+
+    bf_set_inserted_element_cnt(index->bf, header.item_cnt);
+    index->zone = zone;
+
+    return BFI_E_OK;
+}
@@ -38,83 +38,1074 @@
  */
 
 #include <string.h>
+#include <math.h>
 #include <stdint.h>
 
 #include <unistd.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <pthread.h>
 
 #include "bf_index_internal.h"
+#include "bf_index_file.h"
+#include "bf_crc.h"
+#include "bf_io.h"
+#include "bf_numa.h"
 #include "bloomf_wrapper.h"
 
 static uint16_t BFI_FILE_MAGIC = BFI_MAGIC;
 
+// Count of cached optimal parameters (see bfi_compute_parameters())
+#define BFI_PARAMS_CACHE_SIZE 16
+
+typedef struct bfi_params_cache {
+    unsigned long long int est_item_cnt;
+    double fp_prob;
+    unsigned int hash_cnt;
+    unsigned long long int table_size;
+} bfi_params_cache_t;
+
+static bfi_params_cache_t bfi_params_cache[BFI_PARAMS_CACHE_SIZE];
+static unsigned int bfi_params_cache_cnt = 0;
+static unsigned int bfi_params_cache_next = 0;
+static pthread_mutex_t bfi_params_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+const char *bfi_error_messages [] = {
+    "BFI info: OK.",
+    "BFI error: Unable to compute Bloom filter optimal parameters.",
+    "BFI error: Passed empty index.",
+    "BFI error: Store: Unable to open file for storing an index.",
+    "BFI error: Store: Unable to get an index binary representation.",
+    "BFI error: Store: Unable to write the magic.",
+    "BFI error: Store: Unable to write an index size.",
+    "BFI error: Store: Unable to write an index.",
+	"BFI error: Load: Unable to allocate memory.",
+	"BFI error: Load: Unable to open file for loading an index.",
+    "BFI error: Load: Unable to load an index from binary representation."\
+		"(because of corrupted file or different data type sizes).",
+    "BFI error: Load: Unable to read the magic.",
+    "BFI error: Load: Read bad magic.",
+    "BFI error: Load: Unable to read an index size.",
+    "BFI error: Load: Zero index size.",
+    "BFI error: Load: Unable to read an index",
+    "BFI error: Unable to allocate memory.",
+    "BFI error: Store: Unable to write a section table.",
+    "BFI error: Load: Unsupported index file format version.",
+    "BFI error: Load: Unable to read a section (corrupted file).",
+    "BFI error: Load: Required section is missing in the index file.",
+    "BFI error: Unknown engine or operation not supported by the engine.",
+    "BFI error: Range filter field is unknown, already attached or there is"\
+        " too many fields.",
+    "BFI error: Indexes are not of the same family (could not be merged).",
+    "BFI error: Index is too full to be folded to a summary.",
+    "BFI error: Catalog: Unable to read or write a catalog (corrupted file,"\
+        " unknown version or file system error).",
+    "BFI error: Delta: Corrupted delta of an index.",
+    "BFI error: Load: Checksum mismatch (corrupted file).",
+    "BFI error: Unable to lock an index in memory (see RLIMIT_MEMLOCK).",
+    "BFI error: Time slot out of range of the index.",
+    "BFI error: Postings: Unable to read or write a postings index"\
+        " (corrupted file or file system error).",
+    "BFI error: Quotient filter could not grow (no remainder bit is left).",
+};
+
 const char *bfi_get_error_msg(bfi_ecode_t ecode)
 {
     return bfi_error_messages[ecode];
 }
 
+uint32_t *bfi_compute_hashes(bloom_filter_h *bf, const unsigned char *buffer,
+                    size_t len, uint32_t *stack_hashes)
+{
+    uint32_t *hashes = stack_hashes;
+    size_t hash_cnt = bf_hash_count(bf);
+
+    if (hash_cnt > BFI_STACK_HASH_CNT) {
+        hashes = (uint32_t *) malloc(hash_cnt * sizeof(uint32_t));
+        if (!hashes) {
+            return NULL;
+        }
+    }
+    bf_compute_hashes(bf, buffer, &len, hashes);
+
+    return hashes;
+}
+
+
+uint32_t *bfi_compute_hashes_iov(bloom_filter_h *bf, const bfi_iovec_t *iov,
+                    size_t iov_cnt, uint32_t *stack_hashes)
+{
+    uint32_t *hashes = stack_hashes;
+    size_t hash_cnt = bf_hash_count(bf);
+
+    if (hash_cnt > BFI_STACK_HASH_CNT) {
+        hashes = (uint32_t *) malloc(hash_cnt * sizeof(uint32_t));
+        if (!hashes) {
+            return NULL;
+        }
+    }
+    if (iov_cnt == 1) {
+        // Contiguous key
+        bf_compute_hashes(bf, (const unsigned char *) iov[0].base, &iov[0].len,
+                          hashes);
+    } else {
+        bf_compute_hashes_iov(bf, iov, iov_cnt, hashes);
+    }
+
+    return hashes;
+}
+
+
+void bfi_free_hashes(uint32_t *hashes, uint32_t *stack_hashes)
+{
+    if (hashes != stack_hashes) {
+        free(hashes);
+    }
+}
+
+
+bloom_filter_h *bfi_new_empty_filter(bfi_engine_t engine)
+{
+    switch (engine) {
+    case BFI_ENGINE_STANDARD:
+        return new_bloom_filter();
+    case BFI_ENGINE_STABLE:
+        return new_stable_bloom_filter();
+    case BFI_ENGINE_TEMPORAL:
+        return new_temporal_bloom_filter();
+    case BFI_ENGINE_QUOTIENT:
+        return new_quotient_filter();
+    case BFI_ENGINE_REGISTER:
+        return new_register_bloom_filter();
+    default:
+        return NULL;
+    }
+}
+
+
+void bfi_params_init(bfi_params_t *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->engine = BFI_ENGINE_STANDARD;
+    params->est_item_cnt = 10000;
+    params->fp_prob = 0.0001;
+    params->stable_cell_max = 3;
+    params->stable_decrement_cnt = 0;
+    params->temporal_slot_cnt = 8;
+    params->quotient_growth_bits = 2;
+}
+
+
+bool bfi_compute_parameters(bloom_parameters_h *bp)
+{
+    unsigned long long int est_item_cnt = bp_get_proj_elem_cnt(bp);
+    double fp_prob = bp_get_false_pos_prob(bp);
+    bfi_params_cache_t *entry;
+    bool found = false;
+    unsigned int i;
+
+    if (bp_not(bp)) {
+        return false;
+    }
+
+    pthread_mutex_lock(&bfi_params_cache_lock);
+    for (i = 0; i < bfi_params_cache_cnt; ++i) {
+        entry = &bfi_params_cache[i];
+        if (entry->est_item_cnt == est_item_cnt
+                && entry->fp_prob == fp_prob) {
+            bp_set_optimal_parameters(bp, entry->hash_cnt, entry->table_size);
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&bfi_params_cache_lock);
+    if (found) {
+        return true;
+    }
+
+    // Computed without the lock, a concurrent miss only computes it twice
+    if (!bp_compute_optimal_parameters(bp)) {
+        return false;
+    }
+
+    pthread_mutex_lock(&bfi_params_cache_lock);
+    entry = &bfi_params_cache[bfi_params_cache_next];
+    entry->est_item_cnt = est_item_cnt;
+    entry->fp_prob = fp_prob;
+    bp_get_optimal_parameters(bp, &entry->hash_cnt, &entry->table_size);
+    bfi_params_cache_next = (bfi_params_cache_next + 1) % BFI_PARAMS_CACHE_SIZE;
+    if (bfi_params_cache_cnt < BFI_PARAMS_CACHE_SIZE) {
+        bfi_params_cache_cnt++;
+    }
+    pthread_mutex_unlock(&bfi_params_cache_lock);
+
+    return true;
+}
+
+
+/**
+ * \brief Compute quotient and remainder bits of a quotient filter
+ *
+ * \return Returns false if the filter would be too large.
+ */
+static bool bfi_quotient_bits(const bfi_params_t *params,
+                    unsigned int *quotient_bits, unsigned int *remainder_bits)
+{
+    unsigned int q = 3;
+    double r;
+
+    // Table is at most 75 % full for est_item_cnt items
+    while (q < 40 && (double) (1ULL << q) * 0.75 < params->est_item_cnt) {
+        ++q;
+    }
+    // False positive probability is about (load / 2^r)
+    r = params->fp_prob > 0.0 && params->fp_prob < 1.0
+        ? ceil(-log2(params->fp_prob)) : 1.0;
+    if ((double) (1ULL << q) * 0.75 < params->est_item_cnt
+            || params->quotient_growth_bits > 8
+            || r + params->quotient_growth_bits + q > 64) {
+        return false;
+    }
+
+    *quotient_bits = q;
+    *remainder_bits = (unsigned int) r + params->quotient_growth_bits;
+
+    return true;
+}
+
+
+double bfi_register_fp_prob(uint32_t bits_per_key, double load,
+                    double word_cnt)
+{
+    const double half = BFI_REGISTER_WORD_BITS / 2;
+    const uint32_t low_bits = (bits_per_key + 1) / 2;
+    const uint32_t high_bits = bits_per_key / 2;
+    double masks = high_bits ? (double) BFI_REGISTER_PATTERNS
+                               * BFI_REGISTER_PATTERNS : BFI_REGISTER_PATTERNS;
+    double fp_prob = 0.0;
+    double keys = exp(-load);           // Poisson probability of j keys
+    uint32_t max_keys = (uint32_t) (load + 10.0 * sqrt(load) + 20.0);
+
+    // The word takes upper bits of the 32-bit hash value
+    if (masks > 4294967296.0 / word_cnt) {
+        masks = 4294967296.0 / word_cnt;
+    }
+    for (uint32_t j = 0; j <= max_keys; ++j) {
+        // Bits of both halves of the mask are set by the other keys of the
+        // word or the mask is the same as of one of them
+        double bits = pow(1.0 - pow(1.0 - low_bits / half, j), low_bits)
+                      * pow(1.0 - pow(1.0 - high_bits / half, j), high_bits);
+        double other = pow(1.0 - 1.0 / masks, j);
+
+        fp_prob += keys * (1.0 - (1.0 - bits) * other);
+        keys *= load / (j + 1);
+    }
+
+    return fp_prob;
+}
+
+
+uint64_t bfi_register_table_size(uint64_t item_cnt, uint32_t bits_per_key,
+                    double fp_prob)
+{
+    double low = 0.0;
+    double high = BFI_REGISTER_WORD_BITS;
+    uint64_t words;
+
+    // The highest load of words (keys per word) meeting fp_prob
+    for (int i = 0; i < 64; ++i) {
+        double load = (low + high) / 2.0;
+
+        if (bfi_register_fp_prob(bits_per_key, load, item_cnt / load)
+                <= fp_prob) {
+            low = load;
+        } else {
+            high = load;
+        }
+    }
+    if (low <= 0.0 || (double) item_cnt / low > BFI_REGISTER_WORD_MAX) {
+        return 0;
+    }
+    words = (uint64_t) ceil((double) item_cnt / low);
+
+    return (words ? words : 1) * BFI_REGISTER_WORD_BITS;
+}
+
+
+/**
+ * \brief Plan bits per key and table size of a register-blocked filter
+ *
+ * The smallest table meeting fp_prob is used.
+ *
+ * \return Returns false if the table would be too large.
+ */
+static bool bfi_register_bits(const bfi_params_t *params,
+                    uint32_t *bits_per_key, uint64_t *table_size)
+{
+    if (params->hash_cnt || params->table_size) {
+        if (!params->hash_cnt || params->hash_cnt > BFI_REGISTER_KEY_BITS_MAX
+                || params->table_size == 0 || params->table_size
+                   > (uint64_t) BFI_REGISTER_WORD_MAX * BFI_REGISTER_WORD_BITS) {
+            return false;
+        }
+        *bits_per_key = params->hash_cnt;
+        *table_size = params->table_size;
+        return true;
+    }
+
+    *table_size = 0;
+    for (uint32_t k = 1; k <= BFI_REGISTER_KEY_BITS_MAX; ++k) {
+        uint64_t size = bfi_register_table_size(params->est_item_cnt, k,
+                                                params->fp_prob);
+
+        if (size && (*table_size == 0 || size < *table_size)) {
+            *bits_per_key = k;
+            *table_size = size;
+        }
+    }
+
+    return *table_size != 0;
+}
+
+
+/**
+ * \brief Allocate index structure for given engine and filter
+ */
+static bfi_index_t *bfi_new_index(bfi_engine_t engine, bloom_filter_h *bf)
+{
+    bfi_index_t *index = (bfi_index_t *) calloc(1, sizeof(bfi_index_t));
+
+    if (!index) {
+        if (bf) {
+            bf_delete_filter(bf);
+        }
+        return NULL;
+    }
+    index->engine = engine;
+    index->bf = bf;
+    bfi_zone_reset(&index->zone, true);
+
+    return index;
+}
+
+
+bfi_ecode_t bfi_init_index_params(bfi_index_ptr_t *index_ptr,
+                    const bfi_params_t *params)
+{
+    struct bloom_parameters_h *bp;
+    bloom_filter_h *bf;
+    bfi_index_t *index;
+
+    bp = new_bloom_parameters();
+    bp_set_false_pos_prob(bp, params->fp_prob);
+    bp_set_proj_elem_cnt(bp, params->est_item_cnt);
+
+    if (!bfi_compute_parameters(bp)){
+        del_bloom_parameters(bp);
+        return BFI_E_BP_COMP_PARAMS;
+    }
+    if (params->hash_cnt || params->table_size) {
+        if (!params->hash_cnt || params->table_size < 8) {
+            del_bloom_parameters(bp);
+            return BFI_E_BP_COMP_PARAMS;
+        }
+        // Table consists of whole bytes
+        bp_set_optimal_parameters(bp, params->hash_cnt,
+                                  (params->table_size + 7) / 8 * 8);
+    }
+
+    switch (params->engine) {
+    case BFI_ENGINE_STANDARD:
+        if (params->seed) {
+            bf = new_bloom_filter_family(bp, params->seed);
+        } else {
+            bf = new_bloom_filter_bp(bp);
+        }
+        break;
+    case BFI_ENGINE_STABLE:
+        bf = new_stable_bloom_filter_bp(bp, params->stable_cell_max,
+                                        params->stable_decrement_cnt);
+        break;
+    case BFI_ENGINE_TEMPORAL:
+        if (params->temporal_slot_cnt == 0 || params->temporal_slot_cnt > 16) {
+            del_bloom_parameters(bp);
+            return BFI_E_TIME_SLOT;
+        }
+        bf = new_temporal_bloom_filter_bp(bp, params->temporal_slot_cnt);
+        break;
+    case BFI_ENGINE_QUOTIENT: {
+        unsigned int quotient_bits;
+        unsigned int remainder_bits;
+
+        if (!bfi_quotient_bits(params, &quotient_bits, &remainder_bits)) {
+            del_bloom_parameters(bp);
+            return BFI_E_BP_COMP_PARAMS;
+        }
+        // Slots replace the table of the Bloom filter
+        bp_set_optimal_parameters(bp, 2, 8);
+        bf = new_quotient_filter_bp(bp, quotient_bits, remainder_bits);
+        break;
+    }
+    case BFI_ENGINE_REGISTER: {
+        uint32_t bits_per_key;
+        uint64_t table_size;
+
+        if (!bfi_register_bits(params, &bits_per_key, &table_size)) {
+            del_bloom_parameters(bp);
+            return BFI_E_BP_COMP_PARAMS;
+        }
+        // One hash value per key selects the word and the mask
+        bp_set_optimal_parameters(bp, 1, table_size);
+        bf = new_register_bloom_filter_bp(bp, bits_per_key);
+        break;
+    }
+    default:
+        del_bloom_parameters(bp);
+        return BFI_E_ENGINE;
+    }
+    del_bloom_parameters(bp);
+
+    index = bfi_new_index(params->engine, bf);
+    if (!index) {
+        return BFI_E_MEM;
+    }
+
+    // Optional count-min sketch (row per hash value of the filter)
+    if (params->cms_width && params->cms_depth) {
+        uint32_t depth = params->cms_depth;
+
+        if (depth > bf_hash_count(bf)) {
+            depth = (uint32_t) bf_hash_count(bf);
+        }
+        index->cms = new_count_min_sketch_wd(params->cms_width, depth,
+                                             params->cms_conservative);
+    }
+
+    *index_ptr = (bfi_index_ptr_t) index;
+
+    return BFI_E_OK;
+}
+
+
 bfi_ecode_t bfi_init_index(bfi_index_ptr_t *index_ptr, uint64_t est_item_cnt,
 							double fp_prob)
 {
-    struct bloom_parameters_h *bp = new_bloom_parameters();
+    bfi_params_t params;
 
-    bp_set_false_pos_prob(bp, fp_prob);
-    bp_set_proj_elem_cnt(bp, est_item_cnt);
+    bfi_params_init(&params);
+    params.est_item_cnt = est_item_cnt;
+    params.fp_prob = fp_prob;
+
+    return bfi_init_index_params(index_ptr, &params);
+}
+
+
+bfi_ecode_t bfi_family_create(bfi_family_t *family, const bfi_params_t *params)
+{
+    bfi_index_ptr_t index = NULL;
+    bfi_params_t family_params = *params;
+    bfi_ecode_t ret;
+
+    if (params->engine != BFI_ENGINE_STANDARD) {
+        return BFI_E_ENGINE;
+    }
 
-    if (!bp_compute_optimal_parameters(bp)){
+    // Parameters are taken from a (temporary) filter, so the family is exactly
+    // the same as of bfi_init_index_params() indexes
+    family_params.cms_width = 0;
+    family_params.cms_depth = 0;
+    ret = bfi_init_index_params(&index, &family_params);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+    ret = bfi_index_family(index, family);
+    bfi_destroy_index(&index);
+
+    return ret;
+}
+
+
+bfi_ecode_t bfi_init_index_family(bfi_index_ptr_t *index_ptr,
+                    const bfi_family_t *family)
+{
+    struct bloom_parameters_h *bp;
+    bfi_index_t *index;
+
+    if (family->engine != BFI_ENGINE_STANDARD
+            || family->hash != BFI_HASH_AP) {
+        return BFI_E_ENGINE;
+    }
+    // Table consists of whole bytes (as of bfi_init_index_params())
+    if (family->hash_cnt == 0 || family->hash_cnt > BFI_FAMILY_HASH_CNT_MAX
+            || family->table_size < 8 || family->table_size % 8 != 0) {
         return BFI_E_BP_COMP_PARAMS;
     }
-    *index_ptr = (bfi_index_ptr_t) new_bloom_filter_bp(bp);
 
+    bp = new_bloom_parameters();
+    bp_set_false_pos_prob(bp, family->fp_prob);
+    bp_set_proj_elem_cnt(bp, family->est_item_cnt);
+    bp_set_optimal_parameters(bp, family->hash_cnt, family->table_size);
+    index = bfi_new_index(family->engine,
+                          new_bloom_filter_family(bp, family->seed));
     del_bloom_parameters(bp);
+    if (!index) {
+        return BFI_E_MEM;
+    }
+
+    *index_ptr = (bfi_index_ptr_t) index;
+
+    return BFI_E_OK;
+}
+
+
+/**
+ * \brief Fill family descriptor from parameters of a filter
+ */
+static void bfi_filter_family(bloom_filter_h *bf, bfi_engine_t engine,
+                    bfi_family_t *family)
+{
+    unsigned int hash_cnt;
+    unsigned long long int table_size;
+    unsigned long long int seed;
+    unsigned long long int est_item_cnt;
+
+    bf_get_parameters(bf, &hash_cnt, &table_size, &seed, &est_item_cnt,
+                      &family->fp_prob);
+    family->engine = engine;
+    family->hash = BFI_HASH_AP;
+    family->seed = seed;
+    family->table_size = table_size;
+    family->hash_cnt = hash_cnt;
+    family->est_item_cnt = est_item_cnt;
+}
+
+
+bfi_ecode_t bfi_index_family(bfi_index_ptr_t index_ptr, bfi_family_t *family)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+
+    bfi_filter_family(index->bf, index->engine, family);
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_read_family(char *filename, bfi_family_t *family)
+{
+    FILE *bf_file_ptr;
+    bloom_filter_h *bf;
+    uint16_t engine;
+    bfi_section_t filter_section;
+    bfi_ecode_t ret;
+
+    bf_file_ptr = fopen(filename, "rb");
+    if (!bf_file_ptr){
+        return BFI_E_LOAD_FILE_ERR;
+    }
+
+    ret = bfi_file_read_filter_header(bf_file_ptr, &engine, &bf,
+                                      &filter_section);
+    fclose(bf_file_ptr);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+
+    bfi_filter_family(bf, (bfi_engine_t) engine, family);
+    bf_delete_filter(bf);
 
     return BFI_E_OK;
 }
 
 
+bool bfi_family_compatible(const bfi_family_t *a, const bfi_family_t *b)
+{
+    return a->engine == b->engine && a->hash == b->hash
+           && a->seed == b->seed && a->table_size == b->table_size
+           && a->hash_cnt == b->hash_cnt;
+}
+
+
+/**
+ * \brief Find range filter of a field
+ */
+static bloom_filter_h *bfi_find_range(bfi_index_t *index, uint16_t field_id)
+{
+    for (uint16_t i = 0; i < index->range_cnt; ++i) {
+        if (index->ranges[i].field_id == field_id) {
+            return index->ranges[i].rbf;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * \brief Merge count-min sketch and range filters of an index into another
+ *
+ * Sketch and range filters of dst which could not be merged (missing in src
+ * or of other parameters) are dropped, so queries of them report "unknown"
+ * instead of missing items of src.
+ */
+static void bfi_merge_sidecars(bfi_index_t *dst, bfi_index_t *src)
+{
+    bfi_family_t dst_family;
+    bfi_family_t src_family;
+    unsigned int dst_key_bits, src_key_bits;
+    unsigned int max_probes;
+    uint16_t kept = 0;
+
+    // Rows of both sketches are updated by the same hash values
+    if (dst->cms && (!src->cms || cms_merge(dst->cms, src->cms) != 0)) {
+        cms_delete_sketch(dst->cms);
+        dst->cms = NULL;
+    }
+
+    for (uint16_t i = 0; i < dst->range_cnt; ++i) {
+        bfi_range_t range = dst->ranges[i];
+        bloom_filter_h *src_rbf = bfi_find_range(src, range.field_id);
+
+        if (src_rbf) {
+            bfi_filter_family(range.rbf, BFI_ENGINE_STANDARD, &dst_family);
+            bfi_filter_family(src_rbf, BFI_ENGINE_STANDARD, &src_family);
+            rbf_get_parameters(range.rbf, &dst_key_bits, &max_probes);
+            rbf_get_parameters(src_rbf, &src_key_bits, &max_probes);
+        }
+        if (!src_rbf || dst_key_bits != src_key_bits
+                || !bfi_family_compatible(&dst_family, &src_family)) {
+            bf_delete_filter(range.rbf);
+            continue;
+        }
+        bf_union(range.rbf, src_rbf);
+        dst->ranges[kept++] = range;
+    }
+    dst->range_cnt = kept;
+}
+
+
+bfi_ecode_t bfi_merge_index(bfi_index_ptr_t dst_ptr, bfi_index_ptr_t src_ptr)
+{
+    bfi_index_t *dst = (bfi_index_t *) dst_ptr;
+    bfi_index_t *src = (bfi_index_t *) src_ptr;
+    bfi_family_t dst_family;
+    bfi_family_t src_family;
+
+    if (!dst || !src) {
+        return BFI_E_NO_INDEX;
+    }
+    if (dst->engine == BFI_ENGINE_QUOTIENT) {
+        // Tables of different sizes are merged (fingerprints are the same)
+        if (src->engine != BFI_ENGINE_QUOTIENT
+                || qf_merge(dst->bf, src->bf) != 0) {
+            return BFI_E_FAMILY;
+        }
+        bfi_zone_merge(&dst->zone, &src->zone);
+        bfi_merge_sidecars(dst, src);
+        return BFI_E_OK;
+    }
+    if (dst->engine != BFI_ENGINE_STANDARD) {
+        return BFI_E_ENGINE;
+    }
+
+    bfi_filter_family(dst->bf, dst->engine, &dst_family);
+    bfi_filter_family(src->bf, src->engine, &src_family);
+    if (!bfi_family_compatible(&dst_family, &src_family)) {
+        return BFI_E_FAMILY;
+    }
+
+    // Inserted element counts could not be simply added (indexes share
+    // items), so the count is estimated from the merged filter
+    bfi_numa_drop_replicas(dst);
+    bf_union(dst->bf, src->bf);
+    bfi_zone_merge(&dst->zone, &src->zone);
+    bfi_merge_sidecars(dst, src);
+    bf_set_inserted_element_cnt(dst->bf,
+                    (uint64_t) (bf_estimated_element_cnt(dst->bf) + 0.5));
+
+    return BFI_E_OK;
+}
+
+
+/**
+ * \brief Estimate count of items of a filter from its count of set bits
+ */
+static double bfi_bits_to_items(uint64_t set_bits, uint64_t table_size,
+                    uint32_t hash_cnt)
+{
+    // Full filter would give infinity
+    double fill = set_bits < table_size ? (double) set_bits / table_size
+                                        : 1.0 - 0.5 / table_size;
+
+    return -((double) table_size / hash_cnt) * log(1.0 - fill);
+}
+
+
+bfi_ecode_t bfi_index_similarity(bfi_index_ptr_t a_ptr, bfi_index_ptr_t b_ptr,
+                    double *jaccard)
+{
+    bfi_index_t *a = (bfi_index_t *) a_ptr;
+    bfi_index_t *b = (bfi_index_t *) b_ptr;
+    bfi_family_t a_family;
+    bfi_family_t b_family;
+    const unsigned char *a_table;
+    const unsigned char *b_table;
+    uint64_t len;
+    uint64_t a_bits = 0;
+    uint64_t b_bits = 0;
+    uint64_t union_bits = 0;
+    double a_items;
+    double b_items;
+    double union_items;
+
+    *jaccard = 0.0;
+    if (!a || !b) {
+        return BFI_E_NO_INDEX;
+    }
+    if (a->engine != BFI_ENGINE_STANDARD) {
+        return BFI_E_ENGINE;
+    }
+
+    bfi_filter_family(a->bf, a->engine, &a_family);
+    bfi_filter_family(b->bf, b->engine, &b_family);
+    if (!bfi_family_compatible(&a_family, &b_family)) {
+        return BFI_E_FAMILY;
+    }
+
+    a_table = bf_table(a->bf, &len);
+    b_table = bf_table(b->bf, &len);
+    for (uint64_t i = 0; i < len; i += sizeof(uint64_t)) {
+        uint64_t a_word = 0;
+        uint64_t b_word = 0;
+        size_t cnt = len - i < sizeof(uint64_t) ? len - i : sizeof(uint64_t);
+
+        memcpy(&a_word, a_table + i, cnt);
+        memcpy(&b_word, b_table + i, cnt);
+        a_bits += __builtin_popcountll(a_word);
+        b_bits += __builtin_popcountll(b_word);
+        union_bits += __builtin_popcountll(a_word | b_word);
+    }
+    if (union_bits == 0) {
+        // Both indexes are empty
+        *jaccard = 1.0;
+        return BFI_E_OK;
+    }
+
+    // |A & B| = |A| + |B| - |A | B|
+    a_items = bfi_bits_to_items(a_bits, a_family.table_size,
+                                a_family.hash_cnt);
+    b_items = bfi_bits_to_items(b_bits, a_family.table_size,
+                                a_family.hash_cnt);
+    union_items = bfi_bits_to_items(union_bits, a_family.table_size,
+                                    a_family.hash_cnt);
+    *jaccard = (a_items + b_items - union_items) / union_items;
+    if (*jaccard < 0.0) {
+        *jaccard = 0.0;
+    } else if (*jaccard > 1.0) {
+        *jaccard = 1.0;
+    }
+
+    return BFI_E_OK;
+}
+
+
+bfi_engine_t bfi_index_engine(bfi_index_ptr_t index_ptr)
+{
+    if (!index_ptr) {
+        return BFI_ENGINE_STANDARD;
+    }
+
+    return ((bfi_index_t *) index_ptr)->engine;
+}
+
+
 void bfi_destroy_index(bfi_index_ptr_t *index_ptr)
 {
-    if (index_ptr) {
-        bf_delete_filter(*index_ptr);
+    bfi_index_t *index;
+
+    if (!index_ptr || !*index_ptr) {
+        return;
+    }
+    index = (bfi_index_t *) *index_ptr;
+
+    bfi_io_unlock_index(index);
+    bfi_numa_drop_replicas(index);
+    if (index->bf) {
+        bf_delete_filter(index->bf);
     }
-    index_ptr = NULL;
+    if (index->cms) {
+        cms_delete_sketch(index->cms);
+    }
+    for (uint16_t i = 0; i < index->range_cnt; ++i) {
+        bf_delete_filter(index->ranges[i].rbf);
+    }
+    free(index);
+
+    *index_ptr = NULL;
 }
 
 
 bfi_ecode_t bfi_add_addr_index(bfi_index_ptr_t index_ptr,
                     const unsigned char *buffer, const size_t len)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    uint32_t stack_hashes[BFI_STACK_HASH_CNT];
+    uint32_t *hashes;
+
+	if (!index) {
+    	return BFI_E_NO_INDEX;
+	}
+
+    bfi_numa_drop_replicas(index);
+    bfi_zone_update(&index->zone, buffer, len);
+    if (!index->cms) {
+        bf_containsinsert(index->bf, buffer, &len);
+        return BFI_E_OK;
+    }
+
+    // Hash values are computed once for both the filter and the sketch
+    hashes = bfi_compute_hashes(index->bf, buffer, len, stack_hashes);
+    if (!hashes) {
+        return BFI_E_MEM;
+    }
+    bf_containsinsert_hashes(index->bf, hashes);
+    cms_update_hashes(index->cms, hashes);
+    bfi_free_hashes(hashes, stack_hashes);
+
+	return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_add_addr_iov(bfi_index_ptr_t index_ptr,
+                    const bfi_iovec_t *iov, size_t iov_cnt)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    uint32_t stack_hashes[BFI_STACK_HASH_CNT];
+    uint32_t *hashes;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+
+    bfi_numa_drop_replicas(index);
+    bfi_zone_update_iov(&index->zone, iov, iov_cnt);
+    hashes = bfi_compute_hashes_iov(index->bf, iov, iov_cnt, stack_hashes);
+    if (!hashes) {
+        return BFI_E_MEM;
+    }
+    bf_containsinsert_hashes(index->bf, hashes);
+    if (index->cms) {
+        cms_update_hashes(index->cms, hashes);
+    }
+    bfi_free_hashes(hashes, stack_hashes);
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_clear_index(bfi_index_ptr_t index_ptr)
 {
 	if (!index_ptr) {
     	return BFI_E_NO_INDEX;
 	}
 
-	bf_containsinsert(index_ptr, buffer, &len);
+    bfi_numa_drop_replicas((bfi_index_t *) index_ptr);
+    bf_clear(((bfi_index_t *) index_ptr)->bf);
+    if (((bfi_index_t *) index_ptr)->cms) {
+        cms_clear(((bfi_index_t *) index_ptr)->cms);
+    }
+    for (uint16_t i = 0; i < ((bfi_index_t *) index_ptr)->range_cnt; ++i) {
+        bf_clear(((bfi_index_t *) index_ptr)->ranges[i].rbf);
+    }
+    bfi_zone_reset(&((bfi_index_t *) index_ptr)->zone, true);
+
+    return BFI_E_OK;
+}
+
+
+bool bfi_addr_is_stored(bfi_index_ptr_t index_ptr, const unsigned char *buffer,
+                    const size_t len)
+{
+	if (index_ptr) {
+        // Zone map rejects addresses out of stored prefixes cheaply
+        if (!bfi_zone_may_contain(&((bfi_index_t *) index_ptr)->zone, buffer,
+                                  len)) {
+            return false;
+        }
+    	return bf_contains(bfi_local_filter((bfi_index_t *) index_ptr), buffer,
+                           &len);
+	}
+
+	return false;
+}
+
+
+bool bfi_addr_is_stored_iov(bfi_index_ptr_t index_ptr, const bfi_iovec_t *iov,
+                    size_t iov_cnt)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    uint32_t stack_hashes[BFI_STACK_HASH_CNT];
+    uint32_t *hashes;
+    bloom_filter_h *bf;
+    bool stored;
+
+    if (!index || !bfi_zone_may_contain_iov(&index->zone, iov, iov_cnt)) {
+        return false;
+    }
+
+    bf = bfi_local_filter(index);
+    hashes = bfi_compute_hashes_iov(bf, iov, iov_cnt, stack_hashes);
+    if (!hashes) {
+        return false;
+    }
+    stored = bf_contains_hashes(bf, hashes);
+    bfi_free_hashes(hashes, stack_hashes);
+
+    return stored;
+}
+
+
+bfi_ecode_t bfi_resize_index(bfi_index_ptr_t index_ptr)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+    if (index->engine != BFI_ENGINE_QUOTIENT) {
+        return BFI_E_ENGINE;
+    }
+
+    return qf_resize(index->bf) == 0 ? BFI_E_OK : BFI_E_RESIZE;
+}
+
+
+bfi_ecode_t bfi_set_time_slot(bfi_index_ptr_t index_ptr, unsigned int slot)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+    if (index->engine != BFI_ENGINE_TEMPORAL) {
+        return BFI_E_ENGINE;
+    }
+
+    return tbf_set_slot(index->bf, slot) == 0 ? BFI_E_OK : BFI_E_TIME_SLOT;
+}
+
+
+uint32_t bfi_addr_slots(bfi_index_ptr_t index_ptr, const unsigned char *buffer,
+                    const size_t len)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+
+    if (!index || !bfi_zone_may_contain(&index->zone, buffer, len)) {
+        return 0;
+    }
+    if (index->engine != BFI_ENGINE_TEMPORAL) {
+        return bf_contains(bfi_local_filter(index), buffer, &len) ? 1 : 0;
+    }
+
+    return tbf_slots(index->bf, buffer, len);
+}
+
+
+uint64_t bfi_estimate_count(bfi_index_ptr_t index_ptr,
+                    const unsigned char *buffer, const size_t len)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    uint32_t stack_hashes[BFI_STACK_HASH_CNT];
+    uint32_t *hashes;
+    uint64_t cnt;
+
+    if (!index || !index->cms
+            || !bfi_zone_may_contain(&index->zone, buffer, len)) {
+        return 0;
+    }
+
+    hashes = bfi_compute_hashes(index->bf, buffer, len, stack_hashes);
+    if (!hashes) {
+        return 0;
+    }
+    cnt = cms_estimate_hashes(index->cms, hashes);
+    bfi_free_hashes(hashes, stack_hashes);
+
+    return cnt;
+}
+
+
+bfi_ecode_t bfi_range_attach(bfi_index_ptr_t index_ptr, uint16_t field_id,
+                    unsigned int key_bits, uint64_t est_item_cnt,
+                    double fp_prob)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    struct bloom_parameters_h *bp;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+    if (index->range_cnt == BFI_RANGE_MAX || bfi_find_range(index, field_id)
+            || key_bits == 0 || key_bits > 64) {
+        return BFI_E_RANGE_FIELD;
+    }
+
+    // Every value is inserted at every level of the dyadic interval tree
+    bp = new_bloom_parameters();
+    bp_set_false_pos_prob(bp, fp_prob);
+    bp_set_proj_elem_cnt(bp, est_item_cnt * key_bits);
+    if (!bfi_compute_parameters(bp)){
+        del_bloom_parameters(bp);
+        return BFI_E_BP_COMP_PARAMS;
+    }
+
+    index->ranges[index->range_cnt].field_id = field_id;
+    index->ranges[index->range_cnt].rbf = new_range_bloom_filter_bp(bp,
+                                                                    key_bits);
+    index->range_cnt++;
+    del_bloom_parameters(bp);
 
-	return BFI_E_OK;
+    return BFI_E_OK;
 }
 
 
-bfi_ecode_t bfi_clear_index(bfi_index_ptr_t index_ptr)
+bfi_ecode_t bfi_range_add(bfi_index_ptr_t index_ptr, uint16_t field_id,
+                    uint64_t value)
 {
-	if (!index_ptr) {
-    	return BFI_E_NO_INDEX;
-	}
+    bloom_filter_h *rbf;
+
+    if (!index_ptr) {
+        return BFI_E_NO_INDEX;
+    }
+    rbf = bfi_find_range((bfi_index_t *) index_ptr, field_id);
+    if (!rbf) {
+        return BFI_E_RANGE_FIELD;
+    }
 
-    bf_clear(index_ptr);
+    rbf_insert_key(rbf, value);
 
     return BFI_E_OK;
 }
 
 
-bool bfi_addr_is_stored(bfi_index_ptr_t index_ptr, const unsigned char *buffer,
-                    const size_t len)
+bool bfi_range_may_contain(bfi_index_ptr_t index_ptr, uint16_t field_id,
+                    uint64_t low, uint64_t high)
 {
-	if (index_ptr) {
-    	return bf_contains(index_ptr, buffer, &len);
-	}
+    bloom_filter_h *rbf;
 
-	return false;
+    if (!index_ptr) {
+        return false;
+    }
+    rbf = bfi_find_range((bfi_index_t *) index_ptr, field_id);
+    if (!rbf) {
+        // Nothing is known about the field
+        return true;
+    }
+
+    return rbf_range_may_contain(rbf, low, high);
 }
 
 
@@ -123,21 +1114,54 @@ uint64_t bfi_stored_item_cnt(bfi_index_ptr_t index_ptr){
 		return 0;
 	}
 
-    return bf_get_inserted_element_cnt(index_ptr);
+    return bf_get_inserted_element_cnt(((bfi_index_t *) index_ptr)->bf);
 }
 
 
-bfi_ecode_t bfi_store_index(bfi_index_ptr_t index_ptr, char *filename)
+uint64_t bfi_index_size(bfi_index_ptr_t index_ptr)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    uint64_t size = 0;
+    uint64_t len;
+
+    if (!index) {
+        return 0;
+    }
+
+    if (index->bf) {
+        bf_table(index->bf, &len);
+        size += len;
+    }
+    // Nodes without own replica share the filter
+    size += index->replica_cnt * sizeof(bloom_filter_h *);
+    for (uint32_t node = 0; node < index->replica_cnt; ++node) {
+        if (index->replicas[node] != index->bf) {
+            bf_table(index->replicas[node], &len);
+            size += len;
+        }
+    }
+    for (uint16_t i = 0; i < index->range_cnt; ++i) {
+        bf_table(index->ranges[i].rbf, &len);
+        size += len;
+    }
+
+    return size;
+}
+
+
+/**
+ * \brief Store index in version 1 file format (single Bloom filter)
+ *
+ * Size and checksum of the written file are filled in to stored (if it is
+ * not NULL).
+ */
+static bfi_ecode_t bfi_store_index_v1(bloom_filter_h *bf, char *filename,
+                    uint32_t io_policy, bfi_stored_t *stored)
 {
     uint32_t index_len;
     char *bf_bytes;
     FILE *bf_file_ptr;
 
-    if (!index_ptr){
-        // nothing to store
-        return BFI_E_NO_INDEX;
-    }
-
 	// Open file, mode: write binary
     bf_file_ptr = fopen(filename, "wb");
 
@@ -146,39 +1170,957 @@ bfi_ecode_t bfi_store_index(bfi_index_ptr_t index_ptr, char *filename)
     }
 
     // Get filter header and filter itself
-    index_len = bf_get_filter_as_bytes(index_ptr, &bf_bytes);
+    index_len = bf_get_filter_as_bytes(bf, &bf_bytes);
     if (index_len == 0){
+        fclose(bf_file_ptr);
         return BFI_E_STO_BYTES;
     }
 
     // Write magic (to provide file format and endianity check in loading phase)
     if (fwrite(&BFI_FILE_MAGIC, sizeof(uint16_t), 1, bf_file_ptr) != 1){
+        fclose(bf_file_ptr);
+        bf_clear_bytes(bf, &bf_bytes);
         return BFI_E_STO_MAGIC;
     }
 
 	// Write length of the index (size of byte array)
     if (fwrite(&index_len, sizeof(uint32_t), 1, bf_file_ptr) != 1){
+        fclose(bf_file_ptr);
+        bf_clear_bytes(bf, &bf_bytes);
         return BFI_E_STO_IDX_LEN;
     }
 
     // Write Bloom filter header and filter array
     if (fwrite(bf_bytes, sizeof(char), index_len, bf_file_ptr) != index_len){
+        fclose(bf_file_ptr);
+        bf_clear_bytes(bf, &bf_bytes);
         return BFI_E_STO_INDEX;
     }
 
-    fclose(bf_file_ptr);
+    bfi_io_close(bf_file_ptr, io_policy, true);
+
+    if (stored) {
+        stored->checksum = bfi_crc32c(0, &BFI_FILE_MAGIC, sizeof(uint16_t));
+        stored->checksum = bfi_crc32c(stored->checksum, &index_len,
+                                      sizeof(uint32_t));
+        stored->checksum = bfi_crc32c(stored->checksum, bf_bytes, index_len);
+        stored->file_size = sizeof(uint16_t) + sizeof(uint32_t) + index_len;
+    }
 
-    bf_clear_bytes(index_ptr, &bf_bytes);
+    bf_clear_bytes(bf, &bf_bytes);
 
     return BFI_E_OK;
 }
 
 
-bfi_ecode_t bfi_load_index(bfi_index_ptr_t *index_ptr, char *filename)
+/* BFI_SEC_STABLE section format:
+ * +---------------------------------------------------------------------+
+ * | u32: cell max | u64: decrement count | u64: random generator state  |
+ * +---------------------------------------------------------------------+
+ */
+#define BFI_STABLE_SEC_LEN (sizeof(uint32_t) + 2 * sizeof(uint64_t))
+
+/* BFI_SEC_TEMPORAL section format:
+ * +---------------------------------------------------------------------+
+ * | u32: count of time slots | u32: current time slot                   |
+ * +---------------------------------------------------------------------+
+ */
+#define BFI_TEMPORAL_SEC_LEN (2 * sizeof(uint32_t))
+
+/* BFI_SEC_QUOTIENT section format:
+ * +---------------------------------------------------------------------+
+ * | u32: quotient bits | u32: remainder bits                            |
+ * +---------------------------------------------------------------------+
+ */
+#define BFI_QUOTIENT_SEC_LEN (2 * sizeof(uint32_t))
+
+/* BFI_SEC_REGISTER section format:
+ * +---------------------------------------------------------------------+
+ * | u32: bits per key | u32: count of masks                             |
+ * +---------------------------------------------------------------------+
+ */
+#define BFI_REGISTER_SEC_LEN (2 * sizeof(uint32_t))
+
+/**
+ * \brief Set parameters of a register-blocked filter by BFI_SEC_REGISTER
+ *    section payload (masks are generated again from the seed of the filter)
+ */
+static bfi_ecode_t bfi_register_from_bytes(bloom_filter_h *bf,
+                    const char *buff, uint64_t len)
+{
+    uint32_t bits_per_key;
+    uint32_t pattern_cnt;
+
+    if (len != BFI_REGISTER_SEC_LEN) {
+        return BFI_E_LOAD_SECTION;
+    }
+    memcpy(&bits_per_key, buff, sizeof(bits_per_key));
+    memcpy(&pattern_cnt, buff + sizeof(bits_per_key), sizeof(pattern_cnt));
+    if (pattern_cnt != BFI_REGISTER_PATTERNS
+            || rgbf_set_parameters(bf, bits_per_key) != 0) {
+        return BFI_E_LOAD_SECTION;
+    }
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_register_read_file(FILE *file_ptr, bloom_filter_h *bf)
+{
+    bfi_file_header_t header;
+    bfi_section_t *sections;
+    const bfi_section_t *sec;
+    char *payload = NULL;
+    uint64_t payload_len;
+    bfi_ecode_t ret;
+
+    rewind(file_ptr);
+    ret = bfi_file_read_toc(file_ptr, &header, &sections);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+    sec = bfi_file_find_section(sections, header.section_cnt,
+                                BFI_SEC_REGISTER);
+    if (!sec) {
+        ret = BFI_E_LOAD_NO_SECTION;
+    } else {
+        ret = bfi_file_read_section(file_ptr, sec, &payload, &payload_len);
+        if (ret == BFI_E_OK) {
+            ret = bfi_register_from_bytes(bf, payload, payload_len);
+        }
+    }
+    free(payload);
+    free(sections);
+
+    return ret;
+}
+
+
+/* BFI_SEC_RANGE section format:
+ * +---------------------------------------------------------------------+
+ * | u16: field id | u16: key bits | u32: max probes                     |
+ * | range filter (get_filter_as_bytes() format)                         |
+ * +---------------------------------------------------------------------+
+ */
+#define BFI_RANGE_SEC_HDR_LEN (2 * sizeof(uint16_t) + sizeof(uint32_t))
+
+/**
+ * \brief Get range filter as BFI_SEC_RANGE section payload
+ *
+ * \return Returns length of the payload (free() it) or 0 on error.
+ */
+static uint64_t bfi_range_as_bytes(const bfi_range_t *range, char **buff)
+{
+    unsigned int key_bits;
+    unsigned int max_probes;
+    uint16_t u16;
+    uint32_t u32;
+    uint32_t bf_len;
+    char *bf_bytes;
+
+    bf_len = bf_get_filter_as_bytes(range->rbf, &bf_bytes);
+    if (bf_len == 0) {
+        return 0;
+    }
+    *buff = (char *) malloc(BFI_RANGE_SEC_HDR_LEN + bf_len);
+    if (!*buff) {
+        bf_clear_bytes(range->rbf, &bf_bytes);
+        return 0;
+    }
+
+    rbf_get_parameters(range->rbf, &key_bits, &max_probes);
+    memcpy(*buff, &range->field_id, sizeof(uint16_t));
+    u16 = (uint16_t) key_bits;
+    memcpy(*buff + sizeof(uint16_t), &u16, sizeof(uint16_t));
+    u32 = max_probes;
+    memcpy(*buff + 2 * sizeof(uint16_t), &u32, sizeof(uint32_t));
+    memcpy(*buff + BFI_RANGE_SEC_HDR_LEN, bf_bytes, bf_len);
+    bf_clear_bytes(range->rbf, &bf_bytes);
+
+    return BFI_RANGE_SEC_HDR_LEN + bf_len;
+}
+
+
+/**
+ * \brief Re-create range filter from BFI_SEC_RANGE section payload
+ */
+static bfi_ecode_t bfi_range_from_bytes(bfi_index_t *index, const char *buff,
+                    uint64_t len)
+{
+    bfi_range_t *range;
+    uint16_t key_bits;
+    uint32_t max_probes;
+    int load_ret;
+
+    if (len <= BFI_RANGE_SEC_HDR_LEN
+            || len - BFI_RANGE_SEC_HDR_LEN > UINT32_MAX) {
+        return BFI_E_LOAD_SECTION;
+    }
+    if (index->range_cnt == BFI_RANGE_MAX) {
+        return BFI_E_RANGE_FIELD;
+    }
+
+    range = &index->ranges[index->range_cnt];
+    memcpy(&range->field_id, buff, sizeof(uint16_t));
+    memcpy(&key_bits, buff + sizeof(uint16_t), sizeof(uint16_t));
+    memcpy(&max_probes, buff + 2 * sizeof(uint16_t), sizeof(uint32_t));
+    if (key_bits == 0 || key_bits > 64) {
+        return BFI_E_LOAD_SECTION;
+    }
+
+    range->rbf = new_range_bloom_filter();
+    index->range_cnt++;
+    load_ret = bf_load_filter_from_bytes(range->rbf,
+                    buff + BFI_RANGE_SEC_HDR_LEN,
+                    (uint32_t) (len - BFI_RANGE_SEC_HDR_LEN));
+    if (load_ret != 0) {
+        return load_ret == BFI_E_LOAD_MEM ? BFI_E_LOAD_MEM : BFI_E_LOAD_BYTES;
+    }
+    rbf_set_parameters(range->rbf, key_bits, max_probes);
+
+    return BFI_E_OK;
+}
+
+/**
+ * \brief Store index in version 2 file format (sections)
+ */
+static bfi_ecode_t bfi_store_index_v2(bfi_index_t *index, char *filename,
+                    const bfi_store_opts_t *opts, bfi_stored_t *stored)
+{
+    bfi_section_t sections[BFI_SECTION_MAX];
+    const char *payloads[BFI_SECTION_MAX];
+    char *encoded[BFI_SECTION_MAX] = { NULL };
+    char stable_bytes[BFI_STABLE_SEC_LEN];
+    char temporal_bytes[BFI_TEMPORAL_SEC_LEN];
+    char quotient_bytes[BFI_QUOTIENT_SEC_LEN];
+    char register_bytes[BFI_REGISTER_SEC_LEN];
+    uint16_t section_cnt = 0;
+    uint16_t bloom_sec = 0;
+    const char *bf_header;
+    char *header_bytes;
+    uint32_t bf_header_len;
+    const char *bf_body;
+    uint64_t bf_body_len;
+    char *checksum_bytes = NULL;
+    uint16_t checksum_sec = 0;
+    uint32_t *part_crcs = NULL;
+    uint64_t part_cnt;
+    uint32_t align = 0;
+    int direct_fd = -1;
+    char *cms_bytes = NULL;
+    char *range_bytes[BFI_RANGE_MAX] = { NULL };
+    char *summary_bytes = NULL;
+    uint64_t summary_len = 0;
+    char meta_bytes[BFI_META_SEC_LEN];
+    char zone_bytes[BFI_ZONE_SEC_LEN];
+    FILE *bf_file_ptr;
+    bfi_ecode_t ret;
+
+    // Filter itself, the header and the table are written by parts in
+    // parallel after other sections (the table could be larger than 4 GiB)
+    header_bytes = (char *) malloc(bf_header_length(index->bf));
+    if (!header_bytes) {
+        return BFI_E_MEM;
+    }
+    bf_header_len = bf_get_header_as_bytes(index->bf, header_bytes);
+    bf_header = header_bytes;
+    bf_body = (const char *) bf_table(index->bf, &bf_body_len);
+    sections[section_cnt].type = BFI_SEC_BLOOM;
+    sections[section_cnt].encoding = BFI_ENC_RAW;
+    sections[section_cnt].length = bf_header_len + bf_body_len;
+    if (opts->encoding == BFI_STORE_COMPRESSED) {
+        uint64_t length = bfi_codec_encode_parts(bf_header, bf_header_len,
+                                                 bf_body, bf_body_len,
+                                                 opts->chunk_size,
+                                                 &encoded[section_cnt]);
+
+        if (length != 0 && length < sections[section_cnt].length) {
+            sections[section_cnt].encoding = BFI_ENC_CHUNKED;
+            sections[section_cnt].length = length;
+        } else {
+            // Not worth it, raw filter is kept
+            free(encoded[section_cnt]);
+            encoded[section_cnt] = NULL;
+        }
+    }
+    payloads[section_cnt++] = NULL;
+
+    // Engine specific parameters
+    if (index->engine == BFI_ENGINE_STABLE) {
+        unsigned int cell_max;
+        unsigned long long int decrement_cnt;
+        unsigned long long int rng_state;
+        uint32_t u32;
+        uint64_t u64;
+
+        sbf_get_parameters(index->bf, &cell_max, &decrement_cnt, &rng_state);
+        u32 = cell_max;
+        memcpy(stable_bytes, &u32, sizeof(u32));
+        u64 = decrement_cnt;
+        memcpy(stable_bytes + sizeof(u32), &u64, sizeof(u64));
+        u64 = rng_state;
+        memcpy(stable_bytes + sizeof(u32) + sizeof(u64), &u64, sizeof(u64));
+
+        sections[section_cnt].type = BFI_SEC_STABLE;
+        sections[section_cnt].encoding = BFI_ENC_RAW;
+        sections[section_cnt].length = BFI_STABLE_SEC_LEN;
+        payloads[section_cnt++] = stable_bytes;
+    } else if (index->engine == BFI_ENGINE_TEMPORAL) {
+        unsigned int slot_cnt;
+        unsigned int slot;
+        uint32_t u32;
+
+        tbf_get_parameters(index->bf, &slot_cnt, &slot);
+        u32 = slot_cnt;
+        memcpy(temporal_bytes, &u32, sizeof(u32));
+        u32 = slot;
+        memcpy(temporal_bytes + sizeof(u32), &u32, sizeof(u32));
+
+        sections[section_cnt].type = BFI_SEC_TEMPORAL;
+        sections[section_cnt].encoding = BFI_ENC_RAW;
+        sections[section_cnt].length = BFI_TEMPORAL_SEC_LEN;
+        payloads[section_cnt++] = temporal_bytes;
+    } else if (index->engine == BFI_ENGINE_QUOTIENT) {
+        unsigned int quotient_bits;
+        unsigned int remainder_bits;
+        uint32_t u32;
+
+        qf_get_parameters(index->bf, &quotient_bits, &remainder_bits);
+        u32 = quotient_bits;
+        memcpy(quotient_bytes, &u32, sizeof(u32));
+        u32 = remainder_bits;
+        memcpy(quotient_bytes + sizeof(u32), &u32, sizeof(u32));
+
+        sections[section_cnt].type = BFI_SEC_QUOTIENT;
+        sections[section_cnt].encoding = BFI_ENC_RAW;
+        sections[section_cnt].length = BFI_QUOTIENT_SEC_LEN;
+        payloads[section_cnt++] = quotient_bytes;
+    } else if (index->engine == BFI_ENGINE_REGISTER) {
+        uint32_t u32;
+
+        u32 = rgbf_get_bits_per_key(index->bf);
+        memcpy(register_bytes, &u32, sizeof(u32));
+        u32 = BFI_REGISTER_PATTERNS;
+        memcpy(register_bytes + sizeof(u32), &u32, sizeof(u32));
+
+        sections[section_cnt].type = BFI_SEC_REGISTER;
+        sections[section_cnt].encoding = BFI_ENC_RAW;
+        sections[section_cnt].length = BFI_REGISTER_SEC_LEN;
+        payloads[section_cnt++] = register_bytes;
+    }
+
+    // Count-min sketch
+    if (index->cms) {
+        sections[section_cnt].type = BFI_SEC_CMS;
+        sections[section_cnt].encoding = BFI_ENC_RAW;
+        sections[section_cnt].length = cms_get_sketch_as_bytes(index->cms,
+                                                               &cms_bytes);
+        payloads[section_cnt++] = cms_bytes;
+    }
+
+    // Range filters
+    for (uint16_t i = 0; i < index->range_cnt; ++i) {
+        sections[section_cnt].type = BFI_SEC_RANGE;
+        sections[section_cnt].encoding = BFI_ENC_RAW;
+        sections[section_cnt].length = bfi_range_as_bytes(&index->ranges[i],
+                                                           &range_bytes[i]);
+        if (sections[section_cnt].length == 0) {
+            ret = BFI_E_STO_BYTES;
+            goto cleanup;
+        }
+        payloads[section_cnt++] = range_bytes[i];
+    }
+
+    // Folded summary
+    if (opts->summary_fold && index->engine == BFI_ENGINE_STANDARD) {
+        bloom_filter_h *summary = bfi_summary_fold(index->bf,
+                                                   opts->summary_fold);
+
+        if (summary) {
+            sections[section_cnt].type = BFI_SEC_SUMMARY;
+            sections[section_cnt].encoding = BFI_ENC_RAW;
+            summary_len = bfi_summary_as_bytes(summary, &summary_bytes);
+            sections[section_cnt].length = summary_len;
+            bf_delete_filter(summary);
+            if (sections[section_cnt].length == 0) {
+                ret = BFI_E_STO_BYTES;
+                goto cleanup;
+            }
+            payloads[section_cnt++] = summary_bytes;
+        }
+    }
+
+    // Time range of data
+    if (opts->time_first || opts->time_last) {
+        memcpy(meta_bytes, &opts->time_first, sizeof(uint64_t));
+        memcpy(meta_bytes + sizeof(uint64_t), &opts->time_last,
+               sizeof(uint64_t));
+        sections[section_cnt].type = BFI_SEC_META;
+        sections[section_cnt].encoding = BFI_ENC_RAW;
+        sections[section_cnt].length = BFI_META_SEC_LEN;
+        payloads[section_cnt++] = meta_bytes;
+    }
+
+    // Zone map of inserted addresses
+    if (opts->zone_map && index->zone.valid) {
+        sections[section_cnt].type = BFI_SEC_ZONE;
+        sections[section_cnt].encoding = BFI_ENC_RAW;
+        sections[section_cnt].length = bfi_zone_as_bytes(&index->zone,
+                                                         zone_bytes);
+        payloads[section_cnt++] = zone_bytes;
+    }
+
+    // Archival encoding of sections (small engine parameters are kept raw)
+    if (opts->encoding == BFI_STORE_COMPRESSED) {
+        for (uint16_t i = 0; i < section_cnt; ++i) {
+            if (sections[i].type != BFI_SEC_BLOOM
+                    && sections[i].type != BFI_SEC_STABLE
+                    && sections[i].type != BFI_SEC_TEMPORAL
+                    && sections[i].type != BFI_SEC_QUOTIENT
+                    && sections[i].type != BFI_SEC_REGISTER
+                    && sections[i].type != BFI_SEC_META
+                    && sections[i].type != BFI_SEC_ZONE) {
+                bfi_file_encode_section(&sections[i], &payloads[i],
+                                        &encoded[i], opts->chunk_size);
+            }
+        }
+    }
+
+    // Checksums of parts of the stored filter (computed while it is written)
+    if (opts->checksum) {
+        uint32_t u32;
+
+        part_cnt = bfi_file_part_cnt(sections[0].length);
+        checksum_bytes = (char *) malloc(BFI_CHECKSUM_SEC_HDR_LEN
+                                         + part_cnt * sizeof(uint32_t));
+        if (!checksum_bytes) {
+            ret = BFI_E_MEM;
+            goto cleanup;
+        }
+        u32 = BFI_SEC_BLOOM;
+        memcpy(checksum_bytes, &u32, sizeof(u32));
+        u32 = BFI_FILE_IO_PART;
+        memcpy(checksum_bytes + sizeof(u32), &u32, sizeof(u32));
+        memcpy(checksum_bytes + 2 * sizeof(u32), &part_cnt, sizeof(part_cnt));
+
+        checksum_sec = section_cnt;
+        sections[section_cnt].type = BFI_SEC_CHECKSUM;
+        sections[section_cnt].encoding = BFI_ENC_RAW;
+        sections[section_cnt].length = BFI_CHECKSUM_SEC_HDR_LEN
+                                       + part_cnt * sizeof(uint32_t);
+        payloads[section_cnt++] = NULL;
+    }
+
+    // Checksums of parts of the filter give checksum of the stored file
+    if (checksum_bytes) {
+        part_crcs = (uint32_t *) (checksum_bytes + BFI_CHECKSUM_SEC_HDR_LEN);
+    } else if (stored) {
+        part_crcs = (uint32_t *) malloc(bfi_file_part_cnt(sections[0].length)
+                                        * sizeof(uint32_t) + 1);
+        if (!part_crcs) {
+            ret = BFI_E_MEM;
+            goto cleanup;
+        }
+    }
+
+    // Directly written filter is the last (aligned) payload, so padding of
+    // its last block does not overwrite other sections
+    if (opts->io_policy & BFI_IO_DIRECT) {
+        bfi_section_t bloom = sections[0];
+        char *bloom_encoded = encoded[0];
+
+        memmove(&sections[0], &sections[1],
+                (section_cnt - 1) * sizeof(sections[0]));
+        memmove(&payloads[0], &payloads[1],
+                (section_cnt - 1) * sizeof(payloads[0]));
+        memmove(&encoded[0], &encoded[1],
+                (section_cnt - 1) * sizeof(encoded[0]));
+        bloom_sec = section_cnt - 1;
+        sections[bloom_sec] = bloom;
+        payloads[bloom_sec] = NULL;
+        encoded[bloom_sec] = bloom_encoded;
+        checksum_sec--;
+        align = BFI_IO_DIRECT_ALIGN;
+    }
+
+    // Stored payload of the filter
+    if (encoded[bloom_sec]) {
+        bf_header = NULL;
+        bf_header_len = 0;
+        bf_body = encoded[bloom_sec];
+        bf_body_len = sections[bloom_sec].length;
+    }
+
+	// Open file, mode: write binary
+    bf_file_ptr = fopen(filename, "wb");
+    if (!bf_file_ptr){
+        ret = BFI_E_STO_FILE_ERR;
+        goto cleanup;
+    }
+
+    ret = bfi_file_write(bf_file_ptr, (uint16_t) index->engine, align,
+                         sections, payloads, section_cnt);
+    if (ret == BFI_E_OK && align) {
+        direct_fd = bfi_io_open_direct(filename);
+    }
+    if (ret == BFI_E_OK) {
+        ret = bfi_file_pwrite_parts(bf_file_ptr, direct_fd,
+                    sections[bloom_sec].offset, bf_header, bf_header_len,
+                    bf_body, bf_body_len, part_crcs);
+    }
+    if (direct_fd >= 0) {
+        // Padding of the last block
+        if (ftruncate(direct_fd, (off_t) (sections[bloom_sec].offset
+                                          + sections[bloom_sec].length)) != 0
+                && ret == BFI_E_OK) {
+            ret = BFI_E_STO_INDEX;
+        }
+        close(direct_fd);
+    }
+    if (ret == BFI_E_OK && checksum_bytes) {
+        ret = bfi_file_pwrite_parts(bf_file_ptr, -1,
+                                    sections[checksum_sec].offset,
+                                    checksum_bytes,
+                                    sections[checksum_sec].length, NULL, 0,
+                                    NULL);
+    }
+    if (bfi_io_close(bf_file_ptr, opts->io_policy, true) != 0
+            && ret == BFI_E_OK) {
+        ret = BFI_E_STO_INDEX;
+    }
+
+    // Description of the written file (summary is passed to the caller)
+    if (ret == BFI_E_OK && stored) {
+        uint32_t payload_crcs[BFI_SECTION_MAX] = { 0 };
+
+        payload_crcs[bloom_sec] = bfi_file_parts_checksum(part_crcs,
+                                                BFI_FILE_IO_PART,
+                                                sections[bloom_sec].length);
+        if (checksum_bytes) {
+            payloads[checksum_sec] = checksum_bytes;
+        }
+        stored->checksum = bfi_file_checksum((uint16_t) index->engine,
+                                             sections, payloads, payload_crcs,
+                                             section_cnt, &stored->file_size);
+        stored->time_first = opts->time_first;
+        stored->time_last = opts->time_last;
+        stored->zone_map = opts->zone_map && index->zone.valid;
+        stored->summary = summary_bytes;
+        stored->summary_len = summary_len;
+        summary_bytes = NULL;
+    }
+
+cleanup:
+    free(header_bytes);
+    if (!checksum_bytes) {
+        free(part_crcs);
+    }
+    free(checksum_bytes);
+    if (cms_bytes) {
+        cms_clear_bytes(index->cms, &cms_bytes);
+    }
+    for (uint16_t i = 0; i < index->range_cnt; ++i) {
+        free(range_bytes[i]);
+    }
+    free(summary_bytes);
+    for (uint16_t i = 0; i < section_cnt; ++i) {
+        free(encoded[i]);
+    }
+
+    return ret;
+}
+
+
+void bfi_store_opts_init(bfi_store_opts_t *opts)
+{
+    memset(opts, 0, sizeof(*opts));
+    opts->encoding = BFI_STORE_RAW;
+    opts->chunk_size = 0;
+    opts->zone_map = true;
+    opts->io_policy = bfi_get_io_policy();
+}
+
+
+bfi_ecode_t bfi_store_index_opts(bfi_index_ptr_t index_ptr, char *filename,
+                    const bfi_store_opts_t *opts)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    bfi_stored_t stored;
+    uint64_t table_len;
+    bfi_ecode_t ret;
+
+    if (!index){
+        // nothing to store
+        return BFI_E_NO_INDEX;
+    }
+    memset(&stored, 0, sizeof(stored));
+    bf_table(index->bf, &table_len);
+
+    // Plain Bloom filter indexes are stored in the original format, so they
+    // could be loaded by previous versions of the library (unless they are
+    // too large for its 32-bit length)
+    if (index->engine == BFI_ENGINE_STANDARD && !index->cms
+            && index->range_cnt == 0 && opts->encoding == BFI_STORE_RAW
+            && opts->summary_fold == 0 && opts->time_first == 0
+            && opts->time_last == 0 && !opts->zone_map && !opts->checksum
+            && !(opts->io_policy & BFI_IO_DIRECT)
+            && bf_header_length(index->bf) + table_len <= UINT32_MAX) {
+        ret = bfi_store_index_v1(index->bf, filename, opts->io_policy,
+                                 opts->catalog ? &stored : NULL);
+    } else {
+        ret = bfi_store_index_v2(index, filename, opts,
+                                 opts->catalog ? &stored : NULL);
+    }
+
+    // Catalog entry is made from the index and the written data
+    if (ret == BFI_E_OK && opts->catalog) {
+        ret = bfi_catalog_add_stored(opts->catalog, filename, index, &stored);
+    }
+
+    return ret;
+}
+
+
+bfi_ecode_t bfi_store_index(bfi_index_ptr_t index_ptr, char *filename)
+{
+    bfi_store_opts_t opts;
+
+    bfi_store_opts_init(&opts);
+    opts.zone_map = false;
+
+    return bfi_store_index_opts(index_ptr, filename, &opts);
+}
+
+
+/**
+ * \brief Checksums of sections read by a load of an index file
+ */
+typedef struct {
+    uint32_t *crcs;                 // Checksum of every section (or NULL)
+    bool *known;                    // Section was read
+} bfi_load_crcs_t;
+
+
+/**
+ * \brief Read a section of a loaded index (and compute its checksum)
+ */
+static bfi_ecode_t bfi_load_section(FILE *bf_file_ptr,
+                    const bfi_section_t *sections, const bfi_section_t *sec,
+                    bfi_load_crcs_t *sums, char **payload,
+                    uint64_t *payload_len)
+{
+    bfi_ecode_t ret;
+
+    ret = bfi_file_read_section(bf_file_ptr, sec, payload, payload_len);
+    if (ret == BFI_E_OK && sums->crcs) {
+        sums->crcs[sec - sections] = bfi_crc32c(0, *payload, *payload_len);
+        sums->known[sec - sections] = true;
+    }
+
+    return ret;
+}
+
+
+/**
+ * \brief Describe a loaded version 2 file (time range, summary, size and
+ *    checksum)
+ *
+ * Sections not needed by the index are read (they are small), checksum of
+ * the file is combined from checksums of all sections.
+ */
+static bfi_ecode_t bfi_load_stored(FILE *bf_file_ptr,
+                    const bfi_file_header_t *header,
+                    const bfi_section_t *sections, bfi_load_crcs_t *sums,
+                    bfi_index_t *index, bfi_stored_t *stored)
+{
+    char *payload = NULL;
+    uint64_t payload_len;
+
+    for (uint16_t i = 0; i < header->section_cnt; ++i) {
+        bfi_ecode_t ret;
+
+        if (sums->known[i]) {
+            continue;
+        }
+        ret = bfi_load_section(bf_file_ptr, sections, &sections[i], sums,
+                               &payload, &payload_len);
+        if (ret != BFI_E_OK) {
+            return ret;
+        }
+        if (sections[i].type == BFI_SEC_META
+                && payload_len == BFI_META_SEC_LEN) {
+            memcpy(&stored->time_first, payload, sizeof(uint64_t));
+            memcpy(&stored->time_last, payload + sizeof(uint64_t),
+                   sizeof(uint64_t));
+        } else if (sections[i].type == BFI_SEC_SUMMARY && !stored->summary) {
+            stored->summary = payload;
+            stored->summary_len = payload_len;
+            payload = NULL;
+        }
+        free(payload);
+        payload = NULL;
+    }
+
+    stored->zone_map = index->zone.valid;
+    stored->checksum = bfi_file_checksum(header->engine, sections, NULL,
+                                         sums->crcs, header->section_cnt,
+                                         &stored->file_size);
+
+    return BFI_E_OK;
+}
+
+
+/**
+ * \brief Load index from version 2 file (sections)
+ */
+static bfi_ecode_t bfi_load_index_v2(bfi_index_t *index, FILE *bf_file_ptr,
+                    bfi_stored_t *stored)
+{
+    bfi_file_header_t header;
+    bfi_section_t *sections;
+    const bfi_section_t *sec;
+    bfi_checksums_t checksums;
+    bfi_load_crcs_t sums = { NULL, NULL };
+    char *payload = NULL;
+    uint64_t payload_len;
+    uint32_t bloom_crc;
+    int load_ret;
+    bfi_ecode_t ret;
+
+    ret = bfi_file_read_toc(bf_file_ptr, &header, &sections);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+    if (stored) {
+        sums.crcs = (uint32_t *) calloc(header.section_cnt + 1,
+                                        sizeof(uint32_t));
+        sums.known = (bool *) calloc(header.section_cnt + 1, sizeof(bool));
+        if (!sums.crcs || !sums.known) {
+            ret = BFI_E_LOAD_MEM;
+            goto cleanup;
+        }
+    }
+
+    // Create empty filter of the stored engine
+    index->bf = bfi_new_empty_filter((bfi_engine_t) header.engine);
+    if (!index->bf) {
+        ret = BFI_E_ENGINE;
+        goto cleanup;
+    }
+    index->engine = (bfi_engine_t) header.engine;
+
+    // Filter itself
+    sec = bfi_file_find_section(sections, header.section_cnt, BFI_SEC_BLOOM);
+    if (!sec) {
+        ret = BFI_E_LOAD_NO_SECTION;
+        goto cleanup;
+    }
+    ret = bfi_file_read_checksums(bf_file_ptr, sections, header.section_cnt,
+                                  sec, &checksums);
+    if (ret != BFI_E_OK) {
+        goto cleanup;
+    }
+    ret = bfi_file_read_filter(bf_file_ptr, sec, &checksums, index->bf,
+                               stored ? &bloom_crc : NULL);
+    free(checksums.crcs);
+    if (ret != BFI_E_OK) {
+        goto cleanup;
+    }
+    if (stored) {
+        sums.crcs[sec - sections] = bloom_crc;
+        sums.known[sec - sections] = true;
+    }
+
+    // Engine specific parameters
+    if (index->engine == BFI_ENGINE_STABLE) {
+        uint32_t cell_max;
+        uint64_t decrement_cnt;
+        uint64_t rng_state;
+
+        sec = bfi_file_find_section(sections, header.section_cnt,
+                                    BFI_SEC_STABLE);
+        if (!sec) {
+            ret = BFI_E_LOAD_NO_SECTION;
+            goto cleanup;
+        }
+        ret = bfi_load_section(bf_file_ptr, sections, sec, &sums, &payload,
+                               &payload_len);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        if (payload_len != BFI_STABLE_SEC_LEN) {
+            ret = BFI_E_LOAD_SECTION;
+            goto cleanup;
+        }
+        memcpy(&cell_max, payload, sizeof(cell_max));
+        memcpy(&decrement_cnt, payload + sizeof(cell_max),
+               sizeof(decrement_cnt));
+        memcpy(&rng_state, payload + sizeof(cell_max) + sizeof(decrement_cnt),
+               sizeof(rng_state));
+        // Cells have to hold cell_max
+        if (sbf_set_parameters(index->bf, cell_max, decrement_cnt, rng_state)
+                != 0) {
+            ret = BFI_E_LOAD_SECTION;
+            goto cleanup;
+        }
+        free(payload);
+        payload = NULL;
+    } else if (index->engine == BFI_ENGINE_TEMPORAL) {
+        uint32_t slot_cnt;
+        uint32_t slot;
+
+        sec = bfi_file_find_section(sections, header.section_cnt,
+                                    BFI_SEC_TEMPORAL);
+        if (!sec) {
+            ret = BFI_E_LOAD_NO_SECTION;
+            goto cleanup;
+        }
+        ret = bfi_load_section(bf_file_ptr, sections, sec, &sums, &payload,
+                               &payload_len);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        if (payload_len != BFI_TEMPORAL_SEC_LEN) {
+            ret = BFI_E_LOAD_SECTION;
+            goto cleanup;
+        }
+        memcpy(&slot_cnt, payload, sizeof(slot_cnt));
+        memcpy(&slot, payload + sizeof(slot_cnt), sizeof(slot));
+        // Width of cells has to match the stored table
+        if (tbf_set_parameters(index->bf, slot_cnt, slot) != 0) {
+            ret = BFI_E_LOAD_SECTION;
+            goto cleanup;
+        }
+        free(payload);
+        payload = NULL;
+    } else if (index->engine == BFI_ENGINE_QUOTIENT) {
+        uint32_t quotient_bits;
+        uint32_t remainder_bits;
+
+        sec = bfi_file_find_section(sections, header.section_cnt,
+                                    BFI_SEC_QUOTIENT);
+        if (!sec) {
+            ret = BFI_E_LOAD_NO_SECTION;
+            goto cleanup;
+        }
+        ret = bfi_load_section(bf_file_ptr, sections, sec, &sums, &payload,
+                               &payload_len);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        if (payload_len != BFI_QUOTIENT_SEC_LEN) {
+            ret = BFI_E_LOAD_SECTION;
+            goto cleanup;
+        }
+        memcpy(&quotient_bits, payload, sizeof(quotient_bits));
+        memcpy(&remainder_bits, payload + sizeof(quotient_bits),
+               sizeof(remainder_bits));
+        // Slots have to match the stored table, count of fingerprints is
+        // recounted from it
+        if (qf_set_parameters(index->bf, quotient_bits, remainder_bits) != 0) {
+            ret = BFI_E_LOAD_SECTION;
+            goto cleanup;
+        }
+        free(payload);
+        payload = NULL;
+    } else if (index->engine == BFI_ENGINE_REGISTER) {
+        sec = bfi_file_find_section(sections, header.section_cnt,
+                                    BFI_SEC_REGISTER);
+        if (!sec) {
+            ret = BFI_E_LOAD_NO_SECTION;
+            goto cleanup;
+        }
+        ret = bfi_load_section(bf_file_ptr, sections, sec, &sums, &payload,
+                               &payload_len);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        ret = bfi_register_from_bytes(index->bf, payload, payload_len);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        free(payload);
+        payload = NULL;
+    }
+
+    // Optional count-min sketch
+    sec = bfi_file_find_section(sections, header.section_cnt, BFI_SEC_CMS);
+    if (sec) {
+        ret = bfi_load_section(bf_file_ptr, sections, sec, &sums, &payload,
+                               &payload_len);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        index->cms = new_count_min_sketch();
+        load_ret = cms_load_sketch_from_bytes(index->cms, payload,
+                                              payload_len);
+        if (load_ret != 0
+                || cms_get_depth(index->cms) > bf_hash_count(index->bf)) {
+            ret = load_ret == BFI_E_LOAD_MEM ? BFI_E_LOAD_MEM
+                                             : BFI_E_LOAD_BYTES;
+            goto cleanup;
+        }
+        free(payload);
+        payload = NULL;
+    }
+
+    // Range filters
+    for (uint16_t i = 0; i < header.section_cnt; ++i) {
+        if (sections[i].type != BFI_SEC_RANGE) {
+            continue;
+        }
+        ret = bfi_load_section(bf_file_ptr, sections, &sections[i], &sums,
+                               &payload, &payload_len);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        ret = bfi_range_from_bytes(index, payload, payload_len);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        free(payload);
+        payload = NULL;
+    }
+
+    // Optional zone map
+    sec = bfi_file_find_section(sections, header.section_cnt, BFI_SEC_ZONE);
+    if (sec) {
+        ret = bfi_load_section(bf_file_ptr, sections, sec, &sums, &payload,
+                               &payload_len);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        ret = bfi_zone_from_bytes(payload, payload_len, &index->zone);
+    }
+
+    if (ret == BFI_E_OK && stored) {
+        ret = bfi_load_stored(bf_file_ptr, &header, sections, &sums, index,
+                              stored);
+    }
+
+cleanup:
+    free(payload);
+    free(sections);
+    free(sums.crcs);
+    free(sums.known);
+
+    return ret;
+}
+
+
+bfi_ecode_t bfi_load_index_stored(bfi_index_ptr_t *index_ptr, char *filename,
+                    bfi_stored_t *stored)
 {
+    bfi_index_t *index;
     uint32_t index_len = 0;
     uint16_t magic_check;
+    uint32_t io_policy = bfi_get_io_policy();
     FILE *bf_file_ptr;
+    int load_ret;
+
+    if (stored) {
+        memset(stored, 0, sizeof(*stored));
+    }
 
 	// Open file, mode: read binary
     bf_file_ptr = fopen(filename, "rb");
@@ -186,43 +2128,84 @@ bfi_ecode_t bfi_load_index(bfi_index_ptr_t *index_ptr, char *filename)
     if (!bf_file_ptr){
         return BFI_E_LOAD_FILE_ERR;
     }
+    bfi_io_advise_file(fileno(bf_file_ptr), io_policy, false);
 
 	// Create empty index
-    *index_ptr = (bfi_index_ptr_t) new_bloom_filter();
+    index = bfi_new_index(BFI_ENGINE_STANDARD, NULL);
+    if (!index) {
+        fclose(bf_file_ptr);
+        return BFI_E_LOAD_MEM;
+    }
+    *index_ptr = (bfi_index_ptr_t) index;
+    // Zone map is known only if it is stored in the file
+    bfi_zone_reset(&index->zone, false);
 
 	// Read and check magic value (format and endianity check)
     if (fread(&magic_check, sizeof(uint16_t), 1, bf_file_ptr) != 1) {
+        fclose(bf_file_ptr);
         return BFI_E_LOAD_IDX_LEN;
     }
+    if (magic_check == BFI_MAGIC_V2) {
+        // Sectioned file, re-read it from the beginning
+        rewind(bf_file_ptr);
+        bfi_ecode_t ret = bfi_load_index_v2(index, bf_file_ptr, stored);
+        bfi_io_close(bf_file_ptr, io_policy, false);
+        return ret;
+    }
+    index->bf = new_bloom_filter();
     if (magic_check != BFI_FILE_MAGIC) {
+        fclose(bf_file_ptr);
 		return BFI_E_LOAD_BAD_MAGIC;
     }
 
 	// Read and check index size
     if (fread(&index_len, sizeof(uint32_t), 1, bf_file_ptr) != 1) {
+        fclose(bf_file_ptr);
         return BFI_E_LOAD_IDX_LEN;
     }
     if (index_len == 0){
+        fclose(bf_file_ptr);
         return BFI_E_LOAD_ZERO_LEN;
     }
 
 	// Read index byte array
     char *index_bytes = (char *) malloc(index_len * sizeof(char));
     if (!index_bytes){
+        fclose(bf_file_ptr);
         return BFI_E_LOAD_MEM;
     }
     if (fread(index_bytes, sizeof(char), index_len, bf_file_ptr) != index_len){
+        free(index_bytes);
+        fclose(bf_file_ptr);
         return BFI_E_LOAD_INDEX;
     }
 
 	// Re-create index from loaded bytes (i.e. from index binary representation)
-    if (bf_load_filter_from_bytes(*index_ptr, index_bytes, index_len) != 0){
-        return BFI_E_LOAD_BYTES;
+    load_ret = bf_load_filter_from_bytes(index->bf, index_bytes, index_len);
+    if (load_ret != 0){
+        free(index_bytes);
+        fclose(bf_file_ptr);
+        return load_ret == BFI_E_LOAD_MEM ? BFI_E_LOAD_MEM : BFI_E_LOAD_BYTES;
     }
 
+    if (stored) {
+        stored->checksum = bfi_crc32c(0, &magic_check, sizeof(magic_check));
+        stored->checksum = bfi_crc32c(stored->checksum, &index_len,
+                                      sizeof(index_len));
+        stored->checksum = bfi_crc32c(stored->checksum, index_bytes,
+                                      index_len);
+        stored->file_size = sizeof(magic_check) + sizeof(index_len)
+                            + index_len;
+    }
     free(index_bytes);
 
-    fclose(bf_file_ptr);
+    bfi_io_close(bf_file_ptr, io_policy, false);
 
     return BFI_E_OK;
 }
+
+
+bfi_ecode_t bfi_load_index(bfi_index_ptr_t *index_ptr, char *filename)
+{
+    return bfi_load_index_stored(index_ptr, filename, NULL);
+}
@@ -0,0 +1,1002 @@
+/**
+ * \file bf_index_file.c
+ * \brief Sectioned (version 2) Bloom filter index file format
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "bf_index_file.h"
+#include "bf_codec.h"
+#include "bf_crc.h"
+#include "bf_io.h"
+#include "bf_parallel.h"
+
+// Minimal count of chunks decoded by one thread
+#define BFI_FILE_PARALLEL_CHUNKS 16
+
+static uint16_t BFI_FILE_MAGIC_V2 = BFI_MAGIC_V2;
+
+
+static void bfi_file_header_init(bfi_file_header_t *header, uint16_t engine,
+                    uint16_t section_cnt)
+{
+    header->magic = BFI_FILE_MAGIC_V2;
+    header->version = BFI_FILE_VERSION;
+    header->engine = engine;
+    header->section_cnt = section_cnt;
+}
+
+
+bfi_ecode_t bfi_file_write(FILE *file_ptr, uint16_t engine, uint32_t align,
+                    bfi_section_t *sections, const char * const *payloads,
+                    uint16_t section_cnt)
+{
+    bfi_file_header_t header;
+    uint64_t offset;
+    uint64_t position;
+
+    bfi_file_header_init(&header, engine, section_cnt);
+
+    // Payloads follow the section table in the order of sections
+    offset = sizeof(header) + section_cnt * sizeof(bfi_section_t);
+    for (uint16_t i = 0; i < section_cnt; ++i) {
+        if (!payloads[i] && align > 1) {
+            offset = (offset + align - 1) / align * align;
+        }
+        sections[i].offset = offset;
+        offset += sections[i].length;
+    }
+
+    if (fwrite(&header, sizeof(header), 1, file_ptr) != 1) {
+        return BFI_E_STO_MAGIC;
+    }
+    if (fwrite(sections, sizeof(bfi_section_t), section_cnt, file_ptr)
+            != section_cnt) {
+        return BFI_E_STO_SECTION;
+    }
+
+    // Position of the stream
+    position = sizeof(header) + section_cnt * sizeof(bfi_section_t);
+    for (uint16_t i = 0; i < section_cnt; ++i) {
+        if (!payloads[i]) {
+            // Written later by the caller
+            continue;
+        }
+        if (position != sections[i].offset
+                && fseeko(file_ptr, (off_t) sections[i].offset, SEEK_SET)
+                   != 0) {
+            return BFI_E_STO_INDEX;
+        }
+        position = sections[i].offset + sections[i].length;
+        if (fwrite(payloads[i], sizeof(char), sections[i].length, file_ptr)
+                != sections[i].length) {
+            return BFI_E_STO_INDEX;
+        }
+    }
+
+    return BFI_E_OK;
+}
+
+
+uint32_t bfi_file_checksum(uint16_t engine, const bfi_section_t *sections,
+                    const char * const *payloads, const uint32_t *payload_crcs,
+                    uint16_t section_cnt, uint64_t *file_size)
+{
+    static const char zeros[64] = { 0 };
+    bfi_file_header_t header;
+    uint64_t position;
+    uint32_t crc;
+
+    bfi_file_header_init(&header, engine, section_cnt);
+    crc = bfi_crc32c(0, &header, sizeof(header));
+    crc = bfi_crc32c(crc, sections, section_cnt * sizeof(bfi_section_t));
+
+    position = sizeof(header) + section_cnt * sizeof(bfi_section_t);
+    for (uint16_t i = 0; i < section_cnt; ++i) {
+        // Gap before an aligned payload
+        while (position < sections[i].offset) {
+            uint64_t len = sections[i].offset - position;
+
+            len = len < sizeof(zeros) ? len : sizeof(zeros);
+            crc = bfi_crc32c(crc, zeros, len);
+            position += len;
+        }
+        if (payloads && payloads[i]) {
+            crc = bfi_crc32c(crc, payloads[i], sections[i].length);
+        } else {
+            crc = bfi_crc32c_combine(crc, payload_crcs[i],
+                                     sections[i].length);
+        }
+        position += sections[i].length;
+    }
+    *file_size = position;
+
+    return crc;
+}
+
+
+uint32_t bfi_file_parts_checksum(const uint32_t *crcs, uint32_t part_size,
+                    uint64_t len)
+{
+    uint32_t crc = 0;
+
+    for (uint64_t p = 0; len > 0; ++p) {
+        uint64_t part_len = len < part_size ? len : part_size;
+
+        crc = bfi_crc32c_combine(crc, crcs[p], part_len);
+        len -= part_len;
+    }
+
+    return crc;
+}
+
+
+bfi_ecode_t bfi_file_read_toc(FILE *file_ptr, bfi_file_header_t *header,
+                    bfi_section_t **sections)
+{
+    *sections = NULL;
+
+    if (fread(header, sizeof(*header), 1, file_ptr) != 1) {
+        return BFI_E_LOAD_MAGIC;
+    }
+    if (header->magic != BFI_FILE_MAGIC_V2) {
+        return BFI_E_LOAD_BAD_MAGIC;
+    }
+    if (header->version != BFI_FILE_VERSION) {
+        return BFI_E_LOAD_VERSION;
+    }
+
+    *sections = (bfi_section_t *) malloc(header->section_cnt
+                                         * sizeof(bfi_section_t));
+    if (!*sections && header->section_cnt) {
+        return BFI_E_LOAD_MEM;
+    }
+    if (fread(*sections, sizeof(bfi_section_t), header->section_cnt, file_ptr)
+            != header->section_cnt) {
+        free(*sections);
+        *sections = NULL;
+        return BFI_E_LOAD_SECTION;
+    }
+
+    return BFI_E_OK;
+}
+
+
+const bfi_section_t *bfi_file_find_section(const bfi_section_t *sections,
+                    uint16_t section_cnt, uint32_t type)
+{
+    for (uint16_t i = 0; i < section_cnt; ++i) {
+        if (sections[i].type == type) {
+            return &sections[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+bfi_ecode_t bfi_file_read_section(FILE *file_ptr, const bfi_section_t *section,
+                    char **payload, uint64_t *length)
+{
+    *payload = NULL;
+
+    if (section->length == 0) {
+        return BFI_E_LOAD_ZERO_LEN;
+    }
+    if (section->encoding != BFI_ENC_RAW
+            && section->encoding != BFI_ENC_CHUNKED) {
+        return BFI_E_LOAD_SECTION;
+    }
+    if (fseeko(file_ptr, (off_t) section->offset, SEEK_SET) != 0) {
+        return BFI_E_LOAD_SECTION;
+    }
+
+    *payload = (char *) malloc(section->length);
+    if (!*payload) {
+        return BFI_E_LOAD_MEM;
+    }
+    if (fread(*payload, sizeof(char), section->length, file_ptr)
+            != section->length) {
+        free(*payload);
+        *payload = NULL;
+        return BFI_E_LOAD_SECTION;
+    }
+    *length = section->length;
+
+    // Encoded payload is replaced by the decoded one
+    if (section->encoding == BFI_ENC_CHUNKED) {
+        char *raw;
+        bfi_ecode_t ret;
+
+        ret = bfi_codec_decode(*payload, section->length, &raw, length);
+        free(*payload);
+        *payload = raw;
+        if (ret == BFI_E_OK && *length == 0) {
+            free(*payload);
+            *payload = NULL;
+            ret = BFI_E_LOAD_ZERO_LEN;
+        }
+        return ret;
+    }
+
+    return BFI_E_OK;
+}
+
+
+void bfi_file_encode_section(bfi_section_t *section, const char **payload,
+                    char **encoded, uint32_t chunk_size)
+{
+    uint64_t length;
+
+    *encoded = NULL;
+
+    length = bfi_codec_encode(*payload, section->length, chunk_size, encoded);
+    if (length == 0 || length >= section->length) {
+        // Not worth it, raw payload is kept
+        free(*encoded);
+        *encoded = NULL;
+        return;
+    }
+
+    section->encoding = BFI_ENC_CHUNKED;
+    section->length = length;
+    *payload = *encoded;
+}
+
+
+bfi_ecode_t bfi_file_pread(FILE *file_ptr, uint64_t offset,
+                    uint64_t len, char *buff)
+{
+    if (fseeko(file_ptr, (off_t) offset, SEEK_SET) != 0
+            || fread(buff, sizeof(char), len, file_ptr) != len) {
+        return BFI_E_LOAD_SECTION;
+    }
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_file_read_chunk_table(FILE *file_ptr,
+                    const bfi_section_t *section, bfi_chunk_table_t *table)
+{
+    char head[BFI_CODEC_HDR_LEN];
+    char *table_bytes;
+    bfi_ecode_t ret;
+
+    table->chunks = NULL;
+
+    if (section->encoding != BFI_ENC_CHUNKED
+            || section->length < BFI_CODEC_HDR_LEN) {
+        return BFI_E_LOAD_SECTION;
+    }
+    ret = bfi_file_pread(file_ptr, section->offset, BFI_CODEC_HDR_LEN, head);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+    if (bfi_codec_table_len(head) > section->length) {
+        return BFI_E_LOAD_SECTION;
+    }
+    table_bytes = (char *) malloc(bfi_codec_table_len(head));
+    if (!table_bytes) {
+        return BFI_E_LOAD_MEM;
+    }
+    ret = bfi_file_pread(file_ptr, section->offset, bfi_codec_table_len(head),
+                         table_bytes);
+    if (ret == BFI_E_OK) {
+        ret = bfi_codec_read_table(table_bytes, section->length, table);
+    }
+    free(table_bytes);
+
+    return ret;
+}
+
+
+bfi_ecode_t bfi_file_read_part(FILE *file_ptr, const bfi_section_t *section,
+                    uint64_t offset, uint64_t len, char *buff)
+{
+    bfi_chunk_table_t table;
+    char *chunk_bytes = NULL;
+    char *raw = NULL;
+    bfi_ecode_t ret;
+
+    if (section->encoding == BFI_ENC_RAW) {
+        if (offset > section->length || len > section->length - offset) {
+            return BFI_E_LOAD_SECTION;
+        }
+        return bfi_file_pread(file_ptr, section->offset + offset, len, buff);
+    }
+
+    // Chunk table
+    ret = bfi_file_read_chunk_table(file_ptr, section, &table);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+    if (offset > table.raw_len || len > table.raw_len - offset) {
+        bfi_codec_free_table(&table);
+        return BFI_E_LOAD_SECTION;
+    }
+
+    // Decode chunks covering the requested part
+    raw = (char *) malloc(table.chunk_size);
+    chunk_bytes = (char *) malloc(table.chunk_size);
+    if (!raw || !chunk_bytes) {
+        ret = BFI_E_LOAD_MEM;
+        goto cleanup;
+    }
+    while (len) {
+        uint32_t c = (uint32_t) (offset / table.chunk_size);
+        uint32_t in_chunk = (uint32_t) (offset % table.chunk_size);
+        uint32_t raw_len = bfi_codec_chunk_raw_len(&table, c);
+        uint64_t part_len = raw_len - in_chunk;
+
+        if (part_len > len) {
+            part_len = len;
+        }
+        // Encoded chunk is never longer than the raw one
+        ret = bfi_file_pread(file_ptr, section->offset + table.chunks[c].offset,
+                             table.chunks[c].length, chunk_bytes);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        ret = bfi_codec_decode_chunk(&table.chunks[c], chunk_bytes, raw,
+                                     raw_len);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        memcpy(buff, raw + in_chunk, part_len);
+        buff += part_len;
+        offset += part_len;
+        len -= part_len;
+    }
+
+cleanup:
+    free(raw);
+    free(chunk_bytes);
+    bfi_codec_free_table(&table);
+
+    return ret;
+}
+
+
+/**
+ * \brief Load header of a filter stored in a section
+ *
+ * \param[out] header_len Length of the header (or NULL)
+ */
+static bfi_ecode_t bfi_file_load_filter_header(FILE *file_ptr,
+                    const bfi_section_t *filter_section, bloom_filter_h *bf,
+                    uint32_t *header_len_ptr)
+{
+    uint32_t prefix_len;
+    uint32_t header_len;
+    char *header_bytes;
+    int load_ret;
+    bfi_ecode_t ret;
+
+    // Fixed-size prefix of the header gives the size of the whole header
+    prefix_len = bf_header_prefix_size();
+    header_bytes = (char *) malloc(prefix_len);
+    if (!header_bytes) {
+        return BFI_E_LOAD_MEM;
+    }
+    ret = bfi_file_read_part(file_ptr, filter_section, 0, prefix_len,
+                             header_bytes);
+    if (ret != BFI_E_OK) {
+        free(header_bytes);
+        return ret;
+    }
+    header_len = bf_header_size(header_bytes);
+    free(header_bytes);
+    if (header_len < prefix_len) {
+        return BFI_E_LOAD_BYTES;
+    }
+
+    // Whole header
+    header_bytes = (char *) malloc(header_len);
+    if (!header_bytes) {
+        return BFI_E_LOAD_MEM;
+    }
+    ret = bfi_file_read_part(file_ptr, filter_section, 0, header_len,
+                             header_bytes);
+    if (ret != BFI_E_OK) {
+        free(header_bytes);
+        return ret;
+    }
+    load_ret = bf_load_header_from_bytes(bf, header_bytes, header_len);
+    free(header_bytes);
+    if (load_ret != 0) {
+        return load_ret == BFI_E_LOAD_MEM ? BFI_E_LOAD_MEM : BFI_E_LOAD_BYTES;
+    }
+    if (header_len_ptr) {
+        *header_len_ptr = header_len;
+    }
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_file_read_filter_header(FILE *file_ptr, uint16_t *engine,
+                    bloom_filter_h **bf, bfi_section_t *filter_section)
+{
+    uint16_t magic;
+    bfi_ecode_t ret = BFI_E_OK;
+
+    *bf = NULL;
+
+    // Find the filter according to the file format version
+    rewind(file_ptr);
+    if (fread(&magic, sizeof(magic), 1, file_ptr) != 1) {
+        return BFI_E_LOAD_MAGIC;
+    }
+    if (magic == BFI_MAGIC) {
+        uint32_t index_len;
+
+        if (fread(&index_len, sizeof(index_len), 1, file_ptr) != 1) {
+            return BFI_E_LOAD_IDX_LEN;
+        }
+        // Version 1 file is handled as a file with a single raw section
+        *engine = BFI_ENGINE_STANDARD;
+        filter_section->type = BFI_SEC_BLOOM;
+        filter_section->encoding = BFI_ENC_RAW;
+        filter_section->offset = sizeof(magic) + sizeof(index_len);
+        filter_section->length = index_len;
+    } else if (magic == BFI_MAGIC_V2) {
+        bfi_file_header_t header;
+        bfi_section_t *sections;
+        const bfi_section_t *sec;
+
+        rewind(file_ptr);
+        ret = bfi_file_read_toc(file_ptr, &header, &sections);
+        if (ret != BFI_E_OK) {
+            return ret;
+        }
+        sec = bfi_file_find_section(sections, header.section_cnt,
+                                    BFI_SEC_BLOOM);
+        if (!sec) {
+            free(sections);
+            return BFI_E_LOAD_NO_SECTION;
+        }
+        *engine = header.engine;
+        *filter_section = *sec;
+        free(sections);
+    } else {
+        return BFI_E_LOAD_BAD_MAGIC;
+    }
+
+    *bf = bfi_new_empty_filter((bfi_engine_t) *engine);
+    if (!*bf) {
+        return BFI_E_ENGINE;
+    }
+
+    ret = bfi_file_load_filter_header(file_ptr, filter_section, *bf, NULL);
+    if (ret != BFI_E_OK) {
+        bf_delete_filter(*bf);
+        *bf = NULL;
+    }
+
+    return ret;
+}
+
+
+/**
+ * \brief Split range of a part between head and body of a payload
+ */
+static inline void bfi_file_split_part(uint64_t start, uint64_t end,
+                    uint64_t head_len, uint64_t *head_end,
+                    uint64_t *body_start)
+{
+    *head_end = end < head_len ? end : head_len;
+    *body_start = start > head_len ? start : head_len;
+}
+
+
+/**
+ * \brief Write exactly len bytes at offset of a file descriptor
+ */
+static bool bfi_file_pwrite_all(int fd, uint64_t offset, const char *buff,
+                    uint64_t len)
+{
+    while (len) {
+        ssize_t n = pwrite(fd, buff, len, (off_t) offset);
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buff += n;
+        offset += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+
+/**
+ * \brief Read exactly len bytes at offset of a file descriptor
+ */
+static bool bfi_file_pread_all(int fd, uint64_t offset, char *buff,
+                    uint64_t len)
+{
+    while (len) {
+        ssize_t n = pread(fd, buff, len, (off_t) offset);
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buff += n;
+        offset += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+
+bfi_ecode_t bfi_file_pread_fd(int fd, uint64_t offset, uint64_t len,
+                    char *buff)
+{
+    return bfi_file_pread_all(fd, offset, buff, len) ? BFI_E_OK
+                                                     : BFI_E_LOAD_SECTION;
+}
+
+
+typedef struct {
+    int fd;
+    uint64_t offset;            // Offset of the payload in the file
+    char *head;                 // Payload given by two parts (both NULL to
+    uint64_t head_len;          // verify checksums only)
+    char *body;
+    uint64_t body_len;
+    uint32_t part_size;
+    uint32_t *crcs;             // Computed (write) or expected (read) or NULL
+    uint32_t *read_crcs;        // Computed by reads (or NULL)
+    bool write;
+    bool direct;                // Direct writes through aligned buffers
+    bfi_ecode_t ret;
+} bfi_file_io_ctx_t;
+
+
+/**
+ * \brief Direct write of parts [first, end) through an aligned buffer
+ */
+static void bfi_file_direct_worker(bfi_file_io_ctx_t *ctx, uint64_t first,
+                    uint64_t end)
+{
+    uint64_t total = ctx->head_len + ctx->body_len;
+    void *buff;
+
+    if (posix_memalign(&buff, BFI_IO_DIRECT_ALIGN, ctx->part_size) != 0) {
+        bfi_parallel_error(&ctx->ret, BFI_E_MEM);
+        return;
+    }
+
+    for (uint64_t p = first; p < end && ctx->ret == BFI_E_OK; ++p) {
+        uint64_t start = p * ctx->part_size;
+        uint64_t stop = start + ctx->part_size < total
+                        ? start + ctx->part_size : total;
+        uint64_t padded;
+        uint64_t head_end;
+        uint64_t body_start;
+
+        bfi_file_split_part(start, stop, ctx->head_len, &head_end,
+                            &body_start);
+        if (start < head_end) {
+            memcpy(buff, ctx->head + start, head_end - start);
+        }
+        if (body_start < stop) {
+            memcpy((char *) buff + (body_start - start),
+                   ctx->body + (body_start - ctx->head_len),
+                   stop - body_start);
+        }
+        if (ctx->crcs) {
+            ctx->crcs[p] = bfi_crc32c(0, buff, stop - start);
+        }
+
+        // Last block of the payload is padded
+        padded = (stop - start + BFI_IO_DIRECT_ALIGN - 1)
+                 / BFI_IO_DIRECT_ALIGN * BFI_IO_DIRECT_ALIGN;
+        memset((char *) buff + (stop - start), 0, padded - (stop - start));
+        if (!bfi_file_pwrite_all(ctx->fd, ctx->offset + start, buff, padded)) {
+            bfi_parallel_error(&ctx->ret, BFI_E_STO_INDEX);
+        }
+    }
+
+    free(buff);
+}
+
+
+static void bfi_file_io_worker(void *arg, uint64_t first, uint64_t end)
+{
+    bfi_file_io_ctx_t *ctx = (bfi_file_io_ctx_t *) arg;
+    uint64_t total = ctx->head_len + ctx->body_len;
+    char *verify_buff = NULL;
+
+    if (!ctx->head && !ctx->body) {
+        verify_buff = (char *) malloc(ctx->part_size);
+        if (!verify_buff) {
+            bfi_parallel_error(&ctx->ret, BFI_E_MEM);
+            return;
+        }
+    } else if (ctx->direct) {
+        bfi_file_direct_worker(ctx, first, end);
+        return;
+    }
+
+    for (uint64_t p = first; p < end && ctx->ret == BFI_E_OK; ++p) {
+        uint64_t start = p * ctx->part_size;
+        uint64_t stop = start + ctx->part_size < total
+                        ? start + ctx->part_size : total;
+        uint64_t head_end;
+        uint64_t body_start;
+        uint32_t crc = 0;
+        bool ok = true;
+
+        if (verify_buff) {
+            ok = bfi_file_pread_all(ctx->fd, ctx->offset + start, verify_buff,
+                                    stop - start);
+            crc = bfi_crc32c(0, verify_buff, stop - start);
+        } else {
+            bfi_file_split_part(start, stop, ctx->head_len, &head_end,
+                                &body_start);
+            if (start < head_end) {
+                char *buff = ctx->head + start;
+
+                ok = ctx->write
+                     ? bfi_file_pwrite_all(ctx->fd, ctx->offset + start, buff,
+                                           head_end - start)
+                     : bfi_file_pread_all(ctx->fd, ctx->offset + start, buff,
+                                          head_end - start);
+                crc = bfi_crc32c(crc, buff, head_end - start);
+            }
+            if (ok && body_start < stop) {
+                char *buff = ctx->body + (body_start - ctx->head_len);
+
+                ok = ctx->write
+                     ? bfi_file_pwrite_all(ctx->fd, ctx->offset + body_start,
+                                           buff, stop - body_start)
+                     : bfi_file_pread_all(ctx->fd, ctx->offset + body_start,
+                                          buff, stop - body_start);
+                crc = bfi_crc32c(crc, buff, stop - body_start);
+            }
+        }
+
+        if (!ok) {
+            bfi_parallel_error(&ctx->ret, ctx->write ? BFI_E_STO_INDEX
+                                                     : BFI_E_LOAD_SECTION);
+            break;
+        }
+        if (ctx->read_crcs && !ctx->write) {
+            ctx->read_crcs[p] = crc;
+        }
+        if (ctx->crcs && ctx->write) {
+            ctx->crcs[p] = crc;
+        } else if (ctx->crcs && ctx->crcs[p] != crc) {
+            bfi_parallel_error(&ctx->ret, BFI_E_CHECKSUM);
+        }
+    }
+
+    free(verify_buff);
+}
+
+
+/**
+ * \brief Read, write or verify a payload by parts in parallel
+ */
+static bfi_ecode_t bfi_file_io_parts(bfi_file_io_ctx_t *ctx)
+{
+    uint64_t part_cnt;
+
+    part_cnt = (ctx->head_len + ctx->body_len + ctx->part_size - 1)
+               / ctx->part_size;
+    ctx->ret = BFI_E_OK;
+    bfi_parallel_for(part_cnt, 1, bfi_file_io_worker, ctx);
+
+    return ctx->ret;
+}
+
+
+uint64_t bfi_file_part_cnt(uint64_t len)
+{
+    return (len + BFI_FILE_IO_PART - 1) / BFI_FILE_IO_PART;
+}
+
+
+bfi_ecode_t bfi_file_pwrite_parts(FILE *file_ptr, int direct_fd,
+                    uint64_t offset, const char *head, uint64_t head_len,
+                    const char *body, uint64_t body_len, uint32_t *crcs)
+{
+    bfi_file_io_ctx_t ctx;
+
+    if (fflush(file_ptr) != 0) {
+        return BFI_E_STO_INDEX;
+    }
+
+    ctx.fd = direct_fd >= 0 ? direct_fd : fileno(file_ptr);
+    ctx.direct = direct_fd >= 0;
+    ctx.offset = offset;
+    ctx.head = (char *) head;
+    ctx.head_len = head_len;
+    ctx.body = (char *) body;
+    ctx.body_len = body_len;
+    ctx.part_size = BFI_FILE_IO_PART;
+    ctx.crcs = crcs;
+    ctx.read_crcs = NULL;
+    ctx.write = true;
+
+    return bfi_file_io_parts(&ctx);
+}
+
+
+bfi_ecode_t bfi_file_read_checksums(FILE *file_ptr,
+                    const bfi_section_t *sections, uint16_t section_cnt,
+                    const bfi_section_t *checked, bfi_checksums_t *checksums)
+{
+    char head[BFI_CHECKSUM_SEC_HDR_LEN];
+    uint32_t type;
+
+    checksums->crcs = NULL;
+
+    for (uint16_t i = 0; i < section_cnt; ++i) {
+        const bfi_section_t *sec = &sections[i];
+        bfi_ecode_t ret;
+
+        if (sec->type != BFI_SEC_CHECKSUM
+                || sec->length < BFI_CHECKSUM_SEC_HDR_LEN) {
+            continue;
+        }
+        ret = bfi_file_pread(file_ptr, sec->offset, sizeof(head), head);
+        if (ret != BFI_E_OK) {
+            return ret;
+        }
+        memcpy(&type, head, sizeof(type));
+        if (type != checked->type) {
+            continue;
+        }
+        memcpy(&checksums->part_size, head + sizeof(uint32_t),
+               sizeof(uint32_t));
+        memcpy(&checksums->part_cnt, head + 2 * sizeof(uint32_t),
+               sizeof(uint64_t));
+        if (checksums->part_size == 0
+                || checksums->part_cnt != (checked->length
+                                           + checksums->part_size - 1)
+                                          / checksums->part_size
+                || sec->length != BFI_CHECKSUM_SEC_HDR_LEN
+                                  + checksums->part_cnt * sizeof(uint32_t)) {
+            return BFI_E_LOAD_SECTION;
+        }
+
+        checksums->crcs = (uint32_t *) malloc(checksums->part_cnt
+                                              * sizeof(uint32_t) + 1);
+        if (!checksums->crcs) {
+            return BFI_E_LOAD_MEM;
+        }
+        ret = bfi_file_pread(file_ptr, sec->offset + BFI_CHECKSUM_SEC_HDR_LEN,
+                             checksums->part_cnt * sizeof(uint32_t),
+                             (char *) checksums->crcs);
+        if (ret != BFI_E_OK) {
+            free(checksums->crcs);
+            checksums->crcs = NULL;
+        }
+        return ret;
+    }
+
+    return BFI_E_OK;
+}
+
+
+typedef struct {
+    int fd;
+    const bfi_section_t *section;
+    const bfi_chunk_table_t *table;
+    uint64_t header_len;        // Chunks are decoded to the table behind
+    unsigned char *bf_table;    // the header
+    bfi_ecode_t ret;
+} bfi_file_decode_ctx_t;
+
+
+static void bfi_file_decode_worker(void *arg, uint64_t first, uint64_t end)
+{
+    bfi_file_decode_ctx_t *ctx = (bfi_file_decode_ctx_t *) arg;
+    const bfi_chunk_table_t *table = ctx->table;
+    char *chunk_bytes;
+    char *raw;
+
+    // Encoded chunk is never longer than the raw one
+    chunk_bytes = (char *) malloc(table->chunk_size);
+    raw = (char *) malloc(table->chunk_size);
+    if (!chunk_bytes || !raw) {
+        free(chunk_bytes);
+        free(raw);
+        bfi_parallel_error(&ctx->ret, BFI_E_LOAD_MEM);
+        return;
+    }
+
+    for (uint64_t c = first; c < end && ctx->ret == BFI_E_OK; ++c) {
+        const bfi_chunk_t *chunk = &table->chunks[c];
+        uint64_t start = c * table->chunk_size;
+        uint32_t raw_len = bfi_codec_chunk_raw_len(table, (uint32_t) c);
+        bool direct = start >= ctx->header_len;
+        char *dst = direct ? (char *) ctx->bf_table + (start - ctx->header_len)
+                           : raw;
+        bfi_ecode_t ret;
+
+        if (!bfi_file_pread_all(ctx->fd, ctx->section->offset + chunk->offset,
+                                chunk_bytes, chunk->length)) {
+            bfi_parallel_error(&ctx->ret, BFI_E_LOAD_SECTION);
+            break;
+        }
+        ret = bfi_codec_decode_chunk(chunk, chunk_bytes, dst, raw_len);
+        if (ret != BFI_E_OK) {
+            bfi_parallel_error(&ctx->ret, ret);
+            break;
+        }
+        // Chunk holding (a part of) the header
+        if (!direct && start + raw_len > ctx->header_len) {
+            memcpy(ctx->bf_table, raw + (ctx->header_len - start),
+                   start + raw_len - ctx->header_len);
+        }
+    }
+
+    free(chunk_bytes);
+    free(raw);
+}
+
+
+bfi_ecode_t bfi_file_read_filter(FILE *file_ptr, const bfi_section_t *section,
+                    const bfi_checksums_t *checksums, bloom_filter_h *bf,
+                    uint32_t *payload_crc)
+{
+    bfi_file_io_ctx_t io;
+    unsigned char *table;
+    uint64_t table_len;
+    uint32_t header_len;
+    char *header_bytes = NULL;
+    bfi_ecode_t ret;
+
+    if (checksums && !checksums->crcs) {
+        checksums = NULL;
+    }
+
+    ret = bfi_file_load_filter_header(file_ptr, section, bf, &header_len);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+    // Size of the table given by the header (validated by the engine), the
+    // table is allocated only after the payload is checked to hold it
+    bf_table(bf, &table_len);
+
+    memset(&io, 0, sizeof(io));
+    io.fd = fileno(file_ptr);
+    io.offset = section->offset;
+    io.part_size = checksums ? checksums->part_size : BFI_FILE_IO_PART;
+    io.crcs = checksums ? checksums->crcs : NULL;
+    if (payload_crc) {
+        io.read_crcs = (uint32_t *) malloc((section->length + io.part_size - 1)
+                                           / io.part_size * sizeof(uint32_t)
+                                           + 1);
+        if (!io.read_crcs) {
+            return BFI_E_LOAD_MEM;
+        }
+    }
+
+    if (section->encoding == BFI_ENC_RAW) {
+        if (section->length < header_len
+                || section->length - header_len != table_len) {
+            ret = BFI_E_LOAD_BYTES;
+            goto cleanup;
+        }
+        table = bf_allocate_table(bf, &table_len);
+        if (!table) {
+            ret = BFI_E_LOAD_MEM;
+            goto cleanup;
+        }
+        // Header is read again, so checksums of parts could be verified
+        header_bytes = (char *) malloc(header_len);
+        if (!header_bytes) {
+            ret = BFI_E_LOAD_MEM;
+            goto cleanup;
+        }
+        io.head = header_bytes;
+        io.head_len = header_len;
+        io.body = (char *) table;
+        io.body_len = table_len;
+        ret = bfi_file_io_parts(&io);
+    } else if (section->encoding == BFI_ENC_CHUNKED) {
+        bfi_file_decode_ctx_t ctx;
+        bfi_chunk_table_t chunks;
+
+        // Stored payload is verified (or its checksum is computed) before it
+        // is decoded
+        if (checksums || payload_crc) {
+            io.head_len = section->length;
+            ret = bfi_file_io_parts(&io);
+            if (ret != BFI_E_OK) {
+                goto cleanup;
+            }
+        }
+
+        ret = bfi_file_read_chunk_table(file_ptr, section, &chunks);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        if (chunks.raw_len < header_len
+                || chunks.raw_len - header_len != table_len) {
+            bfi_codec_free_table(&chunks);
+            ret = BFI_E_LOAD_BYTES;
+            goto cleanup;
+        }
+        table = bf_allocate_table(bf, &table_len);
+        if (!table) {
+            bfi_codec_free_table(&chunks);
+            ret = BFI_E_LOAD_MEM;
+            goto cleanup;
+        }
+        ctx.fd = fileno(file_ptr);
+        ctx.section = section;
+        ctx.table = &chunks;
+        ctx.header_len = header_len;
+        ctx.bf_table = table;
+        ctx.ret = BFI_E_OK;
+        bfi_parallel_for(chunks.chunk_cnt, BFI_FILE_PARALLEL_CHUNKS,
+                         bfi_file_decode_worker, &ctx);
+        bfi_codec_free_table(&chunks);
+        ret = ctx.ret;
+    } else {
+        ret = BFI_E_LOAD_SECTION;
+    }
+
+    if (ret == BFI_E_OK && payload_crc) {
+        *payload_crc = bfi_file_parts_checksum(io.read_crcs, io.part_size,
+                                               section->length);
+    }
+
+cleanup:
+    free(header_bytes);
+    free(io.read_crcs);
+
+    return ret;
+}
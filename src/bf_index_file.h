@@ -0,0 +1,360 @@
+/**
+ * \file bf_index_file.h
+ * \brief Sectioned (version 2) Bloom filter index file format (header file)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _BLOOMF_INDEX_FILE_H
+#define _BLOOMF_INDEX_FILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "bf_index_internal.h"
+#include "bf_codec.h"
+
+/* Version 2 index file format:
+ * +---------------------------------------------------------------------+
+ * | u16: magic (BFI_MAGIC_V2) | u16: version | u16: engine | u16: count |
+ * > ---- Section table (count items) ------------------------------------<
+ * | u32: type | u32: encoding | u64: offset | u64: length                |
+ * > ---- Section payloads ------------------------------------------------<
+ * +---------------------------------------------------------------------+
+ * > engine is bfi_engine_t of the stored index
+ * > offset of every section is relative to the beginning of the file
+ * > version 1 files (BFI_MAGIC, see bfi_store_index()) contain a single
+ *   Bloom filter and no section table
+ *
+ * Different magic (than BFI_MAGIC) is used so version 1 and version 2 files
+ * could be distinguished by their first two bytes. Endianity check works the
+ * same way as for version 1 files.
+ */
+#define BFI_MAGIC_V2 0x3457
+#define BFI_FILE_VERSION 2
+
+// Maximal count of sections stored by the library in one file
+#define BFI_SECTION_MAX 32
+
+typedef enum {
+    BFI_SEC_BLOOM = 1,          // Bloom filter (get_filter_as_bytes() format)
+    BFI_SEC_BLOCKS = 2,         // Block table and per-block Bloom filters
+    BFI_SEC_STABLE = 3,         // Stable Bloom filter parameters
+    BFI_SEC_CMS = 4,            // Count-min sketch
+    BFI_SEC_RANGE = 5,          // Range filter of a field (one per field)
+    BFI_SEC_SUMMARY = 6,        // Folded summary of the Bloom filter
+    BFI_SEC_META = 7,           // Time range of data of the index
+    BFI_SEC_ZONE = 8,           // Zone map of inserted addresses
+    BFI_SEC_CHECKSUM = 9,       // Checksums of parts of another section
+    BFI_SEC_TEMPORAL = 10,      // Temporal Bloom filter parameters
+    BFI_SEC_QUOTIENT = 11,      // Quotient filter parameters
+    BFI_SEC_REGISTER = 12,      // Register-blocked Bloom filter parameters
+} bfi_section_type_t;
+
+/* BFI_SEC_META section format:
+ * +---------------------------------------------------------------------+
+ * | u64: time first | u64: time last                                    |
+ * +---------------------------------------------------------------------+
+ */
+#define BFI_META_SEC_LEN (2 * sizeof(uint64_t))
+
+/* BFI_SEC_ZONE section format:
+ * +---------------------------------------------------------------------+
+ * | u32: IPv4 min | u32: IPv4 max                                       |
+ * | u64[4]: first octets of IPv4 addresses                              |
+ * | u64[16]: sketch of /16 prefixes of IPv6 addresses                   |
+ * +---------------------------------------------------------------------+
+ */
+#define BFI_ZONE_SEC_LEN (2 * sizeof(uint32_t) \
+                          + (BFI_ZONE_IPV4_WORDS + BFI_ZONE_IPV6_WORDS) \
+                            * sizeof(uint64_t))
+
+/* BFI_SEC_CHECKSUM section format:
+ * +---------------------------------------------------------------------+
+ * | u32: type of the checked section | u32: size of a part              |
+ * | u64: count of parts | u32[]: CRC-32C of every part                  |
+ * +---------------------------------------------------------------------+
+ * > parts of stored (i.e. encoded) payload of the checked section are
+ *   checked, so a corrupted file is detected before it is decoded
+ */
+#define BFI_CHECKSUM_SEC_HDR_LEN (2 * sizeof(uint32_t) + sizeof(uint64_t))
+
+// Size of a part of a payload read or written by one call (and by one thread
+// of parallel I/O) and of a part covered by one checksum
+#define BFI_FILE_IO_PART (4 * 1024 * 1024)
+
+typedef enum {
+    BFI_ENC_RAW = 0,            // Payload stored as is
+    BFI_ENC_CHUNKED = 1,        // Chunked archival encoding (see bf_codec.h)
+} bfi_section_encoding_t;
+
+typedef struct {
+    uint16_t magic;
+    uint16_t version;
+    uint16_t engine;
+    uint16_t section_cnt;
+} bfi_file_header_t;
+
+typedef struct {
+    uint32_t type;
+    uint32_t encoding;
+    uint64_t offset;
+    uint64_t length;
+} bfi_section_t;
+
+typedef struct {
+    uint32_t part_size;
+    uint64_t part_cnt;
+    uint32_t *crcs;             // Checksum of every part (or NULL)
+} bfi_checksums_t;
+
+/**
+ * \brief Write version 2 index file
+ *
+ * Offsets of sections are computed by this function, type, encoding and
+ * length of every section has to be set by the caller. Payloads given as NULL
+ * are skipped, the caller writes them later (see bfi_file_pwrite_parts()).
+ *
+ * \param[in] file_ptr File opened for writing (positioned at its beginning)
+ * \param[in] engine Engine of the stored index
+ * \param[in] align Alignment of offsets of payloads given as NULL (e.g. for
+ *    direct writes), 0 means no alignment
+ * \param[in/out] sections Section table (offsets are filled in)
+ * \param[in] payloads Payload of every section
+ * \param[in] section_cnt Count of sections
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_file_write(FILE *file_ptr, uint16_t engine, uint32_t align,
+                    bfi_section_t *sections, const char * const *payloads,
+                    uint16_t section_cnt);
+
+/**
+ * \brief CRC-32C checksum and size of a file written by bfi_file_write()
+ *
+ * Computed from the written data, the file is not read. Gaps before
+ * aligned payloads are zeros.
+ *
+ * \param[in] engine Engine of the stored index
+ * \param[in] sections Section table filled in by bfi_file_write()
+ * \param[in] payloads Payload of every section (or NULL), NULL means that
+ *    checksums of all payloads are given
+ * \param[in] payload_crcs Checksums of payloads given as NULL
+ * \param[in] section_cnt Count of sections
+ * \param[out] file_size Size of the file
+ * \return Returns checksum of the whole file.
+ */
+uint32_t bfi_file_checksum(uint16_t engine, const bfi_section_t *sections,
+                    const char * const *payloads, const uint32_t *payload_crcs,
+                    uint16_t section_cnt, uint64_t *file_size);
+
+/**
+ * \brief CRC-32C checksum of a payload by checksums of its parts (see
+ *    bfi_file_pwrite_parts())
+ */
+uint32_t bfi_file_parts_checksum(const uint32_t *crcs, uint32_t part_size,
+                    uint64_t len);
+
+/**
+ * \brief Read header and section table of version 2 index file
+ *
+ * \param[in] file_ptr File opened for reading (positioned at its beginning)
+ * \param[out] header File header
+ * \param[out] sections Newly allocated section table (free() it)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_file_read_toc(FILE *file_ptr, bfi_file_header_t *header,
+                    bfi_section_t **sections);
+
+/**
+ * \brief Find first section of a given type in section table
+ *
+ * \return Returns pointer to the section or NULL if there is no such section.
+ */
+const bfi_section_t *bfi_file_find_section(const bfi_section_t *sections,
+                    uint16_t section_cnt, uint32_t type);
+
+/**
+ * \brief Read payload of a section
+ *
+ * Encoded payload is decoded, so the length of the payload could differ from
+ * the length of the section.
+ *
+ * \param[in] file_ptr File opened for reading
+ * \param[in] section Section to read
+ * \param[out] payload Newly allocated payload (free() it)
+ * \param[out] length Length of the payload
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_file_read_section(FILE *file_ptr, const bfi_section_t *section,
+                    char **payload, uint64_t *length);
+
+/**
+ * \brief Read exactly len bytes at offset of a file
+ *
+ * \return Returns BFI_OK on success, BFI_E_LOAD_SECTION otherwise.
+ */
+bfi_ecode_t bfi_file_pread(FILE *file_ptr, uint64_t offset, uint64_t len,
+                    char *buff);
+
+/**
+ * \brief Read exactly len bytes at offset of a file descriptor by pread()
+ *
+ * Neither position nor buffer of a stream of the descriptor is used, so
+ * small reads do not fill the whole stream buffer.
+ *
+ * \return Returns BFI_OK on success, BFI_E_LOAD_SECTION otherwise.
+ */
+bfi_ecode_t bfi_file_pread_fd(int fd, uint64_t offset, uint64_t len,
+                    char *buff);
+
+/**
+ * \brief Read chunk table of an encoded (BFI_ENC_CHUNKED) section
+ *
+ * \param[in] file_ptr File opened for reading
+ * \param[in] section Encoded section
+ * \param[out] table Chunk table (free it by bfi_codec_free_table())
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_file_read_chunk_table(FILE *file_ptr,
+                    const bfi_section_t *section, bfi_chunk_table_t *table);
+
+/**
+ * \brief Read part of (decoded) payload of a section
+ *
+ * Only chunks covering the part are read and decoded if the section is
+ * encoded.
+ *
+ * \param[in] file_ptr File opened for reading
+ * \param[in] section Section to read
+ * \param[in] offset Offset of the part in the payload
+ * \param[in] len Length of the part
+ * \param[out] buff Buffer for the part (len bytes)
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_file_read_part(FILE *file_ptr, const bfi_section_t *section,
+                    uint64_t offset, uint64_t len, char *buff);
+
+/**
+ * \brief Encode payload of a section by chunked encoding
+ *
+ * Payload is kept raw if the encoding does not make it shorter.
+ *
+ * \param[in/out] section Section (encoding and length are updated)
+ * \param[in/out] payload Payload of the section (set to encoded payload)
+ * \param[out] encoded Newly allocated encoded payload or NULL (free() it)
+ * \param[in] chunk_size Size of a chunk (0 means default)
+ */
+void bfi_file_encode_section(bfi_section_t *section, const char **payload,
+                    char **encoded, uint32_t chunk_size);
+
+/**
+ * \brief Read header of the (file-level) filter of an index file
+ *
+ * Only parameters of the filter are read (not its table), so e.g. a family
+ * of a filter could be checked or hash values computed without loading
+ * the whole filter. Version 1 and version 2 files are supported.
+ *
+ * \param[in] file_ptr File opened for reading
+ * \param[out] engine Engine of the stored index
+ * \param[out] bf Newly created filter with loaded header (bf_delete_filter())
+ * \param[out] filter_section Section of the filter (get_filter_as_bytes()
+ *    format), raw section is filled in for version 1 files
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_file_read_filter_header(FILE *file_ptr, uint16_t *engine,
+                    bloom_filter_h **bf, bfi_section_t *filter_section);
+
+/**
+ * \brief Write payload given by two parts at offset of a file (in parallel)
+ *
+ * Payload is written by parts of BFI_FILE_IO_PART bytes, parts are divided
+ * among threads (see bfi_set_io_threads()).
+ *
+ * \param[in] file_ptr File opened for writing (flushed by this function)
+ * \param[in] direct_fd Descriptor of the file opened by bfi_io_open_direct()
+ *    or -1, direct writes need offset aligned to BFI_IO_DIRECT_ALIGN and the
+ *    last block is padded (the file has to be truncated by the caller)
+ * \param[in] offset Offset of the payload in the file
+ * \param[in] head First part of the payload
+ * \param[in] head_len Length of the first part
+ * \param[in] body Second part of the payload (or NULL)
+ * \param[in] body_len Length of the second part
+ * \param[out] crcs Checksums of written parts (or NULL), array of
+ *    bfi_file_part_cnt() items
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_file_pwrite_parts(FILE *file_ptr, int direct_fd,
+                    uint64_t offset, const char *head, uint64_t head_len,
+                    const char *body, uint64_t body_len, uint32_t *crcs);
+
+/**
+ * \brief Count of parts of a payload (BFI_FILE_IO_PART bytes each)
+ */
+uint64_t bfi_file_part_cnt(uint64_t len);
+
+/**
+ * \brief Read checksums of a section (BFI_SEC_CHECKSUM)
+ *
+ * \param[in] file_ptr File opened for reading
+ * \param[in] sections Section table
+ * \param[in] section_cnt Count of sections
+ * \param[in] checked Checked section
+ * \param[out] checksums Checksums (crcs is NULL if there are none), free
+ *    crcs by free()
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+bfi_ecode_t bfi_file_read_checksums(FILE *file_ptr,
+                    const bfi_section_t *sections, uint16_t section_cnt,
+                    const bfi_section_t *checked, bfi_checksums_t *checksums);
+
+/**
+ * \brief Load filter stored in a section (in parallel)
+ *
+ * Table is read (or read and decoded) directly to the filter by several
+ * threads (see bfi_set_io_threads()), so even large filters are loaded
+ * without an extra copy.
+ *
+ * \param[in] file_ptr File opened for reading
+ * \param[in] section Section of the filter (get_filter_as_bytes() format)
+ * \param[in] checksums Checksums of the section (or NULL)
+ * \param[in/out] bf Empty filter of the stored engine
+ * \param[out] payload_crc CRC-32C of the whole payload as read (or NULL),
+ *    compressed payloads are read once more to compute it
+ * \return Returns BFI_OK on success, BFI_E_CHECKSUM on checksum mismatch,
+ *    other error code otherwise.
+ */
+bfi_ecode_t bfi_file_read_filter(FILE *file_ptr, const bfi_section_t *section,
+                    const bfi_checksums_t *checksums, bloom_filter_h *bf,
+                    uint32_t *payload_crc);
+
+#endif //_BLOOMF_INDEX_FILE_H
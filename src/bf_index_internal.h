@@ -44,6 +44,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include "bf_index.h"
 #include "bloomf_wrapper.h"
 
 // Magic number (16 bit integer) has to be at the beginning of every file. This
@@ -52,146 +53,248 @@
 //    https://github.com/switch-ch/nfdump-libnfread/blob/master/bin/nffile.h
 #define BFI_MAGIC 0x3456
 
-typedef bloom_filter_h *bfi_index_ptr_t;
+// Hash values of a key are kept on the stack up to this count of hash
+// functions, heap is used for (unusual) filters with more hash functions.
+#define BFI_STACK_HASH_CNT 64
 
-typedef enum {
-    BFI_E_OK = 0,
-    BFI_E_BP_COMP_PARAMS,
-    BFI_E_NO_INDEX,
-    BFI_E_STO_FILE_ERR,
-    BFI_E_STO_BYTES,
-    BFI_E_STO_MAGIC,
-    BFI_E_STO_IDX_LEN,
-    BFI_E_STO_INDEX,
-    BFI_E_LOAD_MEM,
-    BFI_E_LOAD_FILE_ERR,
-    BFI_E_LOAD_BYTES,
-    BFI_E_LOAD_MAGIC,
-    BFI_E_LOAD_BAD_MAGIC,
-    BFI_E_LOAD_IDX_LEN,
-    BFI_E_LOAD_ZERO_LEN,
-    BFI_E_LOAD_INDEX,
-}bfi_ecode_t;
+// Maximal count of hash functions of a filter given by a family descriptor
+// (optimal count is searched below 1000, see compute_optimal_parameters())
+#define BFI_FAMILY_HASH_CNT_MAX 1000
 
+// Maximal count of range filters attached to one index
+#define BFI_RANGE_MAX 8
 
-const char *bfi_error_messages [] = {
-    "BFI info: OK.",
-    "BFI error: Unable to compute Bloom filter optimal parameters.",
-    "BFI error: Passed empty index.",
-    "BFI error: Store: Unable to open file for storing an index.",
-    "BFI error: Store: Unable to get an index binary representation.",
-    "BFI error: Store: Unable to write the magic.",
-    "BFI error: Store: Unable to write an index size.",
-    "BFI error: Store: Unable to write an index.",
-	"BFI error: Load: Unable to allocate memory.",
-	"BFI error: Load: Unable to open file for loading an index.",
-    "BFI error: Load: Unable to load an index from binary representation."\
-		"(because of corrupted file or different data type sizes).",
-    "BFI error: Load: Unable to read the magic.",
-    "BFI error: Load: Read bad magic.",
-    "BFI error: Load: Unable to read an index size.",
-    "BFI error: Load: Zero index size.",
-    "BFI error: Load: Unable to read an index",
-};
+// Required false positive probability of a folded summary (the summary has to
+// reject at least 9 of 10 queries of missing addresses to be useful)
+#define BFI_SUMMARY_FP_PROB 0.1
 
 /**
- * \brief Print error message according to BFI error code
+ * \brief Range filter of a field
+ */
+typedef struct {
+    uint16_t field_id;
+    bloom_filter_h *rbf;
+} bfi_range_t;
+
+/**
+ * \brief Index (bfi_index_ptr_t points to this structure)
+ *
+ * Filters of all engines are derived from the Bloom filter, so bf_* wrapper
+ * functions work for all of them (engine specific calls are made only for
+ * engine specific parameters).
+ */
+typedef struct {
+    bfi_engine_t engine;
+    bloom_filter_h *bf;
+    count_min_sketch_h *cms;        // Optional count-min sketch (or NULL)
+    bfi_range_t ranges[BFI_RANGE_MAX];  // Attached range filters
+    uint16_t range_cnt;
+    bfi_zone_t zone;                // Zone map of inserted addresses
+    void *locked_table;             // Pages locked by bfi_prefetch_index()
+    uint64_t locked_len;
+    bloom_filter_h **replicas;      // Copies of bf per NUMA node (or NULL)
+    uint32_t replica_cnt;           // Count of nodes (bfi_numa_node_cnt())
+} bfi_index_t;
+
+/**
+ * \brief Index file just stored or loaded (its catalog entry and statistics
+ *    are made without reading the file again)
+ */
+typedef struct {
+    uint64_t file_size;
+    uint32_t checksum;              // CRC-32C of the written (read) file
+    uint64_t time_first;            // Time range stored in the file
+    uint64_t time_last;
+    bool zone_map;                  // Zone map of the index is stored
+    char *summary;                  // Summary section payload (or NULL)
+    uint64_t summary_len;
+} bfi_stored_t;
+
+// Error messages, indexed by bfi_ecode_t
+extern const char *bfi_error_messages [];
+
+/**
+ * \brief Compute hash values of a key with hash functions of a given filter
+ *
+ * Hash values depend only on the count of hash functions and the random seed
+ * of the filter, so they could be re-used for all filters sharing these
+ * parameters (e.g. filters of one block index).
+ *
+ * \param[in] bf Filter which hash functions are used
+ * \param[in] buffer Buffer containing the key
+ * \param[in] len Length of the key in buffer
+ * \param[in] stack_hashes Array of BFI_STACK_HASH_CNT items to use if possible
+ * \return Returns array of hash values (stack_hashes or newly allocated array
+ *    which has to be freed by bfi_free_hashes()) or NULL on allocation error.
+ */
+uint32_t *bfi_compute_hashes(bloom_filter_h *bf, const unsigned char *buffer,
+                    size_t len, uint32_t *stack_hashes);
+
+/**
+ * \brief Compute hash values of a key made of fragments (see
+ *    bfi_compute_hashes())
  *
- * \note Error is printed to stderr.
- * \param[in] ecode Bloom filter index error code
+ * Hash values are the same as of the concatenated fragments.
+ */
+uint32_t *bfi_compute_hashes_iov(bloom_filter_h *bf, const bfi_iovec_t *iov,
+                    size_t iov_cnt, uint32_t *stack_hashes);
+
+/**
+ * \brief Free hash values returned by bfi_compute_hashes()
  */
-const char *bfi_get_error_msg(bfi_ecode_t ecode);
+void bfi_free_hashes(uint32_t *hashes, uint32_t *stack_hashes);
 
 /**
- * \brief Initialize Bloom filter index
+ * \brief Compute optimal parameters of a filter (thread-safe)
  *
- * Computes optimal Bloom filter parameters and create new Bloom filter.
- * \param[in] index_ptr Pointer to Bloom filter index
- * \param[in] est_item_cnt Estimated count of items in Bloom filter
- * \param[in] fp_prob Required false positive probability of Bloom filter
- * \return Returns BFI_OK on success, error code otherwise.
+ * Same as bp_compute_optimal_parameters(), but results are cached for
+ * recently used (item count, false positive probability) pairs, since the
+ * computation is rather expensive compared to creation of a small filter.
+ *
+ * \return Returns false if the parameters are invalid.
  */
-bfi_ecode_t bfi_init_index(bfi_index_ptr_t *index_ptr, uint64_t est_item_cnt,
-							double fp_prob);
+bool bfi_compute_parameters(bloom_parameters_h *bp);
+
+// Register-blocked filters (see RegisterBloomFilter.hpp)
+#define BFI_REGISTER_WORD_BITS 64
+#define BFI_REGISTER_WORD_MAX (1 << 22)
+#define BFI_REGISTER_PATTERNS 1024     // Masks per half of a word
+#define BFI_REGISTER_KEY_BITS_MAX 16
 
 /**
- * \brief Destroy Bloom filter index
+ * \brief False positive probability of a register-blocked filter
  *
- * \note Sets pointer to index to NULL.
- * \param[in] index_ptr Pointer to pointer to index to free
+ * Keys per word are Poisson distributed, a missing key is a false positive
+ * if all bits of its mask are set by other keys of its word or if its mask
+ * is the same as of one of them. Masks of keys of one word differ in lower
+ * bits of the hash value only, so large tables have fewer distinct masks.
+ *
+ * \param[in] bits_per_key Count of bits of a mask
+ * \param[in] load Average count of keys per word
+ * \param[in] word_cnt Count of words of the table
  */
-void bfi_destroy_index(bfi_index_ptr_t *index_ptr);
+double bfi_register_fp_prob(uint32_t bits_per_key, double load,
+                    double word_cnt);
 
 /**
- * \brief Add item to Bloom filter
+ * \brief Table size (bits) of a register-blocked filter of item_cnt items
+ *    with fp_prob
  *
- * Add an item to Bloom filter. If the item is already present, nothing
- * happens. To allow optimization of Bloom filter size based on
- * inserted_element_count_ variable (see BloomFilter.hpp) containsinsert() is
- * used instead of insert() since it increments this variable only if inserted
- * item is new to the filter (i.e. inserted_element_count_ is unique element
- * count).                              .
- * \param[in/out] index_ptr Bloom filter index
- * \param[in] buffer Buffer containing value to insert
- * \param[in] len Length of value in buffer
- * \return Returns BFI_OK on success, error code otherwise.
+ * \return Returns 0 if the table would be too large.
  */
-bfi_ecode_t bfi_add_addr_index(bfi_index_ptr_t index_ptr, const unsigned char *buffer,
-                    const size_t len);
+uint64_t bfi_register_table_size(uint64_t item_cnt, uint32_t bits_per_key,
+                    double fp_prob);
 
 /**
- * \brief Clear Bloom filter index.
- * \param[in] index_ptr Pointer to index structure to clear
- * \return Returns BFI_OK on success, error code otherwise.
+ * \brief Read parameters of a register-blocked filter of an opened index
+ *    file (filter header is already loaded to bf)
  */
-bfi_ecode_t bfi_clear_index(bfi_index_ptr_t index_ptr);
+bfi_ecode_t bfi_register_read_file(FILE *file_ptr, bloom_filter_h *bf);
 
 /**
- * \brief Check if address is contained in Bloom filter
+ * \brief Create empty filter of an engine (to be loaded from bytes)
  *
- * \param[in/out] index_ptr Bloom filter index
- * \param[in] buffer Buffer containing value to check
- * \param[in] len Length of value in buffer
- * \return True if value in the buffer is present in the Bloom filter, False
-*    otherwise.
+ * \return Returns new filter or NULL if the engine is unknown.
  */
-bool bfi_addr_is_stored(bfi_index_ptr_t index_ptr, const unsigned char *buffer,
-                    const size_t len);
+bloom_filter_h *bfi_new_empty_filter(bfi_engine_t engine);
 
 /**
- * \brief Gets count of items stored in Bloom filter index
+ * \brief Load an index and describe its file (see bfi_load_index())
  *
- * \param[in] index_ptr Bloom filter index
- * \return Returns count of items.
+ * Size and checksum of the file are computed from the data read by the load
+ * (see bfi_file_read_filter()), summary of stored has to be freed.
  */
-uint64_t bfi_stored_item_cnt(bfi_index_ptr_t index_ptr);
+bfi_ecode_t bfi_load_index_stored(bfi_index_ptr_t *index_ptr, char *filename,
+                    bfi_stored_t *stored);
 
 /**
- * \brief Store Bloom filter index to a file
+ * \brief Add index file just stored to a catalog (see bfi_catalog_add())
  *
- * Stores index length and Bloom filter index structure itself. Binary
- * representation of stored Bloom filter is given by BloomFilter.hpp code.
+ * Statistics are taken from the index in memory and from the stored file
+ * description, the file is not read. Summary of stored is freed.
+ */
+bfi_ecode_t bfi_catalog_add_stored(char *catalog, char *filename,
+                    bfi_index_t *index, bfi_stored_t *stored);
+
+/**
+ * \brief Fold a Bloom filter to a summary
  *
- * \note Every file begins with special 16-bit integer for format and endianity
- *   check.
- * \param[in] index_ptr Bloom filter index (index to store)
- * \param[in] filename Destination file path
- * \return Returns BFI_OK on success, error code otherwise.
+ * The largest fold factor (power of 2 up to max_fold) which keeps false
+ * positive probability of the summary below BFI_SUMMARY_FP_PROB is used.
+ *
+ * \return Returns new folded filter or NULL if no fold is useful.
  */
-bfi_ecode_t bfi_store_index(bfi_index_ptr_t index_ptr, char *filename);
+bloom_filter_h *bfi_summary_fold(bloom_filter_h *bf, uint32_t max_fold);
 
 /**
- * \brief Load Bloom filter index from a file
+ * \brief Get summary as BFI_SEC_SUMMARY section payload
  *
- * Load index length and Bloom filter index binary representation from the file.
- * Fill an index structure with loaded data.
+ * \return Returns length of the payload (free() it) or 0 on error.
+ */
+uint64_t bfi_summary_as_bytes(bloom_filter_h *summary, char **buff);
+
+/**
+ * \brief Re-create summary from BFI_SEC_SUMMARY section payload
+ */
+bfi_ecode_t bfi_summary_from_bytes(const char *buff, uint64_t len,
+                    bloom_filter_h **summary);
+
+/**
+ * \brief Fold factor of a summary given by BFI_SEC_SUMMARY section payload
+ *
+ * \return Returns the fold factor or 0 if the payload is invalid.
+ */
+uint32_t bfi_summary_fold_factor(const char *buff, uint64_t len);
+
+/**
+ * \brief Reset zone map (no address recorded)
+ *
+ * \param[in] valid Zone map describes all addresses of the index
+ */
+void bfi_zone_reset(bfi_zone_t *zone, bool valid);
+
+/**
+ * \brief Record inserted address in a zone map
+ */
+void bfi_zone_update(bfi_zone_t *zone, const unsigned char *buffer,
+                    size_t len);
+
+/**
+ * \brief Record inserted key made of fragments in a zone map
+ */
+void bfi_zone_update_iov(bfi_zone_t *zone, const bfi_iovec_t *iov,
+                    size_t iov_cnt);
+
+/**
+ * \brief Check if a key made of fragments passes a zone map
+ */
+bool bfi_zone_may_contain_iov(const bfi_zone_t *zone, const bfi_iovec_t *iov,
+                    size_t iov_cnt);
+
+/**
+ * \brief Merge zone map of another index into a zone map
+ */
+void bfi_zone_merge(bfi_zone_t *dst, const bfi_zone_t *src);
+
+/**
+ * \brief Get zone map as BFI_SEC_ZONE section payload
+ *
+ * \param[out] buff Buffer of BFI_ZONE_SEC_LEN bytes
+ * \return Returns length of the payload.
+ */
+uint64_t bfi_zone_as_bytes(const bfi_zone_t *zone, char *buff);
+
+/**
+ * \brief Re-create zone map from BFI_SEC_ZONE section payload
+ */
+bfi_ecode_t bfi_zone_from_bytes(const char *buff, uint64_t len,
+                    bfi_zone_t *zone);
+
+/**
+ * \brief Read zone map of an opened index file
  *
- * \note Every file begins with special 16-bit integer for format and endianity
- *   check.
- * \param[in] index_ptr Bloom filter index (where to load the index)
- * \param[in] filename Destination file path (load index from here)
- * \return Returns BFI_OK on success, error code otherwise.
+ * Zone map is invalid if the file has no zone map (e.g. version 1 file).
  */
-bfi_ecode_t bfi_load_index(bfi_index_ptr_t *index_ptr, char *filename);
+bfi_ecode_t bfi_zone_read_file(FILE *file_ptr, bfi_zone_t *zone);
 
 #endif //_BLOOMF_INDEXES_INTERNAL_H
@@ -0,0 +1,177 @@
+/**
+ * \file bf_io.c
+ * \brief I/O policies of index files (page cache, readahead, locking)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+// O_DIRECT
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "bf_io.h"
+#include "bloomf_wrapper.h"
+
+// Global I/O policy (flags of bfi_io_policy_t)
+static uint32_t bfi_io_policy = BFI_IO_DEFAULT;
+
+
+void bfi_set_io_policy(uint32_t policy)
+{
+    __atomic_store_n(&bfi_io_policy, policy, __ATOMIC_RELAXED);
+}
+
+
+uint32_t bfi_get_io_policy(void)
+{
+    return __atomic_load_n(&bfi_io_policy, __ATOMIC_RELAXED);
+}
+
+
+void bfi_io_advise_file(int fd, uint32_t policy, bool random)
+{
+#ifdef POSIX_FADV_RANDOM
+    if (random && (policy & BFI_IO_RANDOM)) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+    }
+    if (!random && (policy & BFI_IO_WILLNEED)) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    }
+#endif
+}
+
+
+void bfi_io_advise_range(int fd, uint64_t offset, uint64_t len)
+{
+#ifdef POSIX_FADV_WILLNEED
+    posix_fadvise(fd, (off_t) offset, (off_t) len, POSIX_FADV_WILLNEED);
+#endif
+}
+
+
+void bfi_io_advise_map(void *map, size_t len, uint32_t policy)
+{
+    if (policy & BFI_IO_RANDOM) {
+        madvise(map, len, MADV_RANDOM);
+    }
+    if (policy & BFI_IO_WILLNEED) {
+        madvise(map, len, MADV_WILLNEED);
+    }
+}
+
+
+int bfi_io_close(FILE *file_ptr, uint32_t policy, bool written)
+{
+#ifdef POSIX_FADV_DONTNEED
+    if (policy & BFI_IO_DONTNEED) {
+        int fd = fileno(file_ptr);
+
+        // Dirty pages are not dropped
+        if (!written || (fflush(file_ptr) == 0 && fdatasync(fd) == 0)) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+    }
+#endif
+
+    return fclose(file_ptr);
+}
+
+
+int bfi_io_open_direct(const char *filename)
+{
+#ifdef O_DIRECT
+    return open(filename, O_WRONLY | O_DIRECT);
+#else
+    return -1;
+#endif
+}
+
+
+bfi_ecode_t bfi_prefetch_index(bfi_index_ptr_t index_ptr, bool lock)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    const unsigned char *table;
+    volatile unsigned char sink = 0;
+    uintptr_t begin;
+    uint64_t len;
+    long page;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+
+    table = bf_table(index->bf, &len);
+    if (len == 0) {
+        return BFI_E_OK;
+    }
+
+    // Whole pages holding the table
+    page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) {
+        page = BFI_IO_DIRECT_ALIGN;
+    }
+    begin = (uintptr_t) table & ~((uintptr_t) page - 1);
+    len += (uintptr_t) table - begin;
+
+    madvise((void *) begin, len, MADV_WILLNEED);
+    for (uint64_t i = 0; i < len; i += page) {
+        sink ^= ((const unsigned char *) begin)[i];
+    }
+    (void) sink;
+
+    if (lock && !index->locked_table) {
+        if (mlock((void *) begin, len) != 0) {
+            return BFI_E_LOCK;
+        }
+        index->locked_table = (void *) begin;
+        index->locked_len = len;
+    }
+
+    return BFI_E_OK;
+}
+
+
+void bfi_io_unlock_index(bfi_index_t *index)
+{
+    if (index->locked_table) {
+        munlock(index->locked_table, index->locked_len);
+        index->locked_table = NULL;
+        index->locked_len = 0;
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * \file bf_io.h
+ * \brief I/O policies of index files (page cache, readahead, locking)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _BLOOMF_IO_H
+#define _BLOOMF_IO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bf_index_internal.h"
+
+// Alignment of buffers, offsets and lengths of direct (O_DIRECT) writes
+#define BFI_IO_DIRECT_ALIGN 4096
+
+/**
+ * \brief Advise kernel how a file opened for loading will be read
+ *
+ * \param[in] fd File descriptor
+ * \param[in] policy I/O policy (flags of bfi_io_policy_t)
+ * \param[in] random Random access (e.g. probes of a cold index) expected
+ */
+void bfi_io_advise_file(int fd, uint32_t policy, bool random);
+
+/**
+ * \brief Advise kernel that a range of a file will be read soon
+ *
+ * Reads of all ranges of a batch are started before the first of them is
+ * waited for, so the device serves them concurrently.
+ */
+void bfi_io_advise_range(int fd, uint64_t offset, uint64_t len);
+
+/**
+ * \brief Advise kernel how a file mapped to memory will be read
+ */
+void bfi_io_advise_map(void *map, size_t len, uint32_t policy);
+
+/**
+ * \brief Close a stored or loaded index file according to an I/O policy
+ *
+ * With BFI_IO_DONTNEED pages of the file are dropped from the page cache
+ * (written files are synced first, only clean pages could be dropped).
+ *
+ * \param[in] file_ptr File to close
+ * \param[in] policy I/O policy (flags of bfi_io_policy_t)
+ * \param[in] written File was written
+ * \return Returns 0 on success, EOF on error (as fclose()).
+ */
+int bfi_io_close(FILE *file_ptr, uint32_t policy, bool written);
+
+/**
+ * \brief Open a file for direct writes bypassing the page cache
+ *
+ * \return Returns file descriptor or -1 if direct I/O is not supported
+ *    (by the system or by the file system).
+ */
+int bfi_io_open_direct(const char *filename);
+
+/**
+ * \brief Unlock memory of an index locked by bfi_prefetch_index()
+ */
+void bfi_io_unlock_index(bfi_index_t *index);
+
+#endif //_BLOOMF_IO_H
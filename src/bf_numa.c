@@ -0,0 +1,256 @@
+/**
+ * \file bf_numa.c
+ * \brief NUMA topology and per-node replicas of read-only indexes
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "bf_numa.h"
+#include "bloomf_wrapper.h"
+
+// Topology read from sysfs
+static pthread_once_t bfi_numa_once = PTHREAD_ONCE_INIT;
+static uint32_t bfi_numa_node_total = 1;
+static uint8_t bfi_numa_cpu_node[CPU_SETSIZE];
+static cpu_set_t bfi_numa_node_cpus[BFI_NUMA_NODE_MAX];
+
+typedef struct {
+    pthread_t thread;
+    bloom_filter_h *bf;             // Original filter
+    bloom_filter_h *copy;           // Replica allocated by the thread
+} bfi_numa_copy_t;
+
+
+/**
+ * \brief Read a sysfs list of ids (e.g. "0-3,8-11") to a set
+ *
+ * \return Returns false if the list could not be read.
+ */
+static bool bfi_numa_read_list(const char *path, cpu_set_t *set)
+{
+    FILE *file_ptr = fopen(path, "r");
+    unsigned int first;
+    unsigned int last;
+    int c = ',';
+
+    CPU_ZERO(set);
+    if (!file_ptr) {
+        return false;
+    }
+    while (c == ',' && fscanf(file_ptr, "%u", &first) == 1) {
+        last = first;
+        c = fgetc(file_ptr);
+        if (c == '-') {
+            if (fscanf(file_ptr, "%u", &last) != 1) {
+                break;
+            }
+            c = fgetc(file_ptr);
+        }
+        for (unsigned int id = first; id <= last && id < CPU_SETSIZE; ++id) {
+            CPU_SET(id, set);
+        }
+    }
+    fclose(file_ptr);
+
+    return true;
+}
+
+
+/**
+ * \brief Read nodes and their processors (once per process)
+ */
+static void bfi_numa_init(void)
+{
+    cpu_set_t nodes;
+    char path[64];
+
+    if (!bfi_numa_read_list("/sys/devices/system/node/online", &nodes)) {
+        return;
+    }
+    for (uint32_t node = 0; node < BFI_NUMA_NODE_MAX; ++node) {
+        if (!CPU_ISSET(node, &nodes)) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist",
+                 node);
+        bfi_numa_read_list(path, &bfi_numa_node_cpus[node]);
+        for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &bfi_numa_node_cpus[node])) {
+                bfi_numa_cpu_node[cpu] = (uint8_t) node;
+            }
+        }
+        bfi_numa_node_total = node + 1;
+    }
+}
+
+
+uint32_t bfi_numa_node_cnt(void)
+{
+    pthread_once(&bfi_numa_once, bfi_numa_init);
+
+    return bfi_numa_node_total;
+}
+
+
+uint32_t bfi_numa_node(void)
+{
+    int cpu = sched_getcpu();
+
+    // Topology is read before the first replica is created
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return 0;
+    }
+
+    return bfi_numa_cpu_node[cpu];
+}
+
+
+static void *bfi_numa_copy_worker(void *arg)
+{
+    bfi_numa_copy_t *copy = (bfi_numa_copy_t *) arg;
+
+    // Pages of the table are placed on the node of the first touch
+    copy->copy = new_bloom_filter_f(copy->bf);
+
+    return NULL;
+}
+
+
+/**
+ * \brief Start a thread copying the filter on processors of a node
+ *
+ * \return Returns false if no processor of the node may run the thread.
+ */
+static bool bfi_numa_start_copy(uint32_t node, bfi_numa_copy_t *copy)
+{
+    pthread_attr_t attr;
+    cpu_set_t allowed;
+    cpu_set_t cpus;
+    bool started;
+
+    // Processors of the node the process may run on (e.g. in a cpuset)
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return false;
+    }
+    CPU_AND(&cpus, &allowed, &bfi_numa_node_cpus[node]);
+    if (CPU_COUNT(&cpus) == 0 || pthread_attr_init(&attr) != 0) {
+        return false;
+    }
+    started = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus) == 0
+              && pthread_create(&copy->thread, &attr, bfi_numa_copy_worker,
+                                copy) == 0;
+    pthread_attr_destroy(&attr);
+
+    return started;
+}
+
+
+bfi_ecode_t bfi_replicate_index(bfi_index_ptr_t index_ptr)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+    bfi_numa_copy_t copies[BFI_NUMA_NODE_MAX];
+    bool started[BFI_NUMA_NODE_MAX] = { false };
+    bloom_filter_h **replicas;
+    uint32_t node_cnt = bfi_numa_node_cnt();
+    bfi_ecode_t ret = BFI_E_OK;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+    if (index->engine != BFI_ENGINE_STANDARD) {
+        return BFI_E_ENGINE;
+    }
+    if (index->replicas || node_cnt < 2) {
+        return BFI_E_OK;
+    }
+
+    replicas = (bloom_filter_h **) calloc(node_cnt, sizeof(bloom_filter_h *));
+    if (!replicas) {
+        return BFI_E_MEM;
+    }
+
+    // Nodes are filled in parallel
+    for (uint32_t node = 0; node < node_cnt; ++node) {
+        copies[node].bf = index->bf;
+        copies[node].copy = NULL;
+        started[node] = bfi_numa_start_copy(node, &copies[node]);
+    }
+    for (uint32_t node = 0; node < node_cnt; ++node) {
+        if (!started[node]) {
+            // Node without (allowed) processors probes the original filter
+            replicas[node] = index->bf;
+            continue;
+        }
+        pthread_join(copies[node].thread, NULL);
+        replicas[node] = copies[node].copy;
+        if (!replicas[node]) {
+            ret = BFI_E_MEM;
+            replicas[node] = index->bf;
+        }
+    }
+
+    index->replicas = replicas;
+    index->replica_cnt = node_cnt;
+    if (ret != BFI_E_OK) {
+        bfi_numa_drop_replicas(index);
+    }
+
+    return ret;
+}
+
+
+void bfi_numa_drop_replicas(bfi_index_t *index)
+{
+    if (!index->replicas) {
+        return;
+    }
+
+    for (uint32_t node = 0; node < index->replica_cnt; ++node) {
+        if (index->replicas[node] != index->bf) {
+            bf_delete_filter(index->replicas[node]);
+        }
+    }
+    free(index->replicas);
+    index->replicas = NULL;
+    index->replica_cnt = 0;
+}
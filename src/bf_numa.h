@@ -0,0 +1,76 @@
+/**
+ * \file bf_numa.h
+ * \brief NUMA topology and per-node replicas of read-only indexes
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _BLOOMF_NUMA_H
+#define _BLOOMF_NUMA_H
+
+#include <stdint.h>
+#include "bf_index_internal.h"
+
+// Maximal count of NUMA nodes (node ids 0 to BFI_NUMA_NODE_MAX - 1)
+#define BFI_NUMA_NODE_MAX 64
+
+/**
+ * \brief Get NUMA node of the processor running the calling thread
+ *
+ * \return Returns node id (less than bfi_numa_node_cnt()), the topology has
+ *    to be read by bfi_numa_node_cnt() before.
+ */
+uint32_t bfi_numa_node(void);
+
+/**
+ * \brief Drop replicas of an index (before the index is modified)
+ */
+void bfi_numa_drop_replicas(bfi_index_t *index);
+
+/**
+ * \brief Get filter of an index to be probed by the calling thread
+ *
+ * \return Returns replica of the local NUMA node if the index is replicated
+ *    (see bfi_replicate_index()), the filter of the index otherwise.
+ */
+static inline bloom_filter_h *bfi_local_filter(const bfi_index_t *index)
+{
+    if (!index->replicas) {
+        return index->bf;
+    }
+
+    return index->replicas[bfi_numa_node()];
+}
+
+#endif //_BLOOMF_NUMA_H
@@ -0,0 +1,139 @@
+/**
+ * \file bf_parallel.c
+ * \brief Parallel processing of large indexes
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "bf_parallel.h"
+
+// Configured count of threads, 0 means count of online processors
+static uint32_t bfi_io_threads = 0;
+
+typedef struct {
+    pthread_t thread;
+    bfi_parallel_fn_t fn;
+    void *ctx;
+    uint64_t first;
+    uint64_t end;
+} bfi_parallel_part_t;
+
+
+void bfi_set_io_threads(uint32_t threads)
+{
+    __atomic_store_n(&bfi_io_threads, threads, __ATOMIC_RELAXED);
+}
+
+
+uint32_t bfi_parallel_threads(void)
+{
+    uint32_t threads = __atomic_load_n(&bfi_io_threads, __ATOMIC_RELAXED);
+
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        threads = cpus > 0 ? (uint32_t) cpus : 1;
+    }
+
+    return threads < BFI_PARALLEL_MAX ? threads : BFI_PARALLEL_MAX;
+}
+
+
+static void *bfi_parallel_worker(void *arg)
+{
+    bfi_parallel_part_t *part = (bfi_parallel_part_t *) arg;
+
+    part->fn(part->ctx, part->first, part->end);
+
+    return NULL;
+}
+
+
+void bfi_parallel_for(uint64_t item_cnt, uint64_t min_items,
+                    bfi_parallel_fn_t fn, void *ctx)
+{
+    bfi_parallel_part_t parts[BFI_PARALLEL_MAX];
+    bool started[BFI_PARALLEL_MAX] = { false };
+    uint64_t thread_cnt = bfi_parallel_threads();
+    uint64_t first = 0;
+
+    if (min_items == 0) {
+        min_items = 1;
+    }
+    if (thread_cnt > item_cnt / min_items) {
+        thread_cnt = item_cnt / min_items;
+    }
+    if (thread_cnt <= 1) {
+        fn(ctx, 0, item_cnt);
+        return;
+    }
+
+    for (uint64_t t = 0; t < thread_cnt; ++t) {
+        uint64_t cnt = item_cnt / thread_cnt + (t < item_cnt % thread_cnt);
+
+        parts[t].fn = fn;
+        parts[t].ctx = ctx;
+        parts[t].first = first;
+        parts[t].end = first + cnt;
+        first += cnt;
+    }
+
+    // The last part is processed by the calling thread, so are parts of
+    // threads which could not be started
+    for (uint64_t t = 0; t + 1 < thread_cnt; ++t) {
+        started[t] = pthread_create(&parts[t].thread, NULL,
+                                    bfi_parallel_worker, &parts[t]) == 0;
+    }
+    bfi_parallel_worker(&parts[thread_cnt - 1]);
+    for (uint64_t t = 0; t + 1 < thread_cnt; ++t) {
+        if (started[t]) {
+            pthread_join(parts[t].thread, NULL);
+        } else {
+            bfi_parallel_worker(&parts[t]);
+        }
+    }
+}
+
+
+void bfi_parallel_error(bfi_ecode_t *ret, bfi_ecode_t error)
+{
+    bfi_ecode_t expected = BFI_E_OK;
+
+    __atomic_compare_exchange_n(ret, &expected, error, false,
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
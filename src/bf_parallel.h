@@ -0,0 +1,81 @@
+/**
+ * \file bf_parallel.h
+ * \brief Parallel processing of large indexes
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _BLOOMF_PARALLEL_H
+#define _BLOOMF_PARALLEL_H
+
+#include <stdint.h>
+#include "bf_index_internal.h"
+
+// Maximal count of threads used by one operation
+#define BFI_PARALLEL_MAX 16
+
+/**
+ * \brief Work of one thread (items [first, end) of a range)
+ *
+ * Errors are reported by bfi_parallel_error() to the context.
+ */
+typedef void (*bfi_parallel_fn_t)(void *ctx, uint64_t first, uint64_t end);
+
+/**
+ * \brief Count of threads used by parallel operations (see
+ *    bfi_set_io_threads())
+ */
+uint32_t bfi_parallel_threads(void);
+
+/**
+ * \brief Process a range of items by several threads
+ *
+ * Range [0, item_cnt) is split to contiguous parts of at least min_items
+ * items, one part per thread (the calling thread processes one of them).
+ * Small ranges are processed by the calling thread only.
+ *
+ * \param[in] item_cnt Count of items
+ * \param[in] min_items Minimal count of items worth a thread
+ * \param[in] fn Work of a thread
+ * \param[in] ctx Context passed to fn
+ */
+void bfi_parallel_for(uint64_t item_cnt, uint64_t min_items,
+                    bfi_parallel_fn_t fn, void *ctx);
+
+/**
+ * \brief Record error of a thread (the first error is kept)
+ */
+void bfi_parallel_error(bfi_ecode_t *ret, bfi_ecode_t error);
+
+#endif //_BLOOMF_PARALLEL_H
@@ -0,0 +1,681 @@
+/**
+ * \file bf_postings.c
+ * \brief Postings indexes (fingerprints of addresses to lists of files)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bf_index_internal.h"
+#include "bf_io.h"
+#include "bf_parallel.h"
+
+/* Postings file format (host byte order, like index files):
+ * +---------------------------------------------------------------------+
+ * | header (bfi_postings_header_t)                                      |
+ * | shard table (bfi_postings_shard_t per shard)                        |
+ * | entries of all shards (bfi_postings_entry_t, sorted by fingerprint) |
+ * | posting lists (see below), followed by 8 zero bytes                 |
+ * +---------------------------------------------------------------------+
+ * Posting list:
+ * +---------------------------------------------------------------------+
+ * | u32: count of ids | u32: first id | u8: bits of a delta             |
+ * | (id - previous id - 1) of following ids packed by bits (LSB first)  |
+ * +---------------------------------------------------------------------+
+ * Shard of a fingerprint is given by its shard_bits highest bits, entries
+ * of a shard are searched by binary search directly in the mapped file.
+ */
+#define BFI_POSTINGS_MAGIC 0x50494642   // "BFIP"
+#define BFI_POSTINGS_VERSION 1
+
+#define BFI_POSTINGS_SHARD_BITS 8
+#define BFI_POSTINGS_SHARD_BITS_MAX 16
+
+#define BFI_POSTINGS_LIST_HDR_LEN (2 * sizeof(uint32_t) + sizeof(uint8_t))
+// Packed deltas are read by 64-bit words
+#define BFI_POSTINGS_PAD sizeof(uint64_t)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t shard_bits;
+    uint64_t key_cnt;
+    uint64_t pair_cnt;
+    uint64_t postings_offset;
+    uint64_t postings_len;
+} bfi_postings_header_t;
+
+typedef struct {
+    uint64_t entries_offset;
+    uint64_t entry_cnt;
+} bfi_postings_shard_t;
+
+typedef struct {
+    uint64_t fingerprint;
+    uint64_t list_offset;       // Offset of the list in posting lists
+} bfi_postings_entry_t;
+
+typedef struct {
+    uint64_t fingerprint;
+    uint32_t file_id;
+    uint32_t reserved;
+} bfi_postings_pair_t;
+
+// Pairs of a shard being built and its encoded entries and lists
+typedef struct {
+    bfi_postings_pair_t *pairs;
+    uint64_t pair_cnt;
+    uint64_t pair_max;
+    bfi_postings_entry_t *entries;
+    uint64_t entry_cnt;
+    unsigned char *lists;
+    uint64_t lists_len;
+} bfi_postings_shard_build_t;
+
+typedef struct {
+    unsigned int shard_bits;
+    bfi_postings_shard_build_t *shards;
+} bfi_postings_builder_t;
+
+typedef struct {
+    char *map;
+    size_t map_len;
+    const bfi_postings_header_t *header;
+    const bfi_postings_shard_t *shards;
+    const unsigned char *lists;
+} bfi_postings_t;
+
+
+uint64_t bfi_addr_fingerprint(const unsigned char *buffer, const size_t len)
+{
+    // MurmurHash64A
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    uint64_t h = 0x8445d61a4e774912ULL ^ (len * m);
+    size_t i = 0;
+
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t k;
+
+        memcpy(&k, buffer + i, sizeof(k));
+        k *= m;
+        k ^= k >> 47;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+    if (i < len) {
+        uint64_t k = 0;
+
+        memcpy(&k, buffer + i, len - i);
+        h ^= k;
+        h *= m;
+    }
+    h ^= h >> 47;
+    h *= m;
+    h ^= h >> 47;
+
+    return h;
+}
+
+
+bfi_ecode_t bfi_postings_builder_init(bfi_postings_builder_ptr_t *builder_ptr,
+                    unsigned int shard_bits)
+{
+    bfi_postings_builder_t *builder;
+
+    *builder_ptr = NULL;
+    if (shard_bits == 0) {
+        shard_bits = BFI_POSTINGS_SHARD_BITS;
+    }
+    if (shard_bits > BFI_POSTINGS_SHARD_BITS_MAX) {
+        return BFI_E_POSTINGS;
+    }
+
+    builder = (bfi_postings_builder_t *) calloc(1, sizeof(*builder));
+    if (!builder) {
+        return BFI_E_MEM;
+    }
+    builder->shard_bits = shard_bits;
+    builder->shards = (bfi_postings_shard_build_t *) calloc(1U << shard_bits,
+                                        sizeof(bfi_postings_shard_build_t));
+    if (!builder->shards) {
+        free(builder);
+        return BFI_E_MEM;
+    }
+
+    *builder_ptr = (bfi_postings_builder_ptr_t) builder;
+
+    return BFI_E_OK;
+}
+
+
+void bfi_postings_builder_destroy(bfi_postings_builder_ptr_t *builder_ptr)
+{
+    bfi_postings_builder_t *builder;
+
+    if (!builder_ptr || !*builder_ptr) {
+        return;
+    }
+    builder = (bfi_postings_builder_t *) *builder_ptr;
+
+    for (uint32_t s = 0; s < (1U << builder->shard_bits); ++s) {
+        free(builder->shards[s].pairs);
+    }
+    free(builder->shards);
+    free(builder);
+
+    *builder_ptr = NULL;
+}
+
+
+bfi_ecode_t bfi_postings_add_fingerprint(
+                    bfi_postings_builder_ptr_t builder_ptr,
+                    uint64_t fingerprint, uint32_t file_id)
+{
+    bfi_postings_builder_t *builder = (bfi_postings_builder_t *) builder_ptr;
+    bfi_postings_shard_build_t *shard;
+
+    if (!builder) {
+        return BFI_E_NO_INDEX;
+    }
+
+    shard = &builder->shards[fingerprint >> (64 - builder->shard_bits)];
+    if (shard->pair_cnt == shard->pair_max) {
+        uint64_t max = shard->pair_max ? 2 * shard->pair_max : 1024;
+        bfi_postings_pair_t *pairs;
+
+        pairs = (bfi_postings_pair_t *) realloc(shard->pairs,
+                                                max * sizeof(*pairs));
+        if (!pairs) {
+            return BFI_E_MEM;
+        }
+        shard->pairs = pairs;
+        shard->pair_max = max;
+    }
+    shard->pairs[shard->pair_cnt].fingerprint = fingerprint;
+    shard->pairs[shard->pair_cnt].file_id = file_id;
+    shard->pairs[shard->pair_cnt].reserved = 0;
+    shard->pair_cnt++;
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_postings_add_addr(bfi_postings_builder_ptr_t builder_ptr,
+                    const unsigned char *buffer, const size_t len,
+                    uint32_t file_id)
+{
+    return bfi_postings_add_fingerprint(builder_ptr,
+                                        bfi_addr_fingerprint(buffer, len),
+                                        file_id);
+}
+
+
+static int bfi_postings_pair_cmp(const void *a, const void *b)
+{
+    const bfi_postings_pair_t *pa = (const bfi_postings_pair_t *) a;
+    const bfi_postings_pair_t *pb = (const bfi_postings_pair_t *) b;
+
+    if (pa->fingerprint != pb->fingerprint) {
+        return pa->fingerprint < pb->fingerprint ? -1 : 1;
+    }
+    if (pa->file_id != pb->file_id) {
+        return pa->file_id < pb->file_id ? -1 : 1;
+    }
+
+    return 0;
+}
+
+
+/**
+ * \brief Count of bits needed to store a value
+ */
+static inline uint8_t bfi_postings_bits(uint32_t value)
+{
+    return value ? (uint8_t) (32 - __builtin_clz(value)) : 0;
+}
+
+
+/**
+ * \brief Sort, deduplicate and encode pairs of a shard
+ *
+ * \return Returns BFI_OK on success, error code otherwise.
+ */
+static bfi_ecode_t bfi_postings_encode_shard(bfi_postings_shard_build_t *shard)
+{
+    bfi_postings_pair_t *pairs = shard->pairs;
+    uint64_t lists_len = 0;
+    uint64_t cnt = 0;
+    unsigned char *cursor;
+
+    qsort(pairs, shard->pair_cnt, sizeof(*pairs), bfi_postings_pair_cmp);
+
+    // Deduplicated pairs, count of keys and length of their lists
+    for (uint64_t i = 0; i < shard->pair_cnt; ++i) {
+        if (cnt && pairs[cnt - 1].fingerprint == pairs[i].fingerprint
+                && pairs[cnt - 1].file_id == pairs[i].file_id) {
+            continue;
+        }
+        pairs[cnt++] = pairs[i];
+    }
+    shard->pair_cnt = cnt;
+    shard->entry_cnt = 0;
+    for (uint64_t i = 0, end; i < cnt; i = end) {
+        uint32_t max_delta = 0;
+
+        for (end = i + 1; end < cnt
+                && pairs[end].fingerprint == pairs[i].fingerprint; ++end) {
+            uint32_t delta = pairs[end].file_id - pairs[end - 1].file_id - 1;
+
+            max_delta = delta > max_delta ? delta : max_delta;
+        }
+        lists_len += BFI_POSTINGS_LIST_HDR_LEN
+                     + ((end - i - 1) * bfi_postings_bits(max_delta) + 7) / 8;
+        shard->entry_cnt++;
+    }
+
+    shard->entries = (bfi_postings_entry_t *) malloc(shard->entry_cnt
+                                                     * sizeof(*shard->entries)
+                                                     + 1);
+    // Slack for packing by 64-bit words
+    shard->lists = (unsigned char *) calloc(lists_len + BFI_POSTINGS_PAD, 1);
+    if (!shard->entries || !shard->lists) {
+        return BFI_E_MEM;
+    }
+    shard->lists_len = lists_len;
+
+    cursor = shard->lists;
+    for (uint64_t i = 0, end, e = 0; i < cnt; i = end, ++e) {
+        uint32_t list_cnt;
+        uint32_t max_delta = 0;
+        uint64_t bit_pos = 0;
+        uint8_t bits;
+
+        for (end = i + 1; end < cnt
+                && pairs[end].fingerprint == pairs[i].fingerprint; ++end) {
+            uint32_t delta = pairs[end].file_id - pairs[end - 1].file_id - 1;
+
+            max_delta = delta > max_delta ? delta : max_delta;
+        }
+        bits = bfi_postings_bits(max_delta);
+        list_cnt = (uint32_t) (end - i);
+
+        shard->entries[e].fingerprint = pairs[i].fingerprint;
+        shard->entries[e].list_offset = cursor - shard->lists;
+        memcpy(cursor, &list_cnt, sizeof(list_cnt));
+        memcpy(cursor + sizeof(uint32_t), &pairs[i].file_id, sizeof(uint32_t));
+        cursor[2 * sizeof(uint32_t)] = bits;
+        cursor += BFI_POSTINGS_LIST_HDR_LEN;
+
+        for (uint64_t j = i + 1; j < end; ++j, bit_pos += bits) {
+            uint64_t delta = pairs[j].file_id - pairs[j - 1].file_id - 1;
+            uint64_t word;
+
+            memcpy(&word, cursor + bit_pos / 8, sizeof(word));
+            word |= delta << (bit_pos % 8);
+            memcpy(cursor + bit_pos / 8, &word, sizeof(word));
+        }
+        cursor += (bit_pos + 7) / 8;
+    }
+
+    return BFI_E_OK;
+}
+
+
+typedef struct {
+    bfi_postings_builder_t *builder;
+    bfi_ecode_t ret;
+} bfi_postings_build_ctx_t;
+
+
+static void bfi_postings_build_worker(void *arg, uint64_t first, uint64_t end)
+{
+    bfi_postings_build_ctx_t *ctx = (bfi_postings_build_ctx_t *) arg;
+
+    for (uint64_t s = first; s < end && ctx->ret == BFI_E_OK; ++s) {
+        bfi_ecode_t ret = bfi_postings_encode_shard(&ctx->builder->shards[s]);
+
+        if (ret != BFI_E_OK) {
+            bfi_parallel_error(&ctx->ret, ret);
+        }
+    }
+}
+
+
+bfi_ecode_t bfi_postings_build(bfi_postings_builder_ptr_t builder_ptr,
+                    char *filename)
+{
+    bfi_postings_builder_t *builder = (bfi_postings_builder_t *) builder_ptr;
+    bfi_postings_build_ctx_t ctx;
+    bfi_postings_header_t header;
+    bfi_postings_shard_t *table = NULL;
+    uint32_t shard_cnt;
+    uint64_t offset;
+    uint64_t lists_offset = 0;
+    FILE *file_ptr = NULL;
+    bool ok = true;
+
+    if (!builder) {
+        return BFI_E_NO_INDEX;
+    }
+    shard_cnt = 1U << builder->shard_bits;
+
+    // Shards are sorted and encoded in parallel
+    ctx.builder = builder;
+    ctx.ret = BFI_E_OK;
+    bfi_parallel_for(shard_cnt, 1, bfi_postings_build_worker, &ctx);
+    if (ctx.ret != BFI_E_OK) {
+        goto cleanup;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = BFI_POSTINGS_MAGIC;
+    header.version = BFI_POSTINGS_VERSION;
+    header.shard_bits = (uint16_t) builder->shard_bits;
+
+    table = (bfi_postings_shard_t *) malloc(shard_cnt * sizeof(*table));
+    if (!table) {
+        ctx.ret = BFI_E_MEM;
+        goto cleanup;
+    }
+    offset = sizeof(header) + shard_cnt * sizeof(*table);
+    for (uint32_t s = 0; s < shard_cnt; ++s) {
+        bfi_postings_shard_build_t *shard = &builder->shards[s];
+
+        table[s].entries_offset = offset;
+        table[s].entry_cnt = shard->entry_cnt;
+        offset += shard->entry_cnt * sizeof(bfi_postings_entry_t);
+        header.key_cnt += shard->entry_cnt;
+        header.pair_cnt += shard->pair_cnt;
+        header.postings_len += shard->lists_len;
+    }
+    header.postings_offset = offset;
+
+    file_ptr = fopen(filename, "wb");
+    if (!file_ptr) {
+        ctx.ret = BFI_E_STO_FILE_ERR;
+        goto cleanup;
+    }
+    ok = fwrite(&header, sizeof(header), 1, file_ptr) == 1
+         && fwrite(table, sizeof(*table), shard_cnt, file_ptr) == shard_cnt;
+
+    // Entries point to lists of their shard, offsets are made global
+    for (uint32_t s = 0; s < shard_cnt && ok; ++s) {
+        bfi_postings_shard_build_t *shard = &builder->shards[s];
+
+        for (uint64_t e = 0; e < shard->entry_cnt; ++e) {
+            shard->entries[e].list_offset += lists_offset;
+        }
+        lists_offset += shard->lists_len;
+        ok = fwrite(shard->entries, sizeof(bfi_postings_entry_t),
+                    shard->entry_cnt, file_ptr) == shard->entry_cnt;
+    }
+    for (uint32_t s = 0; s < shard_cnt && ok; ++s) {
+        bfi_postings_shard_build_t *shard = &builder->shards[s];
+
+        ok = fwrite(shard->lists, 1, shard->lists_len, file_ptr)
+             == shard->lists_len;
+    }
+    if (ok) {
+        uint64_t pad = 0;
+
+        ok = fwrite(&pad, sizeof(pad), 1, file_ptr) == 1;
+    }
+    if (bfi_io_close(file_ptr, bfi_get_io_policy(), true) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        ctx.ret = BFI_E_POSTINGS;
+    }
+
+cleanup:
+    free(table);
+    for (uint32_t s = 0; s < shard_cnt; ++s) {
+        free(builder->shards[s].entries);
+        free(builder->shards[s].lists);
+        builder->shards[s].entries = NULL;
+        builder->shards[s].lists = NULL;
+    }
+
+    return ctx.ret;
+}
+
+
+bfi_ecode_t bfi_postings_open(bfi_postings_ptr_t *postings_ptr,
+                    char *filename)
+{
+    const bfi_postings_header_t *header;
+    bfi_postings_t *postings;
+    uint64_t shard_cnt;
+    uint64_t entries_end;
+    struct stat st;
+    void *map;
+    int fd;
+
+    *postings_ptr = NULL;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return BFI_E_LOAD_FILE_ERR;
+    }
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size
+            < sizeof(bfi_postings_header_t)) {
+        close(fd);
+        return BFI_E_POSTINGS;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return BFI_E_POSTINGS;
+    }
+    bfi_io_advise_map(map, st.st_size, bfi_get_io_policy());
+
+    // Header, shard table and location of entries and lists
+    header = (const bfi_postings_header_t *) map;
+    if (header->magic != BFI_POSTINGS_MAGIC
+            || header->version != BFI_POSTINGS_VERSION
+            || header->shard_bits == 0
+            || header->shard_bits > BFI_POSTINGS_SHARD_BITS_MAX
+            || header->key_cnt > (uint64_t) st.st_size) {
+        munmap(map, st.st_size);
+        return BFI_E_POSTINGS;
+    }
+    shard_cnt = (uint64_t) 1 << header->shard_bits;
+    entries_end = sizeof(*header) + shard_cnt * sizeof(bfi_postings_shard_t)
+                  + header->key_cnt * sizeof(bfi_postings_entry_t);
+    if (header->postings_offset != entries_end
+            || header->postings_len > (uint64_t) st.st_size
+            || entries_end + header->postings_len + BFI_POSTINGS_PAD
+               > (uint64_t) st.st_size) {
+        munmap(map, st.st_size);
+        return BFI_E_POSTINGS;
+    }
+
+    postings = (bfi_postings_t *) calloc(1, sizeof(*postings));
+    if (!postings) {
+        munmap(map, st.st_size);
+        return BFI_E_MEM;
+    }
+    postings->map = (char *) map;
+    postings->map_len = st.st_size;
+    postings->header = header;
+    postings->shards = (const bfi_postings_shard_t *) (postings->map
+                                                       + sizeof(*header));
+    postings->lists = (const unsigned char *) postings->map
+                      + header->postings_offset;
+
+    // Entries of every shard have to be in the entry area
+    for (uint64_t s = 0; s < shard_cnt; ++s) {
+        const bfi_postings_shard_t *shard = &postings->shards[s];
+
+        if (shard->entries_offset < sizeof(*header)
+                                    + shard_cnt * sizeof(*shard)
+                || shard->entries_offset % sizeof(uint64_t) != 0
+                || shard->entries_offset > entries_end
+                || shard->entry_cnt > (entries_end - shard->entries_offset)
+                                      / sizeof(bfi_postings_entry_t)) {
+            bfi_postings_close((bfi_postings_ptr_t *) &postings);
+            return BFI_E_POSTINGS;
+        }
+    }
+
+    *postings_ptr = (bfi_postings_ptr_t) postings;
+
+    return BFI_E_OK;
+}
+
+
+void bfi_postings_close(bfi_postings_ptr_t *postings_ptr)
+{
+    bfi_postings_t *postings;
+
+    if (!postings_ptr || !*postings_ptr) {
+        return;
+    }
+    postings = (bfi_postings_t *) *postings_ptr;
+
+    munmap(postings->map, postings->map_len);
+    free(postings);
+
+    *postings_ptr = NULL;
+}
+
+
+uint64_t bfi_postings_key_cnt(bfi_postings_ptr_t postings_ptr)
+{
+    if (!postings_ptr) {
+        return 0;
+    }
+
+    return ((bfi_postings_t *) postings_ptr)->header->key_cnt;
+}
+
+
+bfi_ecode_t bfi_postings_lookup_fingerprint(bfi_postings_ptr_t postings_ptr,
+                    uint64_t fingerprint, uint32_t **file_ids,
+                    uint64_t *file_cnt)
+{
+    bfi_postings_t *postings = (bfi_postings_t *) postings_ptr;
+    const bfi_postings_shard_t *shard;
+    const bfi_postings_entry_t *entries;
+    const unsigned char *list;
+    uint64_t low;
+    uint64_t high;
+    uint32_t cnt;
+    uint32_t id;
+    uint8_t bits;
+    uint64_t mask;
+
+    *file_ids = NULL;
+    *file_cnt = 0;
+    if (!postings) {
+        return BFI_E_NO_INDEX;
+    }
+
+    // Binary search of the fingerprint in its shard
+    shard = &postings->shards[fingerprint
+                              >> (64 - postings->header->shard_bits)];
+    entries = (const bfi_postings_entry_t *) (postings->map
+                                              + shard->entries_offset);
+    low = 0;
+    high = shard->entry_cnt;
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+
+        if (entries[mid].fingerprint < fingerprint) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == shard->entry_cnt || entries[low].fingerprint != fingerprint) {
+        return BFI_E_OK;
+    }
+
+    // Posting list
+    if (entries[low].list_offset > postings->header->postings_len
+            || postings->header->postings_len - entries[low].list_offset
+               < BFI_POSTINGS_LIST_HDR_LEN) {
+        return BFI_E_POSTINGS;
+    }
+    list = postings->lists + entries[low].list_offset;
+    memcpy(&cnt, list, sizeof(cnt));
+    memcpy(&id, list + sizeof(uint32_t), sizeof(id));
+    bits = list[2 * sizeof(uint32_t)];
+    list += BFI_POSTINGS_LIST_HDR_LEN;
+    if (cnt == 0 || bits > 32
+            || ((uint64_t) (cnt - 1) * bits + 7) / 8
+               > postings->header->postings_len - entries[low].list_offset
+                 - BFI_POSTINGS_LIST_HDR_LEN) {
+        return BFI_E_POSTINGS;
+    }
+
+    *file_ids = (uint32_t *) malloc(cnt * sizeof(uint32_t));
+    if (!*file_ids) {
+        return BFI_E_MEM;
+    }
+
+    // Unpacking of deltas by 64-bit words (the list is followed by padding)
+    mask = ((uint64_t) 1 << bits) - 1;
+    (*file_ids)[0] = id;
+    for (uint32_t i = 1; i < cnt; ++i) {
+        uint64_t bit_pos = (uint64_t) (i - 1) * bits;
+        uint64_t word;
+
+        memcpy(&word, list + bit_pos / 8, sizeof(word));
+        id += (uint32_t) ((word >> (bit_pos % 8)) & mask) + 1;
+        (*file_ids)[i] = id;
+    }
+    *file_cnt = cnt;
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_postings_lookup(bfi_postings_ptr_t postings_ptr,
+                    const unsigned char *buffer, const size_t len,
+                    uint32_t **file_ids, uint64_t *file_cnt)
+{
+    return bfi_postings_lookup_fingerprint(postings_ptr,
+                                           bfi_addr_fingerprint(buffer, len),
+                                           file_ids, file_cnt);
+}
@@ -0,0 +1,299 @@
+/**
+ * \file bf_summary.c
+ * \brief Folded summaries of indexes (resident prefilters)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bf_index_internal.h"
+#include "bf_index_file.h"
+#include "bloomf_wrapper.h"
+
+/* BFI_SEC_SUMMARY section format:
+ * +---------------------------------------------------------------------+
+ * | u64: table size of the original filter                              |
+ * | folded filter (get_filter_as_bytes() format)                        |
+ * +---------------------------------------------------------------------+
+ */
+#define BFI_SUMMARY_SEC_HDR_LEN sizeof(uint64_t)
+
+
+/**
+ * \brief False positive probability of a filter given by its fill ratio
+ */
+static double bfi_filter_fp_prob(bloom_filter_h *bf)
+{
+    unsigned int hash_cnt;
+    unsigned long long int table_size;
+    unsigned long long int seed;
+    unsigned long long int est_item_cnt;
+    double fp_prob;
+    double fill;
+    double ret = 1.0;
+
+    bf_get_parameters(bf, &hash_cnt, &table_size, &seed, &est_item_cnt,
+                      &fp_prob);
+    fill = (double) bf_count_set_bits(bf) / table_size;
+    for (unsigned int i = 0; i < hash_cnt; ++i) {
+        ret *= fill;
+    }
+
+    return ret;
+}
+
+
+bloom_filter_h *bfi_summary_fold(bloom_filter_h *bf, uint32_t max_fold)
+{
+    // The largest fold (power of 2) which still rejects most of the queries
+    for (uint32_t fold = max_fold; fold >= 2; fold /= 2) {
+        bloom_filter_h *summary = new_folded_bloom_filter_f(bf, fold);
+
+        if (bfi_filter_fp_prob(summary) <= BFI_SUMMARY_FP_PROB) {
+            return summary;
+        }
+        bf_delete_filter(summary);
+    }
+
+    return NULL;
+}
+
+
+uint64_t bfi_summary_as_bytes(bloom_filter_h *summary, char **buff)
+{
+    uint64_t original_size = fbf_get_original_table_size(summary);
+    uint32_t bf_len;
+    char *bf_bytes;
+
+    bf_len = bf_get_filter_as_bytes(summary, &bf_bytes);
+    if (bf_len == 0) {
+        return 0;
+    }
+    *buff = (char *) malloc(BFI_SUMMARY_SEC_HDR_LEN + bf_len);
+    if (!*buff) {
+        bf_clear_bytes(summary, &bf_bytes);
+        return 0;
+    }
+    memcpy(*buff, &original_size, sizeof(original_size));
+    memcpy(*buff + BFI_SUMMARY_SEC_HDR_LEN, bf_bytes, bf_len);
+    bf_clear_bytes(summary, &bf_bytes);
+
+    return BFI_SUMMARY_SEC_HDR_LEN + bf_len;
+}
+
+
+bfi_ecode_t bfi_summary_from_bytes(const char *buff, uint64_t len,
+                    bloom_filter_h **summary)
+{
+    uint64_t original_size;
+    int load_ret;
+
+    *summary = NULL;
+    if (len <= BFI_SUMMARY_SEC_HDR_LEN
+            || len - BFI_SUMMARY_SEC_HDR_LEN > UINT32_MAX) {
+        return BFI_E_LOAD_SECTION;
+    }
+    memcpy(&original_size, buff, sizeof(original_size));
+    if (original_size == 0) {
+        return BFI_E_LOAD_SECTION;
+    }
+
+    *summary = new_folded_bloom_filter();
+    load_ret = bf_load_filter_from_bytes(*summary,
+                    buff + BFI_SUMMARY_SEC_HDR_LEN,
+                    (uint32_t) (len - BFI_SUMMARY_SEC_HDR_LEN));
+    if (load_ret != 0) {
+        bf_delete_filter(*summary);
+        *summary = NULL;
+        return load_ret == BFI_E_LOAD_MEM ? BFI_E_LOAD_MEM : BFI_E_LOAD_BYTES;
+    }
+    fbf_set_original_table_size(*summary, original_size);
+
+    return BFI_E_OK;
+}
+
+
+uint32_t bfi_summary_fold_factor(const char *buff, uint64_t len)
+{
+    unsigned long long int table_size = 0;
+    unsigned long long int seed;
+    unsigned long long int est_item_cnt;
+    unsigned int hash_cnt;
+    double fp_prob;
+    uint64_t original_size;
+    bloom_filter_h *summary;
+
+    if (len <= BFI_SUMMARY_SEC_HDR_LEN
+            || len - BFI_SUMMARY_SEC_HDR_LEN > UINT32_MAX) {
+        return 0;
+    }
+    memcpy(&original_size, buff, sizeof(original_size));
+
+    // Header of the folded filter is enough
+    summary = new_folded_bloom_filter();
+    if (bf_load_header_from_bytes(summary, buff + BFI_SUMMARY_SEC_HDR_LEN,
+                                  (uint32_t) (len - BFI_SUMMARY_SEC_HDR_LEN))
+            == 0) {
+        bf_get_parameters(summary, &hash_cnt, &table_size, &seed,
+                          &est_item_cnt, &fp_prob);
+    }
+    bf_delete_filter(summary);
+
+    return table_size ? (uint32_t) (original_size / table_size) : 0;
+}
+
+
+bfi_ecode_t bfi_summary_from_index(bfi_summary_ptr_t *summary_ptr,
+                    bfi_index_ptr_t index_ptr, uint32_t max_fold)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+
+    *summary_ptr = NULL;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+    if (index->engine != BFI_ENGINE_STANDARD) {
+        return BFI_E_ENGINE;
+    }
+
+    *summary_ptr = (bfi_summary_ptr_t) bfi_summary_fold(index->bf, max_fold);
+    if (!*summary_ptr) {
+        return BFI_E_SUMMARY;
+    }
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_load_summary(bfi_summary_ptr_t *summary_ptr, char *filename)
+{
+    bfi_file_header_t header;
+    bfi_section_t *sections = NULL;
+    const bfi_section_t *sec;
+    char *payload = NULL;
+    uint64_t payload_len;
+    uint16_t magic;
+    FILE *bf_file_ptr;
+    bfi_ecode_t ret;
+
+    *summary_ptr = NULL;
+
+	// Open file, mode: read binary
+    bf_file_ptr = fopen(filename, "rb");
+    if (!bf_file_ptr){
+        return BFI_E_LOAD_FILE_ERR;
+    }
+
+    // Version 1 files have no summary
+    if (fread(&magic, sizeof(magic), 1, bf_file_ptr) != 1) {
+        fclose(bf_file_ptr);
+        return BFI_E_LOAD_MAGIC;
+    }
+    if (magic != BFI_MAGIC_V2) {
+        fclose(bf_file_ptr);
+        return magic == BFI_MAGIC ? BFI_E_LOAD_NO_SECTION
+                                  : BFI_E_LOAD_BAD_MAGIC;
+    }
+    rewind(bf_file_ptr);
+
+    ret = bfi_file_read_toc(bf_file_ptr, &header, &sections);
+    if (ret != BFI_E_OK) {
+        goto cleanup;
+    }
+    sec = bfi_file_find_section(sections, header.section_cnt,
+                                BFI_SEC_SUMMARY);
+    if (!sec) {
+        ret = BFI_E_LOAD_NO_SECTION;
+        goto cleanup;
+    }
+    ret = bfi_file_read_section(bf_file_ptr, sec, &payload, &payload_len);
+    if (ret != BFI_E_OK) {
+        goto cleanup;
+    }
+    ret = bfi_summary_from_bytes(payload, payload_len,
+                                 (bloom_filter_h **) summary_ptr);
+
+cleanup:
+    free(payload);
+    free(sections);
+    fclose(bf_file_ptr);
+
+    return ret;
+}
+
+
+bool bfi_summary_may_contain(bfi_summary_ptr_t summary_ptr,
+                    const unsigned char *buffer, const size_t len)
+{
+    if (!summary_ptr) {
+        // Nothing is known about the index
+        return true;
+    }
+
+    return bf_contains((bloom_filter_h *) summary_ptr, buffer, &len);
+}
+
+
+uint64_t bfi_summary_size(bfi_summary_ptr_t summary_ptr)
+{
+    unsigned int hash_cnt;
+    unsigned long long int table_size;
+    unsigned long long int seed;
+    unsigned long long int est_item_cnt;
+    double fp_prob;
+
+    if (!summary_ptr) {
+        return 0;
+    }
+
+    bf_get_parameters((bloom_filter_h *) summary_ptr, &hash_cnt, &table_size,
+                      &seed, &est_item_cnt, &fp_prob);
+
+    return table_size / 8;
+}
+
+
+void bfi_destroy_summary(bfi_summary_ptr_t *summary_ptr)
+{
+    if (!summary_ptr || !*summary_ptr) {
+        return;
+    }
+
+    bf_delete_filter((bloom_filter_h *) *summary_ptr);
+    *summary_ptr = NULL;
+}
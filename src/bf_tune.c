@@ -0,0 +1,284 @@
+/**
+ * \file bf_tune.c
+ * \brief Benchmarks of index parameters on a sample of keys
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#include "bf_index_internal.h"
+
+// Candidate counts of hash functions around the optimal count
+#define BFI_TUNE_HASH_BELOW 3
+
+// Smallest filter of the false positive benchmark (bits)
+#define BFI_TUNE_TABLE_MIN 64
+
+
+static double bfi_tune_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/**
+ * \brief Table size (bits) of a filter of n items with k hash functions
+ *    and false positive probability p
+ */
+static uint64_t bfi_tune_table_size(uint64_t n, uint32_t k, double p)
+{
+    double bits = -(double) k * n / log(1.0 - pow(p, 1.0 / k));
+
+    return ((uint64_t) ceil(bits) + 7) / 8 * 8;
+}
+
+
+/**
+ * \brief Table size (bits) of a candidate of an engine
+ */
+static uint64_t bfi_tune_engine_table_size(bfi_engine_t engine, uint64_t n,
+                    uint32_t k, double p)
+{
+    uint64_t size;
+
+    if (engine != BFI_ENGINE_REGISTER) {
+        return bfi_tune_table_size(n, k, p);
+    }
+
+    // The largest table is benchmarked if fp_prob needs a larger one
+    size = bfi_register_table_size(n, k, p);
+    return size ? size : (uint64_t) BFI_REGISTER_WORD_MAX
+                         * BFI_REGISTER_WORD_BITS;
+}
+
+
+/**
+ * \brief Count of hash functions (bits per key) of the smallest filter of
+ *    an engine
+ */
+static uint32_t bfi_tune_optimal_hash_cnt(bfi_engine_t engine, uint64_t n,
+                    double p)
+{
+    uint32_t k_opt = 1;
+    uint64_t best = 0;
+
+    if (engine != BFI_ENGINE_REGISTER) {
+        // -log2(fp_prob) for a Bloom filter
+        k_opt = (uint32_t) (-log2(p) + 0.5);
+        return k_opt ? k_opt : 1;
+    }
+
+    for (uint32_t k = 1; k <= BFI_REGISTER_KEY_BITS_MAX; ++k) {
+        uint64_t size = bfi_register_table_size(n, k, p);
+
+        if (size && (best == 0 || size < best)) {
+            best = size;
+            k_opt = k;
+        }
+    }
+
+    return k_opt;
+}
+
+
+/**
+ * \brief Benchmark one configuration
+ */
+static bfi_ecode_t bfi_tune_candidate(const bfi_params_t *params,
+                    const unsigned char *keys, size_t key_len,
+                    uint64_t ins_cnt, uint64_t probe_cnt,
+                    bfi_tune_candidate_t *cand)
+{
+    const unsigned char *probes = keys + ins_cnt * key_len;
+    bfi_params_t bench = *params;
+    bfi_index_ptr_t index = NULL;
+    uint64_t fp_cnt = 0;
+    volatile uint64_t hits = 0;
+    double start;
+    bfi_ecode_t ret;
+
+    bench.hash_cnt = cand->hash_cnt;
+    bench.table_size = cand->table_size;
+    bench.cms_width = 0;
+    bench.cms_depth = 0;
+
+    // Throughput on the filter of the full size
+    ret = bfi_init_index_params(&index, &bench);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+    start = bfi_tune_now();
+    for (uint64_t i = 0; i < ins_cnt; ++i) {
+        bfi_add_addr_index(index, keys + i * key_len, key_len);
+    }
+    cand->insert_rate = ins_cnt / (bfi_tune_now() - start + 1e-9);
+
+    // Inserted and missing keys are looked up alternately
+    start = bfi_tune_now();
+    for (uint64_t i = 0; i < 2 * probe_cnt; ++i) {
+        const unsigned char *key = i % 2 ? probes + (i / 2) * key_len
+                                         : keys + (i / 2 % ins_cnt) * key_len;
+
+        hits += bfi_addr_is_stored(index, key, key_len);
+    }
+    cand->lookup_rate = 2 * probe_cnt / (bfi_tune_now() - start + 1e-9);
+    bfi_destroy_index(&index);
+
+    // False positive rate on a filter with the same load of bits as the
+    // full filter with est_item_cnt items
+    bench.table_size = (uint64_t) ((double) cand->table_size * ins_cnt
+                                   / params->est_item_cnt);
+    if (bench.table_size < BFI_TUNE_TABLE_MIN) {
+        bench.table_size = BFI_TUNE_TABLE_MIN;
+    }
+    ret = bfi_init_index_params(&index, &bench);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+    for (uint64_t i = 0; i < ins_cnt; ++i) {
+        bfi_add_addr_index(index, keys + i * key_len, key_len);
+    }
+    for (uint64_t i = 0; i < probe_cnt; ++i) {
+        fp_cnt += bfi_addr_is_stored(index, probes + i * key_len, key_len);
+    }
+    cand->fp_rate = (double) fp_cnt / probe_cnt;
+    bfi_destroy_index(&index);
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_autotune(bfi_params_t *params, const unsigned char *keys,
+                    size_t key_len, uint64_t key_cnt, uint64_t memory_cap,
+                    bfi_tune_candidate_t *candidates,
+                    uint32_t *candidate_cnt)
+{
+    bfi_tune_candidate_t cands[BFI_TUNE_CANDIDATE_MAX];
+    uint64_t ins_cnt = key_cnt / 2;
+    uint64_t probe_cnt = key_cnt - ins_cnt;
+    uint32_t cnt = 0;
+    uint32_t k_opt;
+    uint32_t k_first;
+    uint32_t k_max;
+    uint64_t cap_bits;
+    double fp_limit;
+    int best = -1;
+
+    if (candidate_cnt) {
+        *candidate_cnt = 0;
+    }
+    if (params->engine != BFI_ENGINE_STANDARD
+            && params->engine != BFI_ENGINE_REGISTER) {
+        return BFI_E_ENGINE;
+    }
+    if (key_cnt < 2 || params->est_item_cnt == 0 || params->fp_prob <= 0.0
+            || params->fp_prob >= 1.0) {
+        return BFI_E_BP_COMP_PARAMS;
+    }
+    if (ins_cnt > params->est_item_cnt) {
+        ins_cnt = params->est_item_cnt;
+    }
+
+    // Counts of hash functions around the optimal one, register-blocked
+    // tables consist of whole words
+    k_opt = bfi_tune_optimal_hash_cnt(params->engine, params->est_item_cnt,
+                                      params->fp_prob);
+    k_first = k_opt > BFI_TUNE_HASH_BELOW ? k_opt - BFI_TUNE_HASH_BELOW : 1;
+    k_max = BFI_STACK_HASH_CNT;
+    cap_bits = memory_cap * 8;
+    if (params->engine == BFI_ENGINE_REGISTER) {
+        k_max = BFI_REGISTER_KEY_BITS_MAX;
+        cap_bits -= cap_bits % BFI_REGISTER_WORD_BITS;
+        if (memory_cap && cap_bits == 0) {
+            cap_bits = BFI_REGISTER_WORD_BITS;
+        }
+    }
+    for (uint32_t k = k_first; cnt < BFI_TUNE_CANDIDATE_MAX
+            && k <= k_max; ++k, ++cnt) {
+        bfi_tune_candidate_t *cand = &cands[cnt];
+        bfi_ecode_t ret;
+
+        memset(cand, 0, sizeof(*cand));
+        cand->hash_cnt = k;
+        cand->table_size = bfi_tune_engine_table_size(params->engine,
+                                                      params->est_item_cnt, k,
+                                                      params->fp_prob);
+        // Capped filters are benchmarked too (they miss fp_prob)
+        if (memory_cap && cand->table_size > cap_bits) {
+            cand->table_size = cap_bits;
+        }
+        ret = bfi_tune_candidate(params, keys, key_len, ins_cnt, probe_cnt,
+                                 cand);
+        if (ret != BFI_E_OK) {
+            return ret;
+        }
+    }
+
+    // The fastest lookups within fp_prob (3 standard deviations of the
+    // measured rate), the lowest false positive rate otherwise
+    fp_limit = params->fp_prob + 3.0 * sqrt(params->fp_prob / probe_cnt);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        if (cands[i].fp_rate <= fp_limit && (best < 0
+                || cands[best].fp_rate > fp_limit
+                || cands[i].lookup_rate > cands[best].lookup_rate)) {
+            best = i;
+        } else if (cands[i].fp_rate > fp_limit && (best < 0
+                || (cands[best].fp_rate > fp_limit
+                    && cands[i].fp_rate < cands[best].fp_rate))) {
+            best = i;
+        }
+    }
+    cands[best].selected = true;
+    params->hash_cnt = cands[best].hash_cnt;
+    params->table_size = cands[best].table_size;
+
+    if (candidates) {
+        memcpy(candidates, cands, cnt * sizeof(*cands));
+    }
+    if (candidate_cnt) {
+        *candidate_cnt = cnt;
+    }
+
+    return BFI_E_OK;
+}
@@ -0,0 +1,315 @@
+/**
+ * \file bf_zone.c
+ * \brief Zone maps (address ranges and prefix presence) of indexes
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bf_index_internal.h"
+#include "bf_index_file.h"
+
+// Address lengths recorded by zone maps
+#define BFI_ZONE_IPV4_LEN 4
+#define BFI_ZONE_IPV6_LEN 16
+
+
+/**
+ * \brief Bit of the IPv6 sketch of a /16 prefix (multiplicative hashing
+ *    spreads common prefixes, e.g. 2001::/16 and 2a00::/16, over the sketch)
+ */
+static inline uint32_t bfi_zone_ipv6_bit(const unsigned char *buffer)
+{
+    uint16_t prefix = (uint16_t) ((buffer[0] << 8) | buffer[1]);
+
+    return (uint16_t) (prefix * 40503u) >> (16 - 10);
+}
+
+
+static inline uint32_t bfi_zone_ipv4(const unsigned char *buffer)
+{
+    return ((uint32_t) buffer[0] << 24) | ((uint32_t) buffer[1] << 16)
+           | ((uint32_t) buffer[2] << 8) | buffer[3];
+}
+
+
+void bfi_zone_reset(bfi_zone_t *zone, bool valid)
+{
+    memset(zone, 0, sizeof(*zone));
+    zone->valid = valid;
+    zone->ipv4_min = UINT32_MAX;
+}
+
+
+void bfi_zone_update(bfi_zone_t *zone, const unsigned char *buffer,
+                    size_t len)
+{
+    if (len == BFI_ZONE_IPV4_LEN) {
+        uint32_t addr = bfi_zone_ipv4(buffer);
+
+        if (addr < zone->ipv4_min) {
+            zone->ipv4_min = addr;
+        }
+        if (addr > zone->ipv4_max) {
+            zone->ipv4_max = addr;
+        }
+        zone->ipv4_octets[buffer[0] / 64] |= 1ULL << (buffer[0] % 64);
+    } else if (len == BFI_ZONE_IPV6_LEN) {
+        uint32_t bit = bfi_zone_ipv6_bit(buffer);
+
+        zone->ipv6_prefixes[bit / 64] |= 1ULL << (bit % 64);
+    }
+}
+
+
+/**
+ * \brief Copy a key made of fragments to a buffer if it is an address
+ *
+ * \param[out] buffer Buffer of BFI_ZONE_IPV6_LEN bytes
+ * \return Returns length of the key if it is an IPv4 or IPv6 address (only
+ *    such keys are recorded), 0 otherwise.
+ */
+static size_t bfi_zone_gather(const bfi_iovec_t *iov, size_t iov_cnt,
+                    unsigned char *buffer)
+{
+    size_t len = 0;
+
+    for (size_t i = 0; i < iov_cnt; ++i) {
+        len += iov[i].len;
+    }
+    if (len != BFI_ZONE_IPV4_LEN && len != BFI_ZONE_IPV6_LEN) {
+        return 0;
+    }
+
+    len = 0;
+    for (size_t i = 0; i < iov_cnt; ++i) {
+        memcpy(buffer + len, iov[i].base, iov[i].len);
+        len += iov[i].len;
+    }
+
+    return len;
+}
+
+
+void bfi_zone_update_iov(bfi_zone_t *zone, const bfi_iovec_t *iov,
+                    size_t iov_cnt)
+{
+    unsigned char buffer[BFI_ZONE_IPV6_LEN];
+    size_t len;
+
+    if (iov_cnt == 1) {
+        bfi_zone_update(zone, (const unsigned char *) iov[0].base, iov[0].len);
+        return;
+    }
+    len = bfi_zone_gather(iov, iov_cnt, buffer);
+    if (len) {
+        bfi_zone_update(zone, buffer, len);
+    }
+}
+
+
+bool bfi_zone_may_contain_iov(const bfi_zone_t *zone, const bfi_iovec_t *iov,
+                    size_t iov_cnt)
+{
+    unsigned char buffer[BFI_ZONE_IPV6_LEN];
+    size_t len;
+
+    if (!zone || !zone->valid) {
+        return true;
+    }
+    if (iov_cnt == 1) {
+        return bfi_zone_may_contain(zone, (const unsigned char *) iov[0].base,
+                                    iov[0].len);
+    }
+    len = bfi_zone_gather(iov, iov_cnt, buffer);
+
+    return len == 0 || bfi_zone_may_contain(zone, buffer, len);
+}
+
+
+void bfi_zone_merge(bfi_zone_t *dst, const bfi_zone_t *src)
+{
+    dst->valid = dst->valid && src->valid;
+    if (src->ipv4_min < dst->ipv4_min) {
+        dst->ipv4_min = src->ipv4_min;
+    }
+    if (src->ipv4_max > dst->ipv4_max) {
+        dst->ipv4_max = src->ipv4_max;
+    }
+    for (int i = 0; i < BFI_ZONE_IPV4_WORDS; ++i) {
+        dst->ipv4_octets[i] |= src->ipv4_octets[i];
+    }
+    for (int i = 0; i < BFI_ZONE_IPV6_WORDS; ++i) {
+        dst->ipv6_prefixes[i] |= src->ipv6_prefixes[i];
+    }
+}
+
+
+bool bfi_zone_may_contain(const bfi_zone_t *zone, const unsigned char *buffer,
+                    const size_t len)
+{
+    if (!zone || !zone->valid) {
+        // Nothing is known about the index
+        return true;
+    }
+
+    if (len == BFI_ZONE_IPV4_LEN) {
+        uint32_t addr = bfi_zone_ipv4(buffer);
+
+        return addr >= zone->ipv4_min && addr <= zone->ipv4_max
+               && (zone->ipv4_octets[buffer[0] / 64]
+                   & (1ULL << (buffer[0] % 64)));
+    } else if (len == BFI_ZONE_IPV6_LEN) {
+        uint32_t bit = bfi_zone_ipv6_bit(buffer);
+
+        return zone->ipv6_prefixes[bit / 64] & (1ULL << (bit % 64));
+    }
+
+    // Other keys are not recorded
+    return true;
+}
+
+
+uint64_t bfi_zone_as_bytes(const bfi_zone_t *zone, char *buff)
+{
+    char *pos = buff;
+
+    memcpy(pos, &zone->ipv4_min, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+    memcpy(pos, &zone->ipv4_max, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+    memcpy(pos, zone->ipv4_octets, sizeof(zone->ipv4_octets));
+    pos += sizeof(zone->ipv4_octets);
+    memcpy(pos, zone->ipv6_prefixes, sizeof(zone->ipv6_prefixes));
+
+    return BFI_ZONE_SEC_LEN;
+}
+
+
+bfi_ecode_t bfi_zone_from_bytes(const char *buff, uint64_t len,
+                    bfi_zone_t *zone)
+{
+    const char *pos = buff;
+
+    if (len != BFI_ZONE_SEC_LEN) {
+        return BFI_E_LOAD_SECTION;
+    }
+
+    bfi_zone_reset(zone, true);
+    memcpy(&zone->ipv4_min, pos, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+    memcpy(&zone->ipv4_max, pos, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+    memcpy(zone->ipv4_octets, pos, sizeof(zone->ipv4_octets));
+    pos += sizeof(zone->ipv4_octets);
+    memcpy(zone->ipv6_prefixes, pos, sizeof(zone->ipv6_prefixes));
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_zone_read_file(FILE *file_ptr, bfi_zone_t *zone)
+{
+    bfi_file_header_t header;
+    bfi_section_t *sections;
+    const bfi_section_t *sec;
+    char *payload = NULL;
+    uint64_t payload_len;
+    uint16_t magic;
+    bfi_ecode_t ret;
+
+    bfi_zone_reset(zone, false);
+
+    // Version 1 files have no zone map
+    rewind(file_ptr);
+    if (fread(&magic, sizeof(magic), 1, file_ptr) != 1) {
+        return BFI_E_LOAD_MAGIC;
+    }
+    if (magic != BFI_MAGIC_V2) {
+        return magic == BFI_MAGIC ? BFI_E_OK : BFI_E_LOAD_BAD_MAGIC;
+    }
+    rewind(file_ptr);
+
+    ret = bfi_file_read_toc(file_ptr, &header, &sections);
+    if (ret != BFI_E_OK) {
+        return ret;
+    }
+    sec = bfi_file_find_section(sections, header.section_cnt, BFI_SEC_ZONE);
+    if (sec) {
+        ret = bfi_file_read_section(file_ptr, sec, &payload, &payload_len);
+        if (ret == BFI_E_OK) {
+            ret = bfi_zone_from_bytes(payload, payload_len, zone);
+        }
+    }
+    free(payload);
+    free(sections);
+
+    return ret;
+}
+
+
+bfi_ecode_t bfi_index_zone(bfi_index_ptr_t index_ptr, bfi_zone_t *zone)
+{
+    bfi_index_t *index = (bfi_index_t *) index_ptr;
+
+    if (!index) {
+        return BFI_E_NO_INDEX;
+    }
+
+    *zone = index->zone;
+
+    return BFI_E_OK;
+}
+
+
+bfi_ecode_t bfi_read_zone(char *filename, bfi_zone_t *zone)
+{
+    FILE *bf_file_ptr;
+    bfi_ecode_t ret;
+
+	// Open file, mode: read binary
+    bf_file_ptr = fopen(filename, "rb");
+    if (!bf_file_ptr){
+        bfi_zone_reset(zone, false);
+        return BFI_E_LOAD_FILE_ERR;
+    }
+
+    ret = bfi_zone_read_file(bf_file_ptr, zone);
+    fclose(bf_file_ptr);
+
+    return ret;
+}
@@ -40,9 +40,18 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <new>
 
 #include "bloomf_wrapper.h"
+#include "bf_index.h"
 #include "BloomFilter.hpp"
+#include "StableBloomFilter.hpp"
+#include "TemporalBloomFilter.hpp"
+#include "QuotientFilter.hpp"
+#include "RegisterBloomFilter.hpp"
+#include "CountMinSketch.hpp"
+#include "RangeBloomFilter.hpp"
+#include "FoldedBloomFilter.hpp"
 
 extern "C" {
     // Bloom filter parameters /////////////////////////////////////////////////
@@ -73,6 +82,25 @@ extern "C" {
         reinterpret_cast<bloom_parameters *>(bp)->false_positive_probability = prob;
     }
 
+    void bp_set_random_seed (bloom_parameters_h* bp, unsigned long long int seed)
+    {
+        reinterpret_cast<bloom_parameters *>(bp)->random_seed = seed;
+    }
+
+    void bp_set_optimal_parameters (bloom_parameters_h* bp, unsigned int hash_cnt, unsigned long long int table_size)
+    {
+        bloom_parameters *p = reinterpret_cast<bloom_parameters *>(bp);
+        p->optimal_parameters.number_of_hashes = hash_cnt;
+        p->optimal_parameters.table_size = table_size;
+    }
+
+    void bp_get_optimal_parameters (bloom_parameters_h* bp, unsigned int *hash_cnt, unsigned long long int *table_size)
+    {
+        bloom_parameters *p = reinterpret_cast<bloom_parameters *>(bp);
+        *hash_cnt = p->optimal_parameters.number_of_hashes;
+        *table_size = p->optimal_parameters.table_size;
+    }
+
     // Public methods and operators
     bool bp_not(bloom_parameters_h* bp)
     {
@@ -107,6 +135,11 @@ extern "C" {
                 const_cast<bloom_filter&>(*(reinterpret_cast<bloom_filter*>(bf)))));
     }
 
+    bloom_filter_h *new_bloom_filter_family(bloom_parameters_h *bp, unsigned long long int random_seed)
+    {
+        return reinterpret_cast<bloom_filter_h *>(new bloom_filter(*(reinterpret_cast<bloom_parameters *>(bp)), random_seed));
+    }
+
     // Public methods and operators
     void bf_clear(bloom_filter_h *bf)
     {
@@ -135,12 +168,21 @@ extern "C" {
 
     uint32_t bf_get_filter_as_bytes(bloom_filter_h *bf, char **buff)
     {
-        return reinterpret_cast<bloom_filter*>(bf)->get_filter_as_bytes(buff);
+        try {
+            return reinterpret_cast<bloom_filter*>(bf)->get_filter_as_bytes(buff);
+        } catch (const std::bad_alloc&) {
+            *buff = NULL;
+            return 0;
+        }
     }
 
     int bf_load_filter_from_bytes(bloom_filter_h *bf, const char *buff, uint32_t len)
     {
-        return reinterpret_cast<bloom_filter*>(bf)->load_filter_from_bytes(buff, len);
+        try {
+            return reinterpret_cast<bloom_filter*>(bf)->load_filter_from_bytes(buff, len);
+        } catch (const std::bad_alloc&) {
+            return BFI_E_LOAD_MEM;
+        }
     }
 
     void bf_clear_bytes(bloom_filter_h *bf, char **buff)
@@ -153,9 +195,376 @@ extern "C" {
         delete reinterpret_cast<bloom_filter*>(bf);
     }
 
-    // Getter
+    std::size_t bf_hash_count(bloom_filter_h *bf)
+    {
+        return reinterpret_cast<bloom_filter*>(bf)->hash_count();
+    }
+
+    void bf_compute_hashes(bloom_filter_h *bf, const unsigned char* key_begin, const size_t *length, uint32_t *hashes)
+    {
+        reinterpret_cast<bloom_filter*>(bf)->compute_hashes(key_begin, *length, hashes);
+    }
+
+    void bf_compute_hashes_iov(bloom_filter_h *bf, const struct bfi_iovec *iov, size_t iov_cnt, uint32_t *hashes)
+    {
+        reinterpret_cast<bloom_filter*>(bf)->compute_hashes_fragments(iov, iov_cnt, hashes);
+    }
+
+    bool bf_contains_hashes(bloom_filter_h *bf, const uint32_t *hashes)
+    {
+        return reinterpret_cast<bloom_filter*>(bf)->contains_hashes(hashes);
+    }
+
+    bool bf_containsinsert_hashes(bloom_filter_h *bf, const uint32_t *hashes)
+    {
+        return reinterpret_cast<bloom_filter*>(bf)->containsinsert_hashes(hashes);
+    }
+
+    void bf_union(bloom_filter_h *bf, bloom_filter_h *other)
+    {
+        *(reinterpret_cast<bloom_filter*>(bf)) |= *(reinterpret_cast<bloom_filter*>(other));
+    }
+
+    double bf_estimated_element_cnt(bloom_filter_h *bf)
+    {
+        return reinterpret_cast<bloom_filter*>(bf)->estimated_element_count();
+    }
+
+    uint64_t bf_count_set_bits(bloom_filter_h *bf)
+    {
+        return reinterpret_cast<bloom_filter*>(bf)->count_set_bits();
+    }
+
+    uint64_t bf_bit_position(bloom_filter_h *bf, uint32_t hash)
+    {
+        return reinterpret_cast<bloom_filter*>(bf)->bit_position(hash);
+    }
+
+    uint32_t bf_header_length(bloom_filter_h *bf)
+    {
+        return reinterpret_cast<bloom_filter*>(bf)->header_length();
+    }
+
+    uint32_t bf_header_prefix_size()
+    {
+        return bloom_filter::header_prefix_size();
+    }
+
+    uint32_t bf_header_size(const char *prefix)
+    {
+        return bloom_filter::header_size(prefix);
+    }
+
+    int bf_load_header_from_bytes(bloom_filter_h *bf, const char *buff, uint32_t len)
+    {
+        try {
+            return reinterpret_cast<bloom_filter*>(bf)->load_header_from_bytes(buff, len);
+        } catch (const std::bad_alloc&) {
+            return BFI_E_LOAD_MEM;
+        }
+    }
+
+    const unsigned char *bf_table(bloom_filter_h *bf, uint64_t *len)
+    {
+        *len = reinterpret_cast<bloom_filter*>(bf)->raw_table_size();
+        return reinterpret_cast<bloom_filter*>(bf)->table();
+    }
+
+    void bf_xor_table(bloom_filter_h *bf, uint64_t offset, const unsigned char *delta, uint64_t len)
+    {
+        reinterpret_cast<bloom_filter*>(bf)->xor_table(offset, delta, len);
+    }
+
+    uint32_t bf_get_header_as_bytes(bloom_filter_h *bf, char *buff)
+    {
+        return reinterpret_cast<bloom_filter*>(bf)->get_header_as_bytes(buff);
+    }
+
+    unsigned char *bf_allocate_table(bloom_filter_h *bf, uint64_t *len)
+    {
+        *len = reinterpret_cast<bloom_filter*>(bf)->raw_table_size();
+        try {
+            return reinterpret_cast<bloom_filter*>(bf)->allocate_table();
+        } catch (const std::bad_alloc&) {
+            return NULL;
+        }
+    }
+
+    // Getters & setters
     uint64_t bf_get_inserted_element_cnt (bloom_filter_h *bf)
     {
         return reinterpret_cast<bloom_filter*>(bf)->get_inserted_element_count();
     }
-}
+
+    void bf_set_inserted_element_cnt(bloom_filter_h *bf, uint64_t cnt)
+    {
+        reinterpret_cast<bloom_filter*>(bf)->set_inserted_element_count(static_cast<unsigned int>(cnt));
+    }
+
+    void bf_get_parameters(bloom_filter_h *bf, unsigned int *hash_cnt, unsigned long long int *table_size, unsigned long long int *random_seed, unsigned long long int *proj_elem_cnt, double *false_pos_prob)
+    {
+        reinterpret_cast<bloom_filter*>(bf)->get_parameters(*hash_cnt, *table_size, *random_seed, *proj_elem_cnt, *false_pos_prob);
+    }
+
+    // Stable Bloom filter //////////////////////////////////////////////////////
+    // Constructors
+    bloom_filter_h *new_stable_bloom_filter()
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new stable_bloom_filter()));
+    }
+
+    bloom_filter_h *new_stable_bloom_filter_bp(bloom_parameters_h *bp, unsigned int cell_max, unsigned long long int decrement_cnt)
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new stable_bloom_filter(
+                *(reinterpret_cast<bloom_parameters *>(bp)), cell_max, decrement_cnt)));
+    }
+
+    // Getters & setters
+    void sbf_get_parameters(bloom_filter_h *bf, unsigned int *cell_max, unsigned long long int *decrement_cnt, unsigned long long int *rng_state)
+    {
+        stable_bloom_filter *sbf = static_cast<stable_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf));
+        *cell_max = sbf->cell_max();
+        *decrement_cnt = sbf->decrement_count();
+        *rng_state = sbf->rng_state();
+    }
+
+    int sbf_set_parameters(bloom_filter_h *bf, unsigned int cell_max, unsigned long long int decrement_cnt, unsigned long long int rng_state)
+    {
+        return static_cast<stable_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->set_stable_parameters(cell_max, decrement_cnt, rng_state) ? 0 : -1;
+    }
+
+    // Temporal Bloom filter ////////////////////////////////////////////////////
+    // Constructors
+    bloom_filter_h *new_temporal_bloom_filter()
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new temporal_bloom_filter()));
+    }
+
+    bloom_filter_h *new_temporal_bloom_filter_bp(bloom_parameters_h *bp, unsigned int slot_cnt)
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new temporal_bloom_filter(
+                *(reinterpret_cast<bloom_parameters *>(bp)), slot_cnt)));
+    }
+
+    // Public methods
+    unsigned int tbf_slots(bloom_filter_h *bf, const unsigned char *buffer, size_t len)
+    {
+        return static_cast<temporal_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->slots(buffer, len);
+    }
+
+    // Getters & setters
+    int tbf_set_slot(bloom_filter_h *bf, unsigned int slot)
+    {
+        return static_cast<temporal_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->set_slot(slot) ? 0 : -1;
+    }
+
+    void tbf_get_parameters(bloom_filter_h *bf, unsigned int *slot_cnt, unsigned int *slot)
+    {
+        temporal_bloom_filter *tbf = static_cast<temporal_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf));
+        *slot_cnt = tbf->slot_count();
+        *slot = tbf->slot();
+    }
+
+    int tbf_set_parameters(bloom_filter_h *bf, unsigned int slot_cnt, unsigned int slot)
+    {
+        return static_cast<temporal_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->set_temporal_parameters(slot_cnt, slot) ? 0 : -1;
+    }
+
+    // Quotient filter //////////////////////////////////////////////////////////
+    // Constructors
+    bloom_filter_h *new_quotient_filter()
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new quotient_filter()));
+    }
+
+    bloom_filter_h *new_quotient_filter_bp(bloom_parameters_h *bp, unsigned int quotient_bits, unsigned int remainder_bits)
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new quotient_filter(
+                *(reinterpret_cast<bloom_parameters *>(bp)), quotient_bits, remainder_bits)));
+    }
+
+    // Public methods
+    int qf_resize(bloom_filter_h *bf)
+    {
+        return static_cast<quotient_filter*>(reinterpret_cast<bloom_filter*>(bf))->resize() ? 0 : -1;
+    }
+
+    int qf_merge(bloom_filter_h *bf, bloom_filter_h *other)
+    {
+        return static_cast<quotient_filter*>(reinterpret_cast<bloom_filter*>(bf))->merge(
+                *static_cast<quotient_filter*>(reinterpret_cast<bloom_filter*>(other))) ? 0 : -1;
+    }
+
+    // Getters & setters
+    void qf_get_parameters(bloom_filter_h *bf, unsigned int *quotient_bits, unsigned int *remainder_bits)
+    {
+        quotient_filter *qf = static_cast<quotient_filter*>(reinterpret_cast<bloom_filter*>(bf));
+        *quotient_bits = qf->quotient_bits();
+        *remainder_bits = qf->remainder_bits();
+    }
+
+    int qf_set_parameters(bloom_filter_h *bf, unsigned int quotient_bits, unsigned int remainder_bits)
+    {
+        return static_cast<quotient_filter*>(reinterpret_cast<bloom_filter*>(bf))->set_quotient_parameters(quotient_bits, remainder_bits) ? 0 : -1;
+    }
+
+    // Register-blocked Bloom filter ////////////////////////////////////////////
+    // Constructors
+    bloom_filter_h *new_register_bloom_filter()
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new register_bloom_filter()));
+    }
+
+    bloom_filter_h *new_register_bloom_filter_bp(bloom_parameters_h *bp, unsigned int bits_per_key)
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new register_bloom_filter(
+                *(reinterpret_cast<bloom_parameters *>(bp)), bits_per_key)));
+    }
+
+    // Public methods
+    void rgbf_contains_hashes_batch(bloom_filter_h *bf, const uint32_t *hashes, size_t cnt, bool *results)
+    {
+        static_cast<register_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->contains_hashes_batch(hashes, cnt, results);
+    }
+
+    uint64_t rgbf_word_position(bloom_filter_h *bf, uint32_t hash, uint64_t *mask)
+    {
+        return static_cast<register_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->word_position(hash, *mask);
+    }
+
+    // Getters & setters
+    unsigned int rgbf_get_bits_per_key(bloom_filter_h *bf)
+    {
+        return static_cast<register_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->bits_per_key();
+    }
+
+    int rgbf_set_parameters(bloom_filter_h *bf, unsigned int bits_per_key)
+    {
+        return static_cast<register_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->set_register_parameters(bits_per_key) ? 0 : -1;
+    }
+
+    // Folded Bloom filter //////////////////////////////////////////////////////
+    // Constructors
+    bloom_filter_h *new_folded_bloom_filter()
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new folded_bloom_filter()));
+    }
+
+    bloom_filter_h *new_folded_bloom_filter_f(bloom_filter_h *bf, unsigned int factor)
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new folded_bloom_filter(
+                    *(reinterpret_cast<bloom_filter *>(bf)), factor)));
+    }
+
+    // Getters & setters
+    uint64_t fbf_get_original_table_size(bloom_filter_h *bf)
+    {
+        return static_cast<folded_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->original_table_size();
+    }
+
+    void fbf_set_original_table_size(bloom_filter_h *bf, uint64_t size)
+    {
+        static_cast<folded_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->set_original_table_size(size);
+    }
+
+    // Range Bloom filter ///////////////////////////////////////////////////////
+    // Constructors
+    bloom_filter_h *new_range_bloom_filter()
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new range_bloom_filter()));
+    }
+
+    bloom_filter_h *new_range_bloom_filter_bp(bloom_parameters_h *bp, unsigned int key_bits)
+    {
+        return reinterpret_cast<bloom_filter_h *>(static_cast<bloom_filter *>(new range_bloom_filter(
+                *(reinterpret_cast<bloom_parameters *>(bp)), key_bits)));
+    }
+
+    // Public methods
+    void rbf_insert_key(bloom_filter_h *bf, uint64_t key)
+    {
+        static_cast<range_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->insert_key(key);
+    }
+
+    bool rbf_range_may_contain(bloom_filter_h *bf, uint64_t low, uint64_t high)
+    {
+        return static_cast<range_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->range_may_contain(low, high);
+    }
+
+    // Getters & setters
+    void rbf_get_parameters(bloom_filter_h *bf, unsigned int *key_bits, unsigned int *max_probes)
+    {
+        range_bloom_filter *rbf = static_cast<range_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf));
+        *key_bits = rbf->key_bits();
+        *max_probes = rbf->max_probes();
+    }
+
+    void rbf_set_parameters(bloom_filter_h *bf, unsigned int key_bits, unsigned int max_probes)
+    {
+        static_cast<range_bloom_filter*>(reinterpret_cast<bloom_filter*>(bf))->set_range_parameters(key_bits, max_probes);
+    }
+
+    // Count-min sketch /////////////////////////////////////////////////////////
+    // Constructors
+    count_min_sketch_h *new_count_min_sketch()
+    {
+        return reinterpret_cast<count_min_sketch_h *>(new count_min_sketch());
+    }
+
+    count_min_sketch_h *new_count_min_sketch_wd(uint32_t width, uint32_t depth, bool conservative)
+    {
+        return reinterpret_cast<count_min_sketch_h *>(new count_min_sketch(width, depth, conservative));
+    }
+
+    // Public methods
+    void cms_clear(count_min_sketch_h *cms)
+    {
+        reinterpret_cast<count_min_sketch*>(cms)->clear();
+    }
+
+    void cms_update_hashes(count_min_sketch_h *cms, const uint32_t *hashes)
+    {
+        reinterpret_cast<count_min_sketch*>(cms)->update_hashes(hashes);
+    }
+
+    uint32_t cms_estimate_hashes(count_min_sketch_h *cms, const uint32_t *hashes)
+    {
+        return reinterpret_cast<count_min_sketch*>(cms)->estimate_hashes(hashes);
+    }
+
+    int cms_merge(count_min_sketch_h *cms, count_min_sketch_h *other)
+    {
+        return reinterpret_cast<count_min_sketch*>(cms)->merge(
+                *reinterpret_cast<count_min_sketch*>(other)) ? 0 : -1;
+    }
+
+    uint64_t cms_get_sketch_as_bytes(count_min_sketch_h *cms, char **buff)
+    {
+        return reinterpret_cast<count_min_sketch*>(cms)->get_sketch_as_bytes(buff);
+    }
+
+    int cms_load_sketch_from_bytes(count_min_sketch_h *cms, const char *buff, uint64_t len)
+    {
+        try {
+            return reinterpret_cast<count_min_sketch*>(cms)->load_sketch_from_bytes(buff, len);
+        } catch (const std::bad_alloc&) {
+            return BFI_E_LOAD_MEM;
+        }
+    }
+
+    void cms_clear_bytes(count_min_sketch_h *cms, char **buff)
+    {
+        reinterpret_cast<count_min_sketch*>(cms)->clear_bytes(buff);
+    }
+
+    void cms_delete_sketch(count_min_sketch_h *cms)
+    {
+        delete reinterpret_cast<count_min_sketch*>(cms);
+    }
+
+    // Getter
+    uint32_t cms_get_depth(count_min_sketch_h *cms)
+    {
+        return reinterpret_cast<count_min_sketch*>(cms)->depth();
+    }
+}
\ No newline at end of file
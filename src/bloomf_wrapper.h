@@ -48,6 +48,13 @@
 extern "C" {
 #endif
 
+// Fragment of a key (bfi_iovec_t of bf_index.h)
+struct bfi_iovec;
+
+// Loads of stored filters and sketches return BFI_E_LOAD_MEM (and
+// bf_allocate_table() NULL, bf_get_filter_as_bytes() 0) if memory could not
+// be allocated, std::bad_alloc does not cross the wrapper
+
 ///- Bloom filter parameters
 typedef struct bloom_parameters_h bloom_parameters_h;
 // Constructor
@@ -57,6 +64,9 @@ unsigned long long int bp_get_proj_elem_cnt (bloom_parameters_h* bp);
 double bp_get_false_pos_prob (bloom_parameters_h *bp);
 void bp_set_proj_elem_cnt (bloom_parameters_h* bp, unsigned long long int cnt);
 void bp_set_false_pos_prob (bloom_parameters_h* bp, double prob);
+void bp_set_random_seed (bloom_parameters_h* bp, unsigned long long int seed);
+void bp_set_optimal_parameters (bloom_parameters_h* bp, unsigned int hash_cnt, unsigned long long int table_size);
+void bp_get_optimal_parameters (bloom_parameters_h* bp, unsigned int *hash_cnt, unsigned long long int *table_size);
 // Public methods and operators
 bool bp_not(bloom_parameters_h* bp);
 bool bp_compute_optimal_parameters(bloom_parameters_h* bp);
@@ -69,6 +79,7 @@ typedef struct bloom_filter_h bloom_filter_h;
 bloom_filter_h *new_bloom_filter();
 bloom_filter_h *new_bloom_filter_bp(bloom_parameters_h *bp);
 bloom_filter_h *new_bloom_filter_f(bloom_filter_h *bf);
+bloom_filter_h *new_bloom_filter_family(bloom_parameters_h *bp, unsigned long long int random_seed);
 // Public methods and operators
 void bf_clear(bloom_filter_h *bf);
 bool bf_contains(bloom_filter_h *bf, const unsigned char* key_begin, const size_t *length);
@@ -79,8 +90,109 @@ uint32_t bf_get_filter_as_bytes(bloom_filter_h *bf, char **buff);
 int bf_load_filter_from_bytes(bloom_filter_h *bf, const char *buff, uint32_t len);
 void bf_clear_bytes(bloom_filter_h *bf, char **buff);
 void bf_delete_filter(bloom_filter_h *bf);
-// Getter
+size_t bf_hash_count(bloom_filter_h *bf);
+void bf_compute_hashes(bloom_filter_h *bf, const unsigned char* key_begin, const size_t *length, uint32_t *hashes);
+void bf_compute_hashes_iov(bloom_filter_h *bf, const struct bfi_iovec *iov, size_t iov_cnt, uint32_t *hashes);
+bool bf_contains_hashes(bloom_filter_h *bf, const uint32_t *hashes);
+bool bf_containsinsert_hashes(bloom_filter_h *bf, const uint32_t *hashes);
+void bf_union(bloom_filter_h *bf, bloom_filter_h *other);
+double bf_estimated_element_cnt(bloom_filter_h *bf);
+uint64_t bf_count_set_bits(bloom_filter_h *bf);
+uint64_t bf_bit_position(bloom_filter_h *bf, uint32_t hash);
+uint32_t bf_header_length(bloom_filter_h *bf);
+uint32_t bf_header_prefix_size();
+uint32_t bf_header_size(const char *prefix);
+int bf_load_header_from_bytes(bloom_filter_h *bf, const char *buff, uint32_t len);
+const unsigned char *bf_table(bloom_filter_h *bf, uint64_t *len);
+void bf_xor_table(bloom_filter_h *bf, uint64_t offset, const unsigned char *delta, uint64_t len);
+uint32_t bf_get_header_as_bytes(bloom_filter_h *bf, char *buff);
+unsigned char *bf_allocate_table(bloom_filter_h *bf, uint64_t *len);
+// Getters & setters
 uint64_t bf_get_inserted_element_cnt(bloom_filter_h *bf);
+void bf_set_inserted_element_cnt(bloom_filter_h *bf, uint64_t cnt);
+void bf_get_parameters(bloom_filter_h *bf, unsigned int *hash_cnt, unsigned long long int *table_size, unsigned long long int *random_seed, unsigned long long int *proj_elem_cnt, double *false_pos_prob);
+
+
+///- Stable Bloom filter (derived from Bloom filter, use bf_* functions)
+// Constructors
+bloom_filter_h *new_stable_bloom_filter();
+bloom_filter_h *new_stable_bloom_filter_bp(bloom_parameters_h *bp, unsigned int cell_max, unsigned long long int decrement_cnt);
+// Getters & setters
+void sbf_get_parameters(bloom_filter_h *bf, unsigned int *cell_max, unsigned long long int *decrement_cnt, unsigned long long int *rng_state);
+int sbf_set_parameters(bloom_filter_h *bf, unsigned int cell_max, unsigned long long int decrement_cnt, unsigned long long int rng_state);
+
+
+///- Temporal Bloom filter (derived from Bloom filter, use bf_* functions)
+// Constructors
+bloom_filter_h *new_temporal_bloom_filter();
+bloom_filter_h *new_temporal_bloom_filter_bp(bloom_parameters_h *bp, unsigned int slot_cnt);
+// Public methods
+unsigned int tbf_slots(bloom_filter_h *bf, const unsigned char *buffer, size_t len);
+// Getters & setters
+int tbf_set_slot(bloom_filter_h *bf, unsigned int slot);
+void tbf_get_parameters(bloom_filter_h *bf, unsigned int *slot_cnt, unsigned int *slot);
+int tbf_set_parameters(bloom_filter_h *bf, unsigned int slot_cnt, unsigned int slot);
+
+
+///- Quotient filter (derived from Bloom filter, use bf_* functions)
+// Constructors
+bloom_filter_h *new_quotient_filter();
+bloom_filter_h *new_quotient_filter_bp(bloom_parameters_h *bp, unsigned int quotient_bits, unsigned int remainder_bits);
+// Public methods
+int qf_resize(bloom_filter_h *bf);
+int qf_merge(bloom_filter_h *bf, bloom_filter_h *other);
+// Getters & setters
+void qf_get_parameters(bloom_filter_h *bf, unsigned int *quotient_bits, unsigned int *remainder_bits);
+int qf_set_parameters(bloom_filter_h *bf, unsigned int quotient_bits, unsigned int remainder_bits);
+
+///- Register-blocked Bloom filter (derived from Bloom filter, use bf_* functions)
+// Constructors
+bloom_filter_h *new_register_bloom_filter();
+bloom_filter_h *new_register_bloom_filter_bp(bloom_parameters_h *bp, unsigned int bits_per_key);
+// Public methods
+void rgbf_contains_hashes_batch(bloom_filter_h *bf, const uint32_t *hashes, size_t cnt, bool *results);
+uint64_t rgbf_word_position(bloom_filter_h *bf, uint32_t hash, uint64_t *mask);
+// Getters & setters
+unsigned int rgbf_get_bits_per_key(bloom_filter_h *bf);
+int rgbf_set_parameters(bloom_filter_h *bf, unsigned int bits_per_key);
+
+///- Folded Bloom filter (derived from Bloom filter, use bf_* functions)
+// Constructors
+bloom_filter_h *new_folded_bloom_filter();
+bloom_filter_h *new_folded_bloom_filter_f(bloom_filter_h *bf, unsigned int factor);
+// Getters & setters
+uint64_t fbf_get_original_table_size(bloom_filter_h *bf);
+void fbf_set_original_table_size(bloom_filter_h *bf, uint64_t size);
+
+
+///- Range Bloom filter (derived from Bloom filter, use bf_* functions)
+// Constructors
+bloom_filter_h *new_range_bloom_filter();
+bloom_filter_h *new_range_bloom_filter_bp(bloom_parameters_h *bp, unsigned int key_bits);
+// Public methods
+void rbf_insert_key(bloom_filter_h *bf, uint64_t key);
+bool rbf_range_may_contain(bloom_filter_h *bf, uint64_t low, uint64_t high);
+// Getters & setters
+void rbf_get_parameters(bloom_filter_h *bf, unsigned int *key_bits, unsigned int *max_probes);
+void rbf_set_parameters(bloom_filter_h *bf, unsigned int key_bits, unsigned int max_probes);
+
+
+///- Count-min sketch (updated by hash values computed by bf_compute_hashes())
+typedef struct count_min_sketch_h count_min_sketch_h;
+// Constructors
+count_min_sketch_h *new_count_min_sketch();
+count_min_sketch_h *new_count_min_sketch_wd(uint32_t width, uint32_t depth, bool conservative);
+// Public methods
+void cms_clear(count_min_sketch_h *cms);
+void cms_update_hashes(count_min_sketch_h *cms, const uint32_t *hashes);
+uint32_t cms_estimate_hashes(count_min_sketch_h *cms, const uint32_t *hashes);
+int cms_merge(count_min_sketch_h *cms, count_min_sketch_h *other);
+uint64_t cms_get_sketch_as_bytes(count_min_sketch_h *cms, char **buff);
+int cms_load_sketch_from_bytes(count_min_sketch_h *cms, const char *buff, uint64_t len);
+void cms_clear_bytes(count_min_sketch_h *cms, char **buff);
+void cms_delete_sketch(count_min_sketch_h *cms);
+// Getter
+uint32_t cms_get_depth(count_min_sketch_h *cms);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,596 @@
+/**
+ * \file bfi_build.c
+ * \brief Builder of Bloom filter indexes from dumps of addresses
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE     // asprintf()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "bf_index.h"
+#include "tool_addr.h"
+#include "tool_pool.h"
+
+// Size of a block of input read at once
+#define BUILD_BLOCK_SIZE (32 * 1024 * 1024)
+
+typedef enum {
+    BUILD_TEXT,                 // IPv4 or IPv6 addresses, one per line
+    BUILD_RAW4,                 // 4 byte records
+    BUILD_RAW16,                // 16 byte records
+} build_format_t;
+
+typedef struct {
+    unsigned int threads;       // Count of threads (-t)
+    build_format_t format;      // Format of inputs (-f)
+    bfi_params_t params;        // Parameters of indexes (-e, -n, -p)
+    bool compressed;            // Compressed encoding (-c)
+    bool checksum;              // Checksums of parts (-k)
+    char *output;               // One index of all inputs (-o)
+    char *dir;                  // Directory of an index per input (-d)
+    char *catalog;              // Catalog of stored indexes (-C)
+    char **inputs;
+    size_t input_cnt;
+} build_args_t;
+
+// Keys parsed from a segment of a block of text input
+typedef struct {
+    const char *begin;
+    const char *end;
+    unsigned char *keys[2];     // IPv4 and IPv6 keys
+    uint64_t key_cnt[2];
+    uint64_t key_max[2];
+    uint64_t invalid;           // Count of lines which are not addresses
+    bool no_mem;
+} build_segment_t;
+
+// Index built from inputs [first, end)
+typedef struct {
+    const build_args_t *args;
+    size_t first;
+    size_t end;
+    char *filename;             // Path of the index
+    unsigned int threads;       // Threads parsing blocks of inputs
+    build_segment_t *segments;
+    char *block;
+    uint64_t keys;
+    uint64_t invalid;
+    uint64_t bytes;
+    double seconds;
+    bfi_ecode_t ret;
+} build_job_t;
+
+static const size_t build_key_len[2] = {TOOL_IPV4_LEN, TOOL_IPV6_LEN};
+
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [OPTIONS] (-o INDEX | -d DIR) [INPUT...]\n"
+           "Builds indexes of addresses of inputs (standard input if no input\n"
+           "or \"-\" is given).\n"
+           "Options:\n"
+           "  -o INDEX    one index of all inputs\n"
+           "  -d DIR      an index per input (DIR/INPUT.bfi)\n"
+           "  -f FORMAT   format of inputs: text (IPv4 and IPv6 addresses,\n"
+           "              one per line, default), raw4 or raw16 (records)\n"
+           "  -e ENGINE   engine of indexes: standard (default), stable,\n"
+           "              quotient or register\n"
+           "  -n COUNT    estimated count of items of an index (required for\n"
+           "              standard input, lines of text inputs are counted by\n"
+           "              an extra pass over them otherwise)\n"
+           "  -p PROB     false positive probability (default 0.01)\n"
+           "  -c          compressed encoding\n"
+           "  -k          checksums of parts of filters\n"
+           "  -C CATALOG  add stored indexes to a catalog\n"
+           "  -t THREADS  count of threads (count of processors)\n",
+           name);
+}
+
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+static bool is_stdin(const char *input)
+{
+    return strcmp(input, "-") == 0;
+}
+
+
+static bool segment_append(build_segment_t *seg, int family,
+                    const unsigned char *key)
+{
+    size_t len = build_key_len[family];
+
+    if (seg->key_cnt[family] == seg->key_max[family]) {
+        uint64_t max = seg->key_max[family] ? 2 * seg->key_max[family]
+                                            : 65536;
+        unsigned char *keys = (unsigned char *) realloc(seg->keys[family],
+                                                        max * len);
+
+        if (!keys) {
+            return false;
+        }
+        seg->keys[family] = keys;
+        seg->key_max[family] = max;
+    }
+    memcpy(seg->keys[family] + seg->key_cnt[family]++ * len, key, len);
+
+    return true;
+}
+
+
+/**
+ * \brief Parse lines of a segment of text to keys
+ *
+ * Lines are found by memchr() (vectorized by the C library).
+ */
+static void parse_job(void *arg, size_t i)
+{
+    build_segment_t *seg = &((build_job_t *) arg)->segments[i];
+    const char *p = seg->begin;
+
+    seg->key_cnt[0] = seg->key_cnt[1] = 0;
+    seg->invalid = 0;
+    while (p < seg->end && !seg->no_mem) {
+        const char *nl = (const char *) memchr(p, '\n', seg->end - p);
+        const char *line_end = nl ? nl : seg->end;
+        unsigned char key[TOOL_IPV6_LEN];
+        int len = tool_parse_addr(p, line_end, key);
+
+        p = nl ? nl + 1 : seg->end;
+        if (len < 0) {
+            seg->invalid++;
+        } else if (len > 0
+                && !segment_append(seg, len == TOOL_IPV6_LEN, key)) {
+            seg->no_mem = true;
+        }
+    }
+}
+
+
+/**
+ * \brief Insert keys of a block of text (complete lines)
+ */
+static bfi_ecode_t insert_text(build_job_t *job, bfi_index_ptr_t index,
+                    const char *text, size_t len)
+{
+    unsigned int seg_cnt = job->threads;
+    const char *begin = text;
+
+    // Segments of about the same size end by the end of a line
+    for (unsigned int s = 0; s < seg_cnt; ++s) {
+        const char *end = text + len * (s + 1) / seg_cnt;
+
+        if (end < begin) {
+            end = begin;
+        }
+        if (s + 1 < seg_cnt && end > text && end < text + len) {
+            const char *nl = (const char *) memchr(end - 1, '\n',
+                                                   text + len - (end - 1));
+
+            end = nl ? nl + 1 : text + len;
+        }
+        job->segments[s].begin = begin;
+        job->segments[s].end = end;
+        begin = end;
+    }
+    job->segments[seg_cnt - 1].end = text + len;
+
+    tool_pool_run(seg_cnt, seg_cnt, parse_job, job);
+
+    // Batches are inserted by all threads of the library
+    for (unsigned int s = 0; s < seg_cnt; ++s) {
+        build_segment_t *seg = &job->segments[s];
+
+        if (seg->no_mem) {
+            return BFI_E_MEM;
+        }
+        job->invalid += seg->invalid;
+        for (int family = 0; family < 2; ++family) {
+            bfi_ecode_t ret;
+
+            ret = bfi_add_addr_batch(index, seg->keys[family],
+                                     build_key_len[family],
+                                     seg->key_cnt[family]);
+            if (ret != BFI_E_OK) {
+                return ret;
+            }
+            job->keys += seg->key_cnt[family];
+        }
+    }
+
+    return BFI_E_OK;
+}
+
+
+/**
+ * \brief Insert all keys of an input into an index
+ */
+static bfi_ecode_t build_input(build_job_t *job, bfi_index_ptr_t index,
+                    const char *input)
+{
+    const build_args_t *args = job->args;
+    size_t rec_len = args->format == BUILD_RAW4 ? 4 : 16;
+    FILE *in = is_stdin(input) ? stdin : fopen(input, "rb");
+    bfi_ecode_t ret = BFI_E_OK;
+    size_t carry = 0;
+    bool eof = false;
+
+    if (!in) {
+        return BFI_E_LOAD_FILE_ERR;
+    }
+
+    while (!eof && ret == BFI_E_OK) {
+        size_t len = carry + fread(job->block + carry, 1,
+                                   BUILD_BLOCK_SIZE - carry, in);
+        size_t done;
+
+        eof = len < BUILD_BLOCK_SIZE;
+        if (eof && ferror(in)) {
+            ret = BFI_E_LOAD_FILE_ERR;
+            break;
+        }
+        job->bytes += len - carry;
+
+        // Only whole records (lines) are processed, the rest is kept
+        if (args->format == BUILD_TEXT) {
+            const char *nl = (const char *) memrchr(job->block, '\n', len);
+
+            done = eof || !nl ? len : (size_t) (nl - job->block) + 1;
+            if (!eof && !nl) {
+                // Line longer than a block is not an address
+                job->invalid++;
+            }
+            ret = insert_text(job, index, job->block, done);
+        } else {
+            done = len - len % rec_len;
+            ret = bfi_add_addr_batch(index, (unsigned char *) job->block,
+                                     rec_len, done / rec_len);
+            job->keys += done / rec_len;
+            if (eof && done < len) {
+                job->invalid++;
+                done = len;
+            }
+        }
+        carry = len - done;
+        memmove(job->block, job->block + done, carry);
+    }
+
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    return ret;
+}
+
+
+/**
+ * \brief Count items of inputs (records or lines)
+ *
+ * Raw inputs are counted by their size, text inputs are read once more
+ * before they are parsed (the whole input, see -n to skip this pass).
+ */
+static uint64_t count_items(const build_args_t *args, size_t first,
+                    size_t end, char *block)
+{
+    uint64_t cnt = 0;
+
+    for (size_t i = first; i < end; ++i) {
+        struct stat st;
+        FILE *in;
+        size_t len;
+
+        if (args->format != BUILD_TEXT) {
+            if (stat(args->inputs[i], &st) == 0) {
+                cnt += st.st_size / (args->format == BUILD_RAW4 ? 4 : 16);
+            }
+            continue;
+        }
+        in = fopen(args->inputs[i], "rb");
+        if (!in) {
+            continue;
+        }
+        while ((len = fread(block, 1, BUILD_BLOCK_SIZE, in)) > 0) {
+            for (const char *p = block;
+                    (p = (const char *) memchr(p, '\n', block + len - p));
+                    ++p) {
+                ++cnt;
+            }
+            if (len < BUILD_BLOCK_SIZE) {
+                // Last line without a new line
+                cnt += block[len - 1] != '\n';
+            }
+        }
+        fclose(in);
+    }
+
+    return cnt;
+}
+
+
+static void build_job(void *arg, size_t i)
+{
+    build_job_t *job = &((build_job_t *) arg)[i];
+    const build_args_t *args = job->args;
+    bfi_params_t params = args->params;
+    bfi_index_ptr_t index = NULL;
+    bfi_store_opts_t opts;
+    double start = now();
+
+    // Output file name could not be made
+    if (job->ret != BFI_E_OK || job->filename == NULL) {
+        return;
+    }
+
+    job->block = (char *) malloc(BUILD_BLOCK_SIZE);
+    job->segments = (build_segment_t *) calloc(job->threads,
+                                               sizeof(build_segment_t));
+    if (!job->block || !job->segments) {
+        job->ret = BFI_E_MEM;
+        goto cleanup;
+    }
+
+    // Filter is sized by the count of items of inputs
+    if (params.est_item_cnt == 0) {
+        params.est_item_cnt = count_items(args, job->first, job->end,
+                                          job->block);
+        if (params.est_item_cnt == 0) {
+            params.est_item_cnt = 1;
+        }
+    }
+    job->ret = bfi_init_index_params(&index, &params);
+
+    for (size_t in = job->first; in < job->end && job->ret == BFI_E_OK;
+            ++in) {
+        job->ret = build_input(job, index, args->inputs[in]);
+        if (job->ret != BFI_E_OK) {
+            fprintf(stderr, "%s: %s\n", args->inputs[in],
+                    bfi_get_error_msg(job->ret));
+        }
+    }
+
+    if (job->ret == BFI_E_OK) {
+        bfi_store_opts_init(&opts);
+        opts.encoding = args->compressed ? BFI_STORE_COMPRESSED
+                                         : BFI_STORE_RAW;
+        opts.checksum = args->checksum;
+        opts.catalog = args->catalog;
+        job->ret = bfi_store_index_opts(index, job->filename, &opts);
+    }
+    job->seconds = now() - start;
+
+cleanup:
+    bfi_destroy_index(&index);
+    if (job->segments) {
+        for (unsigned int s = 0; s < job->threads; ++s) {
+            free(job->segments[s].keys[0]);
+            free(job->segments[s].keys[1]);
+        }
+    }
+    free(job->segments);
+    free(job->block);
+}
+
+
+static void report(const char *name, uint64_t keys, uint64_t invalid,
+                    uint64_t bytes, double seconds)
+{
+    if (seconds <= 0.0) {
+        seconds = 1e-9;
+    }
+    fprintf(stderr, "%s: %" PRIu64 " addresses (%" PRIu64 " invalid), "
+            "%.1f MB in %.2f s (%.2f M addresses/s, %.1f MB/s)\n", name,
+            keys, invalid, bytes / 1e6, seconds, keys / seconds / 1e6,
+            bytes / seconds / 1e6);
+}
+
+
+int main(int argc, char **argv)
+{
+    static char *stdin_input[] = {"-"};
+    build_args_t args;
+    build_job_t *jobs;
+    size_t job_cnt;
+    unsigned int concurrent;
+    uint64_t keys = 0;
+    uint64_t invalid = 0;
+    uint64_t bytes = 0;
+    double start;
+    int failed = 0;
+    int opt;
+
+    memset(&args, 0, sizeof(args));
+    args.threads = tool_cpu_cnt();
+    bfi_params_init(&args.params);
+    args.params.est_item_cnt = 0;
+    args.params.fp_prob = 0.01;
+    while ((opt = getopt(argc, argv, "o:d:f:e:n:p:ckC:t:h")) != -1) {
+        switch (opt) {
+        case 'o':
+            args.output = optarg;
+            break;
+        case 'd':
+            args.dir = optarg;
+            break;
+        case 'f':
+            if (strcmp(optarg, "text") == 0) {
+                args.format = BUILD_TEXT;
+            } else if (strcmp(optarg, "raw4") == 0) {
+                args.format = BUILD_RAW4;
+            } else if (strcmp(optarg, "raw16") == 0) {
+                args.format = BUILD_RAW16;
+            } else {
+                fprintf(stderr, "Unknown format: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'e':
+            if (strcmp(optarg, "standard") == 0) {
+                args.params.engine = BFI_ENGINE_STANDARD;
+            } else if (strcmp(optarg, "stable") == 0) {
+                args.params.engine = BFI_ENGINE_STABLE;
+            } else if (strcmp(optarg, "quotient") == 0) {
+                args.params.engine = BFI_ENGINE_QUOTIENT;
+            } else if (strcmp(optarg, "register") == 0) {
+                args.params.engine = BFI_ENGINE_REGISTER;
+            } else {
+                fprintf(stderr, "Unsupported engine: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'n':
+            args.params.est_item_cnt = strtoull(optarg, NULL, 10);
+            break;
+        case 'p':
+            args.params.fp_prob = strtod(optarg, NULL);
+            break;
+        case 'c':
+            args.compressed = true;
+            break;
+        case 'k':
+            args.checksum = true;
+            break;
+        case 'C':
+            args.catalog = optarg;
+            break;
+        case 't':
+            args.threads = (unsigned int) strtoul(optarg, NULL, 10);
+            if (args.threads == 0) {
+                args.threads = 1;
+            }
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    args.inputs = argv + optind;
+    args.input_cnt = argc - optind;
+    if (args.input_cnt == 0) {
+        args.inputs = stdin_input;
+        args.input_cnt = 1;
+    }
+    if (!args.output == !args.dir) {
+        fprintf(stderr, "Either output index (-o) or directory (-d) is "
+                "required\n");
+        return 1;
+    }
+    for (size_t i = 0; i < args.input_cnt; ++i) {
+        if (is_stdin(args.inputs[i]) && (args.params.est_item_cnt == 0
+                || args.dir)) {
+            fprintf(stderr, "Standard input requires -o and -n\n");
+            return 1;
+        }
+    }
+
+    // One job of all inputs or a job per input
+    job_cnt = args.output ? 1 : args.input_cnt;
+    jobs = (build_job_t *) calloc(job_cnt, sizeof(*jobs));
+    if (!jobs) {
+        fprintf(stderr, "%s\n", bfi_get_error_msg(BFI_E_MEM));
+        return 1;
+    }
+    concurrent = args.threads < job_cnt ? args.threads
+                                        : (unsigned int) job_cnt;
+    bfi_set_io_threads(args.threads / concurrent);
+    for (size_t j = 0; j < job_cnt; ++j) {
+        jobs[j].args = &args;
+        jobs[j].threads = args.threads / concurrent;
+        if (args.output) {
+            jobs[j].first = 0;
+            jobs[j].end = args.input_cnt;
+            jobs[j].filename = strdup(args.output);
+        } else {
+            char *copy = strdup(args.inputs[j]);
+
+            jobs[j].first = j;
+            jobs[j].end = j + 1;
+            if (!copy || asprintf(&jobs[j].filename, "%s/%s.bfi", args.dir,
+                                  basename(copy)) < 0) {
+                jobs[j].filename = NULL;
+            }
+            free(copy);
+        }
+        if (!jobs[j].filename) {
+            jobs[j].ret = BFI_E_MEM;
+        }
+    }
+
+    // Inputs are built concurrently, blocks of an input by several threads
+    start = now();
+    tool_pool_run(job_cnt, concurrent, build_job, jobs);
+
+    for (size_t j = 0; j < job_cnt; ++j) {
+        if (jobs[j].ret != BFI_E_OK) {
+            fprintf(stderr, "%s: %s\n", jobs[j].filename ? jobs[j].filename
+                                                         : args.inputs[j],
+                    bfi_get_error_msg(jobs[j].ret));
+            failed = 1;
+        } else {
+            report(jobs[j].filename, jobs[j].keys, jobs[j].invalid,
+                   jobs[j].bytes, jobs[j].seconds);
+        }
+        keys += jobs[j].keys;
+        invalid += jobs[j].invalid;
+        bytes += jobs[j].bytes;
+        free(jobs[j].filename);
+    }
+    if (job_cnt > 1) {
+        report("total", keys, invalid, bytes, now() - start);
+    }
+    free(jobs);
+
+    return failed;
+}
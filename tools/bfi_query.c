@@ -0,0 +1,617 @@
+/**
+ * \file bfi_query.c
+ * \brief Bulk queries of addresses over Bloom filter indexes
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE     // asprintf()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "bf_index.h"
+#include "tool_addr.h"
+#include "tool_pool.h"
+
+#define QUERY_INDEX_SUFFIX ".bfi"
+
+typedef enum {
+    QUERY_BY_FILE,              // Candidate addresses of every file
+    QUERY_BY_KEY,               // Candidate files of every address
+} query_mode_t;
+
+// Keys of one length (IPv4 or IPv6)
+typedef struct {
+    unsigned char *keys;
+    uint64_t cnt;
+    uint64_t max;
+    uint64_t first_id;          // Id of the first key (ids of all keys)
+} query_keys_t;
+
+// Index file to be queried
+typedef struct {
+    char *path;
+    bfi_catalog_ptr_t catalog;  // Catalog of the file (or NULL)
+    uint64_t entry;             // Entry of the file in the catalog
+    uint64_t *hits;             // Bitmap of candidate keys (by key ids)
+    uint64_t hit_cnt;
+    bool pruned;                // No key passed the catalog
+    bfi_ecode_t ret;
+} query_file_t;
+
+// Index of a queried file (loaded or opened as a cold index)
+typedef struct {
+    bool cold;
+    bfi_index_ptr_t index;
+    bfi_cold_index_ptr_t cold_index;
+} query_index_t;
+
+typedef struct {
+    unsigned int threads;       // Count of threads (-t)
+    bool cold;                  // Probes are read from files (-c)
+    query_mode_t mode;          // Output mode (-m)
+    char *key_file;             // File of addresses (-k)
+    bool time_range;            // Time range of data is given (-T)
+    uint64_t time_begin;
+    uint64_t time_end;
+    query_keys_t keys[2];       // IPv4 and IPv6 keys
+    uint64_t key_cnt;
+    query_file_t *files;
+    size_t file_cnt;
+    size_t file_max;
+    bfi_catalog_ptr_t *catalogs;
+    size_t catalog_cnt;
+} query_t;
+
+static const size_t query_key_len[2] = {TOOL_IPV4_LEN, TOOL_IPV6_LEN};
+
+
+static void usage(const char *name)
+{
+    printf("Usage: %s -k KEYS [OPTIONS] TARGET...\n"
+           "Finds index files which may contain addresses of a list. Target\n"
+           "is an index file, a directory of index files (*.bfi) or a\n"
+           "catalog (its entries are pruned by zone maps, summaries and time).\n"
+           "Options:\n"
+           "  -k KEYS     file of addresses, one per line (\"-\" for standard\n"
+           "              input)\n"
+           "  -m MODE     output: files (candidate addresses of every file,\n"
+           "              default) or keys (candidate files of every address)\n"
+           "  -T FIRST-LAST  time range of data (catalog entries only, entries\n"
+           "              without a time range are always queried)\n"
+           "  -c          read only probed parts of index files instead of\n"
+           "              loading them (huge indexes on slow storage)\n"
+           "  -t THREADS  count of threads (count of processors)\n",
+           name);
+}
+
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+static bool add_key(query_keys_t *keys, size_t len, const unsigned char *key)
+{
+    if (keys->cnt == keys->max) {
+        uint64_t max = keys->max ? 2 * keys->max : 1024;
+        unsigned char *tmp = (unsigned char *) realloc(keys->keys, max * len);
+
+        if (!tmp) {
+            return false;
+        }
+        keys->keys = tmp;
+        keys->max = max;
+    }
+    memcpy(keys->keys + keys->cnt++ * len, key, len);
+
+    return true;
+}
+
+
+/**
+ * \brief Read addresses of the key file (IPv4 keys get the lowest ids)
+ */
+static int read_keys(query_t *query)
+{
+    FILE *in = strcmp(query->key_file, "-") == 0 ? stdin
+                                                 : fopen(query->key_file, "r");
+    char *line = NULL;
+    size_t line_max = 0;
+    ssize_t len;
+    uint64_t invalid = 0;
+
+    if (!in) {
+        perror(query->key_file);
+        return 1;
+    }
+    while ((len = getline(&line, &line_max, in)) >= 0) {
+        unsigned char key[TOOL_IPV6_LEN];
+        int key_len = tool_parse_addr(line, line + len - (len > 0
+                                      && line[len - 1] == '\n'), key);
+
+        if (key_len < 0) {
+            invalid++;
+        } else if (key_len > 0 && !add_key(&query->keys[key_len
+                   == TOOL_IPV6_LEN], key_len, key)) {
+            fprintf(stderr, "%s\n", bfi_get_error_msg(BFI_E_MEM));
+            free(line);
+            return 1;
+        }
+    }
+    free(line);
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (invalid) {
+        fprintf(stderr, "%s: %" PRIu64 " lines are not addresses\n",
+                query->key_file, invalid);
+    }
+
+    query->keys[1].first_id = query->keys[0].cnt;
+    query->key_cnt = query->keys[0].cnt + query->keys[1].cnt;
+
+    return 0;
+}
+
+
+static bool add_file(query_t *query, char *path, bfi_catalog_ptr_t catalog,
+                    uint64_t entry)
+{
+    if (!path) {
+        return false;
+    }
+    if (query->file_cnt == query->file_max) {
+        size_t max = query->file_max ? 2 * query->file_max : 256;
+        query_file_t *tmp = (query_file_t *) realloc(query->files,
+                                                     max * sizeof(*tmp));
+
+        if (!tmp) {
+            free(path);
+            return false;
+        }
+        query->files = tmp;
+        query->file_max = max;
+    }
+    memset(&query->files[query->file_cnt], 0, sizeof(query_file_t));
+    query->files[query->file_cnt].path = path;
+    query->files[query->file_cnt].catalog = catalog;
+    query->files[query->file_cnt].entry = entry;
+    query->file_cnt++;
+
+    return true;
+}
+
+
+static int path_cmp(const void *a, const void *b)
+{
+    return strcmp(((const query_file_t *) a)->path,
+                  ((const query_file_t *) b)->path);
+}
+
+
+/**
+ * \brief Add index files of a directory (sorted by name)
+ */
+static bool add_dir(query_t *query, const char *dir)
+{
+    size_t suffix_len = strlen(QUERY_INDEX_SUFFIX);
+    size_t first = query->file_cnt;
+    struct dirent *ent;
+    DIR *dir_ptr = opendir(dir);
+
+    if (!dir_ptr) {
+        perror(dir);
+        return false;
+    }
+    while ((ent = readdir(dir_ptr))) {
+        size_t len = strlen(ent->d_name);
+        char *path;
+
+        if (len <= suffix_len || strcmp(ent->d_name + len - suffix_len,
+                                        QUERY_INDEX_SUFFIX) != 0) {
+            continue;
+        }
+        if (asprintf(&path, "%s/%s", dir, ent->d_name) < 0
+                || !add_file(query, path, NULL, 0)) {
+            closedir(dir_ptr);
+            return false;
+        }
+    }
+    closedir(dir_ptr);
+    qsort(query->files + first, query->file_cnt - first, sizeof(query_file_t),
+          path_cmp);
+
+    return true;
+}
+
+
+/**
+ * \brief Add entries [first, end) of a catalog overlapping the time range
+ */
+static bool add_catalog_entries(query_t *query, bfi_catalog_ptr_t catalog,
+                    uint64_t first, uint64_t end)
+{
+    bool ok = true;
+
+    for (uint64_t i = first; i < end && ok; ++i) {
+        bfi_catalog_entry_t entry;
+        char *path;
+
+        if (bfi_catalog_get(catalog, i, &entry) != BFI_E_OK) {
+            continue;
+        }
+        if (query->time_range && entry.stat.time_last != 0
+                && (entry.stat.time_first > query->time_end
+                    || entry.stat.time_last < query->time_begin)) {
+            continue;
+        }
+        path = bfi_catalog_entry_path(catalog, &entry);
+        ok = path != NULL && add_file(query, path, catalog, i);
+    }
+
+    return ok;
+}
+
+
+/**
+ * \brief Add entries of a catalog (in the time range if given)
+ *
+ * Entries of indexes stored without a time range are always added, the time
+ * of their data is unknown.
+ */
+static bool add_catalog(query_t *query, bfi_catalog_ptr_t catalog)
+{
+    bfi_catalog_ptr_t *catalogs;
+    uint64_t unknown_cnt = bfi_catalog_unknown_time_cnt(catalog);
+    uint64_t first = 0;
+    uint64_t end = bfi_catalog_entry_cnt(catalog);
+
+    catalogs = (bfi_catalog_ptr_t *) realloc(query->catalogs,
+                                (query->catalog_cnt + 1) * sizeof(*catalogs));
+    if (!catalogs) {
+        bfi_catalog_close(&catalog);
+        return false;
+    }
+    query->catalogs = catalogs;
+    query->catalogs[query->catalog_cnt++] = catalog;
+
+    if (!query->time_range) {
+        return add_catalog_entries(query, catalog, first, end);
+    }
+    bfi_catalog_find_time(catalog, query->time_begin, query->time_end,
+                          &first, &end);
+
+    return add_catalog_entries(query, catalog, 0, unknown_cnt)
+           && add_catalog_entries(query, catalog, first, end);
+}
+
+
+static bool add_target(query_t *query, char *target)
+{
+    bfi_catalog_ptr_t catalog;
+    struct stat st;
+
+    if (stat(target, &st) != 0) {
+        perror(target);
+        return false;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        return add_dir(query, target);
+    }
+    if (bfi_catalog_open(&catalog, target) == BFI_E_OK) {
+        return add_catalog(query, catalog);
+    }
+
+    return add_file(query, strdup(target), NULL, 0);
+}
+
+
+/**
+ * \brief Query keys of one length in an index
+ *
+ * Keys rejected by the catalog (zone map and summary of the entry) are not
+ * looked up, the index is not loaded (or opened) if no key passes.
+ */
+static bfi_ecode_t query_keys(query_file_t *file, query_index_t *index,
+                    const query_keys_t *keys, size_t len)
+{
+    bfi_catalog_entry_t entry;
+    bfi_summary_ptr_t summary = NULL;
+    unsigned char *cand = NULL;
+    uint64_t *cand_ids = NULL;
+    uint64_t cand_cnt = 0;
+    bool *stored = NULL;
+    bfi_ecode_t ret = BFI_E_OK;
+
+    if (keys->cnt == 0) {
+        return BFI_E_OK;
+    }
+    cand = (unsigned char *) malloc(keys->cnt * len);
+    cand_ids = (uint64_t *) malloc(keys->cnt * sizeof(uint64_t));
+    stored = (bool *) malloc(keys->cnt * sizeof(bool));
+    if (!cand || !cand_ids || !stored) {
+        ret = BFI_E_MEM;
+        goto cleanup;
+    }
+
+    if (file->catalog) {
+        ret = bfi_catalog_get(file->catalog, file->entry, &entry);
+        if (ret != BFI_E_OK) {
+            goto cleanup;
+        }
+        if (entry.has_summary) {
+            bfi_catalog_load_summary(file->catalog, file->entry, &summary);
+        }
+    }
+    for (uint64_t k = 0; k < keys->cnt; ++k) {
+        const unsigned char *key = keys->keys + k * len;
+
+        if (file->catalog && (!bfi_zone_may_contain(&entry.stat.zone, key,
+                                                    len)
+                || !bfi_summary_may_contain(summary, key, len))) {
+            continue;
+        }
+        memcpy(cand + cand_cnt * len, key, len);
+        cand_ids[cand_cnt++] = keys->first_id + k;
+    }
+    if (cand_cnt == 0) {
+        goto cleanup;
+    }
+
+    if (index->cold) {
+        if (!index->cold_index) {
+            ret = bfi_open_cold_index(&index->cold_index, file->path, false,
+                                      0);
+            if (ret != BFI_E_OK) {
+                goto cleanup;
+            }
+        }
+        ret = bfi_cold_addr_is_stored_batch(index->cold_index, cand, len,
+                                            cand_cnt, stored);
+    } else {
+        if (!index->index) {
+            ret = bfi_load_index(&index->index, file->path);
+            if (ret != BFI_E_OK) {
+                goto cleanup;
+            }
+        }
+        ret = bfi_addr_is_stored_batch(index->index, cand, len, cand_cnt,
+                                       stored);
+    }
+    for (uint64_t c = 0; c < cand_cnt && ret == BFI_E_OK; ++c) {
+        if (stored[c]) {
+            file->hits[cand_ids[c] / 64] |= 1ULL << (cand_ids[c] % 64);
+            file->hit_cnt++;
+        }
+    }
+
+cleanup:
+    bfi_destroy_summary(&summary);
+    free(cand);
+    free(cand_ids);
+    free(stored);
+
+    return ret;
+}
+
+
+static void query_job(void *arg, size_t i)
+{
+    query_t *query = (query_t *) arg;
+    query_file_t *file = &query->files[i];
+    query_index_t index = {query->cold, NULL, NULL};
+
+    file->hits = (uint64_t *) calloc((query->key_cnt + 63) / 64,
+                                     sizeof(uint64_t));
+    if (!file->hits) {
+        file->ret = BFI_E_MEM;
+        return;
+    }
+    for (int family = 0; family < 2 && file->ret == BFI_E_OK; ++family) {
+        file->ret = query_keys(file, &index, &query->keys[family],
+                               query_key_len[family]);
+    }
+    file->pruned = !index.index && !index.cold_index
+                   && file->ret == BFI_E_OK;
+    bfi_destroy_index(&index.index);
+    bfi_close_cold_index(&index.cold_index);
+}
+
+
+static void key_text(const query_t *query, uint64_t id, char *text)
+{
+    int family = id >= query->keys[1].first_id;
+    const query_keys_t *keys = &query->keys[family];
+
+    tool_format_addr(keys->keys + (id - keys->first_id)
+                     * query_key_len[family], query_key_len[family], text);
+}
+
+
+static void print_results(const query_t *query)
+{
+    char text[TOOL_ADDR_TEXT_MAX];
+
+    if (query->mode == QUERY_BY_FILE) {
+        for (size_t f = 0; f < query->file_cnt; ++f) {
+            const query_file_t *file = &query->files[f];
+
+            if (file->ret != BFI_E_OK || file->hit_cnt == 0) {
+                continue;
+            }
+            printf("%s:", file->path);
+            for (uint64_t id = 0; id < query->key_cnt; ++id) {
+                if (file->hits[id / 64] & (1ULL << (id % 64))) {
+                    key_text(query, id, text);
+                    printf(" %s", text);
+                }
+            }
+            printf("\n");
+        }
+        return;
+    }
+
+    for (uint64_t id = 0; id < query->key_cnt; ++id) {
+        bool found = false;
+
+        for (size_t f = 0; f < query->file_cnt; ++f) {
+            const query_file_t *file = &query->files[f];
+
+            if (file->ret != BFI_E_OK
+                    || !(file->hits[id / 64] & (1ULL << (id % 64)))) {
+                continue;
+            }
+            if (!found) {
+                key_text(query, id, text);
+                printf("%s:", text);
+                found = true;
+            }
+            printf(" %s", file->path);
+        }
+        if (found) {
+            printf("\n");
+        }
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    query_t query;
+    unsigned int concurrent;
+    size_t pruned = 0;
+    double start;
+    int failed = 0;
+    int opt;
+
+    memset(&query, 0, sizeof(query));
+    query.threads = tool_cpu_cnt();
+    while ((opt = getopt(argc, argv, "k:m:T:t:ch")) != -1) {
+        switch (opt) {
+        case 'k':
+            query.key_file = optarg;
+            break;
+        case 'm':
+            if (strcmp(optarg, "files") == 0) {
+                query.mode = QUERY_BY_FILE;
+            } else if (strcmp(optarg, "keys") == 0) {
+                query.mode = QUERY_BY_KEY;
+            } else {
+                fprintf(stderr, "Unknown mode: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'T':
+            if (sscanf(optarg, "%" SCNu64 "-%" SCNu64, &query.time_begin,
+                       &query.time_end) != 2) {
+                fprintf(stderr, "Invalid time range: %s\n", optarg);
+                return 1;
+            }
+            query.time_range = true;
+            break;
+        case 't':
+            query.threads = (unsigned int) strtoul(optarg, NULL, 10);
+            if (query.threads == 0) {
+                query.threads = 1;
+            }
+            break;
+        case 'c':
+            query.cold = true;
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!query.key_file || optind == argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (read_keys(&query) != 0) {
+        return 1;
+    }
+    for (int i = optind; i < argc && !failed; ++i) {
+        failed = !add_target(&query, argv[i]);
+    }
+
+    // Files are queried concurrently, threads left over load parts of files
+    start = now();
+    if (!failed && query.file_cnt > 0) {
+        concurrent = query.threads < query.file_cnt ? query.threads
+                                            : (unsigned int) query.file_cnt;
+        bfi_set_io_threads(query.threads / concurrent);
+        tool_pool_run(query.file_cnt, concurrent, query_job, &query);
+        print_results(&query);
+    }
+
+    for (size_t f = 0; f < query.file_cnt; ++f) {
+        if (query.files[f].ret != BFI_E_OK) {
+            fprintf(stderr, "%s: %s\n", query.files[f].path,
+                    bfi_get_error_msg(query.files[f].ret));
+            failed = 1;
+        }
+        pruned += query.files[f].pruned;
+        free(query.files[f].path);
+        free(query.files[f].hits);
+    }
+    fprintf(stderr, "%" PRIu64 " addresses, %zu files (%zu not loaded), "
+            "%.2f s\n", query.key_cnt, query.file_cnt, pruned, now() - start);
+    for (size_t c = 0; c < query.catalog_cnt; ++c) {
+        bfi_catalog_close(&query.catalogs[c]);
+    }
+    free(query.catalogs);
+    free(query.files);
+    free(query.keys[0].keys);
+    free(query.keys[1].keys);
+
+    return failed;
+}
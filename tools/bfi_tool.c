@@ -0,0 +1,783 @@
+/**
+ * \file bfi_tool.c
+ * \brief Administrative tool of Bloom filter index files
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE     // asprintf()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <arpa/inet.h>
+
+#include "bf_index.h"
+#include "tool_addr.h"
+#include "tool_pool.h"
+
+#define TOOL_FOLD_DEFAULT 64
+#define TOOL_FP_PROB_DEFAULT 0.01
+
+typedef struct {
+    unsigned int threads;       // Count of threads (-t)
+    char *output;               // Output file or directory (-o)
+    bool compressed;            // Compressed encoding (-c)
+    bool checksum;              // Checksums of parts (-k)
+    bool version1;              // Original file format (-1)
+    uint32_t fold;              // Fold factor of summaries (-f)
+    uint64_t est_item_cnt;      // Estimated count of items (-n)
+    double fp_prob;             // False positive probability (-p)
+    uint64_t memory_cap;        // Memory cap of filters in bytes (-M)
+    bfi_engine_t engine;        // Engine of tuned indexes (-e)
+    char **files;
+    size_t file_cnt;
+} tool_args_t;
+
+// Result of a job of one file
+typedef struct {
+    bfi_ecode_t ret;
+    bfi_stat_t stat;
+    bfi_index_ptr_t index;
+} tool_result_t;
+
+typedef struct {
+    const tool_args_t *args;
+    tool_result_t *results;
+} tool_ctx_t;
+
+
+static void usage(const char *name)
+{
+    printf("Usage: %s COMMAND [OPTIONS] FILE...\n"
+           "Commands:\n"
+           "  stat FILE...          print parameters and statistics of indexes\n"
+           "  verify FILE...        load indexes and verify their checksums\n"
+           "  merge -o OUT FILE...  store union of indexes of one family\n"
+           "  convert FILE...       store indexes again by given options\n"
+           "  fold FILE...          store indexes with folded summaries\n"
+           "  similarity FILE...    estimate Jaccard index of every pair\n"
+           "  catalog CATALOG       rebuild catalog of a directory\n"
+           "  tune -n COUNT KEYS    recommend parameters of indexes by\n"
+           "                        benchmarks on a sample of addresses\n"
+           "Options:\n"
+           "  -t THREADS  count of threads (count of processors)\n"
+           "  -o PATH     output file (merge) or directory (convert, fold),\n"
+           "              files are replaced in place by default\n"
+           "  -c          compressed encoding\n"
+           "  -k          checksums of parts of filters\n"
+           "  -1          original (version 1) file format\n"
+           "  -f FACTOR   maximal fold factor of summaries (fold: %d),\n"
+           "              summaries of inputs are kept by default\n"
+           "  -n COUNT    estimated count of items of an index (tune)\n"
+           "  -p PROB     false positive probability (tune, default %g)\n"
+           "  -M MB       memory cap of a filter (tune)\n"
+           "  -e ENGINE   engine of indexes: standard (default) or register\n"
+           "              (tune)\n",
+           name, TOOL_FOLD_DEFAULT, TOOL_FP_PROB_DEFAULT);
+}
+
+
+static const char *engine_name(bfi_engine_t engine)
+{
+    switch (engine) {
+    case BFI_ENGINE_STANDARD:
+        return "standard";
+    case BFI_ENGINE_STABLE:
+        return "stable";
+    case BFI_ENGINE_TEMPORAL:
+        return "temporal";
+    case BFI_ENGINE_QUOTIENT:
+        return "quotient";
+    case BFI_ENGINE_REGISTER:
+        return "register";
+    default:
+        return "unknown";
+    }
+}
+
+
+/**
+ * \brief Split threads among files processed at once
+ *
+ * Files are processed by the pool, the rest of threads is used by the
+ * library to load and store parts of every file.
+ */
+static unsigned int file_threads(const tool_args_t *args)
+{
+    unsigned int threads = args->threads;
+
+    if (args->file_cnt < threads) {
+        bfi_set_io_threads(threads / (unsigned int) args->file_cnt);
+        threads = (unsigned int) args->file_cnt;
+    } else {
+        bfi_set_io_threads(1);
+    }
+
+    return threads;
+}
+
+
+/**
+ * \brief Store options of the tool
+ *
+ * Time range and summary (unless -f is given) of the input file are kept.
+ */
+static void store_opts(const tool_args_t *args, const bfi_stat_t *stat,
+                    bfi_store_opts_t *opts)
+{
+    bfi_store_opts_init(opts);
+    if (args->version1) {
+        opts->zone_map = false;
+        return;
+    }
+    opts->encoding = args->compressed ? BFI_STORE_COMPRESSED : BFI_STORE_RAW;
+    opts->checksum = args->checksum;
+    opts->summary_fold = args->fold ? args->fold : stat->summary_fold;
+    opts->time_first = stat->time_first;
+    opts->time_last = stat->time_last;
+}
+
+
+/**
+ * \brief Add statistics of an input file to statistics of a merged index
+ *
+ * Time range is the union of time ranges of inputs (unknown if any of them
+ * is unknown), summary is folded by the largest factor of inputs.
+ */
+static void merge_stat(bfi_stat_t *merged, const bfi_stat_t *stat)
+{
+    if ((merged->time_first == 0 && merged->time_last == 0)
+            || (stat->time_first == 0 && stat->time_last == 0)) {
+        merged->time_first = 0;
+        merged->time_last = 0;
+    } else {
+        if (stat->time_first < merged->time_first) {
+            merged->time_first = stat->time_first;
+        }
+        if (stat->time_last > merged->time_last) {
+            merged->time_last = stat->time_last;
+        }
+    }
+    if (stat->summary_fold > merged->summary_fold) {
+        merged->summary_fold = stat->summary_fold;
+    }
+}
+
+
+/**
+ * \brief Print error of a file
+ */
+static void file_error(const char *filename, bfi_ecode_t ret)
+{
+    fprintf(stderr, "%s: %s\n", filename, bfi_get_error_msg(ret));
+}
+
+
+static void stat_job(void *arg, size_t i)
+{
+    tool_ctx_t *ctx = (tool_ctx_t *) arg;
+
+    ctx->results[i].ret = bfi_stat_index(ctx->args->files[i],
+                                         &ctx->results[i].stat);
+}
+
+
+static int cmd_stat(const tool_args_t *args, tool_result_t *results)
+{
+    tool_ctx_t ctx = {args, results};
+    int failed = 0;
+
+    tool_pool_run(args->file_cnt, file_threads(args), stat_job, &ctx);
+
+    for (size_t i = 0; i < args->file_cnt; ++i) {
+        const bfi_stat_t *st = &results[i].stat;
+        struct in_addr ipv4;
+
+        if (results[i].ret != BFI_E_OK) {
+            file_error(args->files[i], results[i].ret);
+            failed = 1;
+            continue;
+        }
+        printf("%s:\n", args->files[i]);
+        printf("  engine:      %s\n", engine_name(st->family.engine));
+        printf("  table size:  %" PRIu64 " %s\n", st->family.table_size,
+               st->family.engine == BFI_ENGINE_QUOTIENT ? "slots" : "bits");
+        printf("  hashes:      %" PRIu32 "\n", st->family.hash_cnt);
+        printf("  seed:        %" PRIu64 "\n", st->family.seed);
+        printf("  items:       %" PRIu64 " (estimated %" PRIu64 ")\n",
+               st->item_cnt, st->family.est_item_cnt);
+        printf("  fill ratio:  %.4f\n", st->fill_ratio);
+        printf("  time range:  %" PRIu64 " - %" PRIu64 "\n", st->time_first,
+               st->time_last);
+        printf("  file size:   %" PRIu64 "\n", st->file_size);
+        printf("  checksum:    0x%08" PRIx32 "\n", st->checksum);
+        if (st->summary_fold) {
+            printf("  summary:     1/%" PRIu32 "\n", st->summary_fold);
+        }
+        if (st->zone.valid && st->zone.ipv4_min <= st->zone.ipv4_max) {
+            char low[INET_ADDRSTRLEN];
+            char high[INET_ADDRSTRLEN];
+
+            ipv4.s_addr = htonl(st->zone.ipv4_min);
+            inet_ntop(AF_INET, &ipv4, low, sizeof(low));
+            ipv4.s_addr = htonl(st->zone.ipv4_max);
+            inet_ntop(AF_INET, &ipv4, high, sizeof(high));
+            printf("  IPv4 range:  %s - %s\n", low, high);
+        } else if (!st->zone.valid) {
+            printf("  zone map:    none\n");
+        }
+    }
+
+    return failed;
+}
+
+
+static void verify_job(void *arg, size_t i)
+{
+    tool_ctx_t *ctx = (tool_ctx_t *) arg;
+    bfi_index_ptr_t index;
+
+    // Loading verifies structure of the file and checksums of parts
+    ctx->results[i].ret = bfi_load_index(&index, ctx->args->files[i]);
+    if (ctx->results[i].ret == BFI_E_OK) {
+        bfi_destroy_index(&index);
+    }
+}
+
+
+static int cmd_verify(const tool_args_t *args, tool_result_t *results)
+{
+    tool_ctx_t ctx = {args, results};
+    int failed = 0;
+
+    tool_pool_run(args->file_cnt, file_threads(args), verify_job, &ctx);
+
+    for (size_t i = 0; i < args->file_cnt; ++i) {
+        if (results[i].ret != BFI_E_OK) {
+            file_error(args->files[i], results[i].ret);
+            failed = 1;
+        } else {
+            printf("%s: OK\n", args->files[i]);
+        }
+    }
+
+    return failed;
+}
+
+
+typedef struct {
+    const tool_args_t *args;
+    tool_result_t *results;
+    size_t part_cnt;
+} tool_merge_ctx_t;
+
+
+/**
+ * \brief Merge a part of input files (every part-th file) into one index
+ */
+static void merge_job(void *arg, size_t part)
+{
+    tool_merge_ctx_t *ctx = (tool_merge_ctx_t *) arg;
+    tool_result_t *result = &ctx->results[part];
+    const tool_args_t *args = ctx->args;
+
+    result->ret = bfi_load_index_stat(&result->index, args->files[part],
+                                      &result->stat);
+    if (result->ret != BFI_E_OK) {
+        file_error(args->files[part], result->ret);
+    }
+    for (size_t i = part + ctx->part_cnt;
+            i < args->file_cnt && result->ret == BFI_E_OK;
+            i += ctx->part_cnt) {
+        bfi_index_ptr_t index;
+        bfi_stat_t stat;
+
+        result->ret = bfi_load_index_stat(&index, args->files[i], &stat);
+        if (result->ret == BFI_E_OK) {
+            result->ret = bfi_merge_index(result->index, index);
+            merge_stat(&result->stat, &stat);
+            bfi_destroy_index(&index);
+        }
+        if (result->ret != BFI_E_OK) {
+            file_error(args->files[i], result->ret);
+        }
+    }
+}
+
+
+static int cmd_merge(const tool_args_t *args, tool_result_t *results)
+{
+    tool_merge_ctx_t ctx = {args, results, 0};
+    bfi_store_opts_t opts;
+    bfi_ecode_t ret = BFI_E_OK;
+
+    if (!args->output) {
+        fprintf(stderr, "merge: output file (-o) is required\n");
+        return 1;
+    }
+
+    // Parts are merged by threads of the pool, their results by this thread
+    ctx.part_cnt = file_threads(args);
+    tool_pool_run(ctx.part_cnt, ctx.part_cnt, merge_job, &ctx);
+    for (size_t part = 0; part < ctx.part_cnt; ++part) {
+        if (results[part].ret != BFI_E_OK) {
+            ret = results[part].ret;
+        } else if (part > 0 && ret == BFI_E_OK) {
+            ret = bfi_merge_index(results[0].index, results[part].index);
+            merge_stat(&results[0].stat, &results[part].stat);
+        }
+    }
+
+    if (ret == BFI_E_OK) {
+        store_opts(args, &results[0].stat, &opts);
+        bfi_set_io_threads(args->threads);
+        ret = bfi_store_index_opts(results[0].index, args->output, &opts);
+        if (ret != BFI_E_OK) {
+            file_error(args->output, ret);
+        }
+    }
+    for (size_t part = 0; part < ctx.part_cnt; ++part) {
+        bfi_destroy_index(&results[part].index);
+    }
+
+    return ret != BFI_E_OK;
+}
+
+
+/**
+ * \brief Load an index and store it by options of the tool
+ *
+ * Index is stored to the output directory or replaces the original file
+ * (it is stored to a temporary file which is renamed then).
+ */
+static void convert_job(void *arg, size_t i)
+{
+    tool_ctx_t *ctx = (tool_ctx_t *) arg;
+    const tool_args_t *args = ctx->args;
+    tool_result_t *result = &ctx->results[i];
+    char *filename = args->files[i];
+    char *path = NULL;
+    bfi_store_opts_t opts;
+
+    // Statistics (time range and summary) of the file are kept
+    result->ret = bfi_load_index_stat(&result->index, filename,
+                                      &result->stat);
+    if (result->ret != BFI_E_OK) {
+        return;
+    }
+
+    if (args->output) {
+        char *copy = strdup(filename);
+
+        if (copy && asprintf(&path, "%s/%s", args->output, basename(copy))
+                < 0) {
+            path = NULL;
+        }
+        free(copy);
+    } else if (asprintf(&path, "%s.tmp", filename) < 0) {
+        path = NULL;
+    }
+    if (!path) {
+        result->ret = BFI_E_MEM;
+        goto cleanup;
+    }
+
+    store_opts(args, &result->stat, &opts);
+    result->ret = bfi_store_index_opts(result->index, path, &opts);
+    if (result->ret == BFI_E_OK && !args->output
+            && rename(path, filename) != 0) {
+        result->ret = BFI_E_STO_FILE_ERR;
+    }
+    if (result->ret != BFI_E_OK && !args->output) {
+        unlink(path);
+    }
+
+cleanup:
+    free(path);
+    bfi_destroy_index(&result->index);
+}
+
+
+static int cmd_convert(const tool_args_t *args, tool_result_t *results)
+{
+    tool_ctx_t ctx = {args, results};
+    int failed = 0;
+
+    tool_pool_run(args->file_cnt, file_threads(args), convert_job, &ctx);
+
+    for (size_t i = 0; i < args->file_cnt; ++i) {
+        if (results[i].ret != BFI_E_OK) {
+            file_error(args->files[i], results[i].ret);
+            failed = 1;
+        }
+    }
+
+    return failed;
+}
+
+
+typedef struct {
+    const tool_args_t *args;
+    tool_result_t *results;
+    double *jaccard;
+    bfi_ecode_t *pair_ret;
+} tool_similarity_ctx_t;
+
+
+static void load_job(void *arg, size_t i)
+{
+    tool_similarity_ctx_t *ctx = (tool_similarity_ctx_t *) arg;
+
+    ctx->results[i].ret = bfi_load_index(&ctx->results[i].index,
+                                         ctx->args->files[i]);
+}
+
+
+/**
+ * \brief Similarity of the pair i (pairs a < b are numbered row by row)
+ */
+static void similarity_job(void *arg, size_t i)
+{
+    tool_similarity_ctx_t *ctx = (tool_similarity_ctx_t *) arg;
+    size_t n = ctx->args->file_cnt;
+    size_t a = 0;
+    size_t b;
+    size_t row = n - 1;
+
+    for (b = i; b >= row; b -= row--) {
+        ++a;
+    }
+    b += a + 1;
+
+    if (ctx->results[a].ret != BFI_E_OK || ctx->results[b].ret != BFI_E_OK) {
+        ctx->pair_ret[i] = BFI_E_NO_INDEX;
+        return;
+    }
+    ctx->pair_ret[i] = bfi_index_similarity(ctx->results[a].index,
+                                            ctx->results[b].index,
+                                            &ctx->jaccard[i]);
+}
+
+
+static int cmd_similarity(const tool_args_t *args, tool_result_t *results)
+{
+    size_t pair_cnt = args->file_cnt * (args->file_cnt - 1) / 2;
+    tool_similarity_ctx_t ctx = {args, results, NULL, NULL};
+    int failed = 0;
+    size_t i = 0;
+
+    if (pair_cnt == 0) {
+        fprintf(stderr, "similarity: at least two files are required\n");
+        return 1;
+    }
+    ctx.jaccard = (double *) calloc(pair_cnt, sizeof(double));
+    ctx.pair_ret = (bfi_ecode_t *) calloc(pair_cnt, sizeof(bfi_ecode_t));
+    if (!ctx.jaccard || !ctx.pair_ret) {
+        fprintf(stderr, "%s\n", bfi_get_error_msg(BFI_E_MEM));
+        failed = 1;
+        goto cleanup;
+    }
+
+    tool_pool_run(args->file_cnt, file_threads(args), load_job, &ctx);
+    for (size_t a = 0; a < args->file_cnt; ++a) {
+        if (results[a].ret != BFI_E_OK) {
+            file_error(args->files[a], results[a].ret);
+            failed = 1;
+        }
+    }
+    tool_pool_run(pair_cnt, args->threads, similarity_job, &ctx);
+
+    for (size_t a = 0; a < args->file_cnt; ++a) {
+        for (size_t b = a + 1; b < args->file_cnt; ++b, ++i) {
+            if (ctx.pair_ret[i] == BFI_E_OK) {
+                printf("%s %s %.4f\n", args->files[a], args->files[b],
+                       ctx.jaccard[i]);
+            } else if (ctx.pair_ret[i] != BFI_E_NO_INDEX) {
+                fprintf(stderr, "%s %s: %s\n", args->files[a],
+                        args->files[b], bfi_get_error_msg(ctx.pair_ret[i]));
+                failed = 1;
+            }
+        }
+    }
+
+cleanup:
+    for (size_t a = 0; a < args->file_cnt; ++a) {
+        bfi_destroy_index(&results[a].index);
+    }
+    free(ctx.jaccard);
+    free(ctx.pair_ret);
+
+    return failed;
+}
+
+
+static int cmd_catalog(const tool_args_t *args)
+{
+    int failed = 0;
+
+    for (size_t i = 0; i < args->file_cnt; ++i) {
+        uint64_t entry_cnt;
+        bfi_ecode_t ret = bfi_catalog_rebuild(args->files[i], &entry_cnt);
+
+        if (ret != BFI_E_OK) {
+            file_error(args->files[i], ret);
+            failed = 1;
+        } else {
+            printf("%s: %" PRIu64 " indexes\n", args->files[i], entry_cnt);
+        }
+    }
+
+    return failed;
+}
+
+
+/**
+ * \brief Read addresses of a file (keys of the more frequent length)
+ */
+static unsigned char *read_sample(const char *filename, size_t *key_len,
+                    uint64_t *key_cnt)
+{
+    unsigned char *keys[2] = {NULL, NULL};
+    uint64_t cnt[2] = {0, 0};
+    uint64_t max[2] = {0, 0};
+    const size_t len[2] = {TOOL_IPV4_LEN, TOOL_IPV6_LEN};
+    FILE *in = fopen(filename, "r");
+    char *line = NULL;
+    size_t line_max = 0;
+    ssize_t line_len;
+    int family;
+
+    if (!in) {
+        return NULL;
+    }
+    while ((line_len = getline(&line, &line_max, in)) >= 0) {
+        unsigned char key[TOOL_IPV6_LEN];
+        int key_len = tool_parse_addr(line, line + line_len - (line_len > 0
+                                      && line[line_len - 1] == '\n'), key);
+
+        if (key_len <= 0) {
+            continue;
+        }
+        family = key_len == TOOL_IPV6_LEN;
+        if (cnt[family] == max[family]) {
+            unsigned char *tmp;
+
+            max[family] = max[family] ? 2 * max[family] : 4096;
+            tmp = (unsigned char *) realloc(keys[family],
+                                            max[family] * len[family]);
+            if (!tmp) {
+                break;
+            }
+            keys[family] = tmp;
+        }
+        memcpy(keys[family] + cnt[family]++ * len[family], key, key_len);
+    }
+    free(line);
+    fclose(in);
+
+    family = cnt[1] > cnt[0];
+    free(keys[!family]);
+    *key_len = len[family];
+    *key_cnt = cnt[family];
+
+    return keys[family];
+}
+
+
+static int cmd_tune(const tool_args_t *args)
+{
+    bfi_tune_candidate_t cands[BFI_TUNE_CANDIDATE_MAX];
+    uint32_t cand_cnt;
+    bfi_params_t params;
+    unsigned char *keys;
+    size_t key_len;
+    uint64_t key_cnt;
+    bfi_ecode_t ret;
+
+    if (args->est_item_cnt == 0) {
+        fprintf(stderr, "tune: estimated count of items (-n) is required\n");
+        return 1;
+    }
+    keys = read_sample(args->files[0], &key_len, &key_cnt);
+    if (!keys) {
+        perror(args->files[0]);
+        return 1;
+    }
+
+    bfi_params_init(&params);
+    params.engine = args->engine;
+    params.est_item_cnt = args->est_item_cnt;
+    params.fp_prob = args->fp_prob;
+    ret = bfi_autotune(&params, keys, key_len, key_cnt, args->memory_cap,
+                       cands, &cand_cnt);
+    free(keys);
+    if (ret != BFI_E_OK) {
+        file_error(args->files[0], ret);
+        return 1;
+    }
+
+    printf("%" PRIu64 " keys of %zu bytes\n", key_cnt, key_len);
+    printf("  hashes  table size (KB)  fp rate    inserts/s   lookups/s\n");
+    for (uint32_t i = 0; i < cand_cnt; ++i) {
+        printf("%c %6" PRIu32 "  %15.1f  %9.6f  %10.0f  %10.0f\n",
+               cands[i].selected ? '*' : ' ', cands[i].hash_cnt,
+               cands[i].table_size / 8.0 / 1e3, cands[i].fp_rate,
+               cands[i].insert_rate, cands[i].lookup_rate);
+    }
+
+    // Recommended parameters (fields of bfi_params_t)
+    printf("\nengine=%s\n", engine_name(params.engine));
+    printf("est_item_cnt=%" PRIu64 "\n", params.est_item_cnt);
+    printf("fp_prob=%g\n", params.fp_prob);
+    printf("hash_cnt=%" PRIu32 "\n", params.hash_cnt);
+    printf("table_size=%" PRIu64 "\n", params.table_size);
+
+    return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+    tool_args_t args;
+    tool_result_t *results;
+    const char *cmd;
+    int opt;
+    int ret;
+
+    if (argc < 2 || strcmp(argv[1], "-h") == 0
+            || strcmp(argv[1], "--help") == 0) {
+        usage(argv[0]);
+        return argc < 2;
+    }
+    cmd = argv[1];
+
+    memset(&args, 0, sizeof(args));
+    args.threads = tool_cpu_cnt();
+    args.fp_prob = TOOL_FP_PROB_DEFAULT;
+    while ((opt = getopt(argc - 1, argv + 1, "t:o:ck1f:n:p:M:e:h")) != -1) {
+        switch (opt) {
+        case 't':
+            args.threads = (unsigned int) strtoul(optarg, NULL, 10);
+            if (args.threads == 0) {
+                args.threads = 1;
+            }
+            break;
+        case 'o':
+            args.output = optarg;
+            break;
+        case 'c':
+            args.compressed = true;
+            break;
+        case 'k':
+            args.checksum = true;
+            break;
+        case '1':
+            args.version1 = true;
+            break;
+        case 'f':
+            args.fold = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'n':
+            args.est_item_cnt = strtoull(optarg, NULL, 10);
+            break;
+        case 'p':
+            args.fp_prob = strtod(optarg, NULL);
+            break;
+        case 'M':
+            args.memory_cap = strtoull(optarg, NULL, 10) * 1024 * 1024;
+            break;
+        case 'e':
+            if (strcmp(optarg, "standard") == 0) {
+                args.engine = BFI_ENGINE_STANDARD;
+            } else if (strcmp(optarg, "register") == 0) {
+                args.engine = BFI_ENGINE_REGISTER;
+            } else {
+                fprintf(stderr, "Unsupported engine: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    args.files = argv + 1 + optind;
+    args.file_cnt = argc - 1 - optind;
+    if (args.file_cnt == 0) {
+        fprintf(stderr, "%s: no input files\n", cmd);
+        return 1;
+    }
+    if (strcmp(cmd, "fold") == 0 && args.fold == 0) {
+        args.fold = TOOL_FOLD_DEFAULT;
+    }
+
+    results = (tool_result_t *) calloc(args.file_cnt, sizeof(*results));
+    if (!results) {
+        fprintf(stderr, "%s\n", bfi_get_error_msg(BFI_E_MEM));
+        return 1;
+    }
+
+    if (strcmp(cmd, "stat") == 0) {
+        ret = cmd_stat(&args, results);
+    } else if (strcmp(cmd, "verify") == 0) {
+        ret = cmd_verify(&args, results);
+    } else if (strcmp(cmd, "merge") == 0) {
+        ret = cmd_merge(&args, results);
+    } else if (strcmp(cmd, "convert") == 0 || strcmp(cmd, "fold") == 0) {
+        ret = cmd_convert(&args, results);
+    } else if (strcmp(cmd, "similarity") == 0) {
+        ret = cmd_similarity(&args, results);
+    } else if (strcmp(cmd, "catalog") == 0) {
+        ret = cmd_catalog(&args);
+    } else if (strcmp(cmd, "tune") == 0) {
+        ret = cmd_tune(&args);
+    } else {
+        fprintf(stderr, "Unknown command: %s\n", cmd);
+        usage(argv[0]);
+        ret = 1;
+    }
+
+    free(results);
+
+    return ret;
+}
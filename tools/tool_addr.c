@@ -0,0 +1,110 @@
+/**
+ * \file tool_addr.c
+ * \brief Parsing of addresses of command line tools
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include <arpa/inet.h>
+
+#include "tool_addr.h"
+
+// Longest text of an IPv6 address accepted
+#define TOOL_IPV6_TEXT_MAX 64
+
+
+/**
+ * \brief Parse dotted IPv4 address (the whole text)
+ */
+static bool tool_parse_ipv4(const char *p, const char *end,
+                    unsigned char *addr)
+{
+    for (int octet = 0; octet < 4; ++octet) {
+        unsigned int value = 0;
+        const char *digits = p;
+
+        while (p < end && (unsigned int) (*p - '0') < 10 && p - digits < 3) {
+            value = value * 10 + (*p++ - '0');
+        }
+        if (p == digits || value > 255) {
+            return false;
+        }
+        addr[octet] = (unsigned char) value;
+        if (octet < 3) {
+            if (p == end || *p != '.') {
+                return false;
+            }
+            ++p;
+        }
+    }
+
+    return p == end;
+}
+
+
+int tool_parse_addr(const char *begin, const char *end, unsigned char *key)
+{
+    char text[TOOL_IPV6_TEXT_MAX];
+
+    while (begin < end && (*begin == ' ' || *begin == '\t')) {
+        ++begin;
+    }
+    while (end > begin && (end[-1] == '\r' || end[-1] == ' '
+            || end[-1] == '\t')) {
+        --end;
+    }
+    if (begin == end) {
+        return 0;
+    }
+
+    if (!memchr(begin, ':', end - begin)) {
+        return tool_parse_ipv4(begin, end, key) ? TOOL_IPV4_LEN : -1;
+    }
+    if (end - begin >= TOOL_IPV6_TEXT_MAX) {
+        return -1;
+    }
+    memcpy(text, begin, end - begin);
+    text[end - begin] = '\0';
+
+    return inet_pton(AF_INET6, text, key) == 1 ? TOOL_IPV6_LEN : -1;
+}
+
+
+void tool_format_addr(const unsigned char *key, size_t len, char *text)
+{
+    inet_ntop(len == TOOL_IPV4_LEN ? AF_INET : AF_INET6, key, text,
+              TOOL_ADDR_TEXT_MAX);
+}
@@ -0,0 +1,73 @@
+/**
+ * \file tool_addr.h
+ * \brief Parsing of addresses of command line tools
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _BFI_TOOL_ADDR_H
+#define _BFI_TOOL_ADDR_H
+
+#include <stddef.h>
+
+// Length of keys of IPv4 and IPv6 addresses
+#define TOOL_IPV4_LEN 4
+#define TOOL_IPV6_LEN 16
+// Size of a buffer of an address as text (INET6_ADDRSTRLEN)
+#define TOOL_ADDR_TEXT_MAX 46
+
+/**
+ * \brief Parse a line of text containing an IPv4 or IPv6 address
+ *
+ * Leading and trailing white space is ignored. IPv4 addresses are parsed in
+ * place, only IPv6 addresses are copied for inet_pton().
+ *
+ * \param[in] begin Beginning of the line
+ * \param[in] end End of the line (without the new line)
+ * \param[out] key Address in network byte order (TOOL_IPV6_LEN bytes)
+ * \return Returns length of the key, 0 for an empty line or -1 if the line
+ *    is not an address.
+ */
+int tool_parse_addr(const char *begin, const char *end, unsigned char *key);
+
+/**
+ * \brief Format a key of an address as text
+ *
+ * \param[in] key Key of TOOL_IPV4_LEN or TOOL_IPV6_LEN bytes
+ * \param[in] len Length of the key
+ * \param[out] text Buffer of TOOL_ADDR_TEXT_MAX bytes
+ */
+void tool_format_addr(const unsigned char *key, size_t len, char *text);
+
+#endif //_BFI_TOOL_ADDR_H
@@ -0,0 +1,102 @@
+/**
+ * \file tool_pool.c
+ * \brief Pool of threads processing jobs of command line tools
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "tool_pool.h"
+
+typedef struct {
+    size_t job_cnt;
+    size_t next;                // Next job to be taken
+    tool_job_fn_t fn;
+    void *ctx;
+} tool_pool_t;
+
+
+unsigned int tool_cpu_cnt(void)
+{
+    long cnt = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return cnt > 0 ? (unsigned int) cnt : 1;
+}
+
+
+static void *tool_pool_worker(void *arg)
+{
+    tool_pool_t *pool = (tool_pool_t *) arg;
+    size_t i;
+
+    while ((i = __sync_fetch_and_add(&pool->next, 1)) < pool->job_cnt) {
+        pool->fn(pool->ctx, i);
+    }
+
+    return NULL;
+}
+
+
+void tool_pool_run(size_t job_cnt, unsigned int threads, tool_job_fn_t fn,
+                    void *ctx)
+{
+    tool_pool_t pool = {job_cnt, 0, fn, ctx};
+    pthread_t *tids;
+    unsigned int started = 0;
+
+    if (threads > job_cnt) {
+        threads = (unsigned int) job_cnt;
+    }
+    tids = threads > 1 ? (pthread_t *) calloc(threads - 1, sizeof(*tids))
+                       : NULL;
+    if (tids) {
+        for (; started < threads - 1; ++started) {
+            if (pthread_create(&tids[started], NULL, tool_pool_worker,
+                               &pool) != 0) {
+                break;
+            }
+        }
+    }
+
+    // Calling thread works too (and alone if threads could not be started)
+    tool_pool_worker(&pool);
+
+    for (unsigned int t = 0; t < started; ++t) {
+        pthread_join(tids[t], NULL);
+    }
+    free(tids);
+}
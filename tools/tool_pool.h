@@ -0,0 +1,69 @@
+/**
+ * \file tool_pool.h
+ * \brief Pool of threads processing jobs of command line tools
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _BFI_TOOL_POOL_H
+#define _BFI_TOOL_POOL_H
+
+#include <stddef.h>
+
+/**
+ * \brief Job of a pool (i is the index of the job)
+ */
+typedef void (*tool_job_fn_t)(void *ctx, size_t i);
+
+/**
+ * \brief Count of online processors (default count of threads)
+ */
+unsigned int tool_cpu_cnt(void);
+
+/**
+ * \brief Process jobs [0, job_cnt) by a pool of threads
+ *
+ * Every thread takes the next unprocessed job when it finishes one, so
+ * jobs of different lengths (e.g. files of different sizes) are balanced.
+ * The calling thread is one of the threads of the pool.
+ *
+ * \param[in] job_cnt Count of jobs
+ * \param[in] threads Count of threads (at most job_cnt threads are used)
+ * \param[in] fn Job function
+ * \param[in] ctx Context passed to fn
+ */
+void tool_pool_run(size_t job_cnt, unsigned int threads, tool_job_fn_t fn,
+                    void *ctx);
+
+#endif //_BFI_TOOL_POOL_H